@@ -14,7 +14,14 @@
 //======================================================================================
 namespace nemesis
 {	
-	void NE_API Interlocked_Exchange( Atomic32* p, int32_t v );
+	int32_t NE_API Interlocked_Exchange			( Atomic32* p, int32_t v );
+	int32_t NE_API Interlocked_CompareExchange	( Atomic32* p, int32_t v, int32_t cmp );
+	int32_t NE_API Interlocked_Load				( const Atomic32* p );
+	int32_t NE_API Interlocked_Add				( Atomic32* p, int32_t v );
+
+	int64_t NE_API Interlocked_Exchange64		( Atomic64* p, int64_t v );
+	int64_t NE_API Interlocked_CompareExchange64( Atomic64* p, int64_t v, int64_t cmp );
+	int64_t NE_API Interlocked_Load64			( const Atomic64* p );
 }
 
 //======================================================================================
@@ -15,4 +15,5 @@
 namespace nemesis
 {
 	typedef int32_t Atomic32;
+	typedef int64_t Atomic64;
 }
@@ -23,6 +23,14 @@ namespace nemesis {	namespace system
 	Result_t NE_API File_Write	( File_t file, cptr_t data, uint32_t size, uint32_t* num_written );
 	Result_t NE_API File_Close	( File_t file );
 
+	/// Maps a whole file into memory for reading.
+	/// Written pages are private copies and never reach the file.
+	ptr_t	 NE_API File_Map	( cstr_t path, size_t* size, Handle_t* handle );
+	/// Creates a file of the given size and maps it for reading and writing.
+	/// The file is deleted once it is unmapped.
+	ptr_t	 NE_API File_MapTemp( cstr_t path, size_t size, Handle_t* handle );
+	void	 NE_API File_Unmap	( ptr_t ptr, Handle_t handle );
+
 	int NE_API FileTime_Compare( uint64_t lhs, uint64_t rhs );
 
 } }
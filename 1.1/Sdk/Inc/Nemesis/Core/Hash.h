@@ -0,0 +1,24 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+#include "Types.h"
+
+//======================================================================================
+namespace nemesis
+{
+	/// 64-bit xxHash of the given data.
+	uint64_t NE_API Hash_Xx64( const void* data, size_t size, uint64_t seed );
+	uint64_t NE_API Hash_Xx64( cstr_t text, uint64_t seed );
+
+	inline uint64_t Hash_Xx64( const void* data, size_t size )
+	{ return Hash_Xx64( data, size, 0 ); }
+
+}
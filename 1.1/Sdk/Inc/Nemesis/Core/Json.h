@@ -68,6 +68,6 @@ namespace nemesis
 {
 	/// Json
 
-	Result_t NE_API Json_Parse( cstr_t src, uint32_t len, const JsonClient_s& client, JsonError_s* error );
+	Result_t NE_API Json_Parse( cstr_t src, size_t len, const JsonClient_s& client, JsonError_s* error );
 
 }
@@ -47,6 +47,7 @@ namespace nemesis
 	void NE_API JsonOut_Value	( JsonOut_s& json, int32_t v );
 	void NE_API JsonOut_Value	( JsonOut_s& json, uint32_t v );
 	void NE_API JsonOut_Value	( JsonOut_s& json, float v );
+	void NE_API JsonOut_Value	( JsonOut_s& json, double v );
 	void NE_API JsonOut_Value	( JsonOut_s& json, cstr_t v );
 	void NE_API JsonOut_Field	( JsonOut_s& json, cstr_t name );
 	void NE_API JsonOut_Array	( JsonOut_s& json );
@@ -45,6 +45,11 @@ namespace nemesis {	namespace system
 	void	NE_API Event_Signal  ( Event_t ev );
 	void	NE_API Event_Unsignal( Event_t ev );
 	void	NE_API Event_Wait	 ( Event_t ev );
+	bool	NE_API Event_WaitMs	 ( Event_t ev, uint32_t ms );
+
+	/// Named events are visible to other processes and reset once a waiter has been released.
+	Event_t	NE_API Event_CreateNamed( cstr_t name );
+	Event_t	NE_API Event_OpenNamed	( cstr_t name );
 
 	Semaphore_t NE_API Semaphore_Create ( int initial, int maximum );
 	void		NE_API Semaphore_Destroy  ( Semaphore_t semaphore );
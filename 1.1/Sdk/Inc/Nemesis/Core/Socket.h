@@ -30,6 +30,7 @@ namespace nemesis {	namespace system
 	void		Socket_SetOption	( Socket_t socket, SocketArg::Option option, bool enable );
 	bool		Socket_Send			( Socket_t socket, const void* data, size_t size );
 	bool		Socket_Receive		( Socket_t socket,	     void* data, size_t size );
+	int			Socket_ReceiveSome	( Socket_t socket,	     void* data, size_t size );
 	bool		Socket_SendTo		( Socket_t socket, IpAddress_t  addr, const void* data, size_t size );
 	bool		Socket_ReceiveFrom	( Socket_t socket, IpAddress_t* addr,	    void* data, size_t size );
 
@@ -41,6 +42,7 @@ namespace nemesis {	namespace system
 	IpAddress_t	Tcp_GetPeer		( Socket_t socket );
 	bool		Tcp_Send		( Socket_t socket, const void* buffer, size_t size );
 	bool		Tcp_Receive		( Socket_t socket,		 void* buffer, size_t size );
+	int			Tcp_ReceiveSome	( Socket_t socket,		 void* buffer, size_t size );
 	void		Tcp_Close		( Socket_t socket );
 
 	Socket_t	Udp_Open		( IpPort_t port, SocketOption::Mask opt );
@@ -26,6 +26,7 @@
 #define NE_COMPILER_MSVC	1
 #define NE_COMPILER_SNC		2
 #define NE_COMPILER_CLANG	3
+#define NE_COMPILER_GCC		4
 
 //--------------------------------------------------------------------------------------
 #if defined _MSC_VER
@@ -40,6 +41,10 @@
 #	define NE_COMPILER			NE_COMPILER_CLANG
 #	define NE_COMPILER_VERSION	__clang_version__
 #	define NE_COMPILER_NAME		"LLVM C/C++"
+#elif defined __GNUC__
+#	define NE_COMPILER			NE_COMPILER_GCC
+#	define NE_COMPILER_VERSION	__VERSION__
+#	define NE_COMPILER_NAME		"GNU C/C++"
 #else
 #	error Unrecognized compiler...
 #endif
@@ -83,6 +88,7 @@
 #define NE_PLATFORM_PS5			8
 #define NE_PLATFORM_NX32		9
 #define NE_PLATFORM_NX64		10
+#define NE_PLATFORM_LINUX		11
 
 //--------------------------------------------------------------------------------------
 #define NE_PROCESSOR_X86	1
@@ -179,6 +185,13 @@
 #	define NE_PROCESSOR			NE_PROCESSOR_X64
 #	define NE_PLATFORM			NE_PLATFORM_NX64
 #	define NE_PLATFORM_NAME		"Nintendo Switch (64bit)"
+#elif (defined __linux__ && defined __x86_64__)
+	// Linux - 64 bit
+	// GCC / Clang Toolchain
+#	define NE_ENDIAN			NE_ENDIAN_INTEL
+#	define NE_PROCESSOR			NE_PROCESSOR_X64
+#	define NE_PLATFORM			NE_PLATFORM_LINUX
+#	define NE_PLATFORM_NAME		"Linux (64bit)"
 #else
 #	error Unrecognized platform...
 #endif
@@ -247,7 +260,7 @@
 #if (NE_COMPILER == NE_COMPILER_SNC)
 	extern void snPause();
 #	define NeDebugBreak()	snPause()
-#elif (NE_COMPILER == NE_COMPILER_CLANG)
+#elif ((NE_COMPILER == NE_COMPILER_CLANG) || (NE_COMPILER == NE_COMPILER_GCC))
 #	define NeDebugBreak()	__builtin_trap()
 #else
 #	define NeDebugBreak()	__debugbreak()
@@ -217,7 +217,7 @@ namespace nemesis
 		operator const NamedLocation* () const { return this; }
 
 		const char* Name;
-		Location Location;
+		::nemesis::Location Location;
 	};
 }
 
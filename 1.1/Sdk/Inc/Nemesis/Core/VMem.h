@@ -26,4 +26,14 @@ namespace nemesis
 	ptr_t	NE_API Eop_Alloc	( size_t size );
 	void	NE_API Eop_Free		( ptr_t  size );
 	size_t	NE_API Eop_SizeOf	( ptr_t  size );
-}
\ No newline at end of file
+}
+
+//======================================================================================
+namespace nemesis
+{
+	/// Named memory shared by processes on the same machine.
+	/// Creating fails if the name is in use, opening with a size of zero maps the whole segment.
+	ptr_t	NE_API SharedMem_Create	( cstr_t name, size_t size, Handle_t* handle );
+	ptr_t	NE_API SharedMem_Open	( cstr_t name, size_t size, Handle_t* handle );
+	void	NE_API SharedMem_Close	( ptr_t ptr, Handle_t handle );
+}
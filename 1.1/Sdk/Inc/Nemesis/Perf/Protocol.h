@@ -33,9 +33,13 @@ namespace nemesis {	namespace profiling
 		uint32_t DataSize() const 
 		{ return header.size - sizeof(*this); }
 
+		/// Index of the recording thread plus one, zero for meta data.
+		int SourceThread() const
+		{ return (int)source - 1; }
+
 		Chunk header;
 		uint32_t flags;
-		uint32_t reserved;
+		uint32_t source;
 	};
 
 } }
@@ -51,12 +55,14 @@ namespace nemesis {	namespace profiling
 			{ EnterScope			= 0x00a0
 			, EnterIdleScope		= 0x00a1
 			, EnterLockScope		= 0x00a2
+			, EnterDynamicScope		= 0x00a3
 			, LeaveScope			= 0x00b0
 			, EnterLock				= 0x0030
 			, LeaveLock				= 0x0031
 			, EndFrame				= 0x0041
 			, NameList				= 0x0102
 			, LocationList			= 0x0103
+			, NameRelease			= 0x0104
 			, ThreadInfo			= 0x2002
 			, MutexInfo				= 0x2004
 			, Counter_U32_32		= 0x2010
@@ -85,6 +91,20 @@ namespace nemesis {	namespace profiling
 			int64_t timeStamp;
 		};
 
+		/// A scope named by runtime text.
+		/// The name is the content hash of the text which is sent once in a name list.
+		struct EnterDynamicScope
+		{
+			Chunk header;
+			uint8_t threadId;
+			uint8_t cpuId;
+			uint8_t type;
+			uint8_t _pad_;
+			uint32_t location;
+			int64_t timeStamp;
+			uint64_t name;
+		};
+
 		struct LeaveScope
 		{
 			Chunk header;
@@ -122,6 +142,14 @@ namespace nemesis {	namespace profiling
 			uint32_t _pad_;
 		};
 
+		/// Sent when a dynamic name is recycled by the server.
+		/// Viewers may ignore it; it lets the server drop the name from its backlog.
+		struct NameRelease
+		{
+			Chunk header;
+			uint64_t name;
+		};
+
 		struct LocationItem
 		{
 			uint64_t name;
@@ -267,6 +295,17 @@ namespace nemesis
 		out.timeStamp	= nemesis::EndianSwap( in.timeStamp );
 	}
 
+	inline void EndianSwap( const chunk::EnterDynamicScope& in, chunk::EnterDynamicScope& out )
+	{
+		EndianSwap( in.header, out.header );
+		out.threadId	= nemesis::EndianSwap( in.threadId );
+		out.cpuId		= nemesis::EndianSwap( in.cpuId );
+		out.type		= nemesis::EndianSwap( in.type );
+		out.location	= nemesis::EndianSwap( in.location );
+		out.timeStamp	= nemesis::EndianSwap( in.timeStamp );
+		out.name		= nemesis::EndianSwap( in.name );
+	}
+
 	inline void EndianSwap( const chunk::LeaveScope& in, chunk::LeaveScope& out )
 	{
 		EndianSwap( in.header, out.header );
@@ -384,6 +423,12 @@ namespace nemesis
 		out.reserved = nemesis::EndianSwap( in.reserved );
 	}
 
+	inline void EndianSwap( const chunk::NameRelease& in, chunk::NameRelease& out )
+	{
+		EndianSwap( in.header, out.header );
+		out.name = nemesis::EndianSwap( in.name );
+	}
+
 	inline void EndianSwap( const chunk::LocationList& in, chunk::LocationList& out )
 	{
 		EndianSwap( in.header, out.header );
@@ -417,7 +462,7 @@ namespace nemesis { namespace profiling
 
 		struct Response
 		{
-			Header Header;
+			ping::Header Header;
 			uint32_t	   Data[4];
 		};
 	}
@@ -33,6 +33,7 @@ namespace nemesis { namespace profiling
 		, NumLocks
 		, BacklogSize
 		, BacklogCapacity
+		, NumDynamicNames
 		, COUNT			 
 		};
 	};
@@ -60,6 +61,7 @@ namespace nemesis { namespace profiling
 	void	 Server_LeaveScopeEx	( Server_t server, const NamedLocation& scope, int64_t tick );
 	void	 Server_EnterScope		( Server_t server, const NamedLocation& scope, ScopeType::Enum type );
 	void	 Server_LeaveScope		( Server_t server, const NamedLocation& scope );
+	void	 Server_EnterDynamicScope( Server_t server, const NamedLocation& scope, const char* name, ScopeType::Enum type );
 	void	 Server_SetMutexInfo	( Server_t server, const void* handle, const char* name );
 	void	 Server_EnterMutex		( Server_t server, const void* handle );
 	void	 Server_LeaveMutex		( Server_t server, const void* handle );
@@ -70,6 +72,8 @@ namespace nemesis { namespace profiling
 	void	 Server_RecordLog		( Server_t server, const NamedLocation& scope, const char* text );
 	void	 Server_StartSender		( Server_t server, uint16_t port );
 	void	 Server_StopSender		( Server_t server );
+	Result_t Server_StartSharedSender( Server_t server, const char* name );
+	void	 Server_StopSharedSender( Server_t server );
 
 	Result_t Server_Initialize		( Allocator_t alloc );
 	void	 Server_Shutdown		();
@@ -81,6 +85,7 @@ namespace nemesis { namespace profiling
 	void	 Server_LeaveScopeEx	( const NamedLocation& scope, int64_t tick );
 	void	 Server_EnterScope		( const NamedLocation& scope, ScopeType::Enum type );
 	void	 Server_LeaveScope		( const NamedLocation& scope );
+	void	 Server_EnterDynamicScope( const NamedLocation& scope, const char* name, ScopeType::Enum type );
 	void	 Server_SetMutexInfo	( const void* handle, const char* name );
 	void	 Server_EnterMutex		( const void* handle );
 	void	 Server_LeaveMutex		( const void* handle );
@@ -91,6 +96,8 @@ namespace nemesis { namespace profiling
 	void	 Server_RecordLog		( const NamedLocation& scope, const char* text );
 	void	 Server_StartSender		( uint16_t port );
 	void	 Server_StopSender		();
+	Result_t Server_StartSharedSender( const char* name );
+	void	 Server_StopSharedSender();
 
 } }
 
@@ -111,6 +118,18 @@ namespace nemesis { namespace profiling
 		{ Server_LeaveScope(*this); }
 	};
 
+	/// A scope named by runtime text, e.g. an asset or method name.
+	/// The text is hashed and only needs to stay valid for the duration of the constructor.
+	struct DynamicScope_s : public NamedLocation
+	{
+		DynamicScope_s( const char* function, const char* file, unsigned long line, const char* name, ScopeType::Enum type = ScopeType::Regular )
+			: NamedLocation(function, function, file, line)
+		{ Server_EnterDynamicScope(*this, name, type); }
+
+		~DynamicScope_s()
+		{ Server_LeaveScope(*this); }
+	};
+
 } }
 
 //======================================================================================
@@ -135,7 +154,10 @@ namespace nemesis { namespace profiling
 #	define NePerfLog( text )					::nemesis::profiling::Server_RecordLog( NamedLocation( __FUNCTION__, __FUNCTION__, __FILE__, __LINE__ ), text )
 #	define NePerfStartSender( ... )				::nemesis::profiling::Server_StartSender( __VA_ARGS__ )
 #	define NePerfStopSender						::nemesis::profiling::Server_StopSender
+#	define NePerfStartSharedSender( ... )		::nemesis::profiling::Server_StartSharedSender( __VA_ARGS__ )
+#	define NePerfStopSharedSender				::nemesis::profiling::Server_StopSharedSender
 #	define NePerfScope( ... )					::nemesis::profiling::Scope_s NeUnique(scope)( __FUNCTION__, __FILE__, __LINE__, __VA_ARGS__ )
+#	define NePerfDynamicScope( ... )			::nemesis::profiling::DynamicScope_s NeUnique(scope)( __FUNCTION__, __FILE__, __LINE__, __VA_ARGS__ )
 #else
 #	define NePerfInit(...)						//__noop
 #	define NePerfShutdown(...)					//__noop
@@ -152,7 +174,10 @@ namespace nemesis { namespace profiling
 #	define NePerfLog( text )					//__noop( text )
 #	define NePerfStartSender( ... )				//__noop( __VA_ARGS__ )
 #	define NePerfStopSender						//__noop
+#	define NePerfStartSharedSender( ... )		//__noop( __VA_ARGS__ )
+#	define NePerfStopSharedSender				//__noop
 #	define NePerfScope( ... )					//__noop( __VA_ARGS__ )
+#	define NePerfDynamicScope( ... )			//__noop( __VA_ARGS__ )
 #endif
 
 #define NePerfFunc NePerfScope( __FUNCTION__ )
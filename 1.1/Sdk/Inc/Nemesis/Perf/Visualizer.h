@@ -37,6 +37,8 @@ namespace nemesis { namespace profiling
 	void				Receiver_Destroy( Receiver_t receiver );
 	bool				Receiver_IsConnected( Receiver_t receiver );
 	Connect::Result		Receiver_Connect( Receiver_t receiver, system::IpAddress_t addr, const ReceiverCallback& callback );
+	Connect::Result		Receiver_ConnectShared( Receiver_t receiver, const char* name, const ReceiverCallback& callback );
+	Connect::Result		Receiver_ConnectFile( Receiver_t receiver, const char* path, const ReceiverCallback& callback );
 	void				Receiver_Disconnect( Receiver_t receiver );
 	system::Socket_t	Receiver_GetSocket( Receiver_t receiver );
 	bool				Receiver_IsPaused( Receiver_t receiver );
@@ -47,6 +49,8 @@ namespace nemesis { namespace profiling
 //======================================================================================
 namespace nemesis { namespace profiling
 {
+	/// Immediate parses on the calling thread whenever the parser has nothing queued.
+	/// Buffered always hands the packet to the parser thread.
 	struct Parse
 	{
 		enum Mode
@@ -65,6 +69,7 @@ namespace nemesis { namespace profiling
 	void		Parser_Destroy		( Parser_t parser );
 	void		Parser_ParseData	( Parser_t parser, const Packet& packet, const Chunk* head, Parse::Mode mode );
 	void		Parser_JoinData		( Parser_t parser );
+	void		Parser_FlushData	( Parser_t parser );
 	void		Parser_ResetData	( Parser_t parser );
 	bool		Parser_IsPaused		( Parser_t parser );
 	void		Parser_Pause		( Parser_t parser, bool pause );
@@ -75,19 +80,30 @@ namespace nemesis { namespace profiling
 //======================================================================================
 namespace nemesis { namespace profiling
 {
+	/// Once MaxNumBytes are used, scope events older than the last NumHotFrames are packed
+	/// and other events are moved to a temporary spill file at SpillPath until it holds MaxSpillBytes.
+	/// Only then are the oldest frames dropped.
 	struct DatabaseSetup_s
 	{
 		uint32_t MaxNumBytes;
 		uint32_t MaxNumFrames;
+		uint32_t NumHotFrames;
+		cstr_t	 SpillPath;
+		size_t	 MaxSpillBytes;
 	};
 
 	typedef void (*EnumFrameGroupsFunc)	( void* context, const viz::FrameGroup& item );
 	typedef void (*EnumZoneGroupsFunc)	( void* context, const viz::ZoneGroup& item );
 	typedef void (*EnumCpuGroupsFunc)	( void* context, const viz::CpuGroup& item );
 	typedef void (*EnumLockEventFunc)	( void* context, const viz::LockEvent& ev, int event_index );
+	typedef void (*EnumOccurrencesFunc)	( void* context, const viz::Occurrence& item );
 
 	Database_t			Database_Create					( Allocator_t alloc, const DatabaseSetup_s& setup );
 	void				Database_Destroy				( Database_t db );
+	bool				Database_Save					( Database_t db, cstr_t path );
+	bool				Database_Open					( Database_t db, cstr_t path );
+	bool				Database_ExportTrace			( Database_t db, cstr_t path );
+	bool				Database_ImportTrace			( Database_t db, cstr_t path );
 	size_t				Database_GetSize				( Database_t db );
 	size_t				Database_GetCapacity			( Database_t db );
 	void				Database_SetCapacity			( Database_t db, size_t size );
@@ -110,7 +126,7 @@ namespace nemesis { namespace profiling
 	void				Database_GetThread				( Database_t db, int index, viz::Thread& item );
 	int					Database_GetNumFrames			( Database_t db );
 	void				Database_GetFrame				( Database_t db, int index, viz::Frame& item );
-	const viz::Frame*	Database_GetFrames				( Database_t db );
+	const viz::Frame&	Database_GetFrame				( Database_t db, int index );
 	int					Database_GetNumLocks			( Database_t db );
 	void				Database_GetLock				( Database_t db, int index, viz::Lock& item );
 	int					Database_GetNumCounters			( Database_t db );
@@ -119,14 +135,35 @@ namespace nemesis { namespace profiling
 	void				Database_GetCounterGroup		( Database_t db, int index, viz::CounterGroup& item );
 	int					Database_GetNumCounterValues	( Database_t db );
 	void				Database_GetCounterValue		( Database_t db, int index, viz::CounterValue& item );
+	int					Database_GetCounterSeries		( Database_t db, int counter_index, const TickInterval& time, viz::CounterRange* items, int max_items );
 	int  				Database_GetNumLocations		( Database_t db );
 	void 				Database_GetLocation			( Database_t db, int index, NamedLocation& item );
-	void 				Database_GetLocationByZone		( Database_t db, int zone, NamedLocation& item );
+	void 				Database_GetLocationByZone		( Database_t db, int thread_index, int zone, NamedLocation& item );
 	int  				Database_GetNumScopes			( Database_t db );
 	void 				Database_EnumFrameGroups		( Database_t db, const viz::FrameRange& cull, const viz::FrameGroupSetup& setup, EnumFrameGroupsFunc func, void* context );
 	void 				Database_EnumZoneGroups 		( Database_t db, const viz::FrameRange& cull, const viz::ZoneGroupSetup& setup, int thread_index, EnumZoneGroupsFunc func, void* context );
 	void 				Database_EnumCpuGroups  		( Database_t db, const viz::FrameRange& cull, const viz::CpuGroupSetup& setup, int thread_index, EnumCpuGroupsFunc func, void* context );
 	void 				Database_EnumLockEvents 		( Database_t db, int lock_index, int first_frame, int num_frames, EnumLockEventFunc func, void* context );
+	bool				Database_GetLockStats			( Database_t db, int lock_index, const IndexRange& frames, viz::LockStats& stats );
+	int					Database_GetContendedLocks		( Database_t db, const IndexRange& frames, int* locks, viz::LockStats* stats, int max_items );
+	int					Database_QueryZones				( Database_t db, const viz::ZoneQuery& query, viz::ZoneQueryRow* rows, int max_rows );
+	bool				Database_QueryZone				( Database_t db, int thread_index, uint32_t zone, viz::ZoneQueryRow& row );
+	int					Database_GetOpenZones			( Database_t db, int thread_index, uint32_t* zones, int max_zones );
 	void 				Database_BuildHotSpots  		( Database_t db, const viz::HotSpotRange& range, viz::HotSpotGroup& group );
+	bool				Database_GetLocationStats		( Database_t db, int location, const IndexRange& frames, viz::LocationStats& stats );
+	bool				Database_GetLocationTotalStats	( Database_t db, int location, viz::LocationStats& stats );
+	bool				Database_FindNextOccurrence		( Database_t db, int location, Tick tick, viz::Occurrence& item );
+	bool				Database_FindPrevOccurrence		( Database_t db, int location, Tick tick, viz::Occurrence& item );
+	bool				Database_FindLongestOccurrence	( Database_t db, int location, const IndexRange& frames, viz::Occurrence& item );
+	void				Database_EnumOccurrences		( Database_t db, int location, const TickInterval& time, EnumOccurrencesFunc func, void* context );
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	/// Buckets of the histograms laid out as viz::StatsHistogram.
+	uint32_t			Stats_GetBucket					( Tick duration );
+	uint64_t			Stats_GetBucketBegin			( uint32_t bucket );
 
 } }
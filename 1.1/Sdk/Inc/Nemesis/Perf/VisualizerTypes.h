@@ -89,10 +89,68 @@ namespace nemesis { namespace profiling { namespace viz
 	struct LockEvent
 	{
 		int64_t Tick;
-		uint8_t Lock;
+		uint32_t Lock;
 		uint8_t Thread;
 		uint8_t Enter;
-		uint8_t _padding_;
+		uint8_t _padding_[2];
+	};
+
+	/// Time a thread spent waiting for a lock.
+	struct LockWaiter
+	{
+		Tick WaitTicks;
+		uint32_t NumWaits;
+		uint8_t Thread;
+		uint8_t _pad_[3];
+	};
+
+	/// Contention of a lock within a range of frames.
+	/// A lock is requested when it is entered and acquired once its previous owner left it.
+	struct LockStats
+	{
+		enum { MAX_WAITERS = 4 };
+
+		Tick WaitTicks;
+		Tick HoldTicks;
+		uint32_t NumAcquires;
+		uint32_t NumContended;
+		uint32_t MaxWaiters;
+		uint32_t NumWaiters;
+		LockWaiter Waiters[ MAX_WAITERS ];
+	};
+
+	/// Selects zones within a range of frames and aggregates them per group.
+	struct ZoneQuery
+	{
+		struct Group
+		{
+			enum Enum
+			{ Location
+			, Thread
+			, Level
+			, Frame
+			};
+		};
+
+		IndexRange	Frames;
+		uint64_t	Threads;		///< Mask of the threads to include, zero includes all
+		int32_t		Location;		///< Location to include, negative includes all
+		uint8_t		MinLevel;
+		uint8_t		MaxLevel;		///< Zero includes all levels from MinLevel
+		uint8_t		GroupBy;		///< Group::Enum
+		uint8_t		_padding_;
+		Tick		MinDuration;
+	};
+
+	/// Zones of a single group of a zone query.
+	struct ZoneQueryRow
+	{
+		uint32_t	Key;			///< Location (~0u if unknown), thread, level or frame relative to the queried frames
+		uint32_t	NumZones;
+		Tick		TotalTicks;
+		Tick		SelfTicks;
+		Tick		MinTicks;
+		Tick		MaxTicks;
 	};
 
 	struct Counter
@@ -101,6 +159,7 @@ namespace nemesis { namespace profiling { namespace viz
 		uint32_t Group; 
 		float Minimum;
 		float Maximum;
+		uint32_t Series;
 	};
 
 	struct CounterGroup
@@ -114,18 +173,30 @@ namespace nemesis { namespace profiling { namespace viz
 	{
 		const char* Name;
 		float Value;
+		uint32_t Series;
+	};
+
+	/// Values of a counter within a time interval.
+	struct CounterRange
+	{
+		TickInterval Time;
+		float Min;
+		float Max;
+		float Avg;
+		uint32_t NumValues;
 	};
 
 	/// A profiling frame
 	struct Frame
 	{
 		TickInterval Time;
-		uint32_t FirstScopeEvent;
 		uint32_t NumScopeEvents;
 		uint32_t FirstLockEvent;
 		uint32_t NumLockEvents;
 		uint32_t FirstCounterValue;
 		uint32_t NumCounterValues;
+		uint32_t FirstLogItem;
+		uint32_t NumLogItems;
 		uint32_t ParsedBytes;
 	};
 
@@ -155,6 +226,7 @@ namespace nemesis { namespace profiling { namespace viz
 		uint32_t Location;
 		uint32_t NumSamples;
 		Tick Duration;
+		Tick SelfDuration;
 	};
 
 	struct HotSpotGroup
@@ -169,6 +241,39 @@ namespace nemesis { namespace profiling { namespace viz
 		int NumHotSpotsPerFrame;
 	};
 
+	/// A zone of a location.
+	/// Zone is the index of the zone's enter event like the zone group's index.
+	struct Occurrence
+	{
+		TickInterval Time;
+		int		 Frame;
+		uint32_t Zone;
+		uint8_t	 Thread;
+		uint8_t	 Level;
+		uint8_t	 _pad_[6];
+	};
+
+	/// Distribution of the durations of a location's zones.
+	struct LocationStats
+	{
+		uint32_t Count;
+		uint32_t _pad_;
+		Tick Min;
+		Tick Max;
+		Tick Mean;
+		Tick Total;
+		Tick P50;
+		Tick P90;
+		Tick P99;
+	};
+
+	/// Log-linear histogram layout of the location stats.
+	/// Durations below 2^(SUB_SHIFT+1) have a bucket each, above that every power of two is split into 2^SUB_SHIFT buckets.
+	struct StatsHistogram
+	{
+		enum { SUB_SHIFT = 3, NUM_BUCKETS = (64 - SUB_SHIFT + 1) << SUB_SHIFT };
+	};
+
 } } }
 
 //======================================================================================
@@ -0,0 +1,355 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#include "stdafx.h"
+#include "analyzer.h"
+
+//======================================================================================
+using namespace nemesis;
+using namespace nemesis::profiling;
+
+//======================================================================================
+void Histogram_Add(Histogram_s& hist, Tick value)
+{
+	if (!hist.Count || (value < hist.Min)) hist.Min = value;
+	if (!hist.Count || (value > hist.Max)) hist.Max = value;
+	hist.Count += 1;
+	hist.Sum += value;
+	hist.Bins[Stats_GetBucket(value)] += 1;
+}
+
+/// Returns the lower bound of the bucket holding the given percentile, clamped to the observed range.
+Tick Histogram_GetPercentile(const Histogram_s& hist, uint32_t percent)
+{
+	const uint64_t rank = NeMax<uint64_t>(1, (hist.Count * percent + 99) / 100);
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i < Histogram_s::NUM_BUCKETS; ++i)
+	{
+		seen += hist.Bins[i];
+		if (seen >= rank)
+			return NeClamp((Tick)Stats_GetBucketBegin(i), hist.Min, hist.Max);
+	}
+	return hist.Max;
+}
+
+//======================================================================================
+template <typename T>
+static void Analyzer_Grow(Array<T>& items, int count)
+{
+	if (items.Count >= count)
+		return;
+	const int old = items.Count;
+	items.Resize(count);
+	Arr_Zero(items.Data + old, count - old);
+}
+
+static void Analyzer_AddFrames(Analyzer_s& an, const IndexRange& frames)
+{
+	for (int i = frames.First; i < frames.End(); ++i)
+		Histogram_Add(an.Frames, Database_GetFrame(an.Db, i).Time.Duration());
+}
+
+static void Analyzer_AddRow(Analyzer_s& an, const viz::ZoneQueryRow& row)
+{
+	// zones of unknown locations have no name to report
+	if (row.Key >= (uint32_t)an.Locations.Count)
+		return;
+	LocationTotal_s& total = an.Locations[row.Key];
+	total.NumZones	 += row.NumZones;
+	total.TotalTicks += row.TotalTicks;
+	total.SelfTicks	 += row.SelfTicks;
+	total.MaxTicks	  = NeMax(total.MaxTicks, row.MaxTicks);
+}
+
+/// Adds the zones carried over from the last update which have been left since
+/// and carries over the zones which are still open.
+static void Analyzer_AddOpenZones(Analyzer_s& an)
+{
+	for (int i = 0; i < an.OpenZones.Count; ++i)
+	{
+		viz::ZoneQueryRow row;
+		if (Database_QueryZone(an.Db, an.OpenZones[i].Thread, an.OpenZones[i].Zone, row))
+			Analyzer_AddRow(an, row);
+	}
+	an.OpenZones.Reset();
+
+	uint32_t zones[256];
+	const int num_threads = Database_GetNumThreads(an.Db);
+	for (int i = 0; i < num_threads; ++i)
+	{
+		const int num_zones = Database_GetOpenZones(an.Db, i, zones, (int)NeCountOf(zones));
+		for (int j = 0; j < num_zones; ++j)
+		{
+			const OpenZone_s open = { i, zones[j] };
+			an.OpenZones.Append(open);
+		}
+	}
+}
+
+static void Analyzer_AddZones(Analyzer_s& an, const IndexRange& frames)
+{
+	const int num_locations = Database_GetNumLocations(an.Db);
+	if (!num_locations)
+		return;
+	Analyzer_Grow(an.Locations, num_locations);
+	an.Rows.Resize(num_locations + 1);
+
+	viz::ZoneQuery query;
+	NeZero(query);
+	query.Frames   = frames;
+	query.Location = -1;
+	query.GroupBy  = viz::ZoneQuery::Group::Location;
+
+	const int num_rows = Database_QueryZones(an.Db, query, an.Rows.Data, an.Rows.Count);
+	for (int i = 0; i < num_rows; ++i)
+		Analyzer_AddRow(an, an.Rows[i]);
+	Analyzer_AddOpenZones(an);
+}
+
+static void Analyzer_AddLocks(Analyzer_s& an, const IndexRange& frames)
+{
+	const int num_locks = Database_GetNumLocks(an.Db);
+	if (!num_locks)
+		return;
+	Analyzer_Grow(an.Locks, num_locks);
+	an.LockIds.Resize(num_locks);
+	an.LockStats.Resize(num_locks);
+
+	const int num_items = Database_GetContendedLocks(an.Db, frames, an.LockIds.Data, an.LockStats.Data, num_locks);
+	for (int i = 0; i < num_items; ++i)
+	{
+		const viz::LockStats& stats = an.LockStats[i];
+		LockTotal_s& total = an.Locks[an.LockIds[i]];
+		total.NumAcquires  += stats.NumAcquires;
+		total.NumContended += stats.NumContended;
+		total.WaitTicks	   += stats.WaitTicks;
+		total.HoldTicks	   += stats.HoldTicks;
+		total.MaxWaiters	= NeMax(total.MaxWaiters, stats.MaxWaiters);
+	}
+}
+
+/// Adds the counter values sampled within the given time.
+static void Analyzer_AddCounters(Analyzer_s& an, const TickInterval& time)
+{
+	const int num_counters = Database_GetNumCounters(an.Db);
+	if (!num_counters)
+		return;
+	Analyzer_Grow(an.Counters, num_counters);
+
+	for (int i = 0; i < num_counters; ++i)
+	{
+		viz::CounterRange range;
+		if (!Database_GetCounterSeries(an.Db, i, time, &range, 1))
+			continue;
+
+		CounterTotal_s& total = an.Counters[i];
+		if (!total.NumValues || (range.Min < total.Min)) total.Min = range.Min;
+		if (!total.NumValues || (range.Max > total.Max)) total.Max = range.Max;
+		total.NumValues += range.NumValues;
+		total.Sum		+= (double)range.Avg * range.NumValues;
+	}
+}
+
+//======================================================================================
+static int NE_CALLBK CompareLocations(void* context, const void* lhs, const void* rhs)
+{
+	const Analyzer_s& an = *(const Analyzer_s*)context;
+	const Tick a = an.Locations[*(const int*)lhs].TotalTicks;
+	const Tick b = an.Locations[*(const int*)rhs].TotalTicks;
+	return (a > b) ? -1 : (a < b) ? 1 : 0;
+}
+
+static int NE_CALLBK CompareLocks(void* context, const void* lhs, const void* rhs)
+{
+	const Analyzer_s& an = *(const Analyzer_s*)context;
+	const Tick a = an.Locks[*(const int*)lhs].WaitTicks;
+	const Tick b = an.Locks[*(const int*)rhs].WaitTicks;
+	return (a > b) ? -1 : (a < b) ? 1 : 0;
+}
+
+/// Returns the indices of the non-empty items sorted by the given comparer.
+template <typename T, typename F>
+static void Analyzer_Sort(const Analyzer_s& an, const Array<T>& items, F is_used, int (NE_CALLBK *compare)(void*, const void*, const void*), Array<int>& order)
+{
+	for (int i = 0; i < items.Count; ++i)
+		if (is_used(items[i]))
+			order.Append(i);
+	const SortClient_s client = { compare, (void*)&an };
+	Sort_Quick(order.Data, order.Count, sizeof(int), client);
+}
+
+static void Analyzer_ReportFrames(const Analyzer_s& an, FILE* out)
+{
+	const Clock& clock = Database_GetClock(an.Db);
+	const Histogram_s& hist = an.Frames;
+	fprintf(out, "frames: %llu\n", (unsigned long long)hist.Count);
+	if (an.NumEvictedFrames)
+		fprintf(out, "  %u frames were evicted before they were analyzed, raise the memory limit to keep up\n", an.NumEvictedFrames);
+	if (!hist.Count)
+		return;
+	fprintf(out, "  avg %.3f ms, min %.3f ms, p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n"
+		, clock.TickToMs((Tick)(hist.Sum / (Tick)hist.Count))
+		, clock.TickToMs(hist.Min)
+		, clock.TickToMs(Histogram_GetPercentile(hist, 50))
+		, clock.TickToMs(Histogram_GetPercentile(hist, 90))
+		, clock.TickToMs(Histogram_GetPercentile(hist, 99))
+		, clock.TickToMs(hist.Max)
+		);
+}
+
+static bool IsLocationUsed(const LocationTotal_s& item) { return item.NumZones != 0; }
+static bool IsLockUsed	  (const LockTotal_s& item)		{ return item.WaitTicks != 0; }
+
+static void Analyzer_ReportLocations(const Analyzer_s& an, FILE* out, int max_rows)
+{
+	const Clock& clock = Database_GetClock(an.Db);
+	Array<int> order(an.Alloc);
+	Analyzer_Sort(an, an.Locations, IsLocationUsed, CompareLocations, order);
+
+	fprintf(out, "\ntop locations by total time:\n");
+	fprintf(out, "  %12s %12s %12s %10s %10s  %s\n", "total ms", "self ms", "zones", "avg ms", "max ms", "name");
+	for (int i = 0; i < NeMin(order.Count, max_rows); ++i)
+	{
+		const LocationTotal_s& item = an.Locations[order[i]];
+		NamedLocation loc;
+		Database_GetLocation(an.Db, order[i], loc);
+		fprintf(out, "  %12.3f %12.3f %12llu %10.3f %10.3f  %s (%s:%lu)\n"
+			, clock.TickToMs(item.TotalTicks)
+			, clock.TickToMs(item.SelfTicks)
+			, (unsigned long long)item.NumZones
+			, clock.TickToMs((Tick)(item.TotalTicks / (Tick)item.NumZones))
+			, clock.TickToMs(item.MaxTicks)
+			, loc.Name, loc.Location.File, loc.Location.Line
+			);
+	}
+}
+
+static void Analyzer_ReportLocks(const Analyzer_s& an, FILE* out, int max_rows)
+{
+	const Clock& clock = Database_GetClock(an.Db);
+	Array<int> order(an.Alloc);
+	Analyzer_Sort(an, an.Locks, IsLockUsed, CompareLocks, order);
+
+	fprintf(out, "\ncontended locks:\n");
+	if (!order.Count)
+	{
+		fprintf(out, "  none\n");
+		return;
+	}
+	fprintf(out, "  %12s %12s %12s %12s %8s  %s\n", "wait ms", "hold ms", "acquires", "contended", "waiters", "name");
+	for (int i = 0; i < NeMin(order.Count, max_rows); ++i)
+	{
+		const LockTotal_s& item = an.Locks[order[i]];
+		viz::Lock lock;
+		Database_GetLock(an.Db, order[i], lock);
+		fprintf(out, "  %12.3f %12.3f %12llu %12llu %8u  %s\n"
+			, clock.TickToMs(item.WaitTicks)
+			, clock.TickToMs(item.HoldTicks)
+			, (unsigned long long)item.NumAcquires
+			, (unsigned long long)item.NumContended
+			, item.MaxWaiters
+			, lock.Name ? lock.Name : "<unnamed>"
+			);
+	}
+}
+
+static void Analyzer_ReportCounters(const Analyzer_s& an, FILE* out)
+{
+	fprintf(out, "\ncounters:\n");
+	fprintf(out, "  %14s %14s %14s %12s  %s\n", "min", "avg", "max", "values", "name");
+	for (int i = 0; i < an.Counters.Count; ++i)
+	{
+		const CounterTotal_s& item = an.Counters[i];
+		if (!item.NumValues)
+			continue;
+		viz::Counter counter;
+		Database_GetCounter(an.Db, i, counter);
+		fprintf(out, "  %14.3f %14.3f %14.3f %12llu  %s\n"
+			, item.Min
+			, item.Sum / (double)item.NumValues
+			, item.Max
+			, (unsigned long long)item.NumValues
+			, counter.Name
+			);
+	}
+}
+
+//======================================================================================
+void Analyzer_Initialize(Analyzer_s& an, Allocator_t alloc, Database_t db)
+{
+	NeZero(an);
+	an.Alloc = alloc;
+	an.Db	 = db;
+	an.Locations.Init(alloc);
+	an.OpenZones.Init(alloc);
+	an.Locks	.Init(alloc);
+	an.Counters .Init(alloc);
+	an.Rows		.Init(alloc);
+	an.LockIds	.Init(alloc);
+	an.LockStats.Init(alloc);
+}
+
+void Analyzer_Shutdown(Analyzer_s& an)
+{
+	an.Locations.Clear();
+	an.OpenZones.Clear();
+	an.Locks	.Clear();
+	an.Counters .Clear();
+	an.Rows		.Clear();
+	an.LockIds	.Clear();
+	an.LockStats.Clear();
+}
+
+/// Adds the frames joined since the last update.
+void Analyzer_Update(Analyzer_s& an)
+{
+	if (!Database_GetNumFrames(an.Db))
+		return;
+
+	// count frames dropped before they were seen and start over after the first update or a reset of the stream
+	const uint32_t first = Database_GetFirstFrameNumber(an.Db);
+	const uint32_t last	 = Database_GetLastFrameNumber(an.Db);
+	if (an.HasFrames && (an.NextFrame < first))
+		an.NumEvictedFrames += first - an.NextFrame;
+	if (!an.HasFrames || (an.NextFrame > last + 1))
+		an.OpenZones.Reset();
+	if (!an.HasFrames || (an.NextFrame < first) || (an.NextFrame > last + 1))
+		an.NextFrame = first;
+	an.HasFrames = true;
+	if (an.NextFrame > last)
+		return;
+
+	const IndexRange frames = { (int)(an.NextFrame - first), (int)(last - an.NextFrame + 1) };
+	an.NextFrame = last + 1;
+
+	// samples at the end of the last frame are added by the next update or the final flush
+	const TickInterval time = { Database_GetFrame(an.Db, frames.First).Time.Begin, Database_GetFrame(an.Db, frames.Last()).Time.End };
+	Analyzer_AddFrames	(an, frames);
+	Analyzer_AddZones	(an, frames);
+	Analyzer_AddLocks	(an, frames);
+	Analyzer_AddCounters(an, time);
+}
+
+/// Adds the remaining frames once no more frames follow.
+void Analyzer_Flush(Analyzer_s& an)
+{
+	Analyzer_Update(an);
+	if (!an.HasFrames || !Database_GetNumFrames(an.Db))
+		return;
+	const Tick end = Database_GetLastEndTick(an.Db);
+	const TickInterval time = { end, end + 1 };
+	Analyzer_AddCounters(an, time);
+}
+
+void Analyzer_Report(const Analyzer_s& an, FILE* out, int max_rows)
+{
+	Analyzer_ReportFrames	(an, out);
+	Analyzer_ReportLocations(an, out, max_rows);
+	Analyzer_ReportLocks	(an, out, max_rows);
+	Analyzer_ReportCounters	(an, out);
+}
@@ -0,0 +1,84 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+/// Log-linear histogram of durations laid out like the location stats.
+struct Histogram_s
+{
+	enum { NUM_BUCKETS = ne::profiling::viz::StatsHistogram::NUM_BUCKETS };
+
+	uint64_t			 Count;
+	ne::profiling::Tick	 Min;
+	ne::profiling::Tick	 Max;
+	ne::profiling::Tick	 Sum;
+	uint32_t			 Bins[NUM_BUCKETS];
+};
+
+void				NE_API Histogram_Add		(Histogram_s& hist, ne::profiling::Tick value);
+ne::profiling::Tick NE_API Histogram_GetPercentile(const Histogram_s& hist, uint32_t percent);
+
+//======================================================================================
+struct LocationTotal_s
+{
+	uint64_t			NumZones;
+	ne::profiling::Tick TotalTicks;
+	ne::profiling::Tick SelfTicks;
+	ne::profiling::Tick MaxTicks;
+};
+
+struct LockTotal_s
+{
+	uint64_t			NumAcquires;
+	uint64_t			NumContended;
+	ne::profiling::Tick WaitTicks;
+	ne::profiling::Tick HoldTicks;
+	uint32_t			MaxWaiters;
+};
+
+struct CounterTotal_s
+{
+	uint64_t NumValues;
+	double	 Sum;
+	float	 Min;
+	float	 Max;
+};
+
+/// Zone still open at the end of an update, added once it has been left.
+struct OpenZone_s
+{
+	int32_t	 Thread;
+	uint32_t Zone;
+};
+
+/// Gathers statistics from the frames of a database as they are joined.
+/// Frames only need to stay in the database until the next update,
+/// so captures of any length are analyzed within the database's memory limit.
+struct Analyzer_s
+{
+	ne::Allocator_t							Alloc;
+	ne::profiling::Database_t				Db;
+	uint32_t								NextFrame;
+	uint32_t								NumEvictedFrames;
+	bool									HasFrames;
+	Histogram_s								Frames;
+	ne::Array<LocationTotal_s>				Locations;
+	ne::Array<OpenZone_s>					OpenZones;
+	ne::Array<LockTotal_s>					Locks;
+	ne::Array<CounterTotal_s>				Counters;
+	ne::Array<ne::profiling::viz::ZoneQueryRow>	Rows;
+	ne::Array<int>							LockIds;
+	ne::Array<ne::profiling::viz::LockStats>	LockStats;
+};
+
+void NE_API Analyzer_Initialize(Analyzer_s& an, ne::Allocator_t alloc, ne::profiling::Database_t db);
+void NE_API Analyzer_Shutdown  (Analyzer_s& an);
+void NE_API Analyzer_Update	   (Analyzer_s& an);
+void NE_API Analyzer_Flush	   (Analyzer_s& an);
+void NE_API Analyzer_Report	   (const Analyzer_s& an, FILE* out, int max_rows);
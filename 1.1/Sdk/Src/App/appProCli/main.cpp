@@ -0,0 +1,233 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#include "stdafx.h"
+#include "analyzer.h"
+
+//======================================================================================
+using namespace nemesis;
+using namespace nemesis::profiling;
+
+//======================================================================================
+enum
+{ EXIT_OK		= 0
+, EXIT_FAILED	= 1
+, EXIT_BUDGET	= 2
+};
+
+struct Options_s
+{
+	cstr_t	 Connect;
+	cstr_t	 Stream;
+	cstr_t	 Database;
+	cstr_t	 Record;
+	int		 MaxRows;
+	uint32_t MaxMb;
+	uint32_t MaxSeconds;
+	float	 BudgetMs;
+};
+
+struct Cli_s
+{
+	Allocator_t		 Alloc;
+	Options_s		 Options;
+	Database_t		 Db;
+	Parser_t		 Parser;
+	Receiver_t		 Receiver;
+	system::File_t	 Record;
+	Analyzer_s		 Analyzer;
+};
+
+//======================================================================================
+static void Cli_PrintUsage()
+{
+	fprintf(stderr,
+		"usage: appProCli [options] (-c <ip[:port]> | -f <stream> | -d <database>)\n"
+		"  -c <ip[:port]>  analyze a live capture from a server (default port 16001)\n"
+		"  -f <path>       analyze a recorded stream\n"
+		"  -d <path>       analyze a saved database\n"
+		"  -r <path>       record the received stream to a file\n"
+		"  -n <rows>       rows per table (default 20)\n"
+		"  -m <mb>         memory limit of the database (default 256)\n"
+		"  -t <seconds>    stop a live capture after this time\n"
+		"  -b <ms>         exit with code 2 when the 99th percentile frame time exceeds this budget\n");
+}
+
+static bool Cli_ParseOptions(int argc, char** argv, Options_s& opt)
+{
+	NeZero(opt);
+	opt.MaxRows = 20;
+	opt.MaxMb	= 256;
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+		if ((arg[0] != '-') || !arg[1] || arg[2] || (i+1 == argc))
+			return false;
+		const char* value = argv[++i];
+		switch (arg[1])
+		{
+		case 'c': opt.Connect	 = value;					break;
+		case 'f': opt.Stream	 = value;					break;
+		case 'd': opt.Database	 = value;					break;
+		case 'r': opt.Record	 = value;					break;
+		case 'n': opt.MaxRows	 = atoi(value);				break;
+		case 'm': opt.MaxMb		 = (uint32_t)atoi(value);	break;
+		case 't': opt.MaxSeconds = (uint32_t)atoi(value);	break;
+		case 'b': opt.BudgetMs	 = (float)atof(value);		break;
+		default:
+			return false;
+		}
+	}
+	const int num_sources = (opt.Connect ? 1 : 0) + (opt.Stream ? 1 : 0) + (opt.Database ? 1 : 0);
+	return (num_sources == 1) && (opt.MaxRows > 0) && (opt.MaxMb > 0);
+}
+
+static bool Cli_ParseAddress(cstr_t text, system::IpAddress_t& addr)
+{
+	uint32_t ip[4];
+	uint32_t port = 16001;
+	if (sscanf(text, "%u.%u.%u.%u:%u", ip + 0, ip + 1, ip + 2, ip + 3, &port) < 4)
+		return false;
+	addr.Ip[0] = (uint8_t)ip[0];
+	addr.Ip[1] = (uint8_t)ip[1];
+	addr.Ip[2] = (uint8_t)ip[2];
+	addr.Ip[3] = (uint8_t)ip[3];
+	addr.Port  = (system::IpPort_t)port;
+	return true;
+}
+
+//======================================================================================
+/// Runs on the receiver thread, the parser copies the packet and applies back pressure once its queue is full.
+static void NE_CALLBK OnPacketReceived(void* context, system::Socket_t client, const Packet& packet, const Chunk* head)
+{
+	Cli_s& cli = *(Cli_s*)context;
+	if (cli.Record)
+	{
+		uint32_t num_written = 0;
+		system::File_Write(cli.Record, &packet, sizeof(packet), &num_written);
+		system::File_Write(cli.Record, head, packet.DataSize(), &num_written);
+	}
+	Parser_ParseData(cli.Parser, packet, head, Parse::Buffered);
+}
+
+static bool Cli_Connect(Cli_s& cli)
+{
+	const Options_s& opt = cli.Options;
+	if (opt.Record && NeFailed(system::File_Create(opt.Record, system::FileCreate::CreateAlways, system::FileAccess::Write, &cli.Record)))
+	{
+		fprintf(stderr, "failed to create '%s'\n", opt.Record);
+		cli.Record = nullptr;
+		return false;
+	}
+
+	const ParserSetup parser_setup = { cli.Db, 16 * 1024 * 1024 };
+	const ReceiverCallback callback = { OnPacketReceived, &cli };
+	cli.Parser	 = Parser_Create(cli.Alloc, parser_setup);
+	cli.Receiver = Receiver_Create(cli.Alloc);
+	if (opt.Stream)
+	{
+		if (Receiver_ConnectFile(cli.Receiver, opt.Stream, callback) == Connect::Ok)
+			return true;
+		fprintf(stderr, "failed to open '%s'\n", opt.Stream);
+		return false;
+	}
+
+	system::IpAddress_t addr = {};
+	if (!Cli_ParseAddress(opt.Connect, addr))
+	{
+		fprintf(stderr, "invalid address '%s'\n", opt.Connect);
+		return false;
+	}
+	if (Receiver_Connect(cli.Receiver, addr, callback) == Connect::Ok)
+		return true;
+	fprintf(stderr, "failed to connect to '%s'\n", opt.Connect);
+	return false;
+}
+
+/// Joins and analyzes frames while the receiver streams packets into the parser.
+static void Cli_Receive(Cli_s& cli)
+{
+	const system::StopWatch_c elapsed;
+	const uint64_t max_ms = (uint64_t)cli.Options.MaxSeconds * 1000;
+	while (Receiver_IsConnected(cli.Receiver))
+	{
+		if (max_ms && ((uint64_t)elapsed.ElapsedMs64() >= max_ms))
+			break;
+		Parser_JoinData(cli.Parser);
+		Analyzer_Update(cli.Analyzer);
+		system::Thread_SleepMs(10);
+	}
+	Receiver_Disconnect(cli.Receiver);
+	Parser_FlushData(cli.Parser);
+	Analyzer_Flush(cli.Analyzer);
+}
+
+static int Cli_Run(Cli_s& cli)
+{
+	const Options_s& opt = cli.Options;
+	const uint64_t max_bytes = (uint64_t)opt.MaxMb * 1024 * 1024;
+	const DatabaseSetup_s db_setup = { (uint32_t)NeMin<uint64_t>(max_bytes, UINT32_MAX) };
+	cli.Db = Database_Create(cli.Alloc, db_setup);
+	Analyzer_Initialize(cli.Analyzer, cli.Alloc, cli.Db);
+
+	if (opt.Database)
+	{
+		if (!Database_Open(cli.Db, opt.Database))
+		{
+			fprintf(stderr, "failed to open '%s'\n", opt.Database);
+			return EXIT_FAILED;
+		}
+		Analyzer_Flush(cli.Analyzer);
+	}
+	else
+	{
+		if (!Cli_Connect(cli))
+			return EXIT_FAILED;
+		Cli_Receive(cli);
+	}
+
+	Analyzer_Report(cli.Analyzer, stdout, opt.MaxRows);
+
+	const Histogram_s& frames = cli.Analyzer.Frames;
+	if ((opt.BudgetMs > 0.0f) && frames.Count)
+	{
+		const float p99 = Database_GetClock(cli.Db).TickToMs(Histogram_GetPercentile(frames, 99));
+		if (p99 > opt.BudgetMs)
+		{
+			fprintf(stderr, "99th percentile frame time %.3f ms exceeds the budget of %.3f ms\n", p99, opt.BudgetMs);
+			return EXIT_BUDGET;
+		}
+	}
+	return EXIT_OK;
+}
+
+static void Cli_Shutdown(Cli_s& cli)
+{
+	Receiver_Destroy(cli.Receiver);
+	Parser_Destroy(cli.Parser);
+	Analyzer_Shutdown(cli.Analyzer);
+	Database_Destroy(cli.Db);
+	if (cli.Record)
+		system::File_Close(cli.Record);
+}
+
+//======================================================================================
+int main(int argc, char** argv)
+{
+	static Cli_s cli;
+	if (!Cli_ParseOptions(argc, argv, cli.Options))
+	{
+		Cli_PrintUsage();
+		return EXIT_FAILED;
+	}
+
+	cli.Alloc = Allocator_GetCrt();
+	const int result = Cli_Run(cli);
+	Cli_Shutdown(cli);
+	return result;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+//======================================================================================
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+//======================================================================================
+#include <Nemesis/Core/All.h>
+#include <Nemesis/Core/Allocator.h>
+#include <Nemesis/Core/File.h>
+#include <Nemesis/Perf/All.h>
+NE_LINK("libNeCore.lib")
+NE_LINK("libNePerf.lib")
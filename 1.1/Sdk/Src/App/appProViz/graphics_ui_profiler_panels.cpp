@@ -197,7 +197,7 @@ namespace nemesis { namespace gui { namespace profiler { namespace zone_panel
 					if (zone_hit.NumZones)
 					{
 						NamedLocation loc;
-						Database_GetLocationByZone( db, zone_hit.FirstZone, loc );
+						Database_GetLocationByZone( db, zone_hit.Thread, zone_hit.FirstZone, loc );
 						utilities::OpenFileInVisualStudio( loc.Location.File, loc.Location.Line );
 					}
 				}
@@ -585,7 +585,7 @@ namespace nemesis { namespace gui { namespace profiler { namespace zone_view
 		const Clock clock = Database_GetClock( db );
 		const bool is_group = (view.HitZone.NumZones > 1);
 		NamedLocation location;
-		Database_GetLocationByZone( db, view.HitZone.FirstZone, location );
+		Database_GetLocationByZone( db, view.HitZone.Thread, view.HitZone.FirstZone, location );
 
 		// format duration
 		wchar_t duration[32] = L"";
@@ -867,7 +867,7 @@ namespace nemesis { namespace gui { namespace profiler { namespace zone_view
 
 		const Clock clock = Database_GetClock( db );
 		const int frame_index = NeClamp( i, 0, Database_GetNumFrames( db )-1 );
-		const Frame& frame = Database_GetFrames( db )[ frame_index ];
+		const Frame& frame = Database_GetFrame( db, frame_index );
 		const float frame_ms = clock.TickToMs( frame.Time.Duration() );
 		const float track_width = CalcTrackWidth( view.ViewRect );
 
@@ -148,8 +148,8 @@ namespace nemesis { namespace gui { namespace profiler { namespace time_bar
 		Rect_s bounds_rect;
 		{
 			const int last_frame = g.Frames.Last();
-			const Tick first_tick = Database_GetFrames( db )[ g.Frames.First ].Time.Begin;
-			const Tick last_tick  = Database_GetFrames( db )[ last_frame     ].Time.End;
+			const Tick first_tick = Database_GetFrame( db, g.Frames.First ).Time.Begin;
+			const Tick last_tick  = Database_GetFrame( db, last_frame ).Time.End;
 			const float group_ms = clock.TickToMs( last_tick - first_tick );
 
 			TextBuffer& text = gui::GetTextBuffer();
@@ -169,7 +169,7 @@ namespace nemesis { namespace gui { namespace profiler { namespace time_bar
 		// lead-out
 		{ 
 			const int last_frame = g.Frames.Last();
-			const Tick last_tick  = Database_GetFrames( db )[ last_frame ].Time.End;
+			const Tick last_tick  = Database_GetFrame( db, last_frame ).Time.End;
 			const float group_ms = clock.TickToMs( last_tick - Database_GetFirstTick( db ) );
 
 			const Time tm = MsToTime( group_ms );
@@ -192,8 +192,8 @@ namespace nemesis { namespace gui { namespace profiler { namespace time_bar
 		// calculate groups's total duration in [ms]
 		const Clock clock = Database_GetClock( db );
 		const int last_frame = g.Frames.Last();
-		const Tick first_tick = Database_GetFrames( db )[ g.Frames.First ].Time.Begin;
-		const Tick last_tick  = Database_GetFrames( db )[ last_frame     ].Time.End;
+		const Tick first_tick = Database_GetFrame( db, g.Frames.First ).Time.Begin;
+		const Tick last_tick  = Database_GetFrame( db, last_frame ).Time.End;
 		const float group_ms = clock.TickToMs( last_tick - first_tick );
 
 		// calculate the visible interval 
@@ -232,8 +232,8 @@ namespace nemesis { namespace gui { namespace profiler { namespace time_bar
 
 		// layout
 		const Clock clock = Database_GetClock( args.db );
-		const Frame& frame_0 = Database_GetFrames( args.db )[g.Frames.First];
-		const Frame& frame_1 = Database_GetFrames( args.db )[g.Frames.Last()];
+		const Frame& frame_0 = Database_GetFrame( args.db, g.Frames.First );
+		const Frame& frame_1 = Database_GetFrame( args.db, g.Frames.Last() );
 		const float x0 = args.zoom.TickToPixel( frame_0.Time.Begin - args.cull.Time.Begin, clock );
 		const float x1 = args.zoom.TickToPixel( frame_1.Time.End   - args.cull.Time.Begin, clock );
 		const float w = x1-x0;
@@ -395,8 +395,8 @@ namespace nemesis { namespace gui { namespace profiler { namespace summary_bar
 			if (!item.Visible)
 				return;
 			const Tick num_ticks = 
-				  Database_GetFrames( db )[ g.Frames.Last() ].Time.End 
-				- Database_GetFrames( db )[ g.Frames.First  ].Time.Begin
+				  Database_GetFrame( db, g.Frames.Last() ).Time.End 
+				- Database_GetFrame( db, g.Frames.First ).Time.Begin
 				;
 			if (g.Frames.Count == 1)
 				FormatMs( text, clock.TickToMs( num_ticks ) );
@@ -410,7 +410,7 @@ namespace nemesis { namespace gui { namespace profiler { namespace summary_bar
 			const layout::Item item = layout::Append( l, l.Bounds.w, line_height );
 			if (!item.Visible)
 				return;
-			const Tick begin_tick = Database_GetFrames( db )[ g.Frames.First ].Time.Begin;
+			const Tick begin_tick = Database_GetFrame( db, g.Frames.First ).Time.Begin;
 			const Tick frame_tick = begin_tick - Database_GetFirstTick( db );
 			FormatHMS( text, clock.TickToMs( frame_tick ) );
 			DrawString( text.Text, text.Length, v.SmallFont, TextFormat::NoWrap, item.Bounds, Color::White );
@@ -424,7 +424,7 @@ namespace nemesis { namespace gui { namespace profiler { namespace summary_bar
 			uint32_t total_scope_events = 0;
 			const int frame_end = g.Frames.End();
 			for ( int frame_index = g.Frames.Begin(); frame_index < frame_end; ++frame_index )
-				total_scope_events += Database_GetFrames( db )[ frame_index ].NumScopeEvents;
+				total_scope_events += Database_GetFrame( db, frame_index ).NumScopeEvents;
 			text.Length = swprintf_s( text.Text, L"%u", total_scope_events/2 );
 			DrawString( text.Text, text.Length, v.SmallFont, TextFormat::NoWrap, item.Bounds, Color::White );
 		}
@@ -438,7 +438,7 @@ namespace nemesis { namespace gui { namespace profiler { namespace summary_bar
 			/*
 			const int frame_end = g.Frames.End();
 			for ( int frame_index = g.Frames.Begin(); frame_index < frame_end; ++frame_index )
-				total_size += Database_GetFrames( db )[ frame_index ].TotalSize();
+				total_size += Database_GetFrame( db, frame_index ).TotalSize();
 			*/
 
 			float total;
@@ -467,7 +467,7 @@ namespace nemesis { namespace gui { namespace profiler { namespace summary_bar
 			uint32_t total_size = 0;
 			const int frame_end = g.Frames.End();
 			for ( int frame_index = g.Frames.Begin(); frame_index < frame_end; ++frame_index )
-				total_size += Database_GetFrames( db )[ frame_index ].ParsedBytes;
+				total_size += Database_GetFrame( db, frame_index ).ParsedBytes;
 
 			float total;
 			const char* total_unit;
@@ -526,8 +526,8 @@ namespace nemesis { namespace gui { namespace profiler { namespace summary_bar
 
 		// layout
 		const Clock clock = Database_GetClock( args.db );
-		const Frame& frame_0 = Database_GetFrames( args.db )[g.Frames.First];
-		const Frame& frame_1 = Database_GetFrames( args.db )[g.Frames.Last()];
+		const Frame& frame_0 = Database_GetFrame( args.db, g.Frames.First );
+		const Frame& frame_1 = Database_GetFrame( args.db, g.Frames.Last() );
 		const float x0 = args.zoom.TickToPixel( frame_0.Time.Begin - args.cull.Time.Begin, clock );
 		const float x1 = args.zoom.TickToPixel( frame_1.Time.End   - args.cull.Time.Begin, clock );
 		const float w = x1-x0;
@@ -1148,7 +1148,7 @@ namespace nemesis { namespace gui { namespace profiler { namespace frame_bar
 		const int frame_end = cull.Frames.First + cull.Frames.Count;
 		for ( int frame_index = cull.Frames.First; frame_index < frame_end; ++frame_index )
 		{
-			const Frame& frame = Database_GetFrames( db )[ frame_index ];
+			const Frame& frame = Database_GetFrame( db, frame_index );
 			const Tick frame_ticks = frame.Time.Duration();
 
 			// add frame to group
@@ -1194,7 +1194,7 @@ namespace nemesis { namespace gui { namespace profiler { namespace frame_bar
 		const int frame_end = cull.Frames.First + cull.Frames.Count;
 		for ( int frame_index = cull.Frames.First; frame_index < frame_end; ++frame_index )
 		{
-			const Frame& frame = Database_GetFrames( db )[ frame_index ];
+			const Frame& frame = Database_GetFrame( db, frame_index );
 			const float x0 = r.x + zoom.TickToPixel( frame.Time.Begin - cull.Time.Begin, clock );
 			const float x1 = r.x + zoom.TickToPixel( frame.Time.End   - cull.Time.Begin, clock );
 			const float d = (x0 - prev_x);
@@ -1260,62 +1260,51 @@ namespace nemesis { namespace gui { namespace profiler { namespace graph_bar
 		{
 			FillRectangle( r, v.BkgndColor );
 
+			// one value range per pixel column, fetched in chunks
+			enum { MAX_RANGES = 256 };
+			CounterRange ranges[ MAX_RANGES ];
+
+			const int num_columns = NeMax( 1, (int)(r.w / min_width) );
+			const Tick duration = cull.Time.End - cull.Time.Begin;
+
 			int num_values = 0;
-			float x, y;
 			float prev_x = r.x;
 			float prev_y = Rect_Bottom( r );
-
-			float dy = 0.0f;
-			float prev_dy = 0.0f;
-
-			CounterValue value;
-			const int frame_end = cull.Frames.First + cull.Frames.Count;
-			for ( int frame_index = cull.Frames.First; frame_index < frame_end; ++frame_index )
+			for ( int column = 0; column < num_columns; column += MAX_RANGES )
 			{
-				const Frame& frame = Database_GetFrames( db )[ frame_index ];
-				const int value_end = frame.FirstCounterValue + frame.NumCounterValues;
-				for ( int value_index = frame.FirstCounterValue; value_index < value_end; ++value_index )
+				const int num_ranges = NeMin( (int)MAX_RANGES, num_columns - column );
+				TickInterval time;
+				time.Begin = cull.Time.Begin + (duration * column) / num_columns;
+				time.End   = cull.Time.Begin + (duration * (column + num_ranges)) / num_columns;
+
+				const int num_items = Database_GetCounterSeries( db, item.Counter, time, ranges, num_ranges );
+				for ( int i = 0; i < num_items; ++i )
 				{
-					Database_GetCounterValue( db, value_index, value );
-					if (value.Name != counter.Name)
-						continue;
+					const CounterRange& range = ranges[i];
 
-					// calculate normalized value
-					const float normalized_value = (value.Value - float_min) / (float_max - float_min);
+					// calculate normalized values
+					const float normalized_min = (range.Min - float_min) / (float_max - float_min);
+					const float normalized_max = (range.Max - float_min) / (float_max - float_min);
+					const float normalized_avg = (range.Avg - float_min) / (float_max - float_min);
 
 					// calculate end coords
-					x = r.x + zoom.TickToPixel( frame.Time.End - cull.Time.Begin, clock );
-					y = Rect_Bottom( r ) - normalized_value * scaled_height;
+					const float x = r.x + zoom.TickToPixel( range.Time.End - cull.Time.Begin, clock );
+					const float y = Rect_Bottom( r ) - normalized_avg * scaled_height;
 
 					// first value?
 					if (0 == num_values++)
 					{
-						prev_x = r.x + zoom.TickToPixel( frame.Time.Begin - cull.Time.Begin, clock );
+						prev_x = r.x + zoom.TickToPixel( range.Time.Begin - cull.Time.Begin, clock );
 						prev_y = y;
 					}
 
-					// calculate slope
-					dy = y - prev_y;
-
-					// below threshold?
-					const float delta_x = x-prev_x;
-					if (delta_x < min_width)
-					{
-						/*
-						// no change in orientation?
-						const bool sign_now = dy > 0.0f;
-						const bool sign_prev = prev_dy > 0.0f;
-						if ( sign_now == sign_prev )
-						*/
-							continue;
-					}
-						
-					// draw line segment
+					// draw extrema of the merged values
 					NePerfScope("segment");
+					if (range.NumValues > 1)
+						DrawLine( v.LineColor, x, Rect_Bottom( r ) - normalized_min * scaled_height, x, Rect_Bottom( r ) - normalized_max * scaled_height );
 					DrawLine( v.LineColor, prev_x, prev_y, x, y );
 					prev_x = x;
 					prev_y = y;
-					prev_dy = dy;
 				}
 			}
 		}
@@ -1649,8 +1638,8 @@ namespace nemesis { namespace gui { namespace profiler { namespace profile_bar
 
 		// invariants
 		const Tick total_duration 
-			= Database_GetFrames( db )[ frames.Last () ].Time.End
-			- Database_GetFrames( db )[ frames.Begin() ].Time.Begin;
+			= Database_GetFrame( db, frames.Last () ).Time.End
+			- Database_GetFrame( db, frames.Begin() ).Time.Begin;
 		const float one_over_total_duration = 1.0f / ((float)total_duration);
 
 		// bars
@@ -1708,8 +1697,8 @@ namespace nemesis { namespace gui { namespace profiler { namespace profile_bar
 
 		// layout
 		const Clock clock = Database_GetClock( args.db );
-		const Frame& frame_0 = Database_GetFrames( args.db )[g.Frames.First];
-		const Frame& frame_1 = Database_GetFrames( args.db )[g.Frames.Last()];
+		const Frame& frame_0 = Database_GetFrame( args.db, g.Frames.First );
+		const Frame& frame_1 = Database_GetFrame( args.db, g.Frames.Last() );
 		const float x0 = args.zoom.TickToPixel( frame_0.Time.Begin - args.cull.Time.Begin, clock );
 		const float x1 = args.zoom.TickToPixel( frame_1.Time.End   - args.cull.Time.Begin, clock );
 		const float w = x1-x0;
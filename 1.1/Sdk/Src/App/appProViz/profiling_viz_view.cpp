@@ -56,7 +56,7 @@ namespace nemesis { namespace profiling { namespace viz { namespace view
 		cull.Frames.Count = 0;
 		for ( int i = cull.Frames.First; i < Database_GetNumFrames( db ); ++i )
 		{
-			if (Database_GetFrames( db )[i].Time.Begin >= cull.Time.End)
+			if (Database_GetFrame( db, i ).Time.Begin >= cull.Time.End)
 				break;
 			++cull.Frames.Count;
 		}
@@ -70,7 +70,7 @@ namespace nemesis { namespace profiling { namespace viz { namespace view
 		const int frame_end = cull.Frames.First + cull.Frames.Count;
 		for ( int frame_index = cull.Frames.First; frame_index < frame_end; ++frame_index )
 		{
-			const Frame& frame = Database_GetFrames( db )[frame_index];
+			const Frame& frame = Database_GetFrame( db, frame_index );
 			frame_ticks = frame.Time.Duration();
 			if (frame_ticks > max_duration)
 				max_duration = frame_ticks;
@@ -23,6 +23,8 @@
 #	include "Atomic_Orbis.h"
 #elif (NE_PLATFORM == NE_PLATFORM_PS5)
 #	include "Atomic_Orbis.h"
+#elif (NE_PLATFORM == NE_PLATFORM_LINUX)
+#	include "Atomic_Posix.h"
 #else
 #	error Unrecognized platform...
 #endif
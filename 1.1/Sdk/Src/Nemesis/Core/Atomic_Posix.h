@@ -0,0 +1,52 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+namespace nemesis
+{
+	int32_t Interlocked_Exchange( Atomic32* p, int32_t v )
+	{ 
+		return __atomic_exchange_n( p, v, __ATOMIC_SEQ_CST );
+	}
+
+	int32_t Interlocked_CompareExchange( Atomic32* p, int32_t v, int32_t cmp )
+	{ 
+		__atomic_compare_exchange_n( p, &cmp, v, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST );
+		return cmp;
+	}
+
+	int32_t Interlocked_Load( const Atomic32* p )
+	{ 
+		return __atomic_load_n( p, __ATOMIC_SEQ_CST );
+	}
+
+	/// Returns the previous value.
+	int32_t Interlocked_Add( Atomic32* p, int32_t v )
+	{ 
+		return __atomic_fetch_add( p, v, __ATOMIC_SEQ_CST );
+	}
+
+	int64_t Interlocked_Exchange64( Atomic64* p, int64_t v )
+	{ 
+		return __atomic_exchange_n( p, v, __ATOMIC_SEQ_CST );
+	}
+
+	int64_t Interlocked_CompareExchange64( Atomic64* p, int64_t v, int64_t cmp )
+	{ 
+		__atomic_compare_exchange_n( p, &cmp, v, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST );
+		return cmp;
+	}
+
+	int64_t Interlocked_Load64( const Atomic64* p )
+	{ 
+		return __atomic_load_n( p, __ATOMIC_SEQ_CST );
+	}
+
+}
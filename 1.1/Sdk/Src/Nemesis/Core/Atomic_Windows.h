@@ -12,10 +12,42 @@
 namespace nemesis
 {
 	NeStaticAssert( sizeof(Atomic32) == sizeof(volatile LONG) );
+	NeStaticAssert( sizeof(Atomic64) == sizeof(volatile LONG64) );
 
-	void Interlocked_Exchange( Atomic32* p, int32_t v )
+	int32_t Interlocked_Exchange( Atomic32* p, int32_t v )
 	{ 
-		InterlockedExchange( (volatile LONG*)p, v );
+		return InterlockedExchange( (volatile LONG*)p, v );
+	}
+
+	int32_t Interlocked_CompareExchange( Atomic32* p, int32_t v, int32_t cmp )
+	{ 
+		return InterlockedCompareExchange( (volatile LONG*)p, v, cmp );
+	}
+
+	int32_t Interlocked_Load( const Atomic32* p )
+	{ 
+		return InterlockedCompareExchange( (volatile LONG*)p, 0, 0 );
+	}
+
+	/// Returns the previous value.
+	int32_t Interlocked_Add( Atomic32* p, int32_t v )
+	{ 
+		return InterlockedExchangeAdd( (volatile LONG*)p, v );
+	}
+
+	int64_t Interlocked_Exchange64( Atomic64* p, int64_t v )
+	{ 
+		return InterlockedExchange64( (volatile LONG64*)p, v );
+	}
+
+	int64_t Interlocked_CompareExchange64( Atomic64* p, int64_t v, int64_t cmp )
+	{ 
+		return InterlockedCompareExchange64( (volatile LONG64*)p, v, cmp );
+	}
+
+	int64_t Interlocked_Load64( const Atomic64* p )
+	{ 
+		return InterlockedCompareExchange64( (volatile LONG64*)p, 0, 0 );
 	}
 
 }
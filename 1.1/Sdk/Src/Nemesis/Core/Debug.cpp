@@ -23,6 +23,8 @@
 #	include "Debug_Null.h"
 #elif (NE_PLATFORM == NE_PLATFORM_PS5)
 #	include "Debug_Null.h"
+#elif (NE_PLATFORM == NE_PLATFORM_LINUX)
+#	include "Debug_Null.h"
 #else
 #	error Unrecognized platform...
 #endif
@@ -23,6 +23,8 @@
 #	include "Exception_Null.h"
 #elif (NE_PLATFORM == NE_PLATFORM_PS5)
 #	include "Exception_Null.h"
+#elif (NE_PLATFORM == NE_PLATFORM_LINUX)
+#	include "Exception_Null.h"
 #else
 #	error Unrecognized platform...
 #endif
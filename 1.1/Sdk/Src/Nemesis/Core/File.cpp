@@ -24,6 +24,8 @@
 #	include "File_Orbis.h"
 #elif (NE_PLATFORM == NE_PLATFORM_PS5)
 #	include "File_Orbis.h"
+#elif (NE_PLATFORM == NE_PLATFORM_LINUX)
+#	include "File_Posix.h"
 #else
 #	error Unrecognized platform...
 #endif
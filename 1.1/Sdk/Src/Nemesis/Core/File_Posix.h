@@ -0,0 +1,266 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+namespace nemesis { namespace system
+{
+	static File_t Fd_ToFile( int v )
+	{
+		if (v < 0)
+			return nullptr;
+		if (v == 0)
+			return (File_t)-1;
+		return (File_t)(intptr_t)v;
+	}
+
+	static int File_ToFd( File_t v )
+	{
+		if (v == nullptr)
+			return -1;
+		if (v == (File_t)-1)
+			return 0;
+		return (int)(intptr_t)v;
+	}
+
+	static uint64_t Time_ToNs( const timespec& v )
+	{
+		return (uint64_t)v.tv_sec * 1000000000ull + (uint64_t)v.tv_nsec;
+	}
+
+} }
+//======================================================================================
+namespace nemesis { namespace system
+{
+	Result_t File_Create( cstr_t path, FileCreate::Mode create, FileAccess::Mask_t access, File_t* file )
+	{
+		if (!file)
+			return NE_ERR_INVALID_ARG;
+
+		// convert args
+		int flags = 0;
+		switch (create)
+		{
+		case FileCreate::CreateAlways:		flags = O_CREAT | O_TRUNC;	break;
+		case FileCreate::CreateNew:			flags = O_CREAT | O_EXCL;	break;
+		case FileCreate::OpenAlways:		flags = O_CREAT;			break;
+		case FileCreate::OpenExisting:		flags = 0;					break;
+		case FileCreate::TruncateExisting:	flags = O_TRUNC;			break;
+		default:
+			return NE_ERR_INVALID_CALL;
+		}
+		const bool read  = NeHasFlag(access, FileAccess::Read);
+		const bool write = NeHasFlag(access, FileAccess::Write);
+		if (!read && !write)
+			return NE_ERR_INVALID_ARG;
+		flags |= (read && write) ? O_RDWR : (write ? O_WRONLY : O_RDONLY);
+
+		// create file
+		const int fd = open( path, flags | O_CLOEXEC, 0644 );
+		*file = Fd_ToFile( fd );
+		return (fd >= 0) ? NE_OK : NE_ERROR;
+	}
+
+	Result_t File_GetTime( File_t file, uint64_t* create, uint64_t* access, uint64_t* write )
+	{
+		struct stat info = {};
+		if (fstat( File_ToFd( file ), &info ) != 0)
+			return NE_ERROR;
+		if (create)
+			*create = Time_ToNs( info.st_ctim );
+		if (access)
+			*access = Time_ToNs( info.st_atim );
+		if (write)
+			*write = Time_ToNs( info.st_mtim );
+		return NE_OK;
+	}
+
+	Result_t File_GetSize( File_t file, uint32_t* size )
+	{
+		if (!size)
+			return NE_ERR_INVALID_ARG;
+		struct stat info = {};
+		if ((fstat( File_ToFd( file ), &info ) != 0) || (info.st_size > 0xffffffff))
+		{
+			*size = 0;
+			return NE_ERROR;
+		}
+		*size = (uint32_t)info.st_size;
+		return NE_OK;
+	}
+
+	Result_t File_GetPos( File_t file, uint32_t* pos )
+	{
+		if (!pos)
+			return NE_ERR_INVALID_ARG;
+		const off_t offset = lseek( File_ToFd( file ), 0, SEEK_CUR );
+		if ((offset < 0) || (offset > 0xffffffff))
+		{
+			*pos = 0;
+			return NE_ERROR;
+		}
+		*pos = (uint32_t)offset;
+		return NE_OK;
+	}
+
+	Result_t File_Seek( File_t file, FileSeek::Mode seek, int64_t pos )
+	{
+		int whence = 0;
+		switch (seek)
+		{
+		case FileSeek::Current: whence = SEEK_CUR;	break;
+		case FileSeek::Begin:	whence = SEEK_SET;	break;
+		case FileSeek::End:		whence = SEEK_END;	break;
+		default:
+			return NE_ERR_INVALID_ARG;
+		}
+		if (lseek( File_ToFd( file ), (off_t)pos, whence ) >= 0)
+			return NE_OK;
+		return NE_ERROR;
+	}
+
+	Result_t File_Read( File_t file, ptr_t data, uint32_t size, uint32_t* num_read )
+	{
+		ssize_t hr;
+		while (((hr = read( File_ToFd( file ), data, size )) < 0) && (errno == EINTR))
+			;
+		if (num_read)
+			*num_read = (hr > 0) ? (uint32_t)hr : 0;
+		return (hr >= 0) ? NE_OK : NE_ERROR;
+	}
+
+	Result_t File_Write( File_t file, cptr_t data, uint32_t size, uint32_t* num_written )
+	{
+		ssize_t hr;
+		while (((hr = write( File_ToFd( file ), data, size )) < 0) && (errno == EINTR))
+			;
+		if (num_written)
+			*num_written = (hr > 0) ? (uint32_t)hr : 0;
+		return (hr >= 0) ? NE_OK : NE_ERROR;
+	}
+
+	Result_t File_Close( File_t file )
+	{
+		if (close( File_ToFd( file ) ) == 0)
+			return NE_OK;
+		return NE_ERROR;
+	}
+
+	// The handle of a mapping carries its size which munmap needs.
+
+	ptr_t File_Map( cstr_t path, size_t* size, Handle_t* handle )
+	{
+		if (!size || !handle)
+			return nullptr;
+		*size = 0;
+		*handle = nullptr;
+
+		// map file
+		const int fd = open( path, O_RDONLY | O_CLOEXEC );
+		if (fd < 0)
+			return nullptr;
+		struct stat info = {};
+		ptr_t view = MAP_FAILED;
+		if ((fstat( fd, &info ) == 0) && info.st_size)
+			view = mmap( nullptr, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+		close( fd );
+		if (view == MAP_FAILED)
+			return nullptr;
+		*size = (size_t)info.st_size;
+		*handle = (Handle_t)(uintptr_t)info.st_size;
+		return view;
+	}
+
+	ptr_t File_MapTemp( cstr_t path, size_t size, Handle_t* handle )
+	{
+		if (!size || !handle)
+			return nullptr;
+		*handle = nullptr;
+
+		// map file, the name goes away right away like a file deleted on close
+		const int fd = open( path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 );
+		if (fd < 0)
+			return nullptr;
+		unlink( path );
+		ptr_t view = MAP_FAILED;
+		if (ftruncate( fd, (off_t)size ) == 0)
+			view = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+		close( fd );
+		if (view == MAP_FAILED)
+			return nullptr;
+		*handle = (Handle_t)(uintptr_t)size;
+		return view;
+	}
+
+	void File_Unmap( ptr_t ptr, Handle_t handle )
+	{
+		if (ptr)
+			munmap( ptr, (size_t)(uintptr_t)handle );
+	}
+
+	int FileTime_Compare( uint64_t lhs, uint64_t rhs )
+	{
+		return (lhs < rhs) ? -1 : ((lhs > rhs) ? 1 : 0);
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace system
+{
+	Path_t& Path_Copy( Path_t& path, cstr_t src )
+	{
+		Str_Cpy( path, src );
+		return path;
+	}
+
+	Path_t& Path_Normalize( Path_t& path )
+	{
+		for ( int i = 0; (i < NeCountOf(path)) && path[i]; ++i )
+			if (path[i] == '\\')
+				path[i] = '/';
+		return path;
+	}
+
+	Path_t& Path_Parent( Path_t& path )
+	{
+		str_t pos = Str_ChrR( path, '/' );
+		if (pos)
+			pos[0] = 0;
+		return path;
+	}
+
+	Path_t& Path_Init( Path_t& path, cstr_t src )
+	{
+		return Path_Normalize( Path_Copy( path, src ) );
+	}
+
+	Path_t& Path_Concat( Path_t& path, cstr_t src )
+	{
+		Str_Cat( path, "/" );
+		Str_Cat( path, src );
+		return path;
+	}
+
+	Path_t& Path_Concat( Path_t& path, cstr_t src, cstr_t dst )
+	{
+		return Path_Concat( Path_Init( path, src ), dst );
+	}
+
+	Path_t& Path_SetExt( Path_t& path, cstr_t ext )
+	{
+		str_t pos = Str_ChrR( path, '.' );
+		if (pos)
+			Str_Cpy( pos, NeCountOf(path) - (pos-path), ext );
+		else
+			Str_Cat( path, ext );
+		return path;
+	}
+
+} }
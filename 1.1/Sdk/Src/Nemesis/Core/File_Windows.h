@@ -168,6 +168,76 @@ namespace nemesis { namespace system
 		return NE_ERROR;
 	}
 
+	ptr_t File_Map( cstr_t path, size_t* size, Handle_t* handle )
+	{
+		if (!size || !handle)
+			return nullptr;
+		*size = 0;
+		*handle = nullptr;
+
+		// convert path
+		wchar_t wszPath[1024] = L"";
+		MultiByteToWideChar( CP_UTF8, 0, path, -1, wszPath, NeCountOf(wszPath) );
+
+		// map file
+		HANDLE hFile = ::CreateFileW( wszPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+		if (hFile == INVALID_HANDLE_VALUE)
+			return nullptr;
+		LARGE_INTEGER liSize = {};
+		HANDLE hMapping = nullptr;
+		if (::GetFileSizeEx( hFile, &liSize ) && liSize.QuadPart)
+			hMapping = ::CreateFileMappingW( hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+		::CloseHandle( hFile );
+		if (!hMapping)
+			return nullptr;
+		ptr_t view = ::MapViewOfFile( hMapping, FILE_MAP_COPY, 0, 0, 0 );
+		if (!view)
+		{
+			::CloseHandle( hMapping );
+			return nullptr;
+		}
+		*size = (size_t)liSize.QuadPart;
+		*handle = hMapping;
+		return view;
+	}
+
+	ptr_t File_MapTemp( cstr_t path, size_t size, Handle_t* handle )
+	{
+		if (!size || !handle)
+			return nullptr;
+		*handle = nullptr;
+
+		// convert path
+		wchar_t wszPath[1024] = L"";
+		MultiByteToWideChar( CP_UTF8, 0, path, -1, wszPath, NeCountOf(wszPath) );
+
+		// map file
+		HANDLE hFile = ::CreateFileW( wszPath, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_DELETE_ON_CLOSE, nullptr );
+		if (hFile == INVALID_HANDLE_VALUE)
+			return nullptr;
+		const uint64_t uSize = (uint64_t)size;
+		HANDLE hMapping = ::CreateFileMappingW( hFile, nullptr, PAGE_READWRITE, (DWORD)(uSize >> 32), (DWORD)uSize, nullptr );
+		::CloseHandle( hFile );
+		if (!hMapping)
+			return nullptr;
+		ptr_t view = ::MapViewOfFile( hMapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, size );
+		if (!view)
+		{
+			::CloseHandle( hMapping );
+			return nullptr;
+		}
+		*handle = hMapping;
+		return view;
+	}
+
+	void File_Unmap( ptr_t ptr, Handle_t handle )
+	{
+		if (ptr)
+			::UnmapViewOfFile( ptr );
+		if (handle)
+			::CloseHandle( handle );
+	}
+
 	int FileTime_Compare( uint64_t lhs, uint64_t rhs )
 	{
 		return ::CompareFileTime( (const FILETIME*)&lhs, (const FILETIME*)&rhs );
@@ -0,0 +1,136 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#include "stdafx.h"
+#include <Nemesis/Core/Hash.h>
+#include <Nemesis/Core/Memory.h>
+#include <Nemesis/Core/String.h>
+
+//======================================================================================
+//																				 Private
+//======================================================================================
+namespace nemesis
+{
+	namespace
+	{
+		const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+		const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+		const uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+		const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+		const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+	}
+
+	static inline uint64_t Hash_Rotl64( uint64_t v, int r )
+	{
+		return (v << r) | (v >> (64 - r));
+	}
+
+	static inline uint64_t Hash_Read64( const uint8_t* p )
+	{
+		uint64_t v;
+		Mem_Cpy( &v, p, sizeof(v) );
+		return v;
+	}
+
+	static inline uint32_t Hash_Read32( const uint8_t* p )
+	{
+		uint32_t v;
+		Mem_Cpy( &v, p, sizeof(v) );
+		return v;
+	}
+
+	static inline uint64_t Hash_Round( uint64_t acc, uint64_t input )
+	{
+		acc += input * PRIME64_2;
+		acc  = Hash_Rotl64( acc, 31 );
+		acc *= PRIME64_1;
+		return acc;
+	}
+
+	static inline uint64_t Hash_MergeRound( uint64_t acc, uint64_t val )
+	{
+		acc ^= Hash_Round( 0, val );
+		acc  = acc * PRIME64_1 + PRIME64_4;
+		return acc;
+	}
+
+}
+
+//======================================================================================
+//																				  Public
+//======================================================================================
+namespace nemesis
+{
+	uint64_t Hash_Xx64( const void* data, size_t size, uint64_t seed )
+	{
+		const uint8_t* pos = (const uint8_t*)data;
+		const uint8_t* end = pos + size;
+		uint64_t h;
+
+		if (size >= 32)
+		{
+			const uint8_t* limit = end - 32;
+			uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+			uint64_t v2 = seed + PRIME64_2;
+			uint64_t v3 = seed + 0;
+			uint64_t v4 = seed - PRIME64_1;
+			do
+			{
+				v1 = Hash_Round( v1, Hash_Read64( pos ) ); pos += 8;
+				v2 = Hash_Round( v2, Hash_Read64( pos ) ); pos += 8;
+				v3 = Hash_Round( v3, Hash_Read64( pos ) ); pos += 8;
+				v4 = Hash_Round( v4, Hash_Read64( pos ) ); pos += 8;
+			}
+			while (pos <= limit);
+
+			h = Hash_Rotl64( v1, 1 ) + Hash_Rotl64( v2, 7 ) + Hash_Rotl64( v3, 12 ) + Hash_Rotl64( v4, 18 );
+			h = Hash_MergeRound( h, v1 );
+			h = Hash_MergeRound( h, v2 );
+			h = Hash_MergeRound( h, v3 );
+			h = Hash_MergeRound( h, v4 );
+		}
+		else
+		{
+			h = seed + PRIME64_5;
+		}
+
+		h += (uint64_t)size;
+
+		for ( ; pos + 8 <= end; pos += 8 )
+		{
+			h ^= Hash_Round( 0, Hash_Read64( pos ) );
+			h  = Hash_Rotl64( h, 27 ) * PRIME64_1 + PRIME64_4;
+		}
+
+		if (pos + 4 <= end)
+		{
+			h ^= (uint64_t)Hash_Read32( pos ) * PRIME64_1;
+			h  = Hash_Rotl64( h, 23 ) * PRIME64_2 + PRIME64_3;
+			pos += 4;
+		}
+
+		for ( ; pos < end; ++pos )
+		{
+			h ^= (*pos) * PRIME64_5;
+			h  = Hash_Rotl64( h, 11 ) * PRIME64_1;
+		}
+
+		h ^= h >> 33;
+		h *= PRIME64_2;
+		h ^= h >> 29;
+		h *= PRIME64_3;
+		h ^= h >> 32;
+		return h;
+	}
+
+	uint64_t Hash_Xx64( cstr_t text, uint64_t seed )
+	{
+		return Hash_Xx64( text, Str_Len( text ), seed );
+	}
+
+}
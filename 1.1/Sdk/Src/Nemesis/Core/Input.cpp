@@ -23,6 +23,8 @@
 #	include "Input_Null.h"
 #elif (NE_PLATFORM == NE_PLATFORM_PS5)
 #	include "Input_Null.h"
+#elif (NE_PLATFORM == NE_PLATFORM_LINUX)
+#	include "Input_Null.h"
 #else
 #	error Unrecognized platform...
 #endif
@@ -68,6 +68,17 @@ namespace nemesis
 				s.Result = NE_ERR_JSON_END_OF_STRING;
 				return;
 			}
+			if (*it == '\\')
+			{
+				// escaped characters are passed on as they are, only skip them
+				if (++it == s.Caret.End)
+				{
+					s.Caret.Pos = it;
+					s.Result = NE_ERR_JSON_END_OF_FILE;
+					return;
+				}
+				continue;
+			}
 			if (*it == '"')
 			{
 				value.Pos = s.Caret.Pos+1;
@@ -190,6 +201,15 @@ namespace nemesis
 				}
 				break;
 
+			case '+':
+				if ((part != EXPONENT) || ((it[-1] != 'E') && (it[-1] != 'e')))
+				{
+					s.Result = NE_ERR_JSON_UNEXPECTED_CHAR;
+					s.Caret.Pos = it;
+					return;
+				}
+				break;
+
 			case '.':
 				{
 					if (part != INTEGER)
@@ -279,7 +299,7 @@ namespace nemesis
 		JsonClient_s Client;
 	};
 
-	static void JsonState_Initialize( JsonState_s& s, cstr_t src, uint32_t len, const JsonClient_s& client )
+	static void JsonState_Initialize( JsonState_s& s, cstr_t src, size_t len, const JsonClient_s& client )
 	{
 		s.Stream.Caret.Pos = src;
 		s.Stream.Caret.End = src + len;
@@ -301,57 +321,54 @@ namespace nemesis
 	static void JsonState_Parse_Whitespace	( JsonState_s& s );
 	static void JsonState_Parse_Comment		( JsonState_s& s );
 
-	struct JsonParserItem_s
-	{
-		char Char;
-		void (*Handler)( JsonState_s& s );
-	};
-
 	static void JsonState_Parse( JsonState_s& s )
 	{
-		const JsonParserItem_s item[] =
-		{ { '{'	, JsonState_Parse_Begin		 }
-		, { '['	, JsonState_Parse_Begin		 }
-		, { '}'	, JsonState_Parse_End		 }
-		, { ']'	, JsonState_Parse_End		 }
-		, { ':'	, JsonState_Parse_Field		 }
-		, { ','	, JsonState_Parse_Separator	 }
-		, { '"'	, JsonState_Parse_String	 }
-		, { 't'	, JsonState_Parse_Constant	 }
-		, { 'f'	, JsonState_Parse_Constant	 }
-		, { 'n'	, JsonState_Parse_Constant	 }
-		, { '-'	, JsonState_Parse_Number	 }
-		, { '0'	, JsonState_Parse_Number	 }
-		, { '1'	, JsonState_Parse_Number	 }
-		, { '2'	, JsonState_Parse_Number	 }
-		, { '3'	, JsonState_Parse_Number	 }
-		, { '4'	, JsonState_Parse_Number	 }
-		, { '5'	, JsonState_Parse_Number	 }
-		, { '6'	, JsonState_Parse_Number	 }
-		, { '7'	, JsonState_Parse_Number	 }
-		, { '8'	, JsonState_Parse_Number	 }
-		, { '9'	, JsonState_Parse_Number	 }
-		, { '\n', JsonState_Parse_NewLine	 }
-		, { ' '	, JsonState_Parse_Whitespace }
-		, { '\t', JsonState_Parse_Whitespace }
-		, { '\r', JsonState_Parse_Whitespace }
-		, { '/' , JsonState_Parse_Comment	 }
-		};
-
 		for ( ; JsonStream_Continue( s.Stream ); )
 		{
-			bool handled = false;
-			for ( int i = 0; i < NeCountOf(item); ++i )
+			switch (s.Stream.Caret.Pos[0])
 			{
-				if (s.Stream.Caret.Pos[0] == item[i].Char)
-				{
-					item[i].Handler( s );
-					handled = true;
-					break;
-				}
-			}
-			if (!handled)
+			case '{':
+			case '[':
+				JsonState_Parse_Begin( s );
+				break;
+			case '}':
+			case ']':
+				JsonState_Parse_End( s );
+				break;
+			case ':':
+				JsonState_Parse_Field( s );
+				break;
+			case ',':
+				JsonState_Parse_Separator( s );
+				break;
+			case '"':
+				JsonState_Parse_String( s );
+				break;
+			case 't':
+			case 'f':
+			case 'n':
+				JsonState_Parse_Constant( s );
+				break;
+			case '-':
+			case '0': case '1': case '2': case '3': case '4':
+			case '5': case '6': case '7': case '8': case '9':
+				JsonState_Parse_Number( s );
+				break;
+			case '\n':
+				JsonState_Parse_NewLine( s );
+				break;
+			case ' ':
+			case '\t':
+			case '\r':
+				JsonState_Parse_Whitespace( s );
+				break;
+			case '/':
+				JsonState_Parse_Comment( s );
+				break;
+			default:
 				s.Stream.Result = NE_ERR_JSON_UNEXPECTED_CHAR;
+				break;
+			}
 		}
 	}
 
@@ -360,22 +377,11 @@ namespace nemesis
 		// determine type
 		const JsonType::Enum type = ((*s.Stream.Caret.Pos) == '{') ? JsonType::Object : JsonType::Array;
 
-		// handle syntax errors
-		if (!s.Top)
+		// handle syntax errors, the root may be an object or an array
+		if (!s.Top && s.Root)
 		{
-			if (!s.Root)
-			{
-				if (type != JsonType::Object)
-				{
-					s.Stream.Result = NE_ERR_JSON_UNEXPECTED_CHAR;
-					return;
-				}
-			}
-			else
-			{
-				s.Stream.Result = NE_ERR_JSON_MULTIPLE_ROOT_OBJECTS;
-				return;
-			}
+			s.Stream.Result = NE_ERR_JSON_MULTIPLE_ROOT_OBJECTS;
+			return;
 		}
 
 		// push item
@@ -564,7 +570,10 @@ namespace nemesis
 
 	static void JsonState_Parse_Whitespace( JsonState_s& s )
 	{
-		++s.Stream.Caret.Pos;
+		cstr_t it = s.Stream.Caret.Pos+1;
+		while ((it < s.Stream.Caret.End) && ((*it == ' ') || (*it == '\t') || (*it == '\r')))
+			++it;
+		s.Stream.Caret.Pos = it;
 	}
 
 	static void JsonState_Parse_Comment( JsonState_s& s )
@@ -620,7 +629,7 @@ namespace nemesis
 {
 	/// Json
 
-	Result_t Json_Parse( cstr_t src, uint32_t len, const JsonClient_s& client, JsonError_s* error )
+	Result_t Json_Parse( cstr_t src, size_t len, const JsonClient_s& client, JsonError_s* error )
 	{
 		if (!src || !len || !client.HandleEvent)
 			return NE_ERR_INVALID_ARG;
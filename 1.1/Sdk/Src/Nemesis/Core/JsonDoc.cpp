@@ -112,7 +112,7 @@ namespace nemesis
 	Result_t JsonDoc_Parse( JsonDoc_s& doc, cstr_t json, size_t size, JsonError_s& err )
 	{
 		const JsonClient_s json_client = { Json_ParseDoc, &doc };
-		return Json_Parse( json, (uint32_t)size, json_client, &err );
+		return Json_Parse( json, size, json_client, &err );
 	}
 
 } 
\ No newline at end of file
@@ -33,6 +33,32 @@ namespace nemesis
 		StrBuf_Print( json.Text, " " );
 	}
 
+	/// Writes a quoted string, escaping quotes, backslashes and control characters.
+	static void JsonOut_Write_String( JsonOut_s& json, cstr_t text )
+	{
+		StrBuf_Print( json.Text, "\"" );
+		cstr_t run = text;
+		for ( cstr_t pos = text; *pos; ++pos )
+		{
+			const uint8_t c = (uint8_t)*pos;
+			if ((c >= 0x20) && (c != '"') && (c != '\\'))
+				continue;
+			StrBuf_PrintN( json.Text, run, (int)(pos - run) );
+			switch ( c )
+			{
+			case '"':	StrBuf_Print( json.Text, "\\\"" ); break;
+			case '\\':	StrBuf_Print( json.Text, "\\\\" ); break;
+			case '\n':	StrBuf_Print( json.Text, "\\n" ); break;
+			case '\r':	StrBuf_Print( json.Text, "\\r" ); break;
+			case '\t':	StrBuf_Print( json.Text, "\\t" ); break;
+			default:	StrBuf_PrintF( json.Text, "\\u%04x", c ); break;
+			}
+			run = pos + 1;
+		}
+		StrBuf_Print( json.Text, run );
+		StrBuf_Print( json.Text, "\"" );
+	}
+
 	static void JsonOut_Flush_Comment( JsonOut_s& json )
 	{
 		if (!json.Comment.Count)
@@ -172,11 +198,21 @@ namespace nemesis
 		json.Item = Json::Value;
 	}
 
+	void JsonOut_Value( JsonOut_s& json, double v )
+	{
+		JsonOut_Indent( json );
+		if ((v == floor(v)) && (fabs(v) < 1e15))
+			StrBuf_PrintF( json.Text, "%.1f", v );
+		else
+			StrBuf_PrintF( json.Text, "%.15g", v );
+		json.Item = Json::Value;
+	}
+
 	void JsonOut_Value( JsonOut_s& json, cstr_t v )
 	{
 		JsonOut_Indent( json );
 		if (v)
-			StrBuf_PrintF( json.Text, "\"%s\"", v );
+			JsonOut_Write_String( json, v );
 		else
 			StrBuf_Print( json.Text, "null" );
 		json.Item = Json::Value;
@@ -185,7 +221,8 @@ namespace nemesis
 	void JsonOut_Field( JsonOut_s& json, cstr_t name )
 	{
 		JsonOut_Prefix( json );
-		StrBuf_PrintF( json.Text, "\"%s\": ", name );
+		JsonOut_Write_String( json, name );
+		StrBuf_Print( json.Text, ": " );
 		json.Item = Json::Field;
 	}
 
@@ -28,6 +28,19 @@
 #
 #	include <windows.h>
 #
+#elif (NE_PLATFORM == NE_PLATFORM_LINUX)
+#
+#	include <errno.h>
+#	include <fcntl.h>
+#	include <malloc.h>
+#	include <pthread.h>
+#	include <sched.h>
+#	include <semaphore.h>
+#	include <time.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#
 #else
 #
 #	error Platform not supported...
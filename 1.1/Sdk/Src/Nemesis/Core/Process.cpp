@@ -23,6 +23,8 @@
 #	include "Process_Orbis.h"
 #elif (NE_PLATFORM == NE_PLATFORM_PS5)
 #	include "Process_Orbis.h"
+#elif (NE_PLATFORM == NE_PLATFORM_LINUX)
+#	include "Process_Posix.h"
 #else
 #	error Unrecognized platform...
 #endif
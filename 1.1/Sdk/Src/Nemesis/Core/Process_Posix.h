@@ -0,0 +1,339 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+#include <Nemesis/Core/String.h>
+
+//======================================================================================
+namespace nemesis { namespace system
+{
+	//==================================================================================
+
+	namespace
+	{
+		static const Tick_t TICKS_PER_SECOND = 1000000000;
+
+		static timespec Time_AfterMs( uint32_t ms )
+		{
+			timespec time;
+			clock_gettime( CLOCK_REALTIME, &time );
+			time.tv_sec  += ms / 1000;
+			time.tv_nsec += (long)(ms % 1000) * 1000000;
+			if (time.tv_nsec >= 1000000000)
+			{
+				time.tv_sec  += 1;
+				time.tv_nsec -= 1000000000;
+			}
+			return time;
+		}
+	}
+
+	Tick_t Clock_GetFreq()
+	{
+		return TICKS_PER_SECOND;
+	}
+
+	Tick_t Clock_GetTick()
+	{
+		timespec time;
+		clock_gettime( CLOCK_MONOTONIC, &time );
+		return (Tick_t)time.tv_sec * TICKS_PER_SECOND + time.tv_nsec;
+	}
+
+	//==================================================================================
+
+	CpuId_t Cpu_GetIndex()
+	{ 
+		const int cpu = sched_getcpu();
+		return (cpu >= 0) ? (CpuId_t)cpu : 0; 
+	}
+
+	void Cpu_Yield()
+	{ __builtin_ia32_pause(); }
+
+	//==================================================================================
+	NeStaticAssert( sizeof(TlsId_t) >= sizeof(pthread_key_t) );
+
+	TlsId_t Tls_Alloc()
+	{ 
+		pthread_key_t key = 0;
+		pthread_key_create( &key, nullptr );
+		return (TlsId_t)key; 
+	}
+
+	void Tls_Free( TlsId_t id )
+	{ pthread_key_delete( (pthread_key_t)id ); }
+
+	void Tls_SetValue( TlsId_t id, void* data )
+	{ pthread_setspecific( (pthread_key_t)id, data ); }
+
+	void* Tls_GetValue( TlsId_t id )
+	{ return pthread_getspecific( (pthread_key_t)id ); }
+
+	//==================================================================================
+	// Events within the process are a condition and a flag, named events are semaphores 
+	// which the creator removes once it closes its handle.
+
+	namespace
+	{
+		struct Event_s
+		{
+			pthread_mutex_t Mutex;
+			pthread_cond_t	Cond;
+			bool			Signaled;
+			bool			Owner;
+			sem_t*			Named;
+			char			Name[128];
+		};
+
+		static Event_s* Event_Alloc()
+		{
+			Event_s* ev = new Event_s;
+			NeZero( *ev );
+			return ev;
+		}
+
+		static Event_t Event_OpenSemaphore( cstr_t name, bool create )
+		{
+			Event_s* ev = Event_Alloc();
+			Str_Fmt( ev->Name, sizeof(ev->Name), "/%s", name );
+			for ( char* pos = ev->Name+1; *pos; ++pos )
+				if ((*pos == '/') || (*pos == '\\'))
+					*pos = '_';
+			ev->Owner = create;
+			ev->Named = create ? sem_open( ev->Name, O_CREAT | O_EXCL, 0600, 0 ) : sem_open( ev->Name, 0 );
+			if (ev->Named == SEM_FAILED)
+			{
+				delete ev;
+				return nullptr;
+			}
+			return ev;
+		}
+	}
+
+	Event_t Event_Create( bool signaled )
+	{ 
+		Event_s* ev = Event_Alloc();
+		pthread_mutex_init( &ev->Mutex, nullptr );
+		pthread_cond_init( &ev->Cond, nullptr );
+		ev->Signaled = signaled;
+		return ev; 
+	}
+
+	void Event_Close( Event_t event )
+	{ 
+		Event_s* ev = (Event_s*)event;
+		if (ev->Named)
+		{
+			sem_close( ev->Named );
+			if (ev->Owner)
+				sem_unlink( ev->Name );
+		}
+		else
+		{
+			pthread_cond_destroy( &ev->Cond );
+			pthread_mutex_destroy( &ev->Mutex );
+		}
+		delete ev;
+	}
+
+	void Event_Signal( Event_t event )
+	{ 
+		Event_s* ev = (Event_s*)event;
+		if (ev->Named)
+		{
+			// auto reset, at most one pending release
+			int value = 0;
+			if ((sem_getvalue( ev->Named, &value ) == 0) && (value > 0))
+				return;
+			sem_post( ev->Named );
+			return;
+		}
+		pthread_mutex_lock( &ev->Mutex );
+		ev->Signaled = true;
+		pthread_cond_broadcast( &ev->Cond );
+		pthread_mutex_unlock( &ev->Mutex );
+	}
+
+	void Event_Unsignal( Event_t event )
+	{ 
+		Event_s* ev = (Event_s*)event;
+		if (ev->Named)
+		{
+			while (sem_trywait( ev->Named ) == 0)
+				;
+			return;
+		}
+		pthread_mutex_lock( &ev->Mutex );
+		ev->Signaled = false;
+		pthread_mutex_unlock( &ev->Mutex );
+	}
+
+	void Event_Wait( Event_t event )
+	{ 
+		Event_s* ev = (Event_s*)event;
+		if (ev->Named)
+		{
+			while ((sem_wait( ev->Named ) != 0) && (errno == EINTR))
+				;
+			return;
+		}
+		pthread_mutex_lock( &ev->Mutex );
+		while (!ev->Signaled)
+			pthread_cond_wait( &ev->Cond, &ev->Mutex );
+		pthread_mutex_unlock( &ev->Mutex );
+	}
+
+	bool Event_WaitMs( Event_t event, uint32_t ms )
+	{ 
+		Event_s* ev = (Event_s*)event;
+		const timespec until = Time_AfterMs( ms );
+		if (ev->Named)
+		{
+			int hr;
+			while (((hr = sem_timedwait( ev->Named, &until )) != 0) && (errno == EINTR))
+				;
+			return hr == 0;
+		}
+		int hr = 0;
+		pthread_mutex_lock( &ev->Mutex );
+		while (!ev->Signaled && (hr == 0))
+			hr = pthread_cond_timedwait( &ev->Cond, &ev->Mutex, &until );
+		const bool signaled = ev->Signaled;
+		pthread_mutex_unlock( &ev->Mutex );
+		return signaled;
+	}
+
+	Event_t Event_CreateNamed( cstr_t name )
+	{ return Event_OpenSemaphore( name, true ); }
+
+	Event_t Event_OpenNamed( cstr_t name )
+	{ return Event_OpenSemaphore( name, false ); }
+
+	//==================================================================================
+
+	Semaphore_t Semaphore_Create( int initial, int maximum )
+	{ 
+		sem_t* semaphore = new sem_t;
+		sem_init( semaphore, 0, (unsigned)initial );
+		return semaphore;
+	}
+
+	void Semaphore_Destroy( Semaphore_t semaphore )
+	{ 
+		sem_destroy( (sem_t*)semaphore );
+		delete (sem_t*)semaphore;
+	}
+
+	void Semaphore_Signal( Semaphore_t semaphore, int count )
+	{ 
+		for ( int i = 0; i < count; ++i )
+			sem_post( (sem_t*)semaphore );
+	}
+
+	void Semaphore_Wait( Semaphore_t semaphore )
+	{ 
+		while ((sem_wait( (sem_t*)semaphore ) != 0) && (errno == EINTR))
+			;
+	}
+
+	//==================================================================================
+	NeStaticAssert( sizeof(CriticalSection_t) >= sizeof(pthread_mutex_t) );
+
+	void CriticalSection_Create( CriticalSection_t& cs )
+	{ 
+		NeZero( cs );
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init( &attr );
+		pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_RECURSIVE );
+		pthread_mutex_init( (pthread_mutex_t*)&cs, &attr );
+		pthread_mutexattr_destroy( &attr );
+	}
+
+	void CriticalSection_Destroy( CriticalSection_t& cs )
+	{ 
+		pthread_mutex_destroy( (pthread_mutex_t*)&cs ); 
+	}
+
+	void CriticalSection_Enter( CriticalSection_t& cs )
+	{ 
+		pthread_mutex_lock( (pthread_mutex_t*)&cs ); 
+	}
+
+	void CriticalSection_Leave( CriticalSection_t& cs )
+	{ 
+		pthread_mutex_unlock( (pthread_mutex_t*)&cs ); 
+	}
+
+	//==================================================================================
+
+	namespace
+	{
+		struct ThreadArgs
+		{
+			ThreadProc Proc;
+			void* Context;
+			const char* Name;
+		};
+
+		static void* RunThread( void* context )
+		{
+			// copy args to stack mem and delete them
+			ThreadArgs* ptr = (ThreadArgs*)context;
+			ThreadArgs args = *ptr;
+			delete ptr;
+
+			// set debug name, limited to 15 characters
+			char name[16];
+			Str_Fmt( name, "%.15s", (args.Name && args.Name[0]) ? args.Name : "Nemesis" );
+			pthread_setname_np( pthread_self(), name );
+
+			// run using the copy on the stack
+			args.Proc( args.Context );
+
+			// done
+			return nullptr;
+		}
+	}
+
+	NeStaticAssert( sizeof(Thread_t) >= sizeof(pthread_t) );
+
+	Thread_t Thread_Create( const ThreadSetup_s& setup )
+	{
+		// copy args
+		ThreadArgs* args = new ThreadArgs;
+		args->Context = setup.Context;
+		args->Proc = setup.Proc;
+		args->Name = setup.Name;
+
+		// create thread
+		pthread_t thread;
+		if (pthread_create( &thread, nullptr, &RunThread, args ) != 0)
+		{
+			delete args;
+			return nullptr;
+		}
+		return (Thread_t)thread;
+	}
+
+	void Thread_Wait( Thread_t thread )
+	{ pthread_join( (pthread_t)thread, nullptr ); }
+
+	void Thread_SleepMs( uint32_t ms )
+	{ 
+		timespec time = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000 };
+		while (nanosleep( &time, &time ) != 0)
+			;
+	}
+
+	ThreadId_t Thread_GetId()
+	{ return (ThreadId_t)gettid(); }
+
+} }
@@ -66,6 +66,15 @@ namespace nemesis { namespace system
 	void Event_Wait( Event_t event )
 	{ WaitForSingleObject( event, INFINITE ); }
 
+	bool Event_WaitMs( Event_t event, uint32_t ms )
+	{ return WaitForSingleObject( event, ms ) == WAIT_OBJECT_0; }
+
+	Event_t Event_CreateNamed( cstr_t name )
+	{ return CreateEventA( nullptr, FALSE, FALSE, name ); }
+
+	Event_t Event_OpenNamed( cstr_t name )
+	{ return OpenEventA( EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, name ); }
+
 	//==================================================================================
 
 	Semaphore_t Semaphore_Create( int initial, int maximum )
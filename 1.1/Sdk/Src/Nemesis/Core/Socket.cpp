@@ -23,6 +23,8 @@
 #	include "Socket_Orbis.h"
 #elif (NE_PLATFORM == NE_PLATFORM_PS5)
 #	include "Socket_Orbis.h"
+#elif (NE_PLATFORM == NE_PLATFORM_LINUX)
+#	include "Socket_Posix.h"
 #else
 #	error Unrecognized platform...
 #endif
@@ -84,6 +86,11 @@ namespace nemesis { namespace system
 		return Socket_Receive( socket, buffer, size );
 	}
 
+	int Tcp_ReceiveSome( Socket_t socket, void* buffer, size_t size )
+	{
+		return Socket_ReceiveSome( socket, buffer, size );
+	}
+
 	IpAddress_t Tcp_GetPeer( Socket_t socket )
 	{
 		return Socket_GetPeer( socket );
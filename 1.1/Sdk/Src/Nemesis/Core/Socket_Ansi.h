@@ -65,7 +65,7 @@ namespace nemesis { namespace system
 				return nullptr;
 			if (socket == 0 )
 				return Socket_t(-1);
-			return reinterpret_cast<Socket_t>(socket);
+			return (Socket_t)(intptr_t)socket;
 		}
 
 		static SocketId_t Translate( Socket_t socket )
@@ -74,7 +74,7 @@ namespace nemesis { namespace system
 				return SOCKET_ID_INVALID;
 			if (socket == Socket_t(-1))
 				return 0;
-			return reinterpret_cast<SocketId_t>(socket); 
+			return (SocketId_t)(intptr_t)socket; 
 		}
 
 		static bool Succeeded( int hr )
@@ -181,6 +181,11 @@ namespace nemesis { namespace system
 		return true;
 	}
 
+	int Socket_ReceiveSome( Socket_t socket, void* data, size_t size )
+	{
+		return recv( Translate( socket ), (char*)data, (int)size, 0 );
+	}
+
 	bool Socket_SendTo( Socket_t socket, IpAddress_t addr, const void* data, size_t size )
 	{
 		sockaddr_in address = IpToAddr( addr );
@@ -204,7 +209,7 @@ namespace nemesis { namespace system
 	{
 		sockaddr_in address = IpToAddr(addr);
 		socklen_t l = sizeof(sockaddr_in);
-		const int hr = getnameinfo((sockaddr*)&address, l, name, (DWORD)len, nullptr, 0, 0);
+		const int hr = getnameinfo((sockaddr*)&address, l, name, (socklen_t)len, nullptr, 0, 0);
 		return hr == 0;
 	}
 
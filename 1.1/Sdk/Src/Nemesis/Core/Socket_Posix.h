@@ -0,0 +1,82 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <string.h>
+
+//======================================================================================
+namespace nemesis { namespace system
+{
+	//==================================================================================
+
+	void Socket_Initialize()
+	{
+	}
+
+	void Socket_Shutdown()
+	{
+	}
+
+	//==================================================================================
+
+	namespace
+	{
+		enum { SOCKET_MAX_CONNECTIONS = SOMAXCONN };
+
+		typedef int SocketId_t;
+		const SocketId_t SOCKET_ID_INVALID = -1;
+
+		static int socketclose( SocketId_t socket ) 
+		{ return close( socket ); }
+
+		static int socket_set_non_blocking( SocketId_t socket, bool enable ) 
+		{
+			int non_blocking = enable ? 1 : 0;
+			return ioctl( socket, FIONBIO, &non_blocking );
+		}
+
+		static int socket_get_last_err()
+		{
+			return errno;
+		}
+
+		static const char* socket_get_err_str( int err )
+		{
+			#define CASE(x) case x: return #x;
+			switch ( err )
+			{
+			CASE(ENETDOWN)
+			CASE(EACCES)
+			CASE(EFAULT)
+			CASE(EINVAL)
+			CASE(EINTR)
+			CASE(EWOULDBLOCK)
+			CASE(ENOTSOCK)
+			CASE(EADDRINUSE)
+			default:
+				return "ERRNO";
+			}
+			#undef CASE
+		}
+
+		static const char* socket_get_err_desc( int err )
+		{
+			return strerror( err );
+		}
+	}
+} }
+
+//======================================================================================
+#include "Socket_Ansi.h"
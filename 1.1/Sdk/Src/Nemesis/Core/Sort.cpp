@@ -20,6 +20,8 @@
 #	include "Sort_Orbis.h"
 #elif (NE_PLATFORM == NE_PLATFORM_PS5)
 #	include "Sort_Orbis.h"
+#elif (NE_PLATFORM == NE_PLATFORM_LINUX)
+#	include "Sort_Posix.h"
 #else
 #	error Unrecognized platform...
 #endif
@@ -0,0 +1,31 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+#include <Nemesis/Core/Sort.h>
+#include <stdlib.h>
+
+//======================================================================================
+namespace nemesis
+{
+	namespace
+	{
+		static int SortClient_Compare( const void* lhs, const void* rhs, void* context )
+		{
+			const SortClient_s& client = *(const SortClient_s*)context;
+			return client.Compare( client.Context, lhs, rhs );
+		}
+	}
+
+	void Sort_Quick( void* items, int count, size_t item_size, const SortClient_s& client )
+	{
+		qsort_r( items, count, item_size, SortClient_Compare, (void*)&client );
+	}
+}
@@ -13,6 +13,50 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <wchar.h>
+#include <errno.h>
+
+//======================================================================================
+#if (NE_PLATFORM == NE_PLATFORM_LINUX)
+namespace
+{
+	/// Bounds checked functions of the Microsoft CRT, failing instead of truncating.
+
+	static int vsprintf_s( char* out, size_t size, const char* fmt, va_list args )
+	{
+		const int n = vsnprintf( out, size, fmt, args );
+		if ((n >= 0) && ((size_t)n < size))
+			return n;
+		if (size)
+			out[0] = 0;
+		return -1;
+	}
+
+	static int vswprintf_s( wchar_t* out, size_t count, const wchar_t* fmt, va_list args )
+	{
+		const int n = vswprintf( out, count, fmt, args );
+		if ((n < 0) && count)
+			out[0] = 0;
+		return n;
+	}
+
+	static size_t wcsnlen_s( const wchar_t* t, size_t count )
+	{
+		return t ? wcsnlen( t, count ) : 0;
+	}
+
+	static int wcscpy_s( wchar_t* out, size_t count, const wchar_t* in )
+	{
+		if (wcslen( in ) >= count)
+		{
+			if (count)
+				out[0] = 0;
+			return ERANGE;
+		}
+		wcscpy( out, in );
+		return 0;
+	}
+}
+#endif
 
 //======================================================================================
 namespace nemesis
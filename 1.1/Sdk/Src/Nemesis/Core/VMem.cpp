@@ -23,6 +23,8 @@
 #	include "VMem_Orbis.h"
 #elif (NE_PLATFORM == NE_PLATFORM_PS5)
 #	include "VMem_Orbis.h"
+#elif (NE_PLATFORM == NE_PLATFORM_LINUX)
+#	include "VMem_Posix.h"
 #else
 #	error Unrecognized platform...
 #endif
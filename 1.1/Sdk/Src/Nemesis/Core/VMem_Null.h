@@ -31,5 +31,18 @@ namespace nemesis
 	{
 		return 4096;
 	}
-}
 
+	ptr_t NE_API SharedMem_Create( cstr_t name, size_t size, Handle_t* handle )
+	{
+		return nullptr;
+	}
+
+	ptr_t NE_API SharedMem_Open( cstr_t name, size_t size, Handle_t* handle )
+	{
+		return nullptr;
+	}
+
+	void NE_API SharedMem_Close( ptr_t ptr, Handle_t handle )
+	{
+	}
+}
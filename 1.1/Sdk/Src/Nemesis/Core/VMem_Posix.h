@@ -0,0 +1,109 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+#include <Nemesis/Core/VMem.h>
+#include <Nemesis/Core/String.h>
+
+//======================================================================================
+namespace nemesis
+{
+	ptr_t NE_API VMem_Alloc( size_t size )
+	{
+		ptr_t ptr = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+		return (ptr != MAP_FAILED) ? ptr : nullptr;
+	}
+
+	void NE_API VMem_Free( ptr_t ptr, size_t size )
+	{
+		if (ptr)
+			munmap( ptr, size );
+	}
+
+	uint32_t NE_API VMem_GetPageSize()
+	{
+		return (uint32_t)sysconf( _SC_PAGESIZE );
+	}
+
+	//==================================================================================
+	// Named segments outlive their handles on POSIX, the creator removes the name once it closes its view.
+
+	namespace
+	{
+		struct SharedMem_s
+		{
+			size_t	Size;
+			bool	Owner;
+			char	Name[128];
+		};
+
+		static void SharedMem_MakeName( char* out, size_t size, cstr_t name )
+		{
+			Str_Fmt( out, size, "/%s", name );
+			for ( char* pos = out+1; *pos; ++pos )
+				if ((*pos == '/') || (*pos == '\\'))
+					*pos = '_';
+		}
+
+		static ptr_t SharedMem_Map( cstr_t name, size_t size, bool create, Handle_t* handle )
+		{
+			SharedMem_s* shared = new SharedMem_s;
+			SharedMem_MakeName( shared->Name, sizeof(shared->Name), name );
+			shared->Owner = create;
+			const int fd = create 
+				? shm_open( shared->Name, O_RDWR | O_CREAT | O_EXCL, 0600 ) 
+				: shm_open( shared->Name, O_RDWR, 0 );
+			if (fd < 0)
+			{
+				delete shared;
+				return nullptr;
+			}
+
+			struct stat info = {};
+			bool ok = create ? (ftruncate( fd, (off_t)size ) == 0) : (fstat( fd, &info ) == 0);
+			if (!create && !size)
+				size = (size_t)info.st_size;
+			ptr_t view = (ok && size) ? mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ) : MAP_FAILED;
+			close( fd );
+			if (view == MAP_FAILED)
+			{
+				if (create)
+					shm_unlink( shared->Name );
+				delete shared;
+				return nullptr;
+			}
+			shared->Size = size;
+			*handle = shared;
+			return view;
+		}
+	}
+
+	ptr_t NE_API SharedMem_Create( cstr_t name, size_t size, Handle_t* handle )
+	{
+		return SharedMem_Map( name, size, true, handle );
+	}
+
+	ptr_t NE_API SharedMem_Open( cstr_t name, size_t size, Handle_t* handle )
+	{
+		return SharedMem_Map( name, size, false, handle );
+	}
+
+	void NE_API SharedMem_Close( ptr_t ptr, Handle_t handle )
+	{
+		SharedMem_s* shared = (SharedMem_s*)handle;
+		if (!shared)
+			return;
+		if (ptr)
+			munmap( ptr, shared->Size );
+		if (shared->Owner)
+			shm_unlink( shared->Name );
+		delete shared;
+	}
+}
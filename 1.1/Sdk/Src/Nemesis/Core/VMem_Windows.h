@@ -32,5 +32,49 @@ namespace nemesis
 		GetSystemInfo( &sys_info );
 		return sys_info.dwPageSize;
 	}
-}
 
+	ptr_t NE_API SharedMem_Create( cstr_t name, size_t size, Handle_t* handle )
+	{
+		const DWORD size_hi = (DWORD)(((uint64_t)size) >> 32);
+		const DWORD size_lo = (DWORD)(((uint64_t)size) & 0xffffffff);
+		HANDLE mapping = CreateFileMappingA( INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, size_hi, size_lo, name );
+		if (!mapping)
+			return nullptr;
+		if (GetLastError() == ERROR_ALREADY_EXISTS)
+		{
+			CloseHandle( mapping );
+			return nullptr;
+		}
+		ptr_t view = MapViewOfFile( mapping, FILE_MAP_ALL_ACCESS, 0, 0, size );
+		if (!view)
+		{
+			CloseHandle( mapping );
+			return nullptr;
+		}
+		*handle = mapping;
+		return view;
+	}
+
+	ptr_t NE_API SharedMem_Open( cstr_t name, size_t size, Handle_t* handle )
+	{
+		HANDLE mapping = OpenFileMappingA( FILE_MAP_ALL_ACCESS, FALSE, name );
+		if (!mapping)
+			return nullptr;
+		ptr_t view = MapViewOfFile( mapping, FILE_MAP_ALL_ACCESS, 0, 0, size );
+		if (!view)
+		{
+			CloseHandle( mapping );
+			return nullptr;
+		}
+		*handle = mapping;
+		return view;
+	}
+
+	void NE_API SharedMem_Close( ptr_t ptr, Handle_t handle )
+	{
+		if (ptr)
+			UnmapViewOfFile( ptr );
+		if (handle)
+			CloseHandle( handle );
+	}
+}
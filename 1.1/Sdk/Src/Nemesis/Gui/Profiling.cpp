@@ -193,7 +193,7 @@ namespace nemesis { namespace gui
 		if (Database_GetNumFrames( db ) == 0)
 			return;
 		const int frame_index = NeClamp( i, 0, Database_GetNumFrames( db )-1 );
-		const viz::Frame& frame = Database_GetFrames( db )[ frame_index ];
+		const viz::Frame& frame = Database_GetFrame( db, frame_index );
 		Timeline_FitToTickRange( time, db, frame.Time.Begin, frame.Time.End, range_width, view_width );
 	}	
 	
@@ -203,8 +203,8 @@ namespace nemesis { namespace gui
 			return;
 		const int first_index = NeClamp( first		  , 0, Database_GetNumFrames( db )-1 );
 		const int last_index  = NeClamp( first+count-1, 0, Database_GetNumFrames( db )-1 );
-		const viz::Frame& frame_0 = Database_GetFrames( db )[ first_index ];
-		const viz::Frame& frame_1 = Database_GetFrames( db )[ last_index  ];
+		const viz::Frame& frame_0 = Database_GetFrame( db, first_index );
+		const viz::Frame& frame_1 = Database_GetFrame( db, last_index );
 		Timeline_FitToTickRange( time, db, frame_0.Time.Begin, frame_1.Time.End, range_width, view_width );
 	}	
 
@@ -271,7 +271,7 @@ namespace nemesis { namespace gui
 		cull.Frames.Count = 0;
 		for ( int i = cull.Frames.First; i < Database_GetNumFrames( db ); ++i )
 		{
-			if (Database_GetFrames( db )[i].Time.Begin >= cull.Time.End)
+			if (Database_GetFrame( db, i ).Time.Begin >= cull.Time.End)
 				break;
 			++cull.Frames.Count;
 		}
@@ -325,8 +325,8 @@ namespace nemesis { namespace gui
 		/*
 		// calculate groups's total duration
 		const int	 last_frame		  = group.Frames.Last();
-		const Tick_t first_group_tick = Database_GetFrames( db )[ group.Frames.First ].Time.Begin;
-		const Tick_t last_group_tick  = Database_GetFrames( db )[ last_frame		 ].Time.End;
+		const Tick_t first_group_tick = Database_GetFrame( db, group.Frames.First ).Time.Begin;
+		const Tick_t last_group_tick  = Database_GetFrame( db, last_frame ).Time.End;
 		*/
 
 		// calculate tick range in view
@@ -419,8 +419,8 @@ namespace nemesis { namespace gui
 		const uint32_t text_color = v.Theme->Palette.Frame.Text;
 
 		// item rect
-		const viz::Frame& frame_0 = Database_GetFrames( db )[item.Frames.First];
-		const viz::Frame& frame_1 = Database_GetFrames( db )[item.Frames.Last()];
+		const viz::Frame& frame_0 = Database_GetFrame( db, item.Frames.First );
+		const viz::Frame& frame_1 = Database_GetFrame( db, item.Frames.Last() );
 		const float frame_x = Timeline_TickToCoord( t, frame_0.Time.Begin );
 		const float frame_w = Timeline_DtToDx( t, frame_1.Time.End - frame_0.Time.Begin );
 
@@ -1222,7 +1222,7 @@ namespace nemesis { namespace gui
 		const int frame_end = first_frame + num_frames;
 		for ( int frame_index = first_frame; frame_index < frame_end; ++frame_index )
 		{
-			const viz::Frame& frame = Database_GetFrames( db )[ frame_index ];
+			const viz::Frame& frame = Database_GetFrame( db, frame_index );
 			const Tick frame_ticks = frame.Time.Duration();
 
 			// add frame to group
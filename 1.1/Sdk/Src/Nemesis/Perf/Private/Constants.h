@@ -12,10 +12,43 @@
 namespace nemesis { namespace profiling
 {
 	enum { BUFFER_SIZE				=  4096	};
+	enum { RECEIVE_BUFFER_SIZE		= 256*1024 };
+	enum { PARSER_QUEUE_SIZE		= 4*1024*1024 };
+	enum { PARSE_WORKER_QUEUE_SIZE	= 1024*1024 };
+	enum { MAX_NUM_PARSE_WORKERS	=     4 };
+	enum { MAX_NUM_QUERY_WORKERS	=     4 };
+	enum { QUERY_PARALLEL_MIN_ZONES	= 64*1024 };
+	enum { TRACE_CHUNK_FRAMES		=    16 };
+	enum { NUM_TRACE_CHUNKS		= 2 * (MAX_NUM_QUERY_WORKERS + 1) };
+	enum { TRACE_TICKS_PER_SECOND	= 1000000000 };
+	enum { TRACE_FRAME_TICKS		= TRACE_TICKS_PER_SECOND / 60 };
+	enum { TRACE_IMPORT_FRAMES		=   256 };
 	enum { MAX_NUM_CPUS				=    32	};
 	enum { MAX_NUM_THREADS			=    64	};
+	enum { MAX_ZONE_DEPTH			=    64 };
+	enum { NUM_ZONE_LODS			=     4 };
+	enum { ZONE_LOD_BASE_SHIFT		=    10 };
+	enum { ZONE_LOD_STEP_SHIFT		=     4 };
 	enum { MAX_NUM_POOLED_BUFFERS	=  1024 };
 	enum { MAX_NUM_DISPATCH_ITEMS	=    64 };
 	enum { MAX_NUM_REMOTE_PEERS		=	  8 };
+	enum { MAX_NUM_DYNAMIC_NAMES	=  1024 };
+	enum { MAX_DYNAMIC_NAME_SIZE	=   128 };
+	enum { SHARED_RING_SIZE			= 4*1024*1024 };
+	enum { SHARED_RING_WAIT_MS		=   100 };
+	enum { FRAME_SEGMENT_SHIFT		=     8 };
+	enum { EVENT_SEGMENT_SHIFT		=    12 };
+	enum { SCOPE_CACHE_SIZE			=     4 };
+	enum { NUM_HOT_FRAMES			=   256 };
+	enum { HOTSPOT_SUM_SHIFT		=     8 };
+	enum { HOTSPOT_SUM_STRIDE		= 1 << HOTSPOT_SUM_SHIFT };
+	enum { STATS_CHUNK_SHIFT		=     8 };
+	enum { STATS_CHUNK_STRIDE		= 1 << STATS_CHUNK_SHIFT };
+	enum { POSTING_BLOCK_SIZE		=    64 };
+	enum { COUNTER_LEVEL_SHIFT		=     4 };
+	enum { NUM_COUNTER_LEVELS		=     5 };
+
+	/// Tags name ids which are content hashes rather than string addresses.
+	static const uint64_t DYNAMIC_NAME_FLAG = 0x8000000000000000ULL;
 
 } }
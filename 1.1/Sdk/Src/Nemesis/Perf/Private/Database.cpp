@@ -10,6 +10,9 @@
 #include "Database.h"
 #include "Private/Parser.h"
 
+//======================================================================================
+#include <Nemesis/Core/File.h>
+
 //======================================================================================
 namespace nemesis { namespace profiling
 {
@@ -17,41 +20,52 @@ namespace nemesis { namespace profiling
 	{
 		db->Alloc = alloc;
 		db->Setup = setup;
-		db->NameTable.Alloc = alloc;
 		db->StringPool.Pages.Alloc = alloc;
 		ParsedData_Initialize( db->Data, alloc );
+		ParsedData_UnitTest( alloc );
+		QueryPool_Initialize( db->QueryPool );
 
 		if (!setup.MaxNumBytes)
 			 db->Setup.MaxNumBytes = 500 * 1024 * 1024;
+		if (!setup.NumHotFrames)
+			 db->Setup.NumHotFrames = NUM_HOT_FRAMES;
 
-		const uint32_t large = db->Setup.MaxNumBytes / 2;
-		const uint32_t small = db->Setup.MaxNumBytes / 10;
-
-		db->Data.Frames			.Reserve( small / sizeof(db->Data.Frames		[0]) );
-		db->Data.Scopes			.Reserve( large / sizeof(db->Data.Scopes		[0]) );
-		db->Data.LockEvents		.Reserve( small / sizeof(db->Data.LockEvents	[0]) );
-		db->Data.CounterValues	.Reserve( small / sizeof(db->Data.CounterValues	[0]) );
-		db->Data.LogItems		.Reserve( small / sizeof(db->Data.LogItems		[0]) );
+		if (setup.SpillPath && setup.MaxSpillBytes)
+			SpillStore_Open( db->Data.Spill, setup.SpillPath, setup.MaxSpillBytes );
 	}
 
 	size_t Database_TotalSize( Database_t db )
 	{
 		return db->Data.TotalSize()
-			 + Array_GetCountSize( db->NameTable )
-			 + Stack_GetSize	( db->StringPool );
+			 + Stack_GetSize( db->StringPool );
 	}
 
 	void Database_ResetStrings( Database_t db )
 	{
-		db->NameTable.Reset();
 		db->StringPool.Reset();
 	}
 
+	/// Moves the pages of the string pool to the given array.
+	/// Strings handed out so far stay valid until the pages are freed.
+	void Database_RetireStrings( Database_t db, Array<Page_s*>& pages )
+	{
+		pages.Append( db->StringPool.Pages.Data, db->StringPool.Pages.Count );
+		db->StringPool.Pages.Reset();
+	}
+
+	void Database_FreeStrings( Array<Page_s*>& pages )
+	{
+		for ( int i = 0; i < pages.Count; ++i )
+			Mem_Free( pages.Alloc, pages[i] );
+		pages.Reset();
+	}
+
 	void Database_Shutdown( Database_t db )
 	{
-		db->NameTable.Clear();
+		QueryPool_Shutdown( db->QueryPool );
 		db->StringPool.Clear();
 		ParsedData_Shutdown( db->Data );
+		system::File_Unmap( db->MapView, db->MapHandle );
 	}
 
 } }
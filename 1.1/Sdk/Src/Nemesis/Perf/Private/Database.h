@@ -10,6 +10,7 @@
 
 //======================================================================================
 #include "Private/ParserData.h"
+#include "Private/QueryPool.h"
 
 //======================================================================================
 namespace nemesis { namespace profiling
@@ -19,13 +20,18 @@ namespace nemesis { namespace profiling
 		Allocator_t		Alloc;
 		DatabaseSetup_s Setup;
 		ParsedData_s	Data;
-		Array<cstr_t>	NameTable;
 		Stack_s			StringPool;
+		ptr_t			MapView;
+		Handle_t		MapHandle;
+		QueryPool_s		QueryPool;
+		Parser_t		Parser;
 	};
 
-	void	Database_Initialize	 ( Database_t db, Allocator_t alloc, const DatabaseSetup_s& setup );
-	size_t	Database_TotalSize	 ( Database_t db );
-	void	Database_ResetStrings( Database_t db );
-	void	Database_Shutdown	 ( Database_t db );
+	void	Database_Initialize    ( Database_t db, Allocator_t alloc, const DatabaseSetup_s& setup );
+	size_t	Database_TotalSize     ( Database_t db );
+	void	Database_ResetStrings  ( Database_t db );
+	void	Database_RetireStrings ( Database_t db, Array<Page_s*>& pages );
+	void	Database_FreeStrings   ( Array<Page_s*>& pages );
+	void	Database_Shutdown      ( Database_t db );
 
 } }
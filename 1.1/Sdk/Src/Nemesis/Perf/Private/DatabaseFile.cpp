@@ -0,0 +1,561 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#include "stdafx.h"
+#include "DatabaseFile.h"
+#include "Database.h"
+
+//======================================================================================
+#include <Nemesis/Core/File.h>
+#include <Nemesis/Core/HashTable.h>
+#include <Nemesis/Core/String.h>
+
+//======================================================================================
+using namespace nemesis::system;
+
+//======================================================================================
+// File layout
+//
+//	header
+//	columns		- whole segments, aligned to DB_FILE_ALIGN
+//	tables		- locations, locks, counters and counter groups
+//	strings		- zero terminated, referenced by offset+1 (0 is null)
+//
+// Columns are attached to the mapped file in place. Indices derived from them
+// (zones, hot spots, stats, postings, counter columns and lock indices) are rebuilt.
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	enum { DB_FILE_MAGIC   = 0x4244454e }; // 'NEDB'
+	enum { DB_FILE_VERSION = 1 };
+	enum { DB_FILE_ALIGN   = 64 };
+
+	/// A column stored as whole segments. The first segment holds the item at the base index.
+	struct DbFileColumn_s
+	{
+		uint64_t	Offset;
+		uint32_t	Base;
+		uint32_t	First;
+		uint32_t	End;
+		uint32_t	_pad_;
+	};
+
+	struct DbFileArray_s
+	{
+		uint64_t	Offset;
+		uint32_t	Count;
+		uint32_t	_pad_;
+	};
+
+	struct DbFileThread_s
+	{
+		uint64_t		Name;
+		uint32_t		Id;
+		uint8_t			NumLevels;
+		uint8_t			_pad_[3];
+		DbFileColumn_s	Time;
+		DbFileColumn_s	Location;
+		DbFileColumn_s	Flags;
+		DbFileColumn_s	FrameEnd;
+	};
+
+	struct DbFileHeader_s
+	{
+		uint32_t		Magic;
+		uint32_t		Version;
+		uint64_t		FileSize;
+		profiling::Clock	Clock;
+		int64_t			MaxFrameDuration;
+		uint32_t		LastFrameNumber;
+		uint8_t			NumCpus;
+		uint8_t			NumThreads;
+		uint8_t			_pad_[2];
+		DbFileArray_s	Strings;
+		DbFileArray_s	Locations;
+		DbFileArray_s	Locks;
+		DbFileArray_s	Counters;
+		DbFileArray_s	CounterGroups;
+		DbFileColumn_s	Frames;
+		DbFileColumn_s	LockEvents;
+		DbFileColumn_s	CounterValues;
+		DbFileColumn_s	LogItems;
+		DbFileThread_s	Thread[ MAX_NUM_THREADS ];
+	};
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	struct DbWriter_s
+	{
+		Allocator_t			Alloc;
+		File_t				File;
+		uint64_t			Pos;
+		bool				Failed;
+		HashTable_64_32_s	StringMap;
+		Array<char>			Strings;
+	};
+
+	static void DbWriter_Write( DbWriter_s& w, cptr_t data, size_t size )
+	{
+		const uint8_t* pos = (const uint8_t*)data;
+		while (size && !w.Failed)
+		{
+			const uint32_t num_bytes = (uint32_t)NeMin( size, (size_t)(1 << 30) );
+			uint32_t num_written = 0;
+			if (NeFailed( File_Write( w.File, pos, num_bytes, &num_written ) ) || (num_written != num_bytes))
+				w.Failed = true;
+			pos	  += num_bytes;
+			size  -= num_bytes;
+			w.Pos += num_bytes;
+		}
+	}
+
+	static void DbWriter_Align( DbWriter_s& w )
+	{
+		static const uint8_t zeros[ DB_FILE_ALIGN ] = {};
+		const uint32_t pad = (uint32_t)(-(int64_t)w.Pos & (DB_FILE_ALIGN-1));
+		DbWriter_Write( w, zeros, pad );
+	}
+
+	/// Returns the offset+1 of a string in the string table, or zero for null.
+	static uint64_t DbWriter_String( DbWriter_s& w, cstr_t text )
+	{
+		if (!text)
+			return 0;
+		const uint64_t key = (uint64_t)(size_t)text;
+		uint32_t offset = HashTable_Get( w.StringMap, key, ~0u );
+		if (offset == ~0u)
+		{
+			offset = (uint32_t)w.Strings.Count;
+			w.Strings.Append( text, (int)Str_Len( text ) + 1 );
+			HashTable_Set( w.StringMap, key, offset );
+		}
+		return (uint64_t)offset + 1;
+	}
+
+	/// Replaces a string pointer by its string table reference.
+	static void DbWriter_Patch( DbWriter_s& w, cstr_t& text )
+	{ text = (cstr_t)(size_t)DbWriter_String( w, text ); }
+
+	static void DbWriter_Patch( DbWriter_s& w, viz::CounterValue& item )
+	{ DbWriter_Patch( w, item.Name ); }
+
+	static void DbWriter_Patch( DbWriter_s& w, viz::LogItem& item )
+	{ DbWriter_Patch( w, item.Text ); }
+
+	static void DbWriter_Patch( DbWriter_s& w, viz::Lock& item )
+	{ DbWriter_Patch( w, item.Name ); }
+
+	static void DbWriter_Patch( DbWriter_s& w, viz::Counter& item )
+	{ DbWriter_Patch( w, item.Name ); }
+
+	static void DbWriter_Patch( DbWriter_s& w, viz::CounterGroup& item )
+	{ DbWriter_Patch( w, item.Name ); }
+
+	static void DbWriter_Patch( DbWriter_s& w, NamedLocation& item )
+	{
+		DbWriter_Patch( w, item.Name );
+		DbWriter_Patch( w, item.Location.Function );
+		DbWriter_Patch( w, item.Location.File );
+	}
+
+	template < typename T, int SHIFT >
+	static void DbWriter_Column( DbWriter_s& w, const SegmentArray<T,SHIFT>& arr, DbFileColumn_s& column )
+	{
+		DbWriter_Align( w );
+		column.Offset = w.Pos;
+		column.Base	  = arr.Base;
+		column.First  = arr.First;
+		column.End	  = arr.End;
+		const uint32_t num_segments = (arr.End - arr.Base + SegmentArray<T,SHIFT>::SEGMENT_MASK) >> SHIFT;
+		for ( uint32_t i = 0; i < num_segments; ++i )
+			DbWriter_Write( w, arr.Segment[i], SegmentArray<T,SHIFT>::SEGMENT_SIZE * sizeof(T) );
+	}
+
+	/// Writes a column of scope events. Packed segments are written unpacked.
+	template < typename T >
+	static void DbWriter_ScopeColumn( DbWriter_s& w, const ParsedScopes_s& scopes, const SegmentArray<T,EVENT_SEGMENT_SHIFT>& arr, T (ScopeSegment_s::*part)[ TickArray_s::SEGMENT_SIZE ], DbFileColumn_s& column )
+	{
+		DbWriter_Align( w );
+		column.Offset = w.Pos;
+		column.Base	  = arr.Base;
+		column.First  = arr.First;
+		column.End	  = arr.End;
+		ScopeSegment_s* unpacked = scopes.Packed.Count ? Mem_Alloc<ScopeSegment_s>( w.Alloc, 1 ) : nullptr;
+		const uint32_t num_segments = (arr.End - arr.Base + TickArray_s::SEGMENT_MASK) >> EVENT_SEGMENT_SHIFT;
+		for ( uint32_t i = 0; i < num_segments; ++i )
+		{
+			const T* segment = arr.Segment[i];
+			if ((int)i < scopes.Packed.Count)
+			{
+				ScopePack_Unpack( scopes.Packed[i], *unpacked );
+				segment = unpacked->*part;
+			}
+			DbWriter_Write( w, segment, TickArray_s::SEGMENT_SIZE * sizeof(T) );
+		}
+		Mem_Free( w.Alloc, unpacked );
+	}
+
+	/// Writes a column whose items hold strings.
+	/// Items outside of the retained range are zeroed since their strings may be gone.
+	template < typename T, int SHIFT >
+	static void DbWriter_PatchedColumn( DbWriter_s& w, const SegmentArray<T,SHIFT>& arr, DbFileColumn_s& column )
+	{
+		DbWriter_Align( w );
+		column.Offset = w.Pos;
+		column.Base	  = arr.Base;
+		column.First  = arr.First;
+		column.End	  = arr.End;
+
+		T* segment = Mem_Alloc<T>( w.Alloc, SegmentArray<T,SHIFT>::SEGMENT_SIZE );
+		const uint32_t num_segments = (arr.End - arr.Base + SegmentArray<T,SHIFT>::SEGMENT_MASK) >> SHIFT;
+		for ( uint32_t i = 0; i < num_segments; ++i )
+		{
+			const uint32_t base = arr.Base + (i << SHIFT);
+			Arr_Zero( segment, SegmentArray<T,SHIFT>::SEGMENT_SIZE );
+			for ( uint32_t j = 0; j < SegmentArray<T,SHIFT>::SEGMENT_SIZE; ++j )
+			{
+				if ((base + j - arr.First) >= arr.Count())
+					continue;
+				segment[j] = arr[ base + j ];
+				DbWriter_Patch( w, segment[j] );
+			}
+			DbWriter_Write( w, segment, SegmentArray<T,SHIFT>::SEGMENT_SIZE * sizeof(T) );
+		}
+		Mem_Free( w.Alloc, segment );
+	}
+
+	template < typename T >
+	static void DbWriter_Table( DbWriter_s& w, const Array<T>& items, DbFileArray_s& table )
+	{
+		DbWriter_Align( w );
+		table.Offset = w.Pos;
+		table.Count	 = (uint32_t)items.Count;
+		for ( int i = 0; i < items.Count; ++i )
+		{
+			T item = items[i];
+			DbWriter_Patch( w, item );
+			DbWriter_Write( w, &item, sizeof(item) );
+		}
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static cstr_t DbFile_String( const DbFileHeader_s& header, const uint8_t* view, uint64_t ref )
+	{
+		if (!ref || (ref > header.Strings.Count))
+			return nullptr;
+		return (cstr_t)(view + header.Strings.Offset + ref - 1);
+	}
+
+	static void DbFile_Resolve( const DbFileHeader_s& header, const uint8_t* view, cstr_t& text )
+	{ text = DbFile_String( header, view, (uint64_t)(size_t)text ); }
+
+	static void DbFile_Resolve( const DbFileHeader_s& header, const uint8_t* view, viz::CounterValue& item )
+	{ DbFile_Resolve( header, view, item.Name ); }
+
+	static void DbFile_Resolve( const DbFileHeader_s& header, const uint8_t* view, viz::LogItem& item )
+	{ DbFile_Resolve( header, view, item.Text ); }
+
+	static void DbFile_Resolve( const DbFileHeader_s& header, const uint8_t* view, viz::Lock& item )
+	{ DbFile_Resolve( header, view, item.Name ); }
+
+	static void DbFile_Resolve( const DbFileHeader_s& header, const uint8_t* view, viz::Counter& item )
+	{ DbFile_Resolve( header, view, item.Name ); }
+
+	static void DbFile_Resolve( const DbFileHeader_s& header, const uint8_t* view, viz::CounterGroup& item )
+	{ DbFile_Resolve( header, view, item.Name ); }
+
+	static void DbFile_Resolve( const DbFileHeader_s& header, const uint8_t* view, NamedLocation& item )
+	{
+		DbFile_Resolve( header, view, item.Name );
+		DbFile_Resolve( header, view, item.Location.Function );
+		DbFile_Resolve( header, view, item.Location.File );
+	}
+
+	template < typename T, int SHIFT >
+	static bool DbFile_IsValid( const DbFileColumn_s& column, const SegmentArray<T,SHIFT>&, uint64_t size )
+	{
+		const uint64_t num_segments = (column.End - column.Base + SegmentArray<T,SHIFT>::SEGMENT_MASK) >> SHIFT;
+		return !(column.Offset & (DB_FILE_ALIGN-1))
+			&& !(column.Base & SegmentArray<T,SHIFT>::SEGMENT_MASK)
+			&& ((column.First - column.Base) <= (column.End - column.Base))
+			&& (column.Offset + num_segments * SegmentArray<T,SHIFT>::SEGMENT_SIZE * sizeof(T) <= size);
+	}
+
+	template < typename T >
+	static bool DbFile_IsValid( const DbFileArray_s& table, const Array<T>&, uint64_t size )
+	{
+		return (table.Offset + (uint64_t)table.Count * sizeof(T)) <= size;
+	}
+
+	template < typename T >
+	static const T& DbFile_Item( const DbFileColumn_s& column, const uint8_t* view, uint32_t index )
+	{
+		return ((const T*)(view + column.Offset))[ index - column.Base ];
+	}
+
+	static bool DbFile_IsInRange( const DbFileColumn_s& column, uint32_t first, uint32_t count )
+	{
+		return ((first - column.First) <= (column.End - column.First)) && (count <= (column.End - first));
+	}
+
+	static bool DbFile_IsInRange( const DbFileColumn_s& column, const DbFileColumn_s& range )
+	{
+		return DbFile_IsInRange( column, range.First, range.End - range.First );
+	}
+
+	static bool DbFile_IsSameRange( const DbFileColumn_s& a, const DbFileColumn_s& b )
+	{
+		return (a.First == b.First) && (a.End == b.End);
+	}
+
+	/// Checks the indices held by the columns against the tables and columns they refer to.
+	static bool DbFile_AreIndicesValid( const DbFileHeader_s& header, const uint8_t* view )
+	{
+		for ( uint32_t i = header.Frames.First; i != header.Frames.End; ++i )
+		{
+			const viz::Frame& frame = DbFile_Item<viz::Frame>( header.Frames, view, i );
+			if (!DbFile_IsInRange( header.LockEvents   , frame.FirstLockEvent	, frame.NumLockEvents	 )
+			 || !DbFile_IsInRange( header.CounterValues, frame.FirstCounterValue, frame.NumCounterValues )
+			 || !DbFile_IsInRange( header.LogItems	   , frame.FirstLogItem		, frame.NumLogItems		 ))
+				return false;
+		}
+		for ( uint32_t i = header.LockEvents.First; i != header.LockEvents.End; ++i )
+		{
+			const viz::LockEvent& ev = DbFile_Item<viz::LockEvent>( header.LockEvents, view, i );
+			if ((ev.Lock >= header.Locks.Count) || (ev.Thread >= header.NumThreads))
+				return false;
+		}
+		for ( int i = 0; i < header.NumThreads; ++i )
+		{
+			const DbFileThread_s& thread = header.Thread[i];
+			if (!DbFile_IsSameRange( thread.Time, thread.Location ) || !DbFile_IsSameRange( thread.Time, thread.Flags ) || !DbFile_IsInRange( header.Frames, thread.FrameEnd ))
+				return false;
+			for ( uint32_t j = thread.Location.First; j != thread.Location.End; ++j )
+			{
+				const uint32_t location = DbFile_Item<uint32_t>( thread.Location, view, j );
+				if ((location >= header.Locations.Count) && (location != ~0u))
+					return false;
+			}
+			uint32_t prev = thread.Time.First;
+			for ( uint32_t j = thread.FrameEnd.First; j != thread.FrameEnd.End; ++j )
+			{
+				const uint32_t end = DbFile_Item<uint32_t>( thread.FrameEnd, view, j );
+				if ((end - prev) > (thread.Time.End - prev))
+					return false;
+				prev = end;
+			}
+		}
+		return true;
+	}
+
+	static bool DbFile_IsValid( const DbFileHeader_s& header, const ParsedData_s& data, const uint8_t* view, uint64_t size )
+	{
+		if ((size < sizeof(header)) || (header.Magic != DB_FILE_MAGIC) || (header.Version != DB_FILE_VERSION) || (header.FileSize != size))
+			return false;
+		if (header.NumThreads > MAX_NUM_THREADS)
+			return false;
+		if ((header.Strings.Offset + header.Strings.Count > size) || (header.Strings.Count && view[ header.Strings.Offset + header.Strings.Count - 1 ]))
+			return false;
+
+		bool valid
+			=  DbFile_IsValid( header.Locations	   , data.Locations	   , size )
+			&& DbFile_IsValid( header.Locks		   , data.Locks		   , size )
+			&& DbFile_IsValid( header.Counters	   , data.Counters	   , size )
+			&& DbFile_IsValid( header.CounterGroups, data.CounterGroups, size )
+			&& DbFile_IsValid( header.Frames	   , data.Frames	   , size )
+			&& DbFile_IsValid( header.LockEvents   , data.LockEvents   , size )
+			&& DbFile_IsValid( header.CounterValues, data.CounterValues, size )
+			&& DbFile_IsValid( header.LogItems	   , data.LogItems	   , size );
+		for ( int i = 0; valid && (i < header.NumThreads); ++i )
+		{
+			const DbFileThread_s& thread = header.Thread[i];
+			const ParsedScopes_s& scopes = data.Scopes[i];
+			valid = DbFile_IsValid( thread.Time	   , scopes.Time	, size )
+				 && DbFile_IsValid( thread.Location, scopes.Location, size )
+				 && DbFile_IsValid( thread.Flags   , scopes.Flags	, size )
+				 && DbFile_IsValid( thread.FrameEnd, scopes.FrameEnd, size );
+		}
+		return valid && DbFile_AreIndicesValid( header, view );
+	}
+
+	template < typename T, int SHIFT >
+	static void DbFile_Attach( const DbFileColumn_s& column, uint8_t* view, SegmentArray<T,SHIFT>& arr )
+	{
+		SegmentArray_Attach( arr, (T*)(view + column.Offset), column.Base, column.First, column.End );
+	}
+
+	/// Attaches a column whose items hold strings and resolves them in place.
+	template < typename T, int SHIFT >
+	static void DbFile_AttachPatched( const DbFileHeader_s& header, const DbFileColumn_s& column, uint8_t* view, SegmentArray<T,SHIFT>& arr )
+	{
+		DbFile_Attach( column, view, arr );
+		for ( uint32_t i = arr.First; i != arr.End; ++i )
+			DbFile_Resolve( header, view, arr[i] );
+	}
+
+	template < typename T >
+	static void DbFile_Load( const DbFileHeader_s& header, const DbFileArray_s& table, const uint8_t* view, Array<T>& items )
+	{
+		items.Append( (const T*)(view + table.Offset), (int)table.Count );
+		for ( int i = 0; i < items.Count; ++i )
+			DbFile_Resolve( header, view, items[i] );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	/// Writes the retained frames and everything recorded in them to a file.
+	bool DatabaseFile_Save( Database_t db, cstr_t path )
+	{
+		File_t file = nullptr;
+		if (NeFailed( File_Create( path, FileCreate::CreateAlways, FileAccess::Write, &file ) ))
+			return false;
+
+		DbWriter_s w = {};
+		w.Alloc = db->Alloc;
+		w.File = file;
+		HashTable_Init( w.StringMap, db->Alloc );
+		w.Strings.Init( db->Alloc );
+
+		// placeholder
+		DbFileHeader_s header = {};
+		DbWriter_Write( w, &header, sizeof(header) );
+
+		// columns
+		const ParsedData_s& data = db->Data;
+		DbWriter_Column( w, data.Frames, header.Frames );
+		for ( int i = 0; i < data.Threads.Count; ++i )
+		{
+			DbFileThread_s& thread = header.Thread[i];
+			const ParsedScopes_s& scopes = data.Scopes[i];
+			thread.Id		 = data.Threads.Id[i];
+			thread.NumLevels = data.Threads.Item[i].NumLevels;
+			thread.Name		 = DbWriter_String( w, data.Threads.Item[i].Name );
+			DbWriter_ScopeColumn( w, scopes, scopes.Time	, &ScopeSegment_s::Time	   , thread.Time	 );
+			DbWriter_ScopeColumn( w, scopes, scopes.Location, &ScopeSegment_s::Location, thread.Location );
+			DbWriter_ScopeColumn( w, scopes, scopes.Flags	, &ScopeSegment_s::Flags   , thread.Flags	 );
+			DbWriter_Column( w, scopes.FrameEnd, thread.FrameEnd );
+		}
+		DbWriter_Column		  ( w, data.LockEvents	 , header.LockEvents	);
+		DbWriter_PatchedColumn( w, data.CounterValues, header.CounterValues );
+		DbWriter_PatchedColumn( w, data.LogItems	 , header.LogItems		);
+
+		// tables
+		DbWriter_Table( w, data.Locations	 , header.Locations		);
+		DbWriter_Table( w, data.Locks		 , header.Locks			);
+		DbWriter_Table( w, data.Counters	 , header.Counters		);
+		DbWriter_Table( w, data.CounterGroups, header.CounterGroups );
+
+		// strings
+		DbWriter_Align( w );
+		header.Strings.Offset = w.Pos;
+		header.Strings.Count = (uint32_t)w.Strings.Count;
+		DbWriter_Write( w, w.Strings.Data, (size_t)w.Strings.Count );
+
+		// header
+		header.Magic			= DB_FILE_MAGIC;
+		header.Version			= DB_FILE_VERSION;
+		header.FileSize			= w.Pos;
+		header.Clock			= data.Clock;
+		header.MaxFrameDuration = data.MaxFrameDuration;
+		header.LastFrameNumber	= data.LastFrameNumber;
+		header.NumCpus			= data.NumCpus;
+		header.NumThreads		= data.Threads.Count;
+		if (NeFailed( File_Seek( file, FileSeek::Begin, 0 ) ))
+			w.Failed = true;
+		DbWriter_Write( w, &header, sizeof(header) );
+
+		File_Close( file );
+		HashTable_Clear( w.StringMap );
+		w.Strings.Clear();
+		return !w.Failed;
+	}
+
+	/// Replaces the contents of the database by a file written with DatabaseFile_Save.
+	/// The columns are used in place from the mapped file.
+	/// Fails while a parser appends to the database.
+	bool DatabaseFile_Open( Database_t db, cstr_t path )
+	{
+		if (db->Parser)
+			return false;
+
+		size_t size = 0;
+		Handle_t handle = nullptr;
+		uint8_t* view = (uint8_t*)File_Map( path, &size, &handle );
+		if (!view)
+			return false;
+
+		ParsedData_s& data = db->Data;
+		const DbFileHeader_s& header = *(const DbFileHeader_s*)view;
+		if (!DbFile_IsValid( header, data, view, size ))
+		{
+			File_Unmap( view, handle );
+			return false;
+		}
+
+		DatabaseFile_Close( db );
+		db->MapView = view;
+		db->MapHandle = handle;
+		data.MappedBegin = view;
+		data.MappedEnd = view + size;
+
+		// globals
+		data.Clock			  = header.Clock;
+		data.MaxFrameDuration = header.MaxFrameDuration;
+		data.LastFrameNumber  = header.LastFrameNumber;
+		data.NumCpus		  = header.NumCpus;
+		data.Threads.Count	  = header.NumThreads;
+		for ( int i = 0; i < header.NumThreads; ++i )
+		{
+			const DbFileThread_s& thread = header.Thread[i];
+			ParsedScopes_s& scopes = data.Scopes[i];
+			data.Threads.Id[i] = thread.Id;
+			data.Threads.Item[i].NumLevels = thread.NumLevels;
+			data.Threads.Item[i].Name = DbFile_String( header, view, thread.Name );
+			DbFile_Attach( thread.Time	  , view, scopes.Time	  );
+			DbFile_Attach( thread.Location, view, scopes.Location );
+			DbFile_Attach( thread.Flags	  , view, scopes.Flags	  );
+			DbFile_Attach( thread.FrameEnd, view, scopes.FrameEnd );
+		}
+
+		// columns
+		DbFile_Attach		( header.Frames, view, data.Frames );
+		DbFile_Attach		( header.LockEvents, view, data.LockEvents );
+		DbFile_AttachPatched( header, header.CounterValues, view, data.CounterValues );
+		DbFile_AttachPatched( header, header.LogItems, view, data.LogItems );
+
+		// tables
+		DbFile_Load( header, header.Locations	 , view, data.Locations		);
+		DbFile_Load( header, header.Locks		 , view, data.Locks			);
+		DbFile_Load( header, header.Counters	 , view, data.Counters		);
+		DbFile_Load( header, header.CounterGroups, view, data.CounterGroups );
+
+		ParsedData_BuildIndices( data );
+		return true;
+	}
+
+	/// Removes all data and releases the mapped file.
+	void DatabaseFile_Close( Database_t db )
+	{
+		ParsedData_Reset( db->Data );
+		File_Unmap( db->MapView, db->MapHandle );
+		db->MapView = nullptr;
+		db->MapHandle = nullptr;
+	}
+
+} }
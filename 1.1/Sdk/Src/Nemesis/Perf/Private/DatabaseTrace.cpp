@@ -0,0 +1,893 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#include "stdafx.h"
+#include "DatabaseTrace.h"
+#include "Database.h"
+#include "DatabaseFile.h"
+
+//======================================================================================
+#include <Nemesis/Core/File.h>
+#include <Nemesis/Core/Hash.h>
+#include <Nemesis/Core/HashTable.h>
+#include <Nemesis/Core/Json.h>
+#include <Nemesis/Core/JsonOut.h>
+#include <Nemesis/Core/Sort.h>
+
+//======================================================================================
+using namespace nemesis::system;
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	/// Events of a range of frames, formatted by one of the query workers.
+	struct TraceChunk_s
+	{
+		JsonOut_s	Json;
+		IndexRange	Frames;
+	};
+
+	/// Writes Chrome trace event JSON in batches of chunks.
+	/// Chunks are formatted in parallel and written in order, so memory is bounded by the batch.
+	struct TraceWriter_s
+	{
+		const ParsedData_s*	Data;
+		File_t				File;
+		Tick				FirstTick;
+		double				UsPerTick;
+		bool				HasEvents;
+		bool				Failed;
+		uint8_t				_pad_[6];
+		TraceChunk_s		Chunk[ NUM_TRACE_CHUNKS ];
+	};
+
+	static double TraceWriter_ToUs( const TraceWriter_s& w, Tick tick )
+	{
+		return (double)(tick - w.FirstTick) * w.UsPerTick;
+	}
+
+	static void TraceWriter_Write( TraceWriter_s& w, const StrBuf_s& text, bool delimit )
+	{
+		if (w.Failed || (text.Count <= 1))
+			return;
+		uint32_t num_written = 0;
+		if (delimit)
+			w.Failed |= NeFailed( File_Write( w.File, ",", 1, &num_written ) ) || (num_written != 1);
+		const uint32_t size = (uint32_t)(text.Count-1);
+		w.Failed |= NeFailed( File_Write( w.File, text.Data, size, &num_written ) ) || (num_written != size);
+	}
+
+	static void TraceWriter_Field( JsonOut_s& json, cstr_t name, cstr_t value )
+	{
+		JsonOut_Field( json, name );
+		JsonOut_Value( json, value );
+	}
+
+	static void TraceWriter_Field( JsonOut_s& json, cstr_t name, uint32_t value )
+	{
+		JsonOut_Field( json, name );
+		JsonOut_Value( json, value );
+	}
+
+	static void TraceWriter_Field( JsonOut_s& json, cstr_t name, double value )
+	{
+		JsonOut_Field( json, name );
+		JsonOut_Value( json, value );
+	}
+
+	static void TraceWriter_Thread( JsonOut_s& json, uint32_t thread, cstr_t name )
+	{
+		JsonOut_Object( json );
+		TraceWriter_Field( json, "name", "thread_name" );
+		TraceWriter_Field( json, "ph"  , "M" );
+		TraceWriter_Field( json, "pid" , 0u );
+		TraceWriter_Field( json, "tid" , thread );
+		JsonOut_Object( json, "args" );
+		TraceWriter_Field( json, "name", name ? name : "<unnamed>" );
+		JsonOut_End( json );
+		JsonOut_End( json );
+	}
+
+	static void TraceWriter_Frame( const TraceWriter_s& w, JsonOut_s& json, const viz::Frame& frame )
+	{
+		JsonOut_Object( json );
+		TraceWriter_Field( json, "name", "Frame" );
+		TraceWriter_Field( json, "ph"  , "i" );
+		TraceWriter_Field( json, "s"   , "g" );
+		TraceWriter_Field( json, "ts"  , TraceWriter_ToUs( w, frame.Time.Begin ) );
+		TraceWriter_Field( json, "pid" , 0u );
+		JsonOut_End( json );
+	}
+
+	static void TraceWriter_Zone( const TraceWriter_s& w, JsonOut_s& json, uint32_t thread, const ParsedZone_s& zone )
+	{
+		const ParsedData_s& data = *w.Data;
+		const cstr_t name = (zone.Location < (uint32_t)data.Locations.Count) ? data.Locations[ zone.Location ].Name : nullptr;
+		JsonOut_Object( json );
+		TraceWriter_Field( json, "name", name ? name : "<Unknown>" );
+		TraceWriter_Field( json, "ph"  , "X" );
+		TraceWriter_Field( json, "ts"  , TraceWriter_ToUs( w, zone.Time.Begin ) );
+		TraceWriter_Field( json, "dur" , (double)zone.Time.Duration() * w.UsPerTick );
+		TraceWriter_Field( json, "pid" , 0u );
+		TraceWriter_Field( json, "tid" , thread );
+		JsonOut_End( json );
+	}
+
+	static void TraceWriter_Counter( const TraceWriter_s& w, JsonOut_s& json, const viz::Counter& counter, Tick time, float value )
+	{
+		JsonOut_Object( json );
+		TraceWriter_Field( json, "name", counter.Name );
+		TraceWriter_Field( json, "ph"  , "C" );
+		TraceWriter_Field( json, "ts"  , TraceWriter_ToUs( w, time ) );
+		TraceWriter_Field( json, "pid" , 0u );
+		JsonOut_Object( json, "args" );
+		TraceWriter_Field( json, "value", (double)value );
+		JsonOut_End( json );
+		JsonOut_End( json );
+	}
+
+	/// Formats the frame markers, zones and counter samples of a chunk.
+	/// The writer is primed as if it continued the event array, so chunks concatenate with a comma.
+	static void TraceChunk_Run( void* context, int slot, int index )
+	{
+		const TraceWriter_s& w = *(const TraceWriter_s*)context;
+		const ParsedData_s& data = *w.Data;
+		TraceChunk_s& chunk = ((TraceWriter_s*)context)->Chunk[ index ];
+		JsonOut_s& json = chunk.Json;
+		JsonOut_Reset( json );
+		json.Scope	= Json::Array;
+		json.Item	= Json::Array;
+		json.Indent = 2;
+
+		for ( int i = chunk.Frames.First; i < chunk.Frames.End(); ++i )
+			TraceWriter_Frame( w, json, data.GetFrame( i ) );
+
+		const uint32_t frame_begin = data.Frames.First + (uint32_t)chunk.Frames.First;
+		const uint32_t frame_end   = data.Frames.First + (uint32_t)chunk.Frames.End();
+		for ( int i = 0; i < data.Threads.Count; ++i )
+		{
+			const ParsedZones_s& zones = data.Zones[i];
+			const uint32_t end = ParsedZones_FrameBegin( zones, frame_end );
+			for ( uint32_t j = ParsedZones_FrameBegin( zones, frame_begin ); j < end; ++j )
+			{
+				const ParsedZone_s& zone = zones.Item[j];
+				if (!zone.Open)
+					TraceWriter_Zone( w, json, (uint32_t)i, zone );
+			}
+		}
+
+		// samples are stamped with the end of their frame, which is where the next chunk begins
+		const Tick time_begin = chunk.Frames.First ? data.GetFrame( chunk.Frames.First ).Time.Begin : INT64_MIN;
+		const Tick time_end	  = (chunk.Frames.End() < data.NumFrames()) ? data.GetFrame( chunk.Frames.End() ).Time.Begin : INT64_MAX;
+		for ( int i = 0; i < data.Counters.Count; ++i )
+		{
+			const viz::Counter& counter = data.Counters[i];
+			if ((int)counter.Series >= data.CounterColumns.Count)
+				continue;
+			const CounterColumn_s& column = data.CounterColumns[ counter.Series ];
+			for ( uint32_t j = CounterColumn_LowerBound( column, time_begin ); (j < column.Time.End) && (column.Time[j] < time_end); ++j )
+				TraceWriter_Counter( w, json, counter, column.Time[j], column.Value[j] );
+		}
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	/// Raw JSON string, pointing into the mapped trace until the import is committed.
+	struct TraceText_s
+	{
+		cstr_t		Text;
+		uint32_t	Len;
+		uint32_t	_pad_;
+	};
+
+	struct TraceName_s
+	{
+		TraceText_s	Name;
+		TraceText_s	Category;
+	};
+
+	/// Zone read from a "B"/"E" pair or a complete "X" event.
+	struct TraceSpan_s
+	{
+		Tick		Begin;
+		Tick		End;
+		uint32_t	Location;
+		uint32_t	Order;
+	};
+
+	/// Zones of a single trace thread and the state of turning them into scope events.
+	/// Open holds the "B" spans waiting for their "E" and Stack the ends of the entered zones.
+	struct TraceThread_s
+	{
+		Array<TraceSpan_s>	Span;
+		Array<uint32_t>		Open;
+		Array<Tick>			Stack;
+		TraceText_s			Name;
+		uint32_t			Id;
+		uint32_t			Next;
+		uint32_t			NumLevels;
+		uint32_t			_pad_;
+	};
+
+	/// Fields of the event being read.
+	struct TraceEvent_s
+	{
+		TraceText_s	Name;
+		TraceText_s	Category;
+		TraceText_s	ArgName;
+		Tick		Time;
+		Tick		Duration;
+		uint64_t	Process;
+		uint64_t	Thread;
+		char		Phase;
+		char		Scope;
+		bool		HasTime;
+		uint8_t		_pad_[5];
+	};
+
+	/// Reads Chrome trace events straight from the SAX parser, no document is built.
+	/// Events are those of the "traceEvents" array or of the root array.
+	struct TraceReader_s
+	{
+		Allocator_t			Alloc;
+		HashTable_64_32_s	ThreadMap;
+		HashTable_64_32_s	LocationMap;
+		Array<TraceName_s>	Locations;
+		Array<Tick>			FrameTimes;
+		TraceEvent_s		Event;
+		Tick				FirstTick;
+		Tick				LastTick;
+		int					Depth;
+		int					EventDepth;
+		bool				InEvent;
+		bool				InArgs;
+		uint8_t				_pad_[2];
+		int					NumThreads;
+		uint32_t			NumSpans;
+		uint32_t			NumSkipped;
+		TraceThread_s		Thread[ MAX_NUM_THREADS ];
+	};
+
+	template < int N >
+	static bool Trace_Equals( cstr_t text, int len, const char (&literal)[N] )
+	{
+		return (len == N-1) && !Mem_Cmp( text, literal, N-1 );
+	}
+
+	static bool Trace_IsDigit( char c )
+	{
+		return (c >= '0') && (c <= '9');
+	}
+
+	/// Returns a hash table key which is never the empty key.
+	static uint64_t Trace_MakeKey( uint64_t hash )
+	{
+		return (hash == ~0ull) ? 0 : hash;
+	}
+
+	/// Converts microseconds to nanosecond ticks.
+	/// Plain decimals are converted without floating point, exponents take the slow path.
+	static Tick Trace_ParseTicks( cstr_t val, int len )
+	{
+		int i = 0;
+		const bool negative = (len > 0) && (val[0] == '-');
+		if (negative)
+			++i;
+
+		Tick ticks = 0;
+		for ( ; (i < len) && Trace_IsDigit( val[i] ); ++i )
+			ticks = 10*ticks + (val[i]-'0');
+		ticks *= 1000;
+
+		if ((i < len) && (val[i] == '.'))
+		{
+			Tick scale = 100;
+			for ( ++i; (i < len) && Trace_IsDigit( val[i] ); ++i )
+			{
+				ticks += scale * (val[i]-'0');
+				scale /= 10;
+			}
+		}
+
+		if ((i < len) && ((val[i] == 'e') || (val[i] == 'E')))
+		{
+			++i;
+			const bool negative_exp = (i < len) && (val[i] == '-');
+			if ((i < len) && ((val[i] == '-') || (val[i] == '+')))
+				++i;
+			int exp = 0;
+			for ( ; (i < len) && Trace_IsDigit( val[i] ); ++i )
+				exp = NeMin( 10*exp + (val[i]-'0'), 64 );
+			double value = (double)ticks;
+			for ( int j = 0; j < exp; ++j )
+				value = negative_exp ? (value * 0.1) : (value * 10.0);
+			ticks = (Tick)NeMin( value, 9.0e18 );
+		}
+		return negative ? -ticks : ticks;
+	}
+
+	/// Process and thread ids are numbers, some tools write them as strings.
+	static uint64_t Trace_ParseId( JsonType::Enum type, cstr_t val, int len )
+	{
+		if (type != JsonType::Int)
+			return Hash_Xx64( val, (size_t)len, 0 );
+		const bool negative = (len > 0) && (val[0] == '-');
+		int64_t id = 0;
+		for ( int i = negative ? 1 : 0; i < len; ++i )
+			id = 10*id + (val[i]-'0');
+		return (uint64_t)(negative ? -id : id);
+	}
+
+	static uint32_t Trace_ParseHex( cstr_t text, int len )
+	{
+		uint32_t value = 0;
+		for ( int i = 0; i < len; ++i )
+		{
+			const char c = text[i];
+			const uint32_t digit
+				= ((c >= '0') && (c <= '9')) ? (uint32_t)(c-'0')
+				: ((c >= 'a') && (c <= 'f')) ? (uint32_t)(c-'a'+10)
+				: ((c >= 'A') && (c <= 'F')) ? (uint32_t)(c-'A'+10)
+				: 0;
+			value = (value << 4) | digit;
+		}
+		return value;
+	}
+
+	/// Copies a raw JSON string to the string pool and decodes its escape sequences.
+	/// Each \uXXXX is encoded on its own, so surrogate pairs are not combined.
+	static cstr_t Trace_CopyText( Stack_s& pool, const TraceText_s& text, cstr_t fallback )
+	{
+		if (!text.Len)
+			return fallback;
+
+		char* copy = (char*)pool.Alloc( text.Len+1 );
+		char* out = copy;
+		const cstr_t end = text.Text + text.Len;
+		for ( cstr_t it = text.Text; it < end; ++it )
+		{
+			if ((it[0] != '\\') || (it+1 == end))
+			{
+				*out++ = it[0];
+				continue;
+			}
+
+			switch (*++it)
+			{
+			case 'b': *out++ = '\b'; break;
+			case 'f': *out++ = '\f'; break;
+			case 'n': *out++ = '\n'; break;
+			case 'r': *out++ = '\r'; break;
+			case 't': *out++ = '\t'; break;
+			case 'u':
+				{
+					const int num_digits = (int)NeMin<ptrdiff_t>( end-it-1, 4 );
+					const uint32_t code = Trace_ParseHex( it+1, num_digits );
+					it += num_digits;
+					if (code < 0x80)
+					{
+						*out++ = (char)code;
+					}
+					else if (code < 0x800)
+					{
+						*out++ = (char)(0xc0 | (code >> 6));
+						*out++ = (char)(0x80 | (code & 0x3f));
+					}
+					else
+					{
+						*out++ = (char)(0xe0 | (code >> 12));
+						*out++ = (char)(0x80 | ((code >> 6) & 0x3f));
+						*out++ = (char)(0x80 | (code & 0x3f));
+					}
+				}
+				break;
+			default:
+				*out++ = it[0];
+				break;
+			}
+		}
+		*out = 0;
+		return copy;
+	}
+
+	static int TraceReader_EnsureThread( TraceReader_s& r, const TraceEvent_s& ev )
+	{
+		const uint64_t key = Trace_MakeKey( (ev.Process * 0x9e3779b97f4a7c15ull) ^ ev.Thread );
+		uint32_t index = HashTable_Get( r.ThreadMap, key, ~0u );
+		if (index != ~0u)
+			return (int)index;
+		if (r.NumThreads >= MAX_NUM_THREADS)
+			return -1;
+
+		index = (uint32_t)r.NumThreads++;
+		TraceThread_s& thread = r.Thread[ index ];
+		thread.Span	.Init( r.Alloc );
+		thread.Open	.Init( r.Alloc );
+		thread.Stack.Init( r.Alloc );
+		thread.Id = (uint32_t)ev.Thread;
+		HashTable_Set( r.ThreadMap, key, index );
+		return (int)index;
+	}
+
+	/// Locations are interned by the raw name, the category of the first event becomes the file.
+	/// Names whose hashes collide are probed at the following keys.
+	static uint32_t TraceReader_EnsureLocation( TraceReader_s& r, const TraceEvent_s& ev )
+	{
+		uint64_t key = Trace_MakeKey( Hash_Xx64( ev.Name.Text, ev.Name.Len, 0 ) );
+		for ( ;; key = Trace_MakeKey( key+1 ) )
+		{
+			const uint32_t found = HashTable_Get( r.LocationMap, key, ~0u );
+			if (found == ~0u)
+				break;
+			const TraceText_s& name = r.Locations[ found ].Name;
+			if ((name.Len == ev.Name.Len) && (Mem_Cmp( name.Text, ev.Name.Text, name.Len ) == 0))
+				return found;
+		}
+
+		const uint32_t index = (uint32_t)r.Locations.Count;
+		const TraceName_s name = { ev.Name, ev.Category };
+		r.Locations.Append( name );
+		HashTable_Set( r.LocationMap, key, index );
+		return index;
+	}
+
+	static void TraceReader_AddSpan( TraceReader_s& r, TraceThread_s& thread, Tick begin, Tick end )
+	{
+		const TraceSpan_s span = { begin, end, TraceReader_EnsureLocation( r, r.Event ), (uint32_t)thread.Span.Count };
+		thread.Span.Append( span );
+		++r.NumSpans;
+		r.FirstTick = NeMin( r.FirstTick, begin );
+		r.LastTick	= NeMax( r.LastTick, end );
+	}
+
+	static void TraceReader_ReadField( TraceReader_s& r, JsonType::Enum type, cstr_t name, int name_len, cstr_t val, int val_len )
+	{
+		TraceEvent_s& ev = r.Event;
+		const TraceText_s text = { val, (uint32_t)val_len };
+		if (Trace_Equals( name, name_len, "ph" ))
+			ev.Phase = val_len ? val[0] : 0;
+		else if (Trace_Equals( name, name_len, "ts" ))
+		{
+			ev.Time = Trace_ParseTicks( val, val_len );
+			ev.HasTime = true;
+		}
+		else if (Trace_Equals( name, name_len, "dur" ))
+			ev.Duration = Trace_ParseTicks( val, val_len );
+		else if (Trace_Equals( name, name_len, "tid" ))
+			ev.Thread = Trace_ParseId( type, val, val_len );
+		else if (Trace_Equals( name, name_len, "pid" ))
+			ev.Process = Trace_ParseId( type, val, val_len );
+		else if (Trace_Equals( name, name_len, "name" ))
+			ev.Name = text;
+		else if (Trace_Equals( name, name_len, "cat" ))
+			ev.Category = text;
+		else if (Trace_Equals( name, name_len, "s" ))
+			ev.Scope = val_len ? val[0] : 0;
+	}
+
+	/// Handles a completely read event.
+	/// Complete events become spans right away, "B" spans are closed by the next "E" of their thread.
+	static void TraceReader_Dispatch( TraceReader_s& r )
+	{
+		const TraceEvent_s& ev = r.Event;
+		switch (ev.Phase)
+		{
+		case 'X':
+		case 'B':
+		case 'E':
+		case 'M':
+			break;
+		case 'i':
+		case 'I':
+			if (ev.HasTime && (ev.Scope == 'g') && Trace_Equals( ev.Name.Text, ev.Name.Len, "Frame" ))
+				r.FrameTimes.Append( ev.Time );
+			return;
+		default:
+			return;
+		}
+
+		const int thread_index = TraceReader_EnsureThread( r, ev );
+		if ((thread_index < 0) || (!ev.HasTime && (ev.Phase != 'M')))
+		{
+			++r.NumSkipped;
+			return;
+		}
+
+		TraceThread_s& thread = r.Thread[ thread_index ];
+		switch (ev.Phase)
+		{
+		case 'X':
+			TraceReader_AddSpan( r, thread, ev.Time, ev.Time + NeMax( ev.Duration, (Tick)0 ) );
+			break;
+
+		case 'B':
+			thread.Open.Append( (uint32_t)thread.Span.Count );
+			TraceReader_AddSpan( r, thread, ev.Time, ev.Time );
+			thread.Span[ thread.Span.Count-1 ].End = INT64_MAX;
+			break;
+
+		case 'E':
+			if (!thread.Open.Count)
+			{
+				++r.NumSkipped;
+				break;
+			}
+			{
+				TraceSpan_s& span = thread.Span[ thread.Open[ thread.Open.Count-1 ] ];
+				span.End = NeMax( ev.Time, span.Begin );
+				r.LastTick = NeMax( r.LastTick, span.End );
+				thread.Open.RemoveAt( thread.Open.Count-1 );
+			}
+			break;
+
+		case 'M':
+			if (Trace_Equals( ev.Name.Text, ev.Name.Len, "thread_name" ))
+				thread.Name = ev.ArgName;
+			break;
+		}
+	}
+
+	static void NE_CALLBK TraceReader_HandleEvent( void* context, uint32_t pos, JsonEvent::Enum ev, JsonType::Enum type, cstr_t name, int name_len, cstr_t val, int val_len, int line )
+	{
+		NeUnused(pos);
+		NeUnused(line);
+		TraceReader_s& r = *(TraceReader_s*)context;
+		switch (ev)
+		{
+		case JsonEvent::Begin:
+			if (r.InEvent)
+			{
+				if (r.Depth == r.EventDepth+1)
+					r.InArgs = Trace_Equals( name, name_len, "args" );
+			}
+			else if (r.EventDepth && (r.Depth == r.EventDepth) && (type == JsonType::Object))
+			{
+				NeZero( r.Event );
+				r.InEvent = true;
+			}
+			else if (!r.EventDepth && (type == JsonType::Array) && ((r.Depth == 0) || ((r.Depth == 1) && Trace_Equals( name, name_len, "traceEvents" ))))
+			{
+				r.EventDepth = r.Depth+1;
+			}
+			++r.Depth;
+			break;
+
+		case JsonEvent::Value:
+			if (!r.InEvent)
+				break;
+			if (r.Depth == r.EventDepth+1)
+				TraceReader_ReadField( r, type, name, name_len, val, val_len );
+			else if (r.InArgs && (r.Depth == r.EventDepth+2) && Trace_Equals( name, name_len, "name" ))
+				r.Event.ArgName = { val, (uint32_t)val_len };
+			break;
+
+		case JsonEvent::End:
+			--r.Depth;
+			if (r.InEvent)
+			{
+				if (r.Depth == r.EventDepth)
+				{
+					r.InEvent = false;
+					r.InArgs  = false;
+					TraceReader_Dispatch( r );
+				}
+				else if (r.Depth == r.EventDepth+1)
+				{
+					r.InArgs = false;
+				}
+			}
+			else if (r.Depth < r.EventDepth)
+			{
+				r.EventDepth = 0;
+			}
+			break;
+		}
+	}
+
+	static int NE_CALLBK TraceSpan_Compare( void* context, const void* lhs, const void* rhs )
+	{
+		NeUnused(context);
+		const TraceSpan_s& a = *(const TraceSpan_s*)lhs;
+		const TraceSpan_s& b = *(const TraceSpan_s*)rhs;
+		if (a.Begin != b.Begin)
+			return (a.Begin < b.Begin) ? -1 : 1;
+		if (a.End != b.End)
+			return (a.End > b.End) ? -1 : 1;
+		return (a.Order < b.Order) ? -1 : (a.Order > b.Order) ? 1 : 0;
+	}
+
+	static int NE_CALLBK TraceTick_Compare( void* context, const void* lhs, const void* rhs )
+	{
+		NeUnused(context);
+		const Tick a = *(const Tick*)lhs;
+		const Tick b = *(const Tick*)rhs;
+		return (a < b) ? -1 : (a > b) ? 1 : 0;
+	}
+
+	/// Orders a thread's spans by begin and parents before their children.
+	/// Traces are mostly written in order already, which is checked first.
+	static void TraceThread_Sort( void* context, int slot, int index )
+	{
+		NeUnused(slot);
+		TraceThread_s& thread = ((TraceReader_s*)context)->Thread[ index ];
+		bool sorted = true;
+		for ( int i = 1; sorted && (i < thread.Span.Count); ++i )
+			sorted = TraceSpan_Compare( nullptr, &thread.Span[i-1], &thread.Span[i] ) < 0;
+		if (sorted)
+			return;
+		const SortClient_s sorter = { TraceSpan_Compare, nullptr };
+		Sort_Quick( thread.Span.Data, thread.Span.Count, sizeof(TraceSpan_s), sorter );
+	}
+
+	/// Appends a thread's scope events up to the end of a frame and returns their number.
+	/// Zones are entered in order and left at their end, which is clamped to the end of their parent.
+	static uint32_t TraceThread_Emit( TraceThread_s& thread, ParsedScopes_s& scopes, uint8_t thread_index, Tick frame_end, uint32_t& num_spans )
+	{
+		uint32_t num_events = 0;
+		for ( ;; )
+		{
+			const TraceSpan_s* next = (thread.Next < (uint32_t)thread.Span.Count) ? &thread.Span[ thread.Next ] : nullptr;
+			const Tick top = thread.Stack.Count ? thread.Stack[ thread.Stack.Count-1 ] : INT64_MAX;
+			const bool can_enter = next && (next->Begin < frame_end);
+			const bool can_leave = thread.Stack.Count && (top <= frame_end);
+
+			if (can_leave && (!can_enter || (top <= next->Begin)))
+			{
+				const viz::ScopeEvent ev = { top, 0, thread_index, 0, 0, 0 };
+				ParsedScopes_Append( scopes, ev );
+				thread.Stack.RemoveAt( thread.Stack.Count-1 );
+				--num_spans;
+			}
+			else if (can_enter)
+			{
+				const viz::ScopeEvent ev = { next->Begin, next->Location, thread_index, 0, (uint8_t)ScopeType::Regular, 1 };
+				ParsedScopes_Append( scopes, ev );
+				thread.Stack.Append( NeMin( next->End, top ) );
+				thread.NumLevels = NeMax( thread.NumLevels, (uint32_t)thread.Stack.Count );
+				++thread.Next;
+			}
+			else
+			{
+				break;
+			}
+			++num_events;
+		}
+		return num_events;
+	}
+
+	/// Returns the end of the frame beginning at the given tick.
+	/// Frame markers of the trace are used if there are any, fixed length frames otherwise.
+	static Tick TraceReader_GetFrameEnd( const TraceReader_s& r, int& marker, Tick begin )
+	{
+		while ((marker < r.FrameTimes.Count) && (r.FrameTimes[ marker ] <= begin))
+			++marker;
+		if (marker < r.FrameTimes.Count)
+			return r.FrameTimes[ marker ];
+		if (r.FrameTimes.Count)
+			return r.LastTick+1;
+		return begin + TRACE_FRAME_TICKS;
+	}
+
+	/// Replaces the database contents by the spans read.
+	/// Frames are added in batches, making room the same way the parser does while recording.
+	static void TraceReader_Commit( TraceReader_s& r, Database_t db )
+	{
+		ParsedData_s& data = db->Data;
+		DatabaseFile_Close( db );
+		Database_ResetStrings( db );
+
+		// spans left open end with the trace
+		for ( int i = 0; i < r.NumThreads; ++i )
+		{
+			TraceThread_s& thread = r.Thread[i];
+			for ( int j = 0; j < thread.Open.Count; ++j )
+				thread.Span[ thread.Open[j] ].End = r.LastTick;
+		}
+
+		if (r.NumThreads > 1)
+			QueryPool_Run( db->QueryPool, r.NumThreads, TraceThread_Sort, &r );
+		else if (r.NumThreads)
+			TraceThread_Sort( &r, 0, 0 );
+
+		const SortClient_s sorter = { TraceTick_Compare, nullptr };
+		Sort_Quick( r.FrameTimes.Data, r.FrameTimes.Count, sizeof(Tick), sorter );
+
+		// globals
+		data.Clock.Initialize( TRACE_TICKS_PER_SECOND );
+		data.NumCpus = 1;
+		data.Threads.Count = (uint8_t)r.NumThreads;
+		for ( int i = 0; i < r.NumThreads; ++i )
+		{
+			data.Threads.Id[i] = r.Thread[i].Id;
+			data.Threads.Item[i].Name = Trace_CopyText( db->StringPool, r.Thread[i].Name, nullptr );
+		}
+		for ( int i = 0; i < r.Locations.Count; ++i )
+		{
+			const cstr_t name = Trace_CopyText( db->StringPool, r.Locations[i].Name, "<Unknown>" );
+			const cstr_t file = Trace_CopyText( db->StringPool, r.Locations[i].Category, "<Unknown>" );
+			data.Locations.Append( NamedLocation( name, name, file, 0 ) );
+		}
+
+		// frames
+		const Limit_s limit = { db->Setup.MaxNumBytes, db->Setup.MaxNumFrames, db->Setup.NumHotFrames };
+		uint32_t num_spans = r.NumSpans;
+		size_t batch_size = data.TotalSize();
+		uint32_t num_frames = 0;
+		int marker = 0;
+		for ( Tick begin = r.FirstTick; num_spans; )
+		{
+			const Tick end = TraceReader_GetFrameEnd( r, marker, begin );
+			uint32_t num_events = 0;
+			for ( int i = 0; i < r.NumThreads; ++i )
+			{
+				num_events += TraceThread_Emit( r.Thread[i], data.Scopes[i], (uint8_t)i, end, num_spans );
+				data.Threads.Item[i].NumLevels = (uint8_t)NeMin( r.Thread[i].NumLevels, 255u );
+			}
+
+			viz::Frame& frame = ParsedData_AppendFrame( data );
+			NeZero( frame );
+			frame.Time.Begin = begin;
+			frame.Time.End = end;
+			frame.NumScopeEvents = num_events;
+			data.MaxFrameDuration = NeMax( data.MaxFrameDuration, end - begin );
+			++data.LastFrameNumber;
+			begin = end;
+
+			if ((++num_frames % TRACE_IMPORT_FRAMES) == 0)
+			{
+				ParsedData_BuildIndices( data );
+				const size_t size = data.TotalSize();
+				ParsedData_MakeRoom( data, limit, TRACE_IMPORT_FRAMES, size - NeMin( batch_size, size ) );
+				batch_size = data.TotalSize();
+			}
+		}
+
+		ParsedData_BuildIndices( data );
+	}
+
+	static void TraceReader_Shutdown( TraceReader_s& r )
+	{
+		for ( int i = 0; i < r.NumThreads; ++i )
+		{
+			r.Thread[i].Span .Clear();
+			r.Thread[i].Open .Clear();
+			r.Thread[i].Stack.Clear();
+		}
+		r.Locations .Clear();
+		r.FrameTimes.Clear();
+		HashTable_Clear( r.ThreadMap );
+		HashTable_Clear( r.LocationMap );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	/// Writes the retained frames as Chrome trace event JSON, which Perfetto opens as well.
+	/// Threads become tids of a single process, zones complete events, frames global instant events
+	/// and counter samples counter events.
+	bool DatabaseTrace_Export( Database_t db, cstr_t path )
+	{
+		const ParsedData_s& data = db->Data;
+		File_t file = nullptr;
+		if (NeFailed( File_Create( path, FileCreate::CreateAlways, FileAccess::Write, &file ) ))
+			return false;
+
+		TraceWriter_s& w = *Mem_Calloc<TraceWriter_s>( db->Alloc );
+		w.Data		= &data;
+		w.File		= file;
+		w.FirstTick = data.NumFrames() ? data.GetFrame( 0 ).Time.Begin : 0;
+		w.UsPerTick = data.Clock.TicksPerSecond ? 1000000.0 / (double)data.Clock.TicksPerSecond : 0.0;
+		for ( int i = 0; i < NUM_TRACE_CHUNKS; ++i )
+		{
+			JsonOut_Initialize( w.Chunk[i].Json, db->Alloc, 256*1024, 16, 16 );
+			w.Chunk[i].Json.Tab = "";
+		}
+
+		// header and thread names
+		JsonOut_s json;
+		JsonOut_Initialize( json, db->Alloc, 64*1024, 16, 16 );
+		json.Tab = "";
+		JsonOut_Object( json );
+		TraceWriter_Field( json, "displayTimeUnit", "ms" );
+		JsonOut_Array( json, "traceEvents" );
+		for ( int i = 0; i < data.Threads.Count; ++i )
+			TraceWriter_Thread( json, (uint32_t)i, data.Threads.Item[i].Name );
+		TraceWriter_Write( w, json.Text, false );
+		w.HasEvents = data.Threads.Count > 0;
+		json.Text.Reset();
+
+		// batches of chunks
+		const int num_frames = data.NumFrames();
+		for ( int first = 0; (first < num_frames) && !w.Failed; )
+		{
+			int num_chunks = 0;
+			for ( ; (num_chunks < NUM_TRACE_CHUNKS) && (first < num_frames); ++num_chunks )
+			{
+				const IndexRange frames = { first, NeMin( (int)TRACE_CHUNK_FRAMES, num_frames - first ) };
+				w.Chunk[ num_chunks ].Frames = frames;
+				first += frames.Count;
+			}
+
+			if (num_chunks > 1)
+				QueryPool_Run( db->QueryPool, num_chunks, TraceChunk_Run, &w );
+			else
+				TraceChunk_Run( &w, 0, 0 );
+
+			for ( int i = 0; i < num_chunks; ++i )
+			{
+				const StrBuf_s& text = w.Chunk[i].Json.Text;
+				TraceWriter_Write( w, text, w.HasEvents );
+				w.HasEvents |= text.Count > 1;
+			}
+		}
+
+		// footer
+		json.Item = w.HasEvents ? Json::Object : Json::Array;
+		JsonOut_End( json );
+		JsonOut_End( json );
+		StrBuf_Print( json.Text, "\n" );
+		TraceWriter_Write( w, json.Text, false );
+
+		const bool ok = !w.Failed;
+		JsonOut_Shutdown( json );
+		for ( int i = 0; i < NUM_TRACE_CHUNKS; ++i )
+			JsonOut_Shutdown( w.Chunk[i].Json );
+		Mem_Free( db->Alloc, &w );
+		File_Close( file );
+		return ok;
+	}
+
+	/// Replaces the database contents by the zones of a Chrome trace event JSON file.
+	/// The mapped file is read by the SAX parser, "B"/"E" pairs and "X" events become zones of their
+	/// pid/tid thread and global "Frame" instant events frame boundaries. Without those, frames are cut
+	/// every TRACE_FRAME_TICKS. The database is left untouched if the file can't be read.
+	/// Fails while a parser appends to the database.
+	bool DatabaseTrace_Import( Database_t db, cstr_t path )
+	{
+		if (db->Parser)
+			return false;
+
+		size_t size = 0;
+		Handle_t handle = nullptr;
+		cstr_t view = (cstr_t)File_Map( path, &size, &handle );
+		if (!view)
+			return false;
+
+		TraceReader_s& r = *Mem_Calloc<TraceReader_s>( db->Alloc );
+		r.Alloc		= db->Alloc;
+		r.FirstTick = INT64_MAX;
+		r.LastTick	= INT64_MIN;
+		HashTable_Init( r.ThreadMap, db->Alloc );
+		HashTable_Init( r.LocationMap, db->Alloc );
+		r.Locations .Init( db->Alloc );
+		r.FrameTimes.Init( db->Alloc );
+
+		// the closing bracket of the event array is optional, traces of crashed processes end early and their last event may be cut off
+		const JsonClient_s client = { TraceReader_HandleEvent, &r };
+		const Result_t hr = Json_Parse( view, size, client, nullptr );
+		const bool truncated = (hr == NE_ERR_JSON_END_OF_FILE) && r.EventDepth;
+		const bool ok = NeSucceeded(hr) || truncated;
+		if (ok)
+		{
+			if (!r.NumSpans)
+				r.FirstTick = r.LastTick = 0;
+			TraceReader_Commit( r, db );
+		}
+
+		TraceReader_Shutdown( r );
+		Mem_Free( db->Alloc, &r );
+		File_Unmap( (ptr_t)view, handle );
+		return ok;
+	}
+
+} }
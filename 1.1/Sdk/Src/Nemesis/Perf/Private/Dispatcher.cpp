@@ -123,8 +123,7 @@ namespace nemesis { namespace profiling
 { 
 	static void Backlog_Grow( Backlog_s* log )
 	{
-		Allocator_t alloc = log->Buffer.Alloc;
-		Buffer_t item = Mem_Calloc<Buffer_s>( alloc );
+		Buffer_t item = Mem_Calloc<Buffer_s>( log->Alloc );
 		item->Type = BufferType::Meta;
 		Packet_Initialize( item );
 		log->Buffer.Append( item );
@@ -165,6 +164,24 @@ namespace nemesis { namespace profiling
 		Backlog_Write( log, &chunk.header, chunk.header.size );
 	}
 
+	static void Backlog_WriteName( Backlog_s* log, uint64_t id, uint16_t len, cptr_t text )
+	{
+		const chunk::NameList header = { { (uint32_t)chunk::Type::NameList, (uint32_t)(sizeof(header) + sizeof(id) + sizeof(len) + len) }, 1 };
+		if (!Backlog_Reserve( log, header.header.size ))
+			return;
+		Backlog_Write( log, &header, sizeof(header) );
+		Backlog_Write( log, &id		, sizeof(id)	 );
+		Backlog_Write( log, &len	, sizeof(len)	 );
+		Backlog_Write( log, text	, len			 );
+	}
+
+	static void Backlog_WriteChunk( Backlog_s* log, const Chunk& chunk )
+	{
+		if (!Backlog_Reserve( log, chunk.size ))
+			return;
+		Backlog_Write( log, &chunk, chunk.size );
+	}
+
 	static void Backlog_UnitTest( Backlog_s* log )
 	{
 	#if UNIT_TEST_BACKLOG
@@ -222,35 +239,366 @@ namespace nemesis { namespace profiling
 //======================================================================================
 namespace nemesis { namespace profiling
 { 
-	void Backlog_Initialize( Backlog_s* log, Allocator_t alloc )
+	static void Backlog_AddName( Backlog_s* log, uint64_t id, uint16_t len, const char* text )
+	{
+		if (id & DYNAMIC_NAME_FLAG)
+		{
+			// the length includes the terminator
+			if (!len)
+				return;
+
+			// a name sent again cancels its pending release
+			const uint32_t found = HashTable_Get( log->DynamicMap, id, UINT32_MAX );
+			if ((found != UINT32_MAX) && (log->Dynamic[ found ].Id == id))
+			{
+				log->Dynamic[ found ].Release = 0;
+				return;
+			}
+
+			uint32_t slot;
+			if (log->DynamicFree.Count)
+			{
+				slot = log->DynamicFree[ log->DynamicFree.Count-1 ];
+				log->DynamicFree.RemoveAt( log->DynamicFree.Count-1 );
+			}
+			else
+			{
+				slot = log->Dynamic.Count;
+				log->Dynamic.Append();
+			}
+
+			BacklogDynamicName_s& item = log->Dynamic[ slot ];
+			const uint16_t size = NeMin( len, (uint16_t)MAX_DYNAMIC_NAME_SIZE );
+			item.Id		 = id;
+			item.Release = 0;
+			item.Len	 = size;
+			Mem_Cpy( item.Text, text, size );
+			item.Text[ size-1 ] = 0;
+			HashTable_Set( log->DynamicMap, id, slot );
+
+			// drop keys of released names once they outnumber the live ones
+			if (log->DynamicMap.Count > 2 * NeMax( log->Dynamic.Count, (int)MAX_NUM_DYNAMIC_NAMES ))
+			{
+				HashTable_Reset( log->DynamicMap );
+				for ( int i = 0; i < log->Dynamic.Count; ++i )
+				{
+					if (log->Dynamic[i].Id)
+						HashTable_Set( log->DynamicMap, log->Dynamic[i].Id, (uint32_t)i );
+				}
+			}
+		}
+		else
+		{
+			if (HashTable_Has( log->NameMap, id ))
+				return;
+			const BacklogName_s item = { id, (uint32_t)log->Text.Count, len };
+			log->Text.Append( (const uint8_t*)text, len );
+			log->Names.Append( item );
+			HashTable_Set( log->NameMap, id, (uint32_t)(log->Names.Count-1) );
+		}
+		++log->Version;
+	}
+
+	/// Defers the release of a dynamic name.
+	/// Data buffers of other threads may still refer to it, all of them are sent by the second frame end.
+	static void Backlog_ReleaseName( Backlog_s* log, uint64_t id )
+	{
+		const uint32_t found = HashTable_Get( log->DynamicMap, id, UINT32_MAX );
+		if ((found == UINT32_MAX) || (log->Dynamic[ found ].Id != id))
+			return;
+		const BacklogRelease_s release = { id, log->NumFrames + 2 };
+		log->Dynamic[ found ].Release = release.Frame;
+		log->Released.Append( release );
+	}
+
+	/// Frees the released names whose frame has been sent.
+	static void Backlog_RetireNames( Backlog_s* log )
+	{
+		int num_retired = 0;
+		for ( ; num_retired < log->Released.Count; ++num_retired )
+		{
+			const BacklogRelease_s& release = log->Released[ num_retired ];
+			if ((int32_t)(log->NumFrames - release.Frame) < 0)
+				break;
+
+			// skip names sent again or released once more since
+			const uint32_t found = HashTable_Get( log->DynamicMap, release.Id, UINT32_MAX );
+			if ((found == UINT32_MAX) || (log->Dynamic[ found ].Id != release.Id) || (log->Dynamic[ found ].Release != release.Frame))
+				continue;
+			log->Dynamic[ found ].Id = 0;
+			log->DynamicFree.Append( found );
+			++log->Version;
+		}
+		log->Released.RemoveAt( 0, num_retired );
+	}
+
+	/// Counts the frame ends of a data buffer while releases are pending.
+	static void Backlog_CountFrames( Backlog_s* log, const uint8_t* data, uint32_t size )
+	{
+		Chunk chunk;
+		const uint8_t* pos = data;
+		const uint8_t* end = data + size;
+		for ( ; pos + sizeof(chunk) <= end; pos += chunk.size )
+		{
+			Mem_Cpy( &chunk, pos, sizeof(chunk) );
+			if ((chunk.size < sizeof(chunk)) || (pos + chunk.size > end))
+				break;
+			if (chunk.id == chunk::Type::EndFrame)
+				++log->NumFrames;
+		}
+		Backlog_RetireNames( log );
+	}
+
+	static void Backlog_AddSite( Backlog_s* log, const chunk::LocationItem& item )
 	{
-		log->Buffer.Init( alloc );
-		log->Buffer.Reserve( 64 );
+		if (HashTable_Has( log->SiteMap, (uint64_t)item.id ))
+			return;
+		HashTable_Set( log->SiteMap, (uint64_t)item.id, (uint32_t)log->Sites.Count );
+		log->Sites.Append( item );
+		++log->Version;
+	}
+
+	static void Backlog_AddThread( Backlog_s* log, const chunk::ThreadInfo& info )
+	{
+		for ( int i = 0; i < log->Threads.Count; ++i )
+		{
+			if (log->Threads[i].threadId != info.threadId)
+				continue;
+			log->Threads[i] = info;
+			++log->Version;
+			return;
+		}
+		log->Threads.Append( info );
+		++log->Version;
+	}
+
+	static void Backlog_AddMutex( Backlog_s* log, const chunk::MutexInfo& info )
+	{
+		const uint32_t found = HashTable_Get( log->MutexMap, info.handle, UINT32_MAX );
+		if (found != UINT32_MAX)
+		{
+			log->Mutexes[ found ] = info;
+		}
+		else
+		{
+			HashTable_Set( log->MutexMap, info.handle, (uint32_t)log->Mutexes.Count );
+			log->Mutexes.Append( info );
+		}
+		++log->Version;
+	}
+
+	/// Merges the chunks of a meta buffer into the snapshot tables.
+	static void Backlog_Parse( Backlog_s* log, const uint8_t* data, uint32_t size )
+	{
+		Chunk chunk;
+		const uint8_t* pos = data;
+		const uint8_t* end = data + size;
+		for ( ; pos + sizeof(chunk) <= end; pos += chunk.size )
+		{
+			Mem_Cpy( &chunk, pos, sizeof(chunk) );
+			if ((chunk.size < sizeof(chunk)) || (pos + chunk.size > end))
+				return;
+
+			switch (chunk.id)
+			{
+			case chunk::Type::NameList:
+				{
+					chunk::NameList header;
+					Mem_Cpy( &header, pos, sizeof(header) );
+					const uint8_t* item = pos + sizeof(header);
+					for ( uint32_t i = 0; i < header.numItems; ++i )
+					{
+						uint64_t id;
+						uint16_t len;
+						Mem_Cpy( &id , item, sizeof(id)  ); item += sizeof(id);
+						Mem_Cpy( &len, item, sizeof(len) ); item += sizeof(len);
+						Backlog_AddName( log, id, len, (const char*)item );
+						item += len;
+					}
+				}
+				break;
+
+			case chunk::Type::NameRelease:
+				{
+					chunk::NameRelease release;
+					Mem_Cpy( &release, pos, sizeof(release) );
+					Backlog_ReleaseName( log, release.name );
+				}
+				break;
+
+			case chunk::Type::LocationList:
+				{
+					chunk::LocationList header;
+					chunk::LocationItem item;
+					Mem_Cpy( &header, pos, sizeof(header) );
+					for ( uint32_t i = 0; i < header.numItems; ++i )
+					{
+						Mem_Cpy( &item, pos + sizeof(header) + i * sizeof(item), sizeof(item) );
+						Backlog_AddSite( log, item );
+					}
+				}
+				break;
+
+			case chunk::Type::ThreadInfo:
+				{
+					chunk::ThreadInfo info;
+					Mem_Cpy( &info, pos, sizeof(info) );
+					Backlog_AddThread( log, info );
+				}
+				break;
+
+			case chunk::Type::MutexInfo:
+				{
+					chunk::MutexInfo info;
+					Mem_Cpy( &info, pos, sizeof(info) );
+					Backlog_AddMutex( log, info );
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+	}
+
+	static void Backlog_Release( Backlog_s* log )
+	{
+		const int count = log->Buffer.Count;
+		for ( int i = 0; i < count; ++i )
+			Mem_Free( log->Alloc, log->Buffer[i] );
+		log->Buffer.Reset();
+	}
+
+	/// Rebuilds the backlog packets if the snapshot changed since they were last written.
+	static void Backlog_Serialize( Backlog_s* log )
+	{
+		if (log->Buffer.Count && (log->Serialized == log->Version))
+			return;
+
+		Backlog_Release( log );
 		Backlog_Grow( log );
 		Backlog_WriteConnectHeader( log );
+
+		// names first, everything else refers to them
+		for ( int i = 0; i < log->Names.Count; ++i )
+		{
+			const BacklogName_s& name = log->Names[i];
+			Backlog_WriteName( log, name.Id, name.Len, log->Text.Data + name.Offset );
+		}
+
+		for ( int i = 0; i < log->Dynamic.Count; ++i )
+		{
+			const BacklogDynamicName_s& name = log->Dynamic[i];
+			if (name.Id)
+				Backlog_WriteName( log, name.Id, name.Len, name.Text );
+		}
+
+		chunk::LocationList header = { { chunk::Type::LocationList, sizeof(header) + sizeof(chunk::LocationItem) }, 1, 0 };
+		for ( int i = 0; i < log->Sites.Count; ++i )
+		{
+			if (!Backlog_Reserve( log, header.header.size ))
+				break;
+			Backlog_Write( log, &header		 , sizeof(header)		 );
+			Backlog_Write( log, &log->Sites[i], sizeof(log->Sites[i]) );
+		}
+
+		for ( int i = 0; i < log->Threads.Count; ++i )
+			Backlog_WriteChunk( log, log->Threads[i].header );
+
+		for ( int i = 0; i < log->Mutexes.Count; ++i )
+			Backlog_WriteChunk( log, log->Mutexes[i].header );
+
+		log->Serialized = log->Version;
+		Backlog_UnitTest( log );
+	}
+
+	/// Copies the backlog packets, so they can be sent without holding the lock.
+	static void Backlog_Copy( Backlog_s* log, Array<Buffer_s>& copy )
+	{
+		NeLock(log->Mutex);
+		Backlog_Serialize( log );
+		copy.Reset();
+		for ( int i = 0; i < log->Buffer.Count; ++i )
+			copy.Append( *log->Buffer[i] );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{ 
+	void Backlog_Initialize( Backlog_s* log, Allocator_t alloc )
+	{
+		CriticalSection_Create( log->Mutex );
+		log->Alloc = alloc;
+		HashTable_Init( log->NameMap	, alloc );
+		HashTable_Init( log->DynamicMap	, alloc );
+		HashTable_Init( log->SiteMap	, alloc );
+		HashTable_Init( log->MutexMap	, alloc );
+		log->Names		.Init( alloc );
+		log->Text		.Init( alloc );
+		log->DynamicFree.Init( alloc );
+		log->Dynamic	.Init( alloc );
+		log->Released	.Init( alloc );
+		log->Sites		.Init( alloc );
+		log->Threads	.Init( alloc );
+		log->Mutexes	.Init( alloc );
+		log->Buffer		.Init( alloc );
 	}
 
 	Result_t Backlog_Append( Backlog_s* log, Buffer_t buffer )
 	{
-		if (buffer->Type != BufferType::Meta)
+		if ((buffer->Type != BufferType::Meta) && !log->Released.Count)
 			return NE_OK;
 		NeAssertOut(Packet_IsValid( buffer ), "Buffer has no packet header!");
 		const uint32_t payload_offset = (uint32_t)(sizeof(Packet));
 		const uint32_t payload_size   = buffer->Count - payload_offset;
-		if (!Backlog_Reserve( log, payload_size ))
-			return NE_ERR_OUT_OF_MEMORY;
-		Backlog_Write( log, buffer->Data + payload_offset, payload_size );
-		Backlog_UnitTest( log );
+		NeLock(log->Mutex);
+		if (buffer->Type == BufferType::Meta)
+			Backlog_Parse( log, buffer->Data + payload_offset, payload_size );
+		else
+			Backlog_CountFrames( log, buffer->Data + payload_offset, payload_size );
 		return NE_OK;
 	}
 
+
+	void Backlog_GetSize( Backlog_s* log, size_t& size, size_t& capacity )
+	{
+		NeLock(log->Mutex);
+		const int num_dynamic = log->Dynamic.Count - log->DynamicFree.Count;
+		size = log->Names  .Count * sizeof(log->Names  [0]) + log->Text.Count
+			 + num_dynamic		  * sizeof(log->Dynamic[0])
+			 + log->Sites  .Count * sizeof(log->Sites  [0])
+			 + log->Threads.Count * sizeof(log->Threads[0])
+			 + log->Mutexes.Count * sizeof(log->Mutexes[0]);
+		capacity = Array_GetCapacitySize( log->Names	   )
+				 + Array_GetCapacitySize( log->Text		   )
+				 + Array_GetCapacitySize( log->DynamicFree )
+				 + Array_GetCapacitySize( log->Dynamic	   )
+				 + Array_GetCapacitySize( log->Released	   )
+				 + Array_GetCapacitySize( log->Sites	   )
+				 + Array_GetCapacitySize( log->Threads	   )
+				 + Array_GetCapacitySize( log->Mutexes	   )
+				 + log->Buffer.Count * sizeof(Buffer_s);
+	}
+
 	void Backlog_Shutdown( Backlog_s* log )
 	{
-		Allocator_t alloc = log->Buffer.Alloc;
-		const int count = log->Buffer.Count;
-		for ( int i = 0; i < count; ++i )
-			Mem_Free( alloc, log->Buffer[i] );
+		Backlog_Release( log );
 		log->Buffer.Clear();
+		HashTable_Clear( log->NameMap );
+		HashTable_Clear( log->DynamicMap );
+		HashTable_Clear( log->SiteMap );
+		HashTable_Clear( log->MutexMap );
+		log->Names.Clear();
+		log->Text.Clear();
+		log->DynamicFree.Clear();
+		log->Dynamic.Clear();
+		log->Released.Clear();
+		log->Sites.Clear();
+		log->Threads.Clear();
+		log->Mutexes.Clear();
+		CriticalSection_Destroy( log->Mutex );
 	}
 
 } }
@@ -268,10 +616,11 @@ namespace nemesis { namespace profiling
 		if (peer.Init)
 			return NE_OK;
 		Result_t hr;
-		const int count = log->Buffer.Count;
-		for ( int i = 0; i < count; ++i )
+		Array<Buffer_s> backlog( log->Alloc );
+		Backlog_Copy( log, backlog );
+		for ( int i = 0; i < backlog.Count; ++i )
 		{
-			hr = PeerList_SendBufferTo( log->Buffer[i], peer );
+			hr = PeerList_SendBufferTo( &backlog[i], peer );
 			if (NeFailed(hr))
 				return hr;
 		}
@@ -302,10 +651,11 @@ namespace nemesis { namespace profiling
 		if (peer.Init)
 			return NE_OK;
 		Result_t hr;
-		const int count = log->Buffer.Count;
-		for ( int i = 0; i < count; ++i )
+		Array<Buffer_s> backlog( log->Alloc );
+		Backlog_Copy( log, backlog );
+		for ( int i = 0; i < backlog.Count; ++i )
 		{
-			hr = PeerList_SendBufferTo( log->Buffer[i], peer );
+			hr = PeerList_SendBufferTo( &backlog[i], peer );
 			if (NeFailed(hr))
 				return hr;
 		}
@@ -327,6 +677,46 @@ namespace nemesis { namespace profiling
 		return NE_OK;
 	}
 
+	static Result_t PeerList_SendBufferTo( Buffer_t buffer, const SharedPeer_s& peer )
+	{
+		return SharedRing_Write( peer.Ring, buffer->Data, buffer->Count );
+	}
+
+	static Result_t PeerList_SendBacklogTo( Backlog_s* log, SharedPeer_s& peer )
+	{
+		if (peer.Init)
+			return NE_OK;
+		Result_t hr;
+		Array<Buffer_s> backlog( log->Alloc );
+		Backlog_Copy( log, backlog );
+		for ( int i = 0; i < backlog.Count; ++i )
+		{
+			hr = PeerList_SendBufferTo( &backlog[i], peer );
+			if (NeFailed(hr))
+				return hr;
+		}
+		peer.Init = 1;
+		return NE_OK;
+	}
+
+	static Result_t PeerList_SendShared( PeerList_s* list, Backlog_s* log, Buffer_t buffer )
+	{
+		if (!list->Shared.Ring)
+			return NE_OK;
+		if (SharedRing_Accept( list->Shared.Ring ))
+			list->Shared.Init = 0;
+		if (!SharedRing_IsAttached( list->Shared.Ring ))
+			return NE_OK;
+		Result_t hr;
+		hr = PeerList_SendBacklogTo( log, list->Shared );
+		if (NeFailed(hr))
+			return hr;
+		hr = PeerList_SendBufferTo( buffer, list->Shared );
+		if (NeFailed(hr))
+			return hr;
+		return NE_OK;
+	}
+
 } }
 
 //======================================================================================
@@ -356,6 +746,13 @@ namespace nemesis { namespace profiling
 		NeZero(list->Local);
 	}
 
+	void PeerList_Share( PeerList_s* list, SharedRing_s* ring )
+	{
+		NeLock(list->Mutex);
+		list->Shared.Ring = ring;
+		list->Shared.Init = 0;
+	}
+
 	int PeerList_FindPeer( PeerList_s* list, Socket_t peer )
 	{
 		NeLock(list->Mutex);
@@ -418,6 +815,7 @@ namespace nemesis { namespace profiling
 				++num_succeeded;
 		}
 		PeerList_SendLocal( list, log, buffer );
+		PeerList_SendShared( list, log, buffer );
 
 		if (num_succeeded == list->NumRemote)
 			return;
@@ -497,6 +895,11 @@ namespace nemesis { namespace profiling
 		PeerList_Attach( &dispatcher->PeerList, local );
 	}
 
+	void Dispatcher_Share( Dispatcher_s* dispatcher, SharedRing_s* ring )
+	{
+		PeerList_Share( &dispatcher->PeerList, ring );
+	}
+
 	void Dispatcher_Connect( Dispatcher_s* dispatcher, Socket_t client )
 	{
 		PeerList_Connect( &dispatcher->PeerList, client );
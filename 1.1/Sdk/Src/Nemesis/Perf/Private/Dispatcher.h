@@ -12,6 +12,10 @@
 #include "Buffer.h"
 #include "Worker.h"
 #include "Constants.h"
+#include "SharedRing.h"
+
+//======================================================================================
+#include <Nemesis/Core/HashTable.h>
 
 //======================================================================================
 namespace nemesis { namespace profiling
@@ -65,13 +69,57 @@ namespace nemesis { namespace profiling
 //======================================================================================
 namespace nemesis { namespace profiling
 { 
+	struct BacklogName_s
+	{
+		uint64_t Id;
+		uint32_t Offset;
+		uint16_t Len;
+		uint16_t _pad_;
+	};
+
+	struct BacklogDynamicName_s
+	{
+		uint64_t Id;
+		uint32_t Release;
+		uint16_t Len;
+		char	 Text[ MAX_DYNAMIC_NAME_SIZE ];
+	};
+
+	/// Released dynamic name, kept until the data buffers recorded before its release were sent.
+	struct BacklogRelease_s
+	{
+		uint64_t Id;
+		uint32_t Frame;
+		uint32_t _pad_;
+	};
+
+	/// Snapshot of the live meta data, sent to peers as they connect.
+	/// Tables are updated with every meta buffer, packets are only rebuilt on connect.
 	struct Backlog_s
 	{
-		Array<Buffer_t> Buffer;
+		CriticalSection_t			Mutex;
+		Allocator_t					Alloc;
+		HashTable_64_32_s			NameMap;
+		Array<BacklogName_s>		Names;
+		Array<uint8_t>				Text;
+		HashTable_64_32_s			DynamicMap;
+		Array<uint32_t>				DynamicFree;
+		Array<BacklogDynamicName_s> Dynamic;
+		Array<BacklogRelease_s>		Released;
+		uint32_t					NumFrames;
+		HashTable_64_32_s			SiteMap;
+		Array<chunk::LocationItem>	Sites;
+		Array<chunk::ThreadInfo>	Threads;
+		HashTable_64_32_s			MutexMap;
+		Array<chunk::MutexInfo>		Mutexes;
+		Array<Buffer_t>				Buffer;
+		uint32_t					Version;
+		uint32_t					Serialized;
 	};
 
 	void Backlog_Initialize( Backlog_s* log, Allocator_t alloc );
 	Result_t Backlog_Append( Backlog_s* log, Buffer_t buffer );
+	void Backlog_GetSize( Backlog_s* log, size_t& size, size_t& capacity );
 	void Backlog_Shutdown( Backlog_s* log );
 
 } }
@@ -91,10 +139,17 @@ namespace nemesis { namespace profiling
 		uint32_t Init;
 	};
 
+	struct SharedPeer_s
+	{
+		SharedRing_s* Ring;
+		uint32_t	  Init;
+	};
+
 	struct PeerList_s
 	{
 		CriticalSection_t Mutex;
 		LocalPeer_s		  Local;
+		SharedPeer_s	  Shared;
 		int				  NumRemote;
 		RemotePeer_s	  Remote[ MAX_NUM_REMOTE_PEERS ];
 	};
@@ -103,6 +158,7 @@ namespace nemesis { namespace profiling
 	bool PeerList_IsAttached( PeerList_s* list );
 	void PeerList_Attach( PeerList_s* list, const Consumer_s& local );
 	void PeerList_Detach( PeerList_s* list );
+	void PeerList_Share( PeerList_s* list, SharedRing_s* ring );
 	int PeerList_FindPeer( PeerList_s* list, Socket_t peer );
 	Result_t PeerList_Connect( PeerList_s* list, Socket_t peer );
 	Result_t PeerList_Disconnect( PeerList_s* list, Socket_t peer );
@@ -125,6 +181,7 @@ namespace nemesis { namespace profiling
 
 	void Dispatcher_Initialize( Dispatcher_s* dispatcher, Allocator_t alloc );
 	void Dispatcher_Attach( Dispatcher_s* dispatcher, const Consumer_s& local );
+	void Dispatcher_Share( Dispatcher_s* dispatcher, SharedRing_s* ring );
 	void Dispatcher_Connect( Dispatcher_s* dispatcher, Socket_t client );
 	void Dispatcher_Push( Dispatcher_s* dispatcher, const DispatchItem_s& item );
 	void Dispatcher_Shutdown( Dispatcher_s* dispatcher );
@@ -0,0 +1,353 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#include "stdafx.h"
+#include "LocationStats.h"
+
+//======================================================================================
+#include <Nemesis/Core/Sort.h>
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static int HighestBit( uint64_t v )
+	{
+		int bit = 0;
+		if (v >> 32) { v >>= 32; bit += 32; }
+		if (v >> 16) { v >>= 16; bit += 16; }
+		if (v >>  8) { v >>=  8; bit +=  8; }
+		if (v >>  4) { v >>=  4; bit +=  4; }
+		if (v >>  2) { v >>=  2; bit +=  2; }
+		if (v >>  1) { bit += 1; }
+		return bit;
+	}
+
+	/// Returns the histogram bucket of a duration.
+	/// Durations below 2^(STATS_SUB_SHIFT+1) have a bucket each, above that every power of two is split into 2^STATS_SUB_SHIFT buckets.
+	uint32_t Stats_GetBucket( Tick duration )
+	{
+		const uint64_t value = (duration > 0) ? (uint64_t)duration : 0;
+		if (value < (2u << STATS_SUB_SHIFT))
+			return (uint32_t)value;
+		const int shift = HighestBit( value ) - STATS_SUB_SHIFT;
+		return ((uint32_t)(shift + 1) << STATS_SUB_SHIFT) + (uint32_t)((value >> shift) & ((1u << STATS_SUB_SHIFT)-1));
+	}
+
+	/// Returns the smallest duration of a histogram bucket.
+	uint64_t Stats_GetBucketBegin( uint32_t bucket )
+	{
+		if (bucket < (2u << STATS_SUB_SHIFT))
+			return bucket;
+		const int shift = (int)(bucket >> STATS_SUB_SHIFT) - 1;
+		const uint64_t mantissa = (1u << STATS_SUB_SHIFT) + (bucket & ((1u << STATS_SUB_SHIFT)-1));
+		return mantissa << shift;
+	}
+
+	static uint64_t Stats_GetBucketWidth( uint32_t bucket )
+	{
+		if (bucket < (2u << STATS_SUB_SHIFT))
+			return 1;
+		return 1ull << ((bucket >> STATS_SUB_SHIFT) - 1);
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static void StatsAccum_Merge( StatsAccum_s& accum, const StatsItem_s& item, const StatsBinArray_s& bins )
+	{
+		if (!item.Count)
+			return;
+
+		if (!accum.Count || (item.Min < accum.Min)) accum.Min = item.Min;
+		if (!accum.Count || (item.Max > accum.Max)) accum.Max = item.Max;
+		accum.Count += item.Count;
+		accum.Sum += item.Sum;
+
+		for ( uint32_t i = 0; i < item.NumBins; ++i )
+		{
+			const StatsBin_s& bin = bins[ item.FirstBin + i ];
+			accum.Bins[ bin.Bucket ] += bin.Count;
+		}
+	}
+
+	/// Returns the duration below which the given percentage of the zones lie.
+	/// The value is interpolated within its bucket and clamped to the observed range.
+	static Tick StatsAccum_GetPercentile( const StatsAccum_s& accum, uint32_t percent )
+	{
+		const uint64_t rank = NeMax<uint64_t>( 1, ((uint64_t)accum.Count * percent + 99) / 100 );
+		uint64_t seen = 0;
+		for ( uint32_t i = 0; i < NUM_STATS_BUCKETS; ++i )
+		{
+			const uint32_t count = accum.Bins[i];
+			if (seen + count < rank)
+			{
+				seen += count;
+				continue;
+			}
+
+			const double fraction = ((double)(rank - seen) - 0.5) / (double)count;
+			const double value = (double)Stats_GetBucketBegin( i ) + fraction * (double)Stats_GetBucketWidth( i );
+			if (value >= (double)accum.Max)
+				return accum.Max;
+			return NeMax( accum.Min, (Tick)value );
+		}
+		return accum.Max;
+	}
+
+	void StatsAccum_Add( StatsAccum_s& accum, Tick duration )
+	{
+		if (!accum.Count || (duration < accum.Min)) accum.Min = duration;
+		if (!accum.Count || (duration > accum.Max)) accum.Max = duration;
+		accum.Count += 1;
+		accum.Sum += duration;
+		accum.Bins[ Stats_GetBucket( duration ) ] += 1;
+	}
+
+	void StatsAccum_GetResult( const StatsAccum_s& accum, viz::LocationStats& result )
+	{
+		NeZero( result );
+		if (!accum.Count)
+			return;
+
+		result.Count = accum.Count;
+		result.Min	 = accum.Min;
+		result.Max	 = accum.Max;
+		result.Mean	 = accum.Sum / accum.Count;
+		result.Total = accum.Sum;
+		result.P50	 = StatsAccum_GetPercentile( accum, 50 );
+		result.P90	 = StatsAccum_GetPercentile( accum, 90 );
+		result.P99	 = StatsAccum_GetPercentile( accum, 99 );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static StatsAccum_s& ParsedStats_GetAccum( Array<StatsAccum_s>& accums, uint32_t location )
+	{
+		if ((uint32_t)accums.Count <= location)
+			accums.Resize( location+1 );
+
+		StatsAccum_s& accum = accums[ location ];
+		if (!accum.Bins)
+			accum.Bins = Arr_Zero( Mem_Alloc<uint32_t>( accums.Alloc, NUM_STATS_BUCKETS ), NUM_STATS_BUCKETS );
+		return accum;
+	}
+
+	static void ParsedStats_FreeAccums( Array<StatsAccum_s>& accums )
+	{
+		for ( int i = 0; i < accums.Count; ++i )
+			Mem_Free( accums.Alloc, accums[i].Bins );
+	}
+
+	static const StatsItem_s* ParsedStats_FindItem( const ParsedStats_s& stats, const StatsChunk_s& chunk, uint32_t location )
+	{
+		uint32_t lo = 0;
+		uint32_t hi = chunk.NumItems;
+		while (lo < hi)
+		{
+			const uint32_t mid = (lo + hi) / 2;
+			const StatsItem_s& item = stats.Item[ chunk.FirstItem + mid ];
+			if (item.Location == location)
+				return &item;
+			if (item.Location < location)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return nullptr;
+	}
+
+	static int NE_CALLBK CompareLocations( void*, const void* l, const void* r )
+	{
+		const uint32_t lhs = *static_cast<const uint32_t*>(l);
+		const uint32_t rhs = *static_cast<const uint32_t*>(r);
+		return (lhs < rhs) ? -1 : (lhs > rhs) ? 1 : 0;
+	}
+
+	/// Moves the durations of the open frames into a chunk.
+	static void ParsedStats_CloseChunk( ParsedStats_s& stats )
+	{
+		const SortClient_s sorter = { CompareLocations, nullptr };
+		Sort_Quick( stats.Touched.Data, stats.Touched.Count, sizeof(stats.Touched.Data[0]), sorter );
+
+		if (!stats.Chunk.Count())
+			SegmentArray_Rebase( stats.Chunk, stats.OpenFirstFrame >> STATS_CHUNK_SHIFT );
+
+		StatsChunk_s& chunk = SegmentArray_Append( stats.Chunk );
+		chunk.FirstFrame = stats.OpenFirstFrame;
+		chunk.EndFrame	 = stats.OpenFirstFrame + stats.NumOpenFrames;
+		chunk.FirstItem	 = stats.Item.End;
+		chunk.NumItems	 = (uint32_t)stats.Touched.Count;
+
+		for ( int i = 0; i < stats.Touched.Count; ++i )
+		{
+			StatsAccum_s& open = stats.Open[ stats.Touched[i] ];
+			StatsItem_s& item = SegmentArray_Append( stats.Item );
+			item.Location = stats.Touched[i];
+			item.Count	  = open.Count;
+			item.Min	  = open.Min;
+			item.Max	  = open.Max;
+			item.Sum	  = open.Sum;
+			item.FirstBin = stats.Bin.End;
+
+			for ( uint32_t j = 0; j < NUM_STATS_BUCKETS; ++j )
+			{
+				if (!open.Bins[j])
+					continue;
+				StatsBin_s& bin = SegmentArray_Append( stats.Bin );
+				bin.Bucket = j;
+				bin.Count = open.Bins[j];
+				open.Bins[j] = 0;
+			}
+			item.NumBins = stats.Bin.End - item.FirstBin;
+
+			uint32_t* bins = open.Bins;
+			NeZero( open );
+			open.Bins = bins;
+		}
+
+		stats.Touched.Reset();
+		stats.NumOpenFrames = 0;
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	void ParsedStats_Initialize( ParsedStats_s& stats, Allocator_t alloc )
+	{
+		SegmentArray_Init( stats.Chunk , alloc );
+		SegmentArray_Init( stats.Item  , alloc );
+		SegmentArray_Init( stats.Bin   , alloc );
+		stats.Open.Init( alloc );
+		stats.Total.Init( alloc );
+		stats.Touched.Init( alloc );
+		stats.OpenFirstFrame = 0;
+		stats.NumOpenFrames = 0;
+	}
+
+	void ParsedStats_Shutdown( ParsedStats_s& stats )
+	{
+		ParsedStats_FreeAccums( stats.Open );
+		ParsedStats_FreeAccums( stats.Total );
+		SegmentArray_Clear( stats.Chunk );
+		SegmentArray_Clear( stats.Item );
+		SegmentArray_Clear( stats.Bin );
+		stats.Open.Clear();
+		stats.Total.Clear();
+		stats.Touched.Clear();
+		stats.OpenFirstFrame = 0;
+		stats.NumOpenFrames = 0;
+	}
+
+	void ParsedStats_Reset( ParsedStats_s& stats )
+	{
+		ParsedStats_FreeAccums( stats.Open );
+		ParsedStats_FreeAccums( stats.Total );
+		SegmentArray_Reset( stats.Chunk );
+		SegmentArray_Reset( stats.Item );
+		SegmentArray_Reset( stats.Bin );
+		stats.Open.Reset();
+		stats.Total.Reset();
+		stats.Touched.Reset();
+		stats.OpenFirstFrame = 0;
+		stats.NumOpenFrames = 0;
+	}
+
+	/// Adds the duration of a zone which closed in the current frame.
+	void ParsedStats_Add( ParsedStats_s& stats, uint32_t location, Tick duration )
+	{
+		if (location == UNKNOWN_LOCATION)
+			return;
+		StatsAccum_s& open = ParsedStats_GetAccum( stats.Open, location );
+		if (!open.Count)
+			stats.Touched.Append( location );
+		StatsAccum_Add( open, duration );
+		StatsAccum_Add( ParsedStats_GetAccum( stats.Total, location ), duration );
+	}
+
+	/// Closes the current frame and its chunk once the frame ends a stride.
+	void ParsedStats_CloseFrame( ParsedStats_s& stats, uint32_t frame_index )
+	{
+		if (!stats.NumOpenFrames)
+			stats.OpenFirstFrame = frame_index;
+		++stats.NumOpenFrames;
+
+		if (((frame_index+1) & (STATS_CHUNK_STRIDE-1)) == 0)
+			ParsedStats_CloseChunk( stats );
+	}
+
+	/// Drops the chunks ending before the given frame.
+	void ParsedStats_Evict( ParsedStats_s& stats, uint32_t first_frame )
+	{
+		uint32_t first_chunk = stats.Chunk.First;
+		while ((first_chunk != stats.Chunk.End) && ((int32_t)(first_frame - stats.Chunk[ first_chunk ].EndFrame) >= 0))
+			++first_chunk;
+		if (first_chunk == stats.Chunk.First)
+			return;
+
+		SegmentArray_Evict( stats.Chunk, first_chunk );
+		const uint32_t first_item = stats.Chunk.Count() ? stats.Chunk[ first_chunk ].FirstItem : stats.Item.End;
+		SegmentArray_Evict( stats.Item, first_item );
+		const uint32_t first_bin = stats.Item.Count() ? stats.Item[ first_item ].FirstBin : stats.Bin.End;
+		SegmentArray_Evict( stats.Bin, first_bin );
+	}
+
+	size_t ParsedStats_GetSize( const ParsedStats_s& stats )
+	{
+		size_t size 
+			= SegmentArray_GetSize( stats.Chunk )
+			+ SegmentArray_GetSize( stats.Item )
+			+ SegmentArray_GetSize( stats.Bin )
+			+ Array_GetCountSize( stats.Open )
+			+ Array_GetCountSize( stats.Total )
+			+ Array_GetCountSize( stats.Touched );
+		for ( int i = 0; i < stats.Open.Count; ++i )
+			size += stats.Open[i].Bins ? NUM_STATS_BUCKETS * sizeof(uint32_t) : 0;
+		for ( int i = 0; i < stats.Total.Count; ++i )
+			size += stats.Total[i].Bins ? NUM_STATS_BUCKETS * sizeof(uint32_t) : 0;
+		return size;
+	}
+
+	void ParsedStats_Gather( const ParsedStats_s& stats, uint32_t location, uint32_t first_frame, uint32_t end_frame, StatsAccum_s& accum, uint32_t& chunk_first, uint32_t& chunk_end )
+	{
+		chunk_first = first_frame;
+		chunk_end = first_frame;
+		for ( uint32_t i = stats.Chunk.First; i != stats.Chunk.End; ++i )
+		{
+			const StatsChunk_s& chunk = stats.Chunk[i];
+			if ((int32_t)(chunk.FirstFrame - first_frame) < 0)
+				continue;
+			if ((int32_t)(end_frame - chunk.EndFrame) < 0)
+				break;
+
+			if (chunk_first == chunk_end)
+				chunk_first = chunk.FirstFrame;
+			chunk_end = chunk.EndFrame;
+
+			const StatsItem_s* item = ParsedStats_FindItem( stats, chunk, location );
+			if (item)
+				StatsAccum_Merge( accum, *item, stats.Bin );
+		}
+	}
+
+	bool ParsedStats_GetTotal( const ParsedStats_s& stats, uint32_t location, viz::LocationStats& result )
+	{
+		NeZero( result );
+		if ((uint32_t)stats.Total.Count <= location)
+			return false;
+		StatsAccum_GetResult( stats.Total[ location ], result );
+		return result.Count > 0;
+	}
+
+} }
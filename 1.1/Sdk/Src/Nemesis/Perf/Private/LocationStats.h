@@ -0,0 +1,99 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+#include <Nemesis/Perf/Visualizer.h>
+
+//======================================================================================
+#include "Constants.h"
+#include "SegmentArray.h"
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	/// Location of scope events whose call site was never registered.
+	static const uint32_t UNKNOWN_LOCATION = 0xffffffff;
+
+	enum { STATS_SUB_SHIFT	 = viz::StatsHistogram::SUB_SHIFT };
+	enum { NUM_STATS_BUCKETS = viz::StatsHistogram::NUM_BUCKETS };
+
+	/// Durations of a location gathered over time.
+	/// Bins holds a log-linear histogram with 2^STATS_SUB_SHIFT buckets per power of two.
+	struct StatsAccum_s
+	{
+		uint32_t	Count;
+		uint32_t	_pad_;
+		Tick		Min;
+		Tick		Max;
+		Tick		Sum;
+		uint32_t*	Bins;
+	};
+
+	/// Durations of a location within a chunk of frames.
+	struct StatsItem_s
+	{
+		uint32_t	Location;
+		uint32_t	Count;
+		Tick		Min;
+		Tick		Max;
+		Tick		Sum;
+		uint32_t	FirstBin;
+		uint32_t	NumBins;
+	};
+
+	/// Non-empty bucket of a chunk's histogram.
+	struct StatsBin_s
+	{
+		uint32_t	Bucket;
+		uint32_t	Count;
+	};
+
+	/// Frames aggregated together, their items are sorted by location.
+	struct StatsChunk_s
+	{
+		uint32_t	FirstFrame;
+		uint32_t	EndFrame;
+		uint32_t	FirstItem;
+		uint32_t	NumItems;
+	};
+
+	typedef SegmentArray<StatsChunk_s, FRAME_SEGMENT_SHIFT> StatsChunkArray_s;
+	typedef SegmentArray<StatsItem_s , EVENT_SEGMENT_SHIFT> StatsItemArray_s;
+	typedef SegmentArray<StatsBin_s	 , EVENT_SEGMENT_SHIFT> StatsBinArray_s;
+
+	/// Zone durations per location, per chunk of STATS_CHUNK_STRIDE frames and over the whole capture.
+	struct ParsedStats_s
+	{
+		StatsChunkArray_s	Chunk;
+		StatsItemArray_s	Item;
+		StatsBinArray_s		Bin;
+		Array<StatsAccum_s>	Open;
+		Array<StatsAccum_s>	Total;
+		Array<uint32_t>		Touched;
+		uint32_t			OpenFirstFrame;
+		uint32_t			NumOpenFrames;
+	};
+
+	void	 ParsedStats_Initialize	( ParsedStats_s& stats, Allocator_t alloc );
+	void	 ParsedStats_Shutdown	( ParsedStats_s& stats );
+	void	 ParsedStats_Reset		( ParsedStats_s& stats );
+	void	 ParsedStats_Add		( ParsedStats_s& stats, uint32_t location, Tick duration );
+	void	 ParsedStats_CloseFrame	( ParsedStats_s& stats, uint32_t frame_index );
+	void	 ParsedStats_Evict		( ParsedStats_s& stats, uint32_t first_frame );
+	size_t	 ParsedStats_GetSize	( const ParsedStats_s& stats );
+
+	/// Merges the chunks lying within the given frames and returns the frames they cover.
+	void	 ParsedStats_Gather		( const ParsedStats_s& stats, uint32_t location, uint32_t first_frame, uint32_t end_frame, StatsAccum_s& accum, uint32_t& chunk_first, uint32_t& chunk_end );
+	bool	 ParsedStats_GetTotal	( const ParsedStats_s& stats, uint32_t location, viz::LocationStats& result );
+
+	void	 StatsAccum_Add			( StatsAccum_s& accum, Tick duration );
+	void	 StatsAccum_GetResult	( const StatsAccum_s& accum, viz::LocationStats& result );
+
+} }
@@ -34,6 +34,13 @@ namespace nemesis { namespace profiling
 		buffer->Count = sizeof( packet );
 	}
 
+	inline void Packet_SetSource( Buffer_t buffer, uint8_t thread_index )
+	{
+		NeAssert(buffer->Count >= sizeof(Packet));
+		Packet* packet = ((Packet*)(buffer->Data));
+		packet->source = 1 + thread_index;
+	}
+
 	inline void Packet_Finalize( Buffer_t buffer )
 	{
 		NeAssert(buffer->Count >= sizeof(Packet));
@@ -10,6 +10,9 @@
 #include "PacketQueue.h"
 
 //======================================================================================
+#include <Nemesis/Core/Alloc.h>
+#include <Nemesis/Core/Atomic.h>
+#include <Nemesis/Core/Memory.h>
 #include <Nemesis/Core/Process.h>
 
 //======================================================================================
@@ -18,49 +21,26 @@ using namespace nemesis::system;
 //======================================================================================
 namespace nemesis { namespace profiling
 { 
-	void PacketRing_Initialize( PacketRing_s& ring, Allocator_t alloc, int num_streams, int bytes_per_stream )
+	/// Prefix of every packet in the slab, a size of zero skips to the start of the slab.
+	struct PacketRecord_s
 	{
-		ring.ReadPos = 0;
-		ring.WritePos = 0;
-		ring.Stream.Alloc = alloc;
-		ring.Stream.Resize( num_streams );
-		for ( int i = 0; i < ring.Stream.Count; ++i )
-			RecorderStream_Initialize( ring.Stream[i], ring.Stream.Alloc, bytes_per_stream );
-	}
+		uint32_t Size;
+		uint32_t _pad_;
+	};
 
-	void PacketRing_Push( PacketRing_s& ring, const Packet& packet, const Chunk* head )
+	static uint32_t PacketQueue_AlignRecord( uint32_t size )
 	{
-		if (ring.Stream.Count)
-		{
-			RecorderStream_s& item = ring.Stream[ring.WritePos];
-			ring.WritePos = (ring.WritePos + 1) % ring.Stream.Count;
-			RecorderStream_Reset( item );
-			RecorderStream_Record( item, &packet, sizeof(Packet) );
-			RecorderStream_Record( item, head, packet.DataSize() );
-		}
+		return (sizeof(PacketRecord_s) + size + 7) & ~7u;
 	}
 
-	void PacketRing_Pop( PacketRing_s& ring, RecorderStream_s& s )
+	static PacketRecord_s* PacketQueue_GetRecord( PacketQueue_s& queue, int64_t pos )
 	{
-		if (ring.Stream.Count)
-		{
-			RecorderStream_s& item = ring.Stream[ring.ReadPos];
-			ring.ReadPos = (ring.ReadPos + 1) % ring.Stream.Count;
-			RecorderStream_Reset( s );
-			RecorderStream_Record( s, item );
-			item.Data.Reset();
-		}
-		else
-		{
-			RecorderStream_Reset( s );
-		}
+		return (PacketRecord_s*)(queue.Data + (pos & (queue.Capacity-1)));
 	}
 
-	void PacketRing_Shutdown( PacketRing_s& ring )
+	static bool PacketQueue_HasSpace( PacketQueue_s& queue, int64_t write, uint32_t size )
 	{
-		for ( int i = 0; i < ring.Stream.Count; ++i )
-			ring.Stream[i].Data.Clear();
-		ring.Stream.Clear();
+		return (queue.Capacity - (write - Interlocked_Load64( &queue.ReadPos ))) >= size;
 	}
 
 } }
@@ -68,48 +48,112 @@ namespace nemesis { namespace profiling
 //======================================================================================
 namespace nemesis { namespace profiling
 { 
-	void PacketQueue_Initialize( PacketQueue_s& queue, Allocator_t alloc, int num_streams, int bytes_per_stream )
+	void PacketQueue_Initialize( PacketQueue_s& queue, Allocator_t alloc, uint32_t capacity )
 	{
+		NeAssert((capacity & (capacity-1)) == 0);
 		NeZero(queue);
+		queue.Alloc	   = alloc;
+		queue.Data	   = Mem_Alloc<uint8_t>( alloc, capacity );
+		queue.Capacity = capacity;
+		queue.Work	   = Semaphore_Create( 0, 1 );
+		queue.Space	   = Semaphore_Create( 0, 1 );
+	}
 
-		PacketRing_Initialize( queue.Ring, alloc, num_streams, bytes_per_stream );
-
-		queue.Work = Semaphore_Create( 0, num_streams );
-		queue.Space = Semaphore_Create( num_streams, num_streams );
-		CriticalSection_Create( queue.Mutex );
+	bool PacketQueue_IsEmpty( PacketQueue_s& queue )
+	{
+		return Interlocked_Load64( &queue.ReadPos ) == Interlocked_Load64( &queue.WritePos );
 	}
 
 	void PacketQueue_Push( PacketQueue_s& queue, const Packet& packet, const Chunk* head )
 	{
-		Semaphore_Wait( queue.Space );
+		const uint32_t size = sizeof(Packet) + packet.DataSize();
+		const uint32_t length = PacketQueue_AlignRecord( size );
+		NeAssert(length <= queue.Capacity/2);
+
+		const int64_t write = Interlocked_Load64( &queue.WritePos );
+		const uint32_t tail = queue.Capacity - (uint32_t)(write & (queue.Capacity-1));
+		const uint32_t needed = (tail < length) ? (tail + length) : length;
+
+		// wait for the parser to make room
+		while (!PacketQueue_HasSpace( queue, write, needed ))
 		{
-			NeLock(queue.Mutex);
-			PacketRing_Push( queue.Ring, packet, head );
+			if (Interlocked_Load( &queue.Closed ))
+				return;
+			Interlocked_Exchange( &queue.WriterWaiting, 1 );
+			if (PacketQueue_HasSpace( queue, write, needed ))
+			{
+				Interlocked_Exchange( &queue.WriterWaiting, 0 );
+				break;
+			}
+			Semaphore_Wait( queue.Space );
 		}
-		Semaphore_Signal( queue.Work, 1 );
+
+		int64_t pos = write;
+		if (tail < length)
+		{
+			PacketQueue_GetRecord( queue, pos )->Size = 0;
+			pos += tail;
+		}
+		PacketRecord_s* record = PacketQueue_GetRecord( queue, pos );
+		record->Size = size;
+		Mem_Cpy( record+1, &packet, sizeof(Packet) );
+		Mem_Cpy( ((uint8_t*)(record+1)) + sizeof(Packet), head, packet.DataSize() );
+		Interlocked_Exchange64( &queue.WritePos, pos + length );
+
+		if (Interlocked_Exchange( &queue.ReaderWaiting, 0 ))
+			Semaphore_Signal( queue.Work, 1 );
 	}
 
-	void PacketQueue_Pop( PacketQueue_s& queue, RecorderStream_s& s )
+	const Packet* PacketQueue_Peek( PacketQueue_s& queue )
 	{
-		Semaphore_Wait( queue.Work );
+		for ( ;; )
 		{
-			NeLock(queue.Mutex);
-			PacketRing_Pop( queue.Ring, s );
+			const int64_t read = Interlocked_Load64( &queue.ReadPos );
+			if (read == Interlocked_Load64( &queue.WritePos ))
+			{
+				if (Interlocked_Load( &queue.Closed ))
+					return nullptr;
+				Interlocked_Exchange( &queue.ReaderWaiting, 1 );
+				if ((read == Interlocked_Load64( &queue.WritePos )) && !Interlocked_Load( &queue.Closed ))
+					Semaphore_Wait( queue.Work );
+				Interlocked_Exchange( &queue.ReaderWaiting, 0 );
+				continue;
+			}
+
+			const PacketRecord_s* record = PacketQueue_GetRecord( queue, read );
+			if (!record->Size)
+			{
+				const uint32_t tail = queue.Capacity - (uint32_t)(read & (queue.Capacity-1));
+				Interlocked_Exchange64( &queue.ReadPos, read + tail );
+				continue;
+			}
+			return (const Packet*)(record+1);
 		}
-		Semaphore_Signal( queue.Space, 1 );
+	}
+
+	void PacketQueue_Pop( PacketQueue_s& queue )
+	{
+		const int64_t read = Interlocked_Load64( &queue.ReadPos );
+		const PacketRecord_s* record = PacketQueue_GetRecord( queue, read );
+		Interlocked_Exchange64( &queue.ReadPos, read + PacketQueue_AlignRecord( record->Size ) );
+
+		if (Interlocked_Exchange( &queue.WriterWaiting, 0 ))
+			Semaphore_Signal( queue.Space, 1 );
 	}
 
 	void PacketQueue_Close( PacketQueue_s& queue )
 	{
-		Semaphore_Signal( queue.Work, queue.Ring.Stream.Count );
+		Interlocked_Exchange( &queue.Closed, 1 );
+		Semaphore_Signal( queue.Work, 1 );
+		Semaphore_Signal( queue.Space, 1 );
 	}
 
 	void PacketQueue_Shutdown( PacketQueue_s& queue )
 	{
 		Semaphore_Destroy( queue.Space );
 		Semaphore_Destroy( queue.Work );
-		CriticalSection_Destroy( queue.Mutex );
-		PacketRing_Shutdown( queue.Ring );
+		Mem_Free( queue.Alloc, queue.Data );
+		NeZero(queue);
 	}
 
 } }
@@ -15,96 +15,34 @@
 #include "Types.h"
 
 //======================================================================================
-#include <Nemesis/Core/Array.h>
-
-//======================================================================================
-namespace nemesis { namespace profiling
-{
-	struct RecorderStream_s
-	{
-		Array<uint8_t> Data;
-	};
-
-	inline void RecorderStream_Initialize( RecorderStream_s& s, Allocator_t alloc, int capacity )
-	{
-		s.Data.Alloc = alloc;
-		s.Data.Reserve( capacity ); 
-	}
-
-	inline void RecorderStream_Shutdown( RecorderStream_s& s )
-	{
-		s.Data.Clear();
-	}
-
-	inline int RecorderStream_Remain( const RecorderStream_s& s )
-	{
-		return s.Data.Capacity - s.Data.Count;
-	}
-
-	inline void RecorderStream_Reset( RecorderStream_s& s )
-	{
-		return s.Data.Reset();
-	}
-
-	inline void RecorderStream_Record( RecorderStream_s& s, cptr_t data, int size )
-	{
-		return s.Data.Append( (const uint8_t*)data, size );
-	}
-
-	inline void RecorderStream_Record( RecorderStream_s& s, const RecorderStream_s& from )
-	{
-		RecorderStream_Record( s, from.Data.Data, from.Data.Count );
-	}
-
-	inline bool RecorderStream_TryRecord( RecorderStream_s& s, cptr_t data, int size )
-	{
-		if (RecorderStream_Remain( s ) >= size)
-		{
-			RecorderStream_Record( s, data, size );
-			return true;
-		}
-		return false;
-	}
-
-} }
-
-//======================================================================================
-namespace nemesis { namespace profiling
-{
-	struct PacketBuffer_s
-	{
-		Packet* Packet;
-	};
-
-	struct PacketRing_s
-	{
-		int ReadPos;
-		int WritePos;
-		Array<RecorderStream_s> Stream;
-	};
-
-	void PacketRing_Initialize( PacketRing_s& ring, Allocator_t alloc, int num_streams, int bytes_per_stream );
-	void PacketRing_Push( PacketRing_s& ring, const Packet& packet, const Chunk* head );
-	void PacketRing_Pop( PacketRing_s& ring, RecorderStream_s& s );
-	void PacketRing_Shutdown( PacketRing_s& rings );
-
-} }
+#include <Nemesis/Core/AtomicTypes.h>
 
 //======================================================================================
 namespace nemesis { namespace profiling
 {
+	/// Single producer, single consumer queue of packets.
+	/// Packets are copied once into a parser owned slab and consumed in place.
+	/// A packet never wraps around the end of the slab.
 	struct PacketQueue_s
 	{
-		system::Semaphore_t Work;
-		system::Semaphore_t Space;
-		system::CriticalSection_t Mutex;
-		PacketRing_s Ring;
+		Allocator_t			Alloc;
+		uint8_t*			Data;
+		uint32_t			Capacity;
+		Atomic32			Closed;
+		Atomic64			ReadPos;
+		Atomic64			WritePos;
+		Atomic32			ReaderWaiting;
+		Atomic32			WriterWaiting;
+		system::Semaphore_t	Work;
+		system::Semaphore_t	Space;
 	};
 
-	void PacketQueue_Initialize( PacketQueue_s& queue, Allocator_t alloc, int num_streams, int bytes_per_stream );
-	void PacketQueue_Push( PacketQueue_s& queue, const Packet& packet, const Chunk* head );
-	void PacketQueue_Pop( PacketQueue_s& queue, RecorderStream_s& s );
-	void PacketQueue_Close( PacketQueue_s& queue );
-	void PacketQueue_Shutdown( PacketQueue_s& queue );
+	void		  PacketQueue_Initialize( PacketQueue_s& queue, Allocator_t alloc, uint32_t capacity );
+	bool		  PacketQueue_IsEmpty	( PacketQueue_s& queue );
+	void		  PacketQueue_Push		( PacketQueue_s& queue, const Packet& packet, const Chunk* head );
+	const Packet* PacketQueue_Peek		( PacketQueue_s& queue );
+	void		  PacketQueue_Pop		( PacketQueue_s& queue );
+	void		  PacketQueue_Close		( PacketQueue_s& queue );
+	void		  PacketQueue_Shutdown	( PacketQueue_s& queue );
 
 } }
@@ -10,28 +10,16 @@
 #include "Parser.h"
 
 //======================================================================================
+#include "Constants.h"
 #include "Database.h"
 
 //======================================================================================
+#include <Nemesis/Core/Atomic.h>
 #include <Nemesis/Core/Process.h>
 
 //======================================================================================
 using namespace nemesis::system;
 
-//======================================================================================
-namespace nemesis { namespace profiling
-{
-	static Packet MakeResetPacket()
-	{
-		const Packet packet = 
-		{ { chunk::Type::Packet, sizeof(packet) }
-		, 0
-		};
-		return packet;
-	}
-
-} }
-
 //======================================================================================
 namespace nemesis { namespace profiling
 {
@@ -44,32 +32,72 @@ namespace nemesis { namespace profiling
 	#endif
 	}
 
-	static void Parser_Process( Parser_t parser, PacketBuffer_s& item )
+	/// Applies a reset requested by the ui, the parser must be acquired.
+	static void Parser_ApplyReset( Parser_t parser )
 	{
-		if (item.Packet->DataSize())
-		{
-			ParserInstance_ParseChunks( parser->Instance, (const Chunk*)(item.Packet+1), item.Packet->DataSize(), NeHasFlag( item.Packet->flags, Packet::BigEndian ) );
-			Parser_Delay( parser );
-		}
-		else
-		{
+		if (Interlocked_Exchange( &parser->ResetRequest, 0 ))
 			ParserInstance_Reset( parser->Instance );
-		}
 	}
 
-	static void Parser_Run( Parser_t parser )
+	static void Parser_Process( Parser_t parser, const Packet& packet, const Chunk* head )
+	{
+		Parser_ApplyReset( parser );
+		if (!packet.DataSize())
+			return;
+		ParserInstance_ParseChunks( parser->Instance, packet.SourceThread(), head, packet.DataSize(), NeHasFlag( packet.flags, Packet::BigEndian ) );
+		ParserInstance_Publish( parser->Instance );
+		Parser_Delay( parser );
+	}
+
+	/// The parser state is owned by whichever thread holds this flag.
+	static bool Parser_TryAcquire( Parser_t parser )
 	{
-		RecorderStream_s s;
-		RecorderStream_Initialize( s, parser->Alloc, 1024*1024 );
+		return Interlocked_CompareExchange( &parser->Parsing, 1, 0 ) == 0;
+	}
 
-		PacketBuffer_s p;
+	static void Parser_Acquire( Parser_t parser )
+	{
+		while (!Parser_TryAcquire( parser ))
+			Cpu_Yield();
+	}
+
+	static void Parser_Release( Parser_t parser )
+	{
+		Interlocked_Exchange( &parser->Parsing, 0 );
+	}
+
+	/// Applies a pending reset unless the parser is busy.
+	static void Parser_TryReset( Parser_t parser )
+	{
+		if (!Interlocked_Load( &parser->ResetRequest ))
+			return;
+		if (!Parser_TryAcquire( parser ))
+			return;
+		Parser_ApplyReset( parser );
+		Parser_Release( parser );
+	}
+
+	/// Hands the frames parsed so far over unless the parser is busy.
+	/// A parser waiting for packets publishes nothing by itself.
+	static void Parser_TryPublish( Parser_t parser )
+	{
+		if (!Parser_TryAcquire( parser ))
+			return;
+		ParserInstance_Publish( parser->Instance );
+		Parser_Release( parser );
+	}
+
+	static void Parser_Run( Parser_t parser )
+	{
 		for ( ; parser->Worker.Continue ; )
 		{
-			PacketQueue_Pop( parser->Queue, s );
-			if (!s.Data.Count)
+			const Packet* packet = PacketQueue_Peek( parser->Queue );
+			if (!packet)
 				continue;
-			p.Packet = (Packet*)s.Data.Data;
-			Parser_Process( parser, p );
+			Parser_Acquire( parser );
+				Parser_Process( parser, *packet, (const Chunk*)(packet+1) );
+				PacketQueue_Pop( parser->Queue );
+			Parser_Release( parser );
 		}
 	}
 
@@ -87,8 +115,9 @@ namespace nemesis { namespace profiling
 	void Parser_Initialize( Parser_t parser, Allocator_t alloc, const ParserSetup& setup )
 	{
 		parser->Alloc = alloc;
+		setup.Database->Parser = parser;
 		ParserInstance_Initialize( parser->Instance, alloc, setup.Database );
-		PacketQueue_Initialize( parser->Queue, alloc, 8, 8*64*1024 );
+		PacketQueue_Initialize( parser->Queue, alloc, PARSER_QUEUE_SIZE );
 
 		const ThreadSetup_s thread_setup = { "[NePerf] Parser", Parser_Proc, parser };
 		Worker_Start( &parser->Worker, thread_setup );
@@ -100,6 +129,7 @@ namespace nemesis { namespace profiling
 			PacketQueue_Close( parser->Queue );
 		Worker_Wait( &parser->Worker );
 		PacketQueue_Shutdown( parser->Queue );
+		parser->Instance.State.Db->Parser = nullptr;
 		ParserInstance_Shutdown( parser->Instance );
 	}
 
@@ -120,25 +150,74 @@ namespace nemesis { namespace profiling
 
 	void Parser_QueueData( Parser_t parser, const Packet& packet, const Chunk* head, Parse::Mode mode )
 	{
+		// parse on the calling thread when nothing is queued ahead of this packet
+		if ((mode == Parse::Immediate) && Parser_TryAcquire( parser ))
+		{
+			if (PacketQueue_IsEmpty( parser->Queue ))
+			{
+				Parser_Process( parser, packet, head );
+				Parser_Release( parser );
+				return;
+			}
+			Parser_Release( parser );
+		}
 		PacketQueue_Push( parser->Queue, packet, head );
 	}
 
+	/// The receiver is the only producer of the queue, so the reset is handed over by flag.
+	/// It is applied before the next packet is parsed, or by the next join while the parser idles.
 	void Parser_QueueReset( Parser_t parser )
 	{
-		PacketQueue_Push( parser->Queue, MakeResetPacket(), nullptr );
+		Interlocked_Exchange( &parser->ResetRequest, 1 );
+		Parser_TryReset( parser );
 	}
 
+	/// Joins the frames the parser has handed over, never waiting for it.
 	void Parser_JoinData( Parser_t parser )
 	{
-		if (!parser->Instance.ParsedFrames.Frames.Count)
+		Parser_TryReset( parser );
+		Parser_TryPublish( parser );
+
+		const ParsedFrames_s* frames = ParserInstance_GetJoinable( parser->Instance );
+		if (!frames)
 			return;
 
 		if (parser->Paused)
 			return;
 
-		const Limit_s limit = { parser->Instance.State.Db->Setup.MaxNumBytes, parser->Instance.State.Db->Setup.MaxNumFrames };
-		ParsedData_MakeRoom( parser->Instance.State.Db->Data, limit, parser->Instance.ParsedFrames.Frames.Count, parser->Instance.ParsedFrames.TotalSize() );
+		const DatabaseSetup_s& setup = parser->Instance.State.Db->Setup;
+		const Limit_s limit = { setup.MaxNumBytes, setup.MaxNumFrames, setup.NumHotFrames };
+		if (!frames->Reset)
+			ParsedData_MakeRoom( parser->Instance.State.Db->Data, limit, frames->Data.Frames.Count(), frames->Data.TotalSize() );
 		ParserInstance_JoinFrames( parser->Instance, parser->Instance.State.Db->Data );
 	}
 
+	/// Waits until every queued packet is parsed and joins all completed frames.
+	/// Used at the end of a stream, where no further packet would hand the last frames over.
+	void Parser_FlushData( Parser_t parser )
+	{
+		for ( ;; )
+		{
+			if (!Parser_TryAcquire( parser ))
+			{
+				Cpu_Yield();
+				continue;
+			}
+			if (!PacketQueue_IsEmpty( parser->Queue ))
+			{
+				Parser_Release( parser );
+				Cpu_Yield();
+				continue;
+			}
+			Parser_ApplyReset( parser );
+			ParserInstance_Publish( parser->Instance );
+			const ParsedFrames_s& pending = parser->Instance.ParsedFrames[ Interlocked_Load( &parser->Instance.WriteFrames ) ];
+			const bool done = !pending.Data.Frames.Count() && !pending.Reset && Interlocked_Load( &parser->Instance.JoinRequest );
+			Parser_Release( parser );
+			if (done || parser->Paused)
+				return;
+			Parser_JoinData( parser );
+		}
+	}
+
 } }
@@ -24,6 +24,8 @@ namespace nemesis { namespace profiling
 		ParserInstance_s Instance;
 		int32_t Delay;
 		int32_t Paused;
+		Atomic32 Parsing;
+		Atomic32 ResetRequest;
 	};
 
 	void Parser_Initialize( Parser_t parser, Allocator_t alloc, const ParserSetup& setup );
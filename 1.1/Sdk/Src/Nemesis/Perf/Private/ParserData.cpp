@@ -8,184 +8,331 @@
 //======================================================================================
 #include "stdafx.h"
 #include "ParserData.h"
+#include "QueryPool.h"
+
+//======================================================================================
+#include <Nemesis/Core/Sort.h>
+
+//======================================================================================
+#define UNIT_TEST_ZONES		0
 
 //======================================================================================
 namespace nemesis { namespace profiling
 {
-	static Tick FrameTable_FirstTick( const Array<viz::Frame>& frames ) { return frames.Count ? frames[0].Time.Begin : 0; }
-	static Tick FrameTable_LastEndTick( const Array<viz::Frame>& frames ) { return frames.Count ? frames[frames.Count-1].Time.End : 0; }
-	static Tick FrameTable_LastBeginTick( const Array<viz::Frame>& frames ) { return frames.Count ? frames[frames.Count-1].Time.Begin : 0; }
+	static Tick FrameTable_FirstTick( const FrameArray_s& frames ) { return frames.Count() ? frames[frames.First].Time.Begin : 0; }
+	static Tick FrameTable_LastEndTick( const FrameArray_s& frames ) { return frames.Count() ? frames[frames.End-1].Time.End : 0; }
+	static Tick FrameTable_LastBeginTick( const FrameArray_s& frames ) { return frames.Count() ? frames[frames.End-1].Time.Begin : 0; }
 
 } }
 
 //======================================================================================
 namespace nemesis { namespace profiling
 {
-	struct Zone_s
+	/// Returns whether the memory belongs to an opened database file.
+	static bool ParsedData_IsMapped( const ParsedData_s& data, cptr_t ptr )
 	{
-		TickInterval Time;
-		uint32_t Location;
-		uint32_t EnterScope;
-		uint32_t LeaveScope;
-		uint8_t Thread;
-		uint8_t Level;
-		uint8_t Type: 2;
-		uint8_t Cpu0: 6;
-		uint8_t Cpu1: 6;
-		uint8_t Flags: 2;
+		return (ptr >= data.MappedBegin) && (ptr < data.MappedEnd);
+	}
+
+	/// Column whose oldest heap segment is moved to the spill file next.
+	struct SpillCandidate_s
+	{
+		size_t	Size;
+		ptr_t	Column;
+		bool	(*Spill)( ParsedData_s& data, ptr_t column );
 	};
 
-	struct ZoneStack_s
+	/// Returns the number of heap bytes which can be spilled.
+	/// The last segment is still being written and stays on the heap.
+	template < typename T, int SHIFT >
+	static size_t SegmentArray_GetSpillableSize( const SegmentArray<T,SHIFT>& arr )
 	{
-		enum { MAX_NUM_ITEMS = 64 };
+		const int num_segments = arr.Segment.Count - (int)arr.Spilled - 1;
+		return (num_segments > 0) ? (size_t)num_segments * SegmentArray<T,SHIFT>::SEGMENT_SIZE * sizeof(T) : 0;
+	}
 
-		Zone_s Item[ MAX_NUM_ITEMS ];
-		uint8_t NumItems;
-		uint8_t _pad_[3];
+	/// Moves the oldest heap segment into the spill file.
+	/// Segments of an opened database file are already backed by it and are only marked.
+	template < typename T, int SHIFT >
+	static bool SegmentArray_Spill( ParsedData_s& data, ptr_t column )
+	{
+		SegmentArray<T,SHIFT>& arr = *(SegmentArray<T,SHIFT>*)column;
+		const size_t size = SegmentArray<T,SHIFT>::SEGMENT_SIZE * sizeof(T);
+		T* segment = arr.Segment[ arr.Spilled ];
+		if (ParsedData_IsMapped( data, segment ))
+		{
+			++arr.Spilled;
+			data.Size -= size;
+			return true;
+		}
+		T* slot = (T*)SpillStore_Alloc( data.Spill, size );
+		if (!slot)
+			return false;
+		Mem_Cpy( slot, segment, size );
+		Mem_Free( arr.Segment.Alloc, segment );
+		arr.Segment[ arr.Spilled++ ] = slot;
+		data.Size -= size;
+		return true;
+	}
+
+	template < typename T, int SHIFT >
+	static void SpillCandidate_Add( SpillCandidate_s& best, SegmentArray<T,SHIFT>& arr )
+	{
+		const size_t size = SegmentArray_GetSpillableSize( arr );
+		if (size <= best.Size)
+			return;
+		best.Size = size;
+		best.Column = &arr;
+		best.Spill = SegmentArray_Spill<T,SHIFT>;
+	}
 
-		void Push( const viz::ScopeEvent& ev, int index )
-		{
-			NeAssert(ev.Enter == 1);
-			NeAssert(NumItems < MAX_NUM_ITEMS);
-			Zone_s& zone = Item[ NumItems ];
-			zone.Time.Begin = ev.Time;
-			zone.Time.End = ev.Time;
-			zone.Location = ev.Location;
-			zone.EnterScope = index;
-			zone.LeaveScope = index;
-			zone.Thread = ev.Thread;
-			zone.Level = NumItems;
-			zone.Cpu0 = ev.Cpu;
-			zone.Cpu1 = ev.Cpu;
-			zone.Type = ev.Type;
-			zone.Flags = 0;
-			++NumItems;
-		}
-
-		int Pop( const viz::ScopeEvent& ev, int index )
-		{
-			NeAssert(ev.Enter == 0);
-			if (!NumItems)
-				return -1;
-			--NumItems;
-			Zone_s& zone = Item[NumItems];
-			NeAssert(zone.Thread == ev.Thread);
-			zone.Time.End = ev.Time;
-			zone.LeaveScope = index;
-			zone.Cpu1 = ev.Cpu;
-			return NumItems;
-		}
-
-		int Parse( const viz::ScopeEvent& ev, int index )
+	/// Releases the spilled segments which evicting all items before the given index drops.
+	template < typename T, int SHIFT >
+	static void SegmentArray_ReleaseSpilled( SpillStore_s& spill, SegmentArray<T,SHIFT>& arr, uint32_t first )
+	{
+		const size_t size = SegmentArray<T,SHIFT>::SEGMENT_SIZE * sizeof(T);
+		const uint32_t num_segments = NeMin( arr.Spilled, (first - arr.Base) >> SHIFT );
+		for ( uint32_t i = 0; i < num_segments; ++i )
 		{
-			if (ev.Enter)
-			{
-				Push( ev, index );
-				return -1;
-			}
-			return Pop( ev, index );
+			if (SpillStore_Contains( spill, arr.Segment[i] ))
+				SpillStore_Free( spill, arr.Segment[i], size );
 		}
-	};
+		arr.Segment.RemoveAt( 0, (int)num_segments );
+		arr.Base	+= num_segments << SHIFT;
+		arr.Spilled -= num_segments;
+	}
 
 } }
 
 //======================================================================================
 namespace nemesis { namespace profiling
 {
-	using namespace viz;
+	enum { SCOPE_PACK_SIZE = TickArray_s::SEGMENT_SIZE };
 
-	namespace
+	/// Locations of the parts which follow the header of a packed segment.
+	struct ScopePackParts_s
 	{
-		// @note: fails when there are gaps in between frames
-		struct FrameComparer
-		{
-			static int Compare( const Frame& frame, Tick tick )
-			{
-				if ( tick < frame.Time.Begin )
-					return 1;
-				if ( tick >= frame.Time.End )
-					return -1;
-				return 0;
-			}
-		};
+		uint32_t*	LocationDict;
+		uint32_t*	FlagsDict;
+		uint64_t*	LocationCodes;
+		uint64_t*	FlagsCodes;
+		uint8_t*	Time;
+	};
+
+	static uint32_t ScopePack_NumBits( uint32_t count )
+	{
+		uint32_t bits = 0;
+		while ((1u << bits) < count)
+			++bits;
+		return bits;
 	}
 
-	/// Calculates the tick offset for a given frame index
-	Tick ParsedData_GotoFrameIndex( const ParsedData_s& data, int frame_index )
+	static size_t ScopePack_NumWords( uint32_t bits )
 	{
-		if ( (frame_index >= 0) && (frame_index < data.Frames.Count) )
-			return data.Frames.Data[ frame_index ].Time.Begin;
+		return ((size_t)SCOPE_PACK_SIZE * bits + 63) / 64;
+	}
 
-		if ( data.Frames.Count )
-			return data.Frames[0].Time.Begin;
+	static void ScopePack_GetParts( const ScopePack_s* pack, ScopePackParts_s& parts )
+	{
+		uint8_t* p = (uint8_t*)(pack+1);
+		parts.LocationDict = (uint32_t*)p;
+		p += pack->NumLocations * sizeof(uint32_t);
+		parts.FlagsDict = (uint32_t*)p;
+		p += pack->NumFlags * sizeof(uint32_t);
+		p = (uint8_t*)(((size_t)p + 7) & ~(size_t)7);
+		parts.LocationCodes = (uint64_t*)p;
+		p += ScopePack_NumWords( pack->LocationBits ) * sizeof(uint64_t);
+		parts.FlagsCodes = (uint64_t*)p;
+		p += ScopePack_NumWords( pack->FlagsBits ) * sizeof(uint64_t);
+		parts.Time = p;
+	}
 
+	static int NE_CALLBK ScopePack_SortValues( void*, const void* l, const void* r )
+	{
+		const uint32_t lhs = *static_cast<const uint32_t*>(l);
+		const uint32_t rhs = *static_cast<const uint32_t*>(r);
+		if (lhs < rhs)
+			return -1;
+		if (lhs > rhs)
+			return 1;
 		return 0;
 	}
 
-	/// Calculates the tick offset for a given frame number.
-	Tick ParsedData_GotoFrameNumber( const ParsedData_s& data, uint32_t frame_number )
+	/// Stores the distinct values in ascending order and returns their number.
+	static uint32_t ScopePack_MakeDict( const uint32_t* values, uint32_t* dict )
 	{
-		return ParsedData_GotoFrameIndex( data, frame_number - data.FirstFrameNumber() );
+		const SortClient_s sorter = { ScopePack_SortValues, nullptr };
+		Mem_Cpy( dict, values, SCOPE_PACK_SIZE * sizeof(uint32_t) );
+		Sort_Quick( dict, SCOPE_PACK_SIZE, sizeof(uint32_t), sorter );
+		uint32_t count = 1;
+		for ( uint32_t i = 1; i < SCOPE_PACK_SIZE; ++i )
+		{
+			if (dict[i] != dict[count-1])
+				dict[count++] = dict[i];
+		}
+		return count;
 	}
-	
-	/// Calculates the tick offset for the first frame.
-	Tick ParsedData_GotoFirstFrame( const ParsedData_s& data )
+
+	static uint32_t ScopePack_FindCode( const uint32_t* dict, uint32_t count, uint32_t value )
 	{
-		return ParsedData_GotoFrameIndex( data, 0 );
+		uint32_t first = 0;
+		while (count)
+		{
+			const uint32_t half = count / 2;
+			if (dict[ first + half ] < value)
+			{
+				first += half + 1;
+				count -= half + 1;
+			}
+			else
+			{
+				count = half;
+			}
+		}
+		return first;
 	}
 
-	/// Calculates the tick offset for the last frame.
-	Tick ParsedData_GotoLastFrame( const ParsedData_s& data )
+	static void ScopePack_WriteCodes( uint64_t* words, uint32_t bits, const uint32_t* values, const uint32_t* dict, uint32_t count )
 	{
-		return ParsedData_GotoFrameIndex( data, data.Frames.Count-1 );
+		if (!bits)
+			return;
+		Mem_Zero( words, ScopePack_NumWords( bits ) * sizeof(uint64_t) );
+		for ( uint32_t i = 0; i < SCOPE_PACK_SIZE; ++i )
+		{
+			const uint64_t code = ScopePack_FindCode( dict, count, values[i] );
+			const uint32_t bit = i * bits;
+			const uint32_t shift = bit & 63;
+			words[ bit >> 6 ] |= code << shift;
+			if ((shift + bits) > 64)
+				words[ (bit >> 6) + 1 ] |= code >> (64 - shift);
+		}
 	}
 
-	/// Calculates the minimal tick offset.
-	Tick ParsedData_GotoBegin( const ParsedData_s& data )
+	static uint32_t ScopePack_ReadCode( const uint64_t* words, uint32_t bits, uint32_t index )
 	{
-		return ParsedData_GotoFirstFrame( data );
+		if (!bits)
+			return 0;
+		const uint32_t bit = index * bits;
+		const uint32_t shift = bit & 63;
+		uint64_t code = words[ bit >> 6 ] >> shift;
+		if ((shift + bits) > 64)
+			code |= words[ (bit >> 6) + 1 ] << (64 - shift);
+		return (uint32_t)(code & ((1ull << bits) - 1));
 	}
 
-	/// Calculates the tick offset required to right-align the end of the 
-	/// last frame with the view's client rectangle. 
-	Tick ParsedData_GotoEnd( const ParsedData_s& data, Tick ticks_in_view )
+	/// Writes a tick delta as zigzag varint and returns its number of bytes.
+	/// Only counts the bytes if no output is given.
+	static uint32_t ScopePack_PutDelta( uint8_t* out, int64_t delta )
 	{
-		const Tick last_end_tick = FrameTable_LastEndTick( data.Frames);
-		const Tick right_aligned_max = last_end_tick - ticks_in_view;
-		return right_aligned_max;
+		uint64_t value = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+		uint32_t size = 0;
+		do
+		{
+			uint8_t byte = (uint8_t)(value & 0x7f);
+			value >>= 7;
+			if (value)
+				byte |= 0x80;
+			if (out)
+				out[ size ] = byte;
+			++size;
+		}
+		while (value);
+		return size;
 	}
 
-	/// Find the earliest frame containing the given tick.
-	static int BinaryTickToFrame( const ParsedData_s& data, Tick tick )
+	/// Packs a whole segment of scope events.
+	static ScopePack_s* ScopePack_Create( Allocator_t alloc, uint32_t id, const Tick* time, const uint32_t* location, const ScopeFlags_s* flags )
 	{
-		const int pos = Array_BinaryFind<FrameComparer>(data.Frames, tick);
-		return (pos >= 0) ? pos : -1;
+		uint32_t* scratch = Mem_Alloc<uint32_t>( alloc, 3 * SCOPE_PACK_SIZE );
+		uint32_t* location_dict = scratch;
+		uint32_t* flags_dict	= scratch + SCOPE_PACK_SIZE;
+		uint32_t* flags_values	= scratch + SCOPE_PACK_SIZE * 2;
+		Mem_Cpy( flags_values, flags, SCOPE_PACK_SIZE * sizeof(uint32_t) );
+
+		ScopePack_s header;
+		NeZero( header );
+		header.Id			= id;
+		header.FirstTime	= time[0];
+		header.NumLocations	= (uint16_t)ScopePack_MakeDict( location	, location_dict );
+		header.NumFlags		= (uint16_t)ScopePack_MakeDict( flags_values, flags_dict );
+		header.LocationBits	= (uint8_t)ScopePack_NumBits( header.NumLocations );
+		header.FlagsBits	= (uint8_t)ScopePack_NumBits( header.NumFlags );
+
+		size_t time_size = 0;
+		for ( uint32_t i = 0; i < SCOPE_PACK_SIZE; ++i )
+			time_size += ScopePack_PutDelta( nullptr, time[i] - (i ? time[i-1] : header.FirstTime) );
+
+		ScopePackParts_s parts;
+		ScopePack_GetParts( &header, parts );
+		header.Size = (uint32_t)((parts.Time - (uint8_t*)&header) + time_size);
+
+		ScopePack_s* pack = (ScopePack_s*)Mem_Alloc<uint64_t>( alloc, (header.Size + 7) / 8 );
+		*pack = header;
+		ScopePack_GetParts( pack, parts );
+		Mem_Cpy( parts.LocationDict, location_dict, header.NumLocations * sizeof(uint32_t) );
+		Mem_Cpy( parts.FlagsDict   , flags_dict	  , header.NumFlags		* sizeof(uint32_t) );
+		ScopePack_WriteCodes( parts.LocationCodes, header.LocationBits, location	, location_dict, header.NumLocations );
+		ScopePack_WriteCodes( parts.FlagsCodes	 , header.FlagsBits	  , flags_values, flags_dict   , header.NumFlags );
+		uint8_t* out = parts.Time;
+		for ( uint32_t i = 0; i < SCOPE_PACK_SIZE; ++i )
+			out += ScopePack_PutDelta( out, time[i] - (i ? time[i-1] : header.FirstTime) );
+
+		Mem_Free( alloc, scratch );
+		return pack;
 	}
 
-	/// Finds the index of the first frame whose time interval contains the given tick.
-	/// If the tick preceeds the start of the first frame or exceeds the end of the last
-	/// frame the function returns zero or the last frame's index, respectively.
-	int ParsedData_TickToFrameIndex( const ParsedData_s& data, Tick tick )
+	/// Returns the unpacked segment, unpacking it into the least recently used entry if needed.
+	static const ScopeSegment_s& ScopeCache_Get( ScopeCache_s& cache, const ScopePack_s* pack )
 	{
-		if (data.Frames.Count == 0)
-			return 0;
-
-		// before first frame?
-		if (tick <= data.Frames.Data[0].Time.Begin)
-			return 0;
+		++cache.Clock;
+		int slot = 0;
+		for ( int i = 0; i < SCOPE_CACHE_SIZE; ++i )
+		{
+			if ((cache.Pack[i] == pack) && (cache.Id[i] == pack->Id))
+			{
+				cache.Used[i] = cache.Clock;
+				return cache.Item[i];
+			}
+			if (cache.Used[i] < cache.Used[slot])
+				slot = i;
+		}
+		ScopePack_Unpack( pack, cache.Item[ slot ] );
+		cache.Pack[ slot ] = pack;
+		cache.Id  [ slot ] = pack->Id;
+		cache.Used[ slot ] = cache.Clock;
+		return cache.Item[ slot ];
+	}
 
-		// past last frame?
-		const int last_frame_index = data.Frames.Count-1;
-		if (tick >= data.Frames.Data[last_frame_index].Time.End)
-			return last_frame_index;
+} }
 
-		// find the (left-most) frame
-		const int frame_index = BinaryTickToFrame( data, tick );
-		if (frame_index >= 0)
-			return frame_index;
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	void ScopePack_Unpack( const ScopePack_s* pack, ScopeSegment_s& segment )
+	{
+		ScopePackParts_s parts;
+		ScopePack_GetParts( pack, parts );
+		const uint8_t* in = parts.Time;
+		Tick time = pack->FirstTime;
+		for ( uint32_t i = 0; i < SCOPE_PACK_SIZE; ++i )
+		{
+			uint64_t value = 0;
+			uint32_t shift = 0;
+			uint8_t byte = 0;
+			do
+			{
+				byte = *in++;
+				value |= (uint64_t)(byte & 0x7f) << shift;
+				shift += 7;
+			}
+			while (byte & 0x80);
+			time += (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
 
-		NeAssertOut( frame_index >= 0 /*data.Frames.Data[frame_index].Time.Contains( tick )*/, "Binary search failed because there's no frame at the given tick (it's a gap)." );
-		return 0; //LinearTickToFrame( data, tick );
+			const uint32_t flags = parts.FlagsDict[ ScopePack_ReadCode( parts.FlagsCodes, pack->FlagsBits, i ) ];
+			segment.Time[i]		= time;
+			segment.Location[i] = parts.LocationDict[ ScopePack_ReadCode( parts.LocationCodes, pack->LocationBits, i ) ];
+			Mem_Cpy( &segment.Flags[i], &flags, sizeof(flags) );
+		}
 	}
 
 } }
@@ -193,61 +340,147 @@ namespace nemesis { namespace profiling
 //======================================================================================
 namespace nemesis { namespace profiling
 {
-	using namespace viz;
+	static void ParsedScopes_Init( ParsedScopes_s& scopes, Allocator_t alloc )
+	{
+		SegmentArray_Init( scopes.Time	   , alloc );
+		SegmentArray_Init( scopes.Location , alloc );
+		SegmentArray_Init( scopes.Flags	   , alloc );
+		SegmentArray_Init( scopes.FrameEnd , alloc );
+		scopes.Packed.Init( alloc );
+		scopes.PackedSize = 0;
+	}
 
-	struct FrameBatch_s
+	/// Frees the given number of oldest packed segments.
+	static void ParsedScopes_FreePacked( ParsedScopes_s& scopes, int count )
 	{
-		IndexRange Frames;
-	};
+		for ( int i = 0; i < count; ++i )
+		{
+			scopes.PackedSize -= scopes.Packed[i]->Size;
+			Mem_Free( scopes.Packed.Alloc, scopes.Packed[i] );
+		}
+		scopes.Packed.RemoveAt( 0, count );
+	}
 
-	static void FlushBatch( const FrameBatch_s& batch, EnumFrameGroupsFunc func, void* context )
+	static void ParsedScopes_Clear( ParsedScopes_s& scopes )
 	{
-		if (!batch.Frames.Count)
-			return;
+		ParsedScopes_FreePacked( scopes, scopes.Packed.Count );
+		scopes.Packed.Clear();
+		SegmentArray_Clear( scopes.Time );
+		SegmentArray_Clear( scopes.Location );
+		SegmentArray_Clear( scopes.Flags );
+		SegmentArray_Clear( scopes.FrameEnd );
+	}
 
-		const FrameGroup group = 
-		{ batch.Frames 
-		};
-		func( context, group );
+	static void ParsedScopes_Reset( ParsedScopes_s& scopes )
+	{
+		ParsedScopes_FreePacked( scopes, scopes.Packed.Count );
+		SegmentArray_Reset( scopes.Time );
+		SegmentArray_Reset( scopes.Location );
+		SegmentArray_Reset( scopes.Flags );
+		SegmentArray_Reset( scopes.FrameEnd );
 	}
 
-	static void EnumFrameGroupsLod( const ParsedData_s& data, const FrameRange& cull, const FrameGroupSetup& setup, EnumFrameGroupsFunc func, void* context )
+	/// Returns the first item of a frame given the end of the items of each frame.
+	static uint32_t FrameIndex_Begin( const FrameIndexArray_s& ends, uint32_t first, uint32_t end, uint32_t frame_index )
 	{
-		if (!cull.Frames.Count)
-			return;
+		if ((int32_t)(frame_index - ends.First) <= 0)
+			return first;
+		if ((int32_t)(frame_index - ends.End) > 0)
+			return end;
+		return ends[ frame_index-1 ];
+	}
 
-		FrameBatch_s batch = {};
-		batch.Frames.First = cull.Frames.Begin();
+	static viz::ScopeEvent ScopeEvent_Make( Tick time, uint32_t location, const ScopeFlags_s& flags, int thread_index )
+	{
+		const viz::ScopeEvent ev = 
+		{ time
+		, location
+		, (uint8_t)thread_index
+		, flags.Cpu
+		, flags.Type
+		, flags.Enter
+		};
+		return ev;
+	}
 
-		const int frame_end = cull.Frames.End();
-		for ( int frame_index = cull.Frames.Begin(); frame_index < frame_end; ++frame_index )
+	/// Returns a scope event, unpacking its segment through the cache if it is packed.
+	static viz::ScopeEvent ParsedScopes_Get( ScopeCache_s* cache, const ParsedScopes_s& scopes, uint32_t index, int thread_index )
+	{
+		const uint32_t segment = (index - scopes.Time.Base) >> EVENT_SEGMENT_SHIFT;
+		if (segment < (uint32_t)scopes.Packed.Count)
 		{
-			const Frame& frame = data.Frames.Data[ frame_index ];
+			const ScopeSegment_s& unpacked = ScopeCache_Get( *cache, scopes.Packed[ segment ] );
+			const uint32_t offset = index & TickArray_s::SEGMENT_MASK;
+			return ScopeEvent_Make( unpacked.Time[ offset ], unpacked.Location[ offset ], unpacked.Flags[ offset ], thread_index );
+		}
+		return ScopeEvent_Make( scopes.Time[ index ], scopes.Location[ index ], scopes.Flags[ index ], thread_index );
+	}
 
-			// accumulate
-			if (frame.Time.Duration() < setup.MinFrameTicks)
-			{
-				++batch.Frames.Count;
-				continue;
-			}
+	/// Returns the first event the thread recorded in the given frame.
+	/// Frames before the thread's first frame start at its first event.
+	static uint32_t ParsedScopes_FrameBegin( const ParsedScopes_s& scopes, uint32_t frame_index )
+	{
+		return FrameIndex_Begin( scopes.FrameEnd, scopes.Time.First, scopes.Time.End, frame_index );
+	}
 
-			// flush
-			FlushBatch( batch, func, context );
+	/// Marks the end of the thread's events in the given frame.
+	static void ParsedScopes_CloseFrame( ParsedScopes_s& scopes, uint32_t frame_index )
+	{
+		if (!scopes.FrameEnd.Count())
+			SegmentArray_Rebase( scopes.FrameEnd, frame_index );
+		NeAssert(scopes.FrameEnd.End == frame_index);
+		SegmentArray_Append( scopes.FrameEnd, scopes.Time.End );
+	}
 
-			// reset
-			batch.Frames.First = frame_index;
-			batch.Frames.Count = 1;
-		}
+	/// Drops the events recorded before the given frame.
+	static void ParsedScopes_Evict( ParsedScopes_s& scopes, SpillStore_s& spill, uint32_t first_frame )
+	{
+		const FrameIndexArray_s& ends = scopes.FrameEnd;
+		if (!ends.Count() || ((int32_t)(first_frame - ends.First) <= 0))
+			return;
+		const uint32_t first_event = ends[ first_frame-1 ];
+		ParsedScopes_FreePacked( scopes, NeMin( scopes.Packed.Count, (int)((first_event - scopes.Time.Base) >> EVENT_SEGMENT_SHIFT) ) );
+		SegmentArray_ReleaseSpilled( spill, scopes.Time	   , first_event );
+		SegmentArray_ReleaseSpilled( spill, scopes.Location, first_event );
+		SegmentArray_ReleaseSpilled( spill, scopes.Flags   , first_event );
+		SegmentArray_Evict( scopes.Time		, first_event );
+		SegmentArray_Evict( scopes.Location	, first_event );
+		SegmentArray_Evict( scopes.Flags	, first_event );
+		SegmentArray_Evict( scopes.FrameEnd	, first_frame );
+	}
 
-		// flush last batch
-		FlushBatch( batch, func, context );
+	/// Appends the events of another thread and rebases its frame ends.
+	static void ParsedScopes_Append( ParsedScopes_s& dst, const ParsedScopes_s& src, uint32_t frame_index )
+	{
+		const uint32_t offset = dst.Time.End - src.Time.First;
+		SegmentArray_Append( dst.Time	 , src.Time );
+		SegmentArray_Append( dst.Location, src.Location );
+		SegmentArray_Append( dst.Flags	 , src.Flags );
+
+		if (!src.FrameEnd.Count())
+			return;
+		if (!dst.FrameEnd.Count())
+			SegmentArray_Rebase( dst.FrameEnd, frame_index );
+		NeAssert(dst.FrameEnd.End == frame_index);
+		for ( uint32_t i = src.FrameEnd.First; i != src.FrameEnd.End; ++i )
+			SegmentArray_Append( dst.FrameEnd, src.FrameEnd[i] + offset );
 	}
 
-	/// Determines the visible set of frames and their local placement.
-	void ParsedData_EnumFrameGroups( const ParsedData_s& data, const FrameRange& cull, const FrameGroupSetup& setup, EnumFrameGroupsFunc func, void* context )
+	void ParsedScopes_Append( ParsedScopes_s& scopes, const viz::ScopeEvent& ev )
 	{
-		//NePerfScope("cull frames");
-		EnumFrameGroupsLod( data, cull, setup, func, context );
+		const ScopeFlags_s flags = { ev.Cpu, ev.Type, ev.Enter };
+		SegmentArray_Append( scopes.Time	, ev.Time );
+		SegmentArray_Append( scopes.Location, ev.Location );
+		SegmentArray_Append( scopes.Flags	, flags );
+	}
+
+	/// Appends a frame and closes it for every known thread.
+	viz::Frame& ParsedData_AppendFrame( ParsedData_s& data )
+	{
+		const uint32_t frame_index = data.Frames.End;
+		for ( int i = 0; i < data.Threads.Count; ++i )
+			ParsedScopes_CloseFrame( data.Scopes[i], frame_index );
+		return SegmentArray_Append( data.Frames );
 	}
 
 } }
@@ -255,167 +488,1933 @@ namespace nemesis { namespace profiling
 //======================================================================================
 namespace nemesis { namespace profiling
 {
-	using namespace viz;
-
-	struct ZoneBatch_s
+	struct Zone_s
 	{
-		Zone_s Zone;
-		int Count;
+		TickInterval Time;
+		uint32_t Location;
+		uint32_t EnterScope;
+		uint8_t Thread;
+		uint8_t Level;
+		uint8_t Type: 2;
+		uint8_t Cpu0: 6;
+		uint8_t Cpu1: 6;
+		uint8_t Flags: 2;
 	};
 
-	struct ZoneCullInfo_s
+	static Zone_s MakeZone( const ParsedZone_s& item, int thread_index )
 	{
-		TickInterval View;
-		Tick LastFrameEndTick;
-		Tick MinGroupTicks;
-		Tick MinZoneTicks;
-		Tick ThresholdTicks;
-		int MaxZoneLevel;
-	};
+		Zone_s zone;
+		zone.Time = item.Time;
+		zone.Location = item.Location;
+		zone.EnterScope = item.EnterScope;
+		zone.Thread = (uint8_t)thread_index;
+		zone.Level = item.Level;
+		zone.Type = item.Type;
+		zone.Cpu0 = item.Cpu0;
+		zone.Cpu1 = item.Cpu1;
+		zone.Flags = 0;
+		return zone;
+	}
 
-	static void FlushBatch( const ZoneBatch_s& batch, const ZoneCullInfo_s& cull, EnumZoneGroupsFunc func, void* context )
+	static Zone_s MakeZone( const ParsedZoneGroup_s& group, int thread_index )
 	{
-		// handle empty batch
-		if (batch.Count == 0)
-			return;
-
-		//NeAssert( batch.Zone.Thread	>= 0 );
-		NeAssert( batch.Zone.Time.Begin >= 0 );
-		NeAssert( batch.Zone.Time.End   >= 0 );
-		NeAssert( batch.Zone.Time.End   >= batch.Zone.Time.Begin );
+		Zone_s zone;
+		zone.Time = group.Time;
+		zone.Location = group.Location;
+		zone.EnterScope = group.EnterScope;
+		zone.Thread = (uint8_t)thread_index;
+		zone.Level = group.Level;
+		zone.Type = group.Type;
+		zone.Cpu0 = group.Cpu0;
+		zone.Cpu1 = group.Cpu1;
+		zone.Flags = 0;
+		return zone;
+	}
 
-		// cull group
-		if ( batch.Zone.Time.Duration() < cull.MinGroupTicks )
-			return;
+} }
 
-		if ( !batch.Zone.Time.Intersects( cull.View ) )
-			return;
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static void Posting_WriteVarint( Array<uint8_t>& data, uint32_t value )
+	{
+		while (value >= 0x80)
+		{
+			data.Append( (uint8_t)(value | 0x80) );
+			value >>= 7;
+		}
+		data.Append( (uint8_t)value );
+	}
 
-		// output the item
-		const ZoneGroup item = 
-		{ batch.Zone.Time
-		, batch.Zone.Location
-		, batch.Zone.Thread
-		, batch.Zone.Level
-		, batch.Zone.Type
-		, batch.Zone.Cpu0
-		, batch.Zone.Cpu1
-		, batch.Zone.Flags
-		, batch.Zone.EnterScope
-		, (uint32_t)batch.Count
-		};
-		func( context, item );
+	static uint32_t Posting_ReadVarint( const uint8_t* data, uint32_t& pos )
+	{
+		uint32_t value = 0;
+		for ( int shift = 0; ; shift += 7 )
+		{
+			const uint8_t byte = data[ pos++ ];
+			value |= (uint32_t)(byte & 0x7f) << shift;
+			if (!(byte & 0x80))
+				return value;
+		}
 	}
 
-	static void AddZoneToBatch( ZoneBatch_s& batch, const Zone_s& zone, const ParsedData_s& data, const ZoneCullInfo_s& cull, EnumZoneGroupsFunc func, void* context )
+	static void ParsedPostings_Free( Array<PostingList_s>& postings )
 	{
-		// depth-cull zone
-		if ( zone.Level > cull.MaxZoneLevel )
-			return;
+		for ( int i = 0; i < postings.Count; ++i )
+		{
+			postings[i].Data.Clear();
+			postings[i].Block.Clear();
+		}
+	}
 
-		// group zone
-		const Tick zone_duration = zone.Time.Duration();
+	static PostingList_s& ParsedPostings_GetList( Array<PostingList_s>& postings, uint32_t location )
+	{
+		if ((uint32_t)postings.Count <= location)
+		{
+			const int first = postings.Count;
+			postings.Resize( location+1 );
+			for ( int i = first; i < postings.Count; ++i )
+			{
+				postings[i].Data.Init( postings.Alloc );
+				postings[i].Block.Init( postings.Alloc );
+			}
+		}
+		return postings[ location ];
+	}
+
+	/// Appends an occurrence and returns the index of its block.
+	static uint32_t PostingList_Add( PostingList_s& list, uint32_t frame_index, int thread_index, uint32_t zone_offset )
+	{
+		if (!list.Block.Count || (list.Block[ list.Block.Count-1 ].Count == POSTING_BLOCK_SIZE))
+		{
+			PostingBlock_s& block = list.Block.Append();
+			block.Offset = (uint32_t)list.Data.Count;
+			block.Frame = frame_index;
+			block.Count = 0;
+			block.MaxTicks = 0;
+			list.LastFrame = frame_index;
+		}
+
+		Posting_WriteVarint( list.Data, frame_index - list.LastFrame );
+		list.Data.Append( (uint8_t)thread_index );
+		Posting_WriteVarint( list.Data, zone_offset );
+		list.LastFrame = frame_index;
+		++list.Block[ list.Block.Count-1 ].Count;
+		return list.BlockBase + list.Block.Count-1;
+	}
+
+	static void PostingList_SetTicks( PostingList_s& list, uint32_t block_index, Tick ticks )
+	{
+		const uint32_t index = block_index - list.BlockBase;
+		if (index >= (uint32_t)list.Block.Count)
+			return;
+		PostingBlock_s& block = list.Block[ index ];
+		block.MaxTicks = NeMax( block.MaxTicks, ticks );
+	}
+
+	/// Drops the blocks whose occurrences all lie before the given frame.
+	static void PostingList_Evict( PostingList_s& list, uint32_t first_frame )
+	{
+		int num_blocks = 0;
+		while (num_blocks < list.Block.Count)
+		{
+			const uint32_t last_frame = (num_blocks+1 < list.Block.Count) ? list.Block[ num_blocks+1 ].Frame : list.LastFrame;
+			if ((int32_t)(first_frame - last_frame) <= 0)
+				break;
+			++num_blocks;
+		}
+		if (!num_blocks)
+			return;
+
+		list.Block.RemoveAt( 0, num_blocks );
+		list.BlockBase += num_blocks;
+
+		// compact the data once most of it is unused
+		const uint32_t unused = list.Block.Count ? list.Block[0].Offset : (uint32_t)list.Data.Count;
+		if (!unused || (2*unused < (uint32_t)list.Data.Count))
+			return;
+		list.Data.RemoveAt( 0, (int)unused );
+		for ( int i = 0; i < list.Block.Count; ++i )
+			list.Block[i].Offset -= unused;
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static void CounterSummary_Merge( CounterSummary_s& dst, const CounterSummary_s& src )
+	{
+		if (!dst.Count)
+		{
+			dst = src;
+			return;
+		}
+		dst.Time.Begin = NeMin( dst.Time.Begin, src.Time.Begin );
+		dst.Time.End   = NeMax( dst.Time.End  , src.Time.End   );
+		dst.Min		   = NeMin( dst.Min, src.Min );
+		dst.Max		   = NeMax( dst.Max, src.Max );
+		dst.Sum		  += src.Sum;
+		dst.Count	  += src.Count;
+	}
+
+	static void CounterSummary_Make( CounterSummary_s& dst, Tick time, float value )
+	{
+		dst.Time.Begin = dst.Time.End = time;
+		dst.Min = dst.Max = value;
+		dst.Sum = value;
+		dst.Count = 1;
+		dst._pad_ = 0;
+	}
+
+	static void ParsedCounters_Free( Array<CounterColumn_s>& columns )
+	{
+		for ( int i = 0; i < columns.Count; ++i )
+		{
+			SegmentArray_Clear( columns[i].Time );
+			SegmentArray_Clear( columns[i].Value );
+			for ( int j = 0; j < NUM_COUNTER_LEVELS; ++j )
+				SegmentArray_Clear( columns[i].Level[j] );
+		}
+	}
+
+	static CounterColumn_s& ParsedCounters_GetColumn( Array<CounterColumn_s>& columns, uint32_t series )
+	{
+		if (columns.Count <= (int)series)
+		{
+			const int first = columns.Count;
+			columns.Resize( series+1 );
+			for ( int i = first; i < columns.Count; ++i )
+			{
+				SegmentArray_Init( columns[i].Time , columns.Alloc );
+				SegmentArray_Init( columns[i].Value, columns.Alloc );
+				for ( int j = 0; j < NUM_COUNTER_LEVELS; ++j )
+					SegmentArray_Init( columns[i].Level[j], columns.Alloc );
+			}
+		}
+		return columns[ series ];
+	}
+
+	/// Returns the index of the first sample at or after the given tick.
+	uint32_t CounterColumn_LowerBound( const CounterColumn_s& column, Tick tick )
+	{
+		uint32_t first = column.Time.First;
+		uint32_t count = column.Time.Count();
+		while (count)
+		{
+			const uint32_t half = count / 2;
+			if (column.Time[ first + half ] < tick)
+			{
+				first += half + 1;
+				count -= half + 1;
+			}
+			else
+			{
+				count = half;
+			}
+		}
+		return first;
+	}
+
+	/// Summarizes the available children of the level entry which ends at the given index.
+	static void CounterColumn_Summarize( CounterColumn_s& column, int level, uint32_t index )
+	{
+		CounterSummary_s summary = {};
+		const uint32_t first = index << COUNTER_LEVEL_SHIFT;
+		const uint32_t end = first + (1 << COUNTER_LEVEL_SHIFT);
+		if (level == 0)
+		{
+			for ( uint32_t i = first; i != end; ++i )
+			{
+				if ((i - column.Time.First) >= column.Time.Count())
+					continue;
+				CounterSummary_s sample;
+				CounterSummary_Make( sample, column.Time[i], column.Value[i] );
+				CounterSummary_Merge( summary, sample );
+			}
+		}
+		else
+		{
+			const CounterSummaryArray_s& children = column.Level[ level-1 ];
+			for ( uint32_t i = first; i != end; ++i )
+			{
+				if ((i - children.First) < children.Count())
+					CounterSummary_Merge( summary, children[i] );
+			}
+		}
+
+		CounterSummaryArray_s& items = column.Level[ level ];
+		if (!items.Count() || (items.End != index))
+			SegmentArray_Rebase( items, index );
+		SegmentArray_Append( items, summary );
+	}
+
+	static void CounterColumn_Append( CounterColumn_s& column, Tick time, float value )
+	{
+		SegmentArray_Append( column.Time , time  );
+		SegmentArray_Append( column.Value, value );
+
+		const uint32_t mask = (1 << COUNTER_LEVEL_SHIFT) - 1;
+		uint32_t end = column.Time.End;
+		for ( int i = 0; (i < NUM_COUNTER_LEVELS) && !(end & mask); ++i )
+		{
+			end >>= COUNTER_LEVEL_SHIFT;
+			CounterColumn_Summarize( column, i, end-1 );
+		}
+	}
+
+	/// Drops the samples taken before the given tick.
+	static void CounterColumn_Evict( CounterColumn_s& column, Tick tick )
+	{
+		uint32_t first = CounterColumn_LowerBound( column, tick );
+		SegmentArray_Evict( column.Time , first );
+		SegmentArray_Evict( column.Value, first );
+		for ( int i = 0; i < NUM_COUNTER_LEVELS; ++i )
+		{
+			CounterSummaryArray_s& items = column.Level[i];
+			first >>= COUNTER_LEVEL_SHIFT;
+			if ((int32_t)(first - items.First) > 0)
+				SegmentArray_Evict( items, ((first - items.First) < items.Count()) ? first : items.End );
+		}
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static void ParsedLocks_Free( Array<LockIndex_s>& locks )
+	{
+		for ( int i = 0; i < locks.Count; ++i )
+			locks[i].Event.Clear();
+	}
+
+	static LockIndex_s& ParsedLocks_GetIndex( Array<LockIndex_s>& locks, uint32_t lock_index )
+	{
+		if (locks.Count <= (int)lock_index)
+		{
+			const int first = locks.Count;
+			locks.Resize( lock_index+1 );
+			for ( int i = first; i < locks.Count; ++i )
+				locks[i].Event.Init( locks.Alloc );
+		}
+		return locks[ lock_index ];
+	}
+
+	/// Appends an event and moves it before the later events of the same frame.
+	static void LockIndex_Add( LockIndex_s& index, const LockEventArray_s& events, uint32_t frame_first_event, uint32_t event_index )
+	{
+		const Tick tick = events[ event_index ].Tick;
+		int pos = index.Event.Count;
+		index.Event.Append( event_index );
+		for ( ; pos > index.First; --pos )
+		{
+			const uint32_t prev = index.Event[ pos-1 ];
+			if (((int32_t)(prev - frame_first_event) < 0) || (events[ prev ].Tick <= tick))
+				break;
+			index.Event[ pos ] = prev;
+		}
+		index.Event[ pos ] = event_index;
+	}
+
+	/// Drops the events before the given event index.
+	static void LockIndex_Evict( LockIndex_s& index, uint32_t first_event )
+	{
+		while ((index.First < index.Event.Count) && ((int32_t)(index.Event[ index.First ] - first_event) < 0))
+			++index.First;
+
+		// compact once most of it is unused
+		if (!index.First || (2*index.First < index.Event.Count))
+			return;
+		index.Event.RemoveAt( 0, index.First );
+		index.First = 0;
+	}
+
+	/// Returns the position of the first event at or after the given event index.
+	static int LockIndex_LowerBound( const LockIndex_s& index, uint32_t event_index )
+	{
+		int first = index.First;
+		int count = index.Event.Count - index.First;
+		while (count > 0)
+		{
+			const int half = count / 2;
+			if ((int32_t)(index.Event[ first + half ] - event_index) < 0)
+			{
+				first += half + 1;
+				count -= half + 1;
+			}
+			else
+			{
+				count = half;
+			}
+		}
+		return first;
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static void ParsedHotSpots_Init( ParsedHotSpots_s& spots, Allocator_t alloc )
+	{
+		SegmentArray_Init( spots.Item	  , alloc );
+		SegmentArray_Init( spots.FrameEnd , alloc );
+		SegmentArray_Init( spots.Sums	  , alloc );
+		spots.Total.Init( alloc );
+		spots.Open.Init( alloc );
+		spots.Touched.Init( alloc );
+	}
+
+	static void ParsedHotSpots_FreeSums( ParsedHotSpots_s& spots, uint32_t end )
+	{
+		for ( uint32_t i = spots.Sums.First; i != end; ++i )
+			Mem_Free( spots.Total.Alloc, spots.Sums[i].Item );
+	}
+
+	static void ParsedHotSpots_Clear( ParsedHotSpots_s& spots )
+	{
+		ParsedHotSpots_FreeSums( spots, spots.Sums.End );
+		SegmentArray_Clear( spots.Item );
+		SegmentArray_Clear( spots.FrameEnd );
+		SegmentArray_Clear( spots.Sums );
+		spots.Total.Clear();
+		spots.Open.Clear();
+		spots.Touched.Clear();
+	}
+
+	static void ParsedHotSpots_Reset( ParsedHotSpots_s& spots )
+	{
+		ParsedHotSpots_FreeSums( spots, spots.Sums.End );
+		SegmentArray_Reset( spots.Item );
+		SegmentArray_Reset( spots.FrameEnd );
+		SegmentArray_Reset( spots.Sums );
+		spots.Total.Reset();
+		spots.Open.Reset();
+		spots.Touched.Reset();
+	}
+
+	/// Stores the current totals as the sums of all frames before the next one.
+	static void ParsedHotSpots_AddSums( ParsedHotSpots_s& spots )
+	{
+		HotSpotSums_s& sums = SegmentArray_Append( spots.Sums );
+		sums.Count = (uint32_t)spots.Total.Count;
+		sums.Item = sums.Count ? Mem_Alloc<ParsedHotSpot_s>( spots.Total.Alloc, spots.Total.Count ) : nullptr;
+		if (sums.Count)
+			Arr_Cpy( sums.Item, spots.Total.Data, (int)sums.Count );
+	}
+
+	/// Starts aggregating at the given frame.
+	static void ParsedHotSpots_Rebase( ParsedHotSpots_s& spots, uint32_t frame_index )
+	{
+		SegmentArray_Rebase( spots.FrameEnd, frame_index );
+		SegmentArray_Rebase( spots.Sums, (frame_index + HOTSPOT_SUM_STRIDE - 1) >> HOTSPOT_SUM_SHIFT );
+		if ((frame_index & (HOTSPOT_SUM_STRIDE-1)) == 0)
+			ParsedHotSpots_AddSums( spots );
+	}
+
+	static void ParsedHotSpots_Add( ParsedHotSpots_s& spots, uint32_t location, Tick inclusive_ticks, Tick exclusive_ticks )
+	{
+		if (location == UNKNOWN_LOCATION)
+			return;
+		if ((uint32_t)spots.Open.Count <= location)
+			spots.Open.Resize( location+1 );
+
+		ParsedHotSpot_s& spot = spots.Open[ location ];
+		if (!spot.NumCalls)
+			spots.Touched.Append( location );
+
+		spot.Location = location;
+		spot.NumCalls += 1;
+		spot.InclusiveTicks += inclusive_ticks;
+		spot.ExclusiveTicks += exclusive_ticks;
+	}
+
+	/// Moves the locations touched in the current frame to the frame's run and adds them to the totals.
+	static void ParsedHotSpots_CloseFrame( ParsedHotSpots_s& spots )
+	{
+		if (spots.Total.Count < spots.Open.Count)
+			spots.Total.Resize( spots.Open.Count );
+
+		for ( int i = 0; i < spots.Touched.Count; ++i )
+		{
+			ParsedHotSpot_s& spot = spots.Open[ spots.Touched[i] ];
+			ParsedHotSpot_s& total = spots.Total[ spots.Touched[i] ];
+			SegmentArray_Append( spots.Item, spot );
+			total.Location = spot.Location;
+			total.NumCalls += spot.NumCalls;
+			total.InclusiveTicks += spot.InclusiveTicks;
+			total.ExclusiveTicks += spot.ExclusiveTicks;
+			NeZero( spot );
+		}
+		spots.Touched.Reset();
+
+		SegmentArray_Append( spots.FrameEnd, spots.Item.End );
+		if ((spots.FrameEnd.End & (HOTSPOT_SUM_STRIDE-1)) == 0)
+			ParsedHotSpots_AddSums( spots );
+	}
+
+	static void ParsedHotSpots_Evict( ParsedHotSpots_s& spots, uint32_t first_frame )
+	{
+		const FrameIndexArray_s& ends = spots.FrameEnd;
+		if (!ends.Count() || ((int32_t)(first_frame - ends.First) <= 0))
+			return;
+		SegmentArray_Evict( spots.Item	  , ends[ first_frame-1 ] );
+		SegmentArray_Evict( spots.FrameEnd, first_frame );
+
+		const uint32_t first_sums = (first_frame + HOTSPOT_SUM_STRIDE - 1) >> HOTSPOT_SUM_SHIFT;
+		if ((int32_t)(first_sums - spots.Sums.First) <= 0)
+			return;
+		ParsedHotSpots_FreeSums( spots, first_sums );
+		SegmentArray_Evict( spots.Sums, first_sums );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static void ParsedZoneLod_Init( ParsedZoneLod_s& lod, Allocator_t alloc, Tick max_ticks )
+	{
+		SegmentArray_Init( lod.Item	   , alloc );
+		SegmentArray_Init( lod.FrameEnd , alloc );
+		lod.Open.Init( alloc );
+		lod.MaxTicks = max_ticks;
+	}
+
+	static void ParsedZoneLod_Clear( ParsedZoneLod_s& lod )
+	{
+		SegmentArray_Clear( lod.Item );
+		SegmentArray_Clear( lod.FrameEnd );
+		lod.Open.Clear();
+	}
+
+	static void ParsedZoneLod_Reset( ParsedZoneLod_s& lod )
+	{
+		SegmentArray_Reset( lod.Item );
+		SegmentArray_Reset( lod.FrameEnd );
+		lod.Open.Reset();
+	}
+
+	static uint32_t ParsedZoneLod_FrameBegin( const ParsedZoneLod_s& lod, uint32_t frame_index )
+	{
+		return FrameIndex_Begin( lod.FrameEnd, lod.Item.First, lod.Item.End, frame_index );
+	}
+
+	static void ParsedZoneLod_Flush( ParsedZoneLod_s& lod, int level )
+	{
+		ParsedZoneGroup_s& group = lod.Open[ level ];
+		if (!group.NumZones)
+			return;
+		SegmentArray_Append( lod.Item, group );
+		group.NumZones = 0;
+	}
+
+	/// Merges a closed zone into the open group of its level.
+	/// Zones of the same level are closed in time order, so the groups only ever grow at the end.
+	/// Like AddZoneToBatch only neighbours of the same location are merged.
+	static void ParsedZoneLod_Add( ParsedZoneLod_s& lod, const ParsedZone_s& zone )
+	{
+		const int level = zone.Level;
+		if (lod.Open.Count <= level)
+			lod.Open.Resize( level+1 );
+
+		ParsedZoneGroup_s& group = lod.Open[ level ];
+		const bool is_tiny = (zone.Time.Duration() < lod.MaxTicks);
+		const bool is_same = group.NumZones && (group.Location == zone.Location);
+		if ( is_tiny && is_same && ((zone.Time.Begin - group.Time.End) < lod.MaxTicks) )
+		{
+			group.Time.End = zone.Time.End;
+			group.Cpu1 = zone.Cpu1;
+			++group.NumZones;
+			return;
+		}
+
+		ParsedZoneLod_Flush( lod, level );
+
+		const ParsedZoneGroup_s item = 
+		{ zone.Time
+		, zone.Location
+		, zone.EnterScope
+		, 1
+		, zone.Level
+		, zone.Type
+		, zone.Cpu0
+		, zone.Cpu1
+		};
+		if (is_tiny)
+			group = item;
+		else
+			SegmentArray_Append( lod.Item, item );
+	}
+
+	static void ParsedZoneLod_CloseFrame( ParsedZoneLod_s& lod )
+	{
+		for ( int i = 0; i < lod.Open.Count; ++i )
+			ParsedZoneLod_Flush( lod, i );
+		SegmentArray_Append( lod.FrameEnd, lod.Item.End );
+	}
+
+	static void ParsedZoneLod_Evict( ParsedZoneLod_s& lod, uint32_t first_frame )
+	{
+		const FrameIndexArray_s& ends = lod.FrameEnd;
+		if (!ends.Count() || ((int32_t)(first_frame - ends.First) <= 0))
+			return;
+		SegmentArray_Evict( lod.Item	, ends[ first_frame-1 ] );
+		SegmentArray_Evict( lod.FrameEnd, first_frame );
+	}
+
+	static void ParsedZoneLod_UnitTest( Allocator_t alloc )
+	{
+	#if UNIT_TEST_ZONES
+		ParsedZoneLod_s lod;
+		ParsedZoneLod_Init( lod, alloc, 100 );
+
+		// test 1: tiny zones of two interleaved locations stay apart
+		const ParsedZone_s interleaved[] = 
+		{ { {  0, 10 }, 10, 1 }
+		, { { 12, 20 },  8, 2 }
+		, { { 22, 30 },  8, 1 }
+		, { { 32, 40 },  8, 2 }
+		};
+		for ( int i = 0; i < NeCountOf(interleaved); ++i )
+			ParsedZoneLod_Add( lod, interleaved[i] );
+		ParsedZoneLod_CloseFrame( lod );
+		NeAssert(lod.Item.Count() == 4);
+		for ( uint32_t i = 0; i < lod.Item.Count(); ++i )
+		{
+			NeAssert(lod.Item[i].NumZones == 1);
+			NeAssert(lod.Item[i].Location == interleaved[i].Location);
+		}
+
+		// test 2: tiny zones of one location are merged
+		ParsedZoneLod_Clear( lod );
+		ParsedZoneLod_Init( lod, alloc, 100 );
+		const ParsedZone_s repeated[] = 
+		{ { {  0, 10 }, 10, 1 }
+		, { { 12, 20 },  8, 1 }
+		, { { 22, 30 },  8, 1 }
+		};
+		for ( int i = 0; i < NeCountOf(repeated); ++i )
+			ParsedZoneLod_Add( lod, repeated[i] );
+		ParsedZoneLod_CloseFrame( lod );
+		NeAssert(lod.Item.Count() == 1);
+		NeAssert(lod.Item[0].NumZones == 3);
+		NeAssert((lod.Item[0].Time.Begin == 0) && (lod.Item[0].Time.End == 30));
+
+		ParsedZoneLod_Clear( lod );
+	#else
+		NeUnused(alloc);
+	#endif
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static void ParsedZones_Init( ParsedZones_s& zones, Allocator_t alloc )
+	{
+		SegmentArray_Init( zones.Item	  , alloc );
+		SegmentArray_Init( zones.FrameEnd , alloc );
+		for ( int i = 0; i < NUM_ZONE_LODS; ++i )
+			ParsedZoneLod_Init( zones.Lod[i], alloc, Tick(1) << (ZONE_LOD_BASE_SHIFT + ZONE_LOD_STEP_SHIFT*i) );
+		zones.NextEvent = 0;
+		zones.Depth = 0;
+		zones.Skipped = 0;
+	}
+
+	static void ParsedZones_Clear( ParsedZones_s& zones )
+	{
+		SegmentArray_Clear( zones.Item );
+		SegmentArray_Clear( zones.FrameEnd );
+		for ( int i = 0; i < NUM_ZONE_LODS; ++i )
+			ParsedZoneLod_Clear( zones.Lod[i] );
+		zones.NextEvent = 0;
+		zones.Depth = 0;
+		zones.Skipped = 0;
+	}
+
+	static void ParsedZones_Reset( ParsedZones_s& zones )
+	{
+		SegmentArray_Reset( zones.Item );
+		SegmentArray_Reset( zones.FrameEnd );
+		for ( int i = 0; i < NUM_ZONE_LODS; ++i )
+			ParsedZoneLod_Reset( zones.Lod[i] );
+		zones.NextEvent = 0;
+		zones.Depth = 0;
+		zones.Skipped = 0;
+	}
+
+	/// Returns the first zone the thread entered in the given frame.
+	uint32_t ParsedZones_FrameBegin( const ParsedZones_s& zones, uint32_t frame_index )
+	{
+		return FrameIndex_Begin( zones.FrameEnd, zones.Item.First, zones.Item.End, frame_index );
+	}
+
+	static void ParsedZones_Enter( ParsedData_s& data, ParsedZones_s& zones, int thread_index, uint32_t frame_index, const viz::ScopeEvent& ev, uint32_t event_index )
+	{
+		if (zones.Depth == MAX_ZONE_DEPTH)
+		{
+			++zones.Skipped;
+			return;
+		}
+
+		OpenZone_s& open = zones.Stack[ zones.Depth ];
+		open.Index = zones.Item.End;
+		open.Location = ev.Location;
+		open.Block = 0;
+		if (ev.Location != UNKNOWN_LOCATION)
+			open.Block = PostingList_Add( ParsedPostings_GetList( data.Postings, ev.Location ), frame_index, thread_index, zones.Item.End - ParsedZones_FrameBegin( zones, frame_index ) );
+		open.Type = ev.Type;
+		open.Begin = ev.Time;
+		open.ChildTicks = 0;
+
+		ParsedZone_s& zone = SegmentArray_Append( zones.Item );
+		zone.Time.Begin = ev.Time;
+		zone.Time.End = ev.Time;
+		zone.SelfTicks = 0;
+		zone.Location = ev.Location;
+		zone.Parent = zones.Depth ? zones.Stack[ zones.Depth-1 ].Index : INVALID_ZONE;
+		zone.EnterScope = event_index;
+		zone.Level = (uint8_t)zones.Depth;
+		zone.Type = ev.Type;
+		zone.Open = 1;
+		zone.Cpu0 = ev.Cpu;
+		zone.Cpu1 = ev.Cpu;
+		++zones.Depth;
+	}
+
+	static void ParsedZones_Leave( ParsedData_s& data, ParsedZones_s& zones, const viz::ScopeEvent& ev )
+	{
+		if (zones.Skipped)
+		{
+			--zones.Skipped;
+			return;
+		}
+		if (!zones.Depth)
+			return;
+
+		const OpenZone_s& open = zones.Stack[ --zones.Depth ];
+		const Tick duration = ev.Time - open.Begin;
+		if (zones.Depth)
+			zones.Stack[ zones.Depth-1 ].ChildTicks += duration;
+
+		ParsedStats_Add( data.Stats, open.Location, duration );
+		if (open.Location != UNKNOWN_LOCATION)
+			PostingList_SetTicks( data.Postings[ open.Location ], open.Block, duration );
+
+		// count recursive calls once towards the inclusive time, leave events carry no type
+		if (open.Type != ScopeType::Idle)
+		{
+			Tick inclusive_ticks = duration;
+			for ( uint32_t i = 0; i < zones.Depth; ++i )
+			{
+				if (zones.Stack[i].Location == open.Location)
+				{
+					inclusive_ticks = 0;
+					break;
+				}
+			}
+			ParsedHotSpots_Add( data.HotSpots, open.Location, inclusive_ticks, duration - open.ChildTicks );
+		}
+
+		// the zone may have been evicted while it was open
+		if ((open.Index - zones.Item.First) >= zones.Item.Count())
+			return;
+
+		ParsedZone_s& zone = zones.Item[ open.Index ];
+		zone.Time.End = ev.Time;
+		zone.SelfTicks = duration - open.ChildTicks;
+		zone.Cpu1 = ev.Cpu;
+		zone.Open = 0;
+
+		for ( int i = 0; i < NUM_ZONE_LODS; ++i )
+			ParsedZoneLod_Add( zones.Lod[i], zone );
+	}
+
+	/// Pairs the thread's scope events of the given frame.
+	static void ParsedZones_Build( ParsedData_s& data, int thread_index, uint32_t frame_index )
+	{
+		ParsedZones_s& zones = data.Zones[ thread_index ];
+		const ParsedScopes_s& scopes = data.Scopes[ thread_index ];
+
+		if (!zones.FrameEnd.Count())
+		{
+			SegmentArray_Rebase( zones.FrameEnd, frame_index );
+			for ( int i = 0; i < NUM_ZONE_LODS; ++i )
+				SegmentArray_Rebase( zones.Lod[i].FrameEnd, frame_index );
+			zones.NextEvent = ParsedScopes_FrameBegin( scopes, frame_index );
+		}
+		NeAssert(zones.FrameEnd.End == frame_index);
+
+		const uint32_t event_end = scopes.FrameEnd[ frame_index ];
+		for ( ; zones.NextEvent != event_end; ++zones.NextEvent )
+		{
+			const viz::ScopeEvent ev = ParsedScopes_Get( data.ScopeCache, scopes, zones.NextEvent, thread_index );
+			if (ev.Enter)
+				ParsedZones_Enter( data, zones, thread_index, frame_index, ev, zones.NextEvent );
+			else
+				ParsedZones_Leave( data, zones, ev );
+		}
+		SegmentArray_Append( zones.FrameEnd, zones.Item.End );
+		for ( int i = 0; i < NUM_ZONE_LODS; ++i )
+			ParsedZoneLod_CloseFrame( zones.Lod[i] );
+	}
+
+	/// Drops the zones entered before the given frame.
+	static void ParsedZones_Evict( ParsedZones_s& zones, SpillStore_s& spill, uint32_t first_frame )
+	{
+		const FrameIndexArray_s& ends = zones.FrameEnd;
+		if (!ends.Count() || ((int32_t)(first_frame - ends.First) <= 0))
+			return;
+		SegmentArray_ReleaseSpilled( spill, zones.Item, ends[ first_frame-1 ] );
+		SegmentArray_Evict( zones.Item	  , ends[ first_frame-1 ] );
+		SegmentArray_Evict( zones.FrameEnd, first_frame );
+		for ( int i = 0; i < NUM_ZONE_LODS; ++i )
+			ParsedZoneLod_Evict( zones.Lod[i], first_frame );
+	}
+
+	static void ParsedData_BuildCounters( ParsedData_s& data, uint32_t frame_index )
+	{
+		const viz::Frame& frame = data.Frames[ frame_index ];
+		for ( uint32_t i = 0; i < frame.NumCounterValues; ++i )
+		{
+			const viz::CounterValue& value = data.CounterValues[ frame.FirstCounterValue + i ];
+			CounterColumn_Append( ParsedCounters_GetColumn( data.CounterColumns, value.Series ), frame.Time.End, value.Value );
+		}
+	}
+
+	static void ParsedData_BuildLocks( ParsedData_s& data, uint32_t frame_index )
+	{
+		const viz::Frame& frame = data.Frames[ frame_index ];
+		for ( uint32_t i = 0; i < frame.NumLockEvents; ++i )
+		{
+			const uint32_t event_index = frame.FirstLockEvent + i;
+			LockIndex_s& index = ParsedLocks_GetIndex( data.LockIndex, data.LockEvents[ event_index ].Lock );
+			LockIndex_Add( index, data.LockEvents, frame.FirstLockEvent, event_index );
+		}
+	}
+
+	/// Sums up the heap bytes held by all columns and tables.
+	/// The result is kept in Size and adjusted when segments are packed or spilled.
+	static size_t ParsedData_MeasureSize( const ParsedData_s& data )
+	{
+		size_t scopes_size = 0;
+		for ( int i = 0; i < data.Threads.Count; ++i )
+			scopes_size += ParsedScopes_GetSize( data.Scopes[i] ) + ParsedZones_GetSize( data.Zones[i] );
+
+		return sizeof(data)
+			+ scopes_size
+			+ ParsedHotSpots_GetSize( data.HotSpots )
+			+ ParsedStats_GetSize( data.Stats )
+			+ ParsedPostings_GetSize( data.Postings )
+			+ ParsedCounters_GetSize( data.CounterColumns )
+			+ ParsedLocks_GetSize( data.LockIndex )
+			+ SegmentArray_GetSize( data.Frames )
+			+ SegmentArray_GetSize( data.LockEvents )
+			+ SegmentArray_GetSize( data.CounterValues )
+			+ SegmentArray_GetSize( data.LogItems )
+			+ Array_GetCountSize( data.Locks )
+			+ Array_GetCountSize( data.Counters )
+			+ Array_GetCountSize( data.CounterGroups )
+			+ Array_GetCountSize( data.Locations );
+	}
+
+	static void ParsedData_BuildFrames( ParsedData_s& data )
+	{
+		ParsedHotSpots_s& spots = data.HotSpots;
+		if (!spots.FrameEnd.Count())
+			ParsedHotSpots_Rebase( spots, data.Frames.First );
+
+		for ( uint32_t frame_index = spots.FrameEnd.End; frame_index != data.Frames.End; ++frame_index )
+		{
+			for ( int i = 0; i < data.Threads.Count; ++i )
+			{
+				const FrameIndexArray_s& frames = data.Scopes[i].FrameEnd;
+				if ((frame_index - frames.First) < frames.Count())
+					ParsedZones_Build( data, i, frame_index );
+			}
+			ParsedHotSpots_CloseFrame( spots );
+			ParsedStats_CloseFrame( data.Stats, frame_index );
+			ParsedData_BuildCounters( data, frame_index );
+			ParsedData_BuildLocks( data, frame_index );
+		}
+	}
+
+	/// Builds zones, hot spots, counter columns and lock indices from the frames added since the last call.
+	void ParsedData_BuildIndices( ParsedData_s& data )
+	{
+		if (data.Frames.Count())
+			ParsedData_BuildFrames( data );
+		data.Size = ParsedData_MeasureSize( data );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	using namespace viz;
+
+	namespace
+	{
+		// @note: fails when there are gaps in between frames
+		struct FrameComparer
+		{
+			static int Compare( const Frame& frame, Tick tick )
+			{
+				if ( tick < frame.Time.Begin )
+					return 1;
+				if ( tick >= frame.Time.End )
+					return -1;
+				return 0;
+			}
+		};
+	}
+
+	/// Calculates the tick offset for a given frame index
+	Tick ParsedData_GotoFrameIndex( const ParsedData_s& data, int frame_index )
+	{
+		if ( (frame_index >= 0) && (frame_index < data.NumFrames()) )
+			return data.GetFrame( frame_index ).Time.Begin;
+
+		if ( data.NumFrames() )
+			return data.GetFrame( 0 ).Time.Begin;
+
+		return 0;
+	}
+
+	/// Calculates the tick offset for a given frame number.
+	Tick ParsedData_GotoFrameNumber( const ParsedData_s& data, uint32_t frame_number )
+	{
+		return ParsedData_GotoFrameIndex( data, frame_number - data.FirstFrameNumber() );
+	}
+	
+	/// Calculates the tick offset for the first frame.
+	Tick ParsedData_GotoFirstFrame( const ParsedData_s& data )
+	{
+		return ParsedData_GotoFrameIndex( data, 0 );
+	}
+
+	/// Calculates the tick offset for the last frame.
+	Tick ParsedData_GotoLastFrame( const ParsedData_s& data )
+	{
+		return ParsedData_GotoFrameIndex( data, data.NumFrames()-1 );
+	}
+
+	/// Calculates the minimal tick offset.
+	Tick ParsedData_GotoBegin( const ParsedData_s& data )
+	{
+		return ParsedData_GotoFirstFrame( data );
+	}
+
+	/// Calculates the tick offset required to right-align the end of the 
+	/// last frame with the view's client rectangle. 
+	Tick ParsedData_GotoEnd( const ParsedData_s& data, Tick ticks_in_view )
+	{
+		const Tick last_end_tick = FrameTable_LastEndTick( data.Frames);
+		const Tick right_aligned_max = last_end_tick - ticks_in_view;
+		return right_aligned_max;
+	}
+
+	/// Find the earliest frame containing the given tick.
+	static int BinaryTickToFrame( const ParsedData_s& data, Tick tick )
+	{
+		int lo = 0;
+		int hi = data.NumFrames()-1;
+		while (lo <= hi)
+		{
+			const int mid = (lo + hi) / 2;
+			const int cmp = FrameComparer::Compare( data.GetFrame( mid ), tick );
+			if (cmp == 0)
+				return mid;
+			if (cmp < 0)
+				lo = mid + 1;
+			else
+				hi = mid - 1;
+		}
+		return -1;
+	}
+
+	/// Finds the index of the first frame whose time interval contains the given tick.
+	/// If the tick preceeds the start of the first frame or exceeds the end of the last
+	/// frame the function returns zero or the last frame's index, respectively.
+	int ParsedData_TickToFrameIndex( const ParsedData_s& data, Tick tick )
+	{
+		if (data.NumFrames() == 0)
+			return 0;
+
+		// before first frame?
+		if (tick <= data.GetFrame( 0 ).Time.Begin)
+			return 0;
+
+		// past last frame?
+		const int last_frame_index = data.NumFrames()-1;
+		if (tick >= data.GetFrame( last_frame_index ).Time.End)
+			return last_frame_index;
+
+		// find the (left-most) frame
+		const int frame_index = BinaryTickToFrame( data, tick );
+		if (frame_index >= 0)
+			return frame_index;
+
+		NeAssertOut( frame_index >= 0 /*data.Frames.Data[frame_index].Time.Contains( tick )*/, "Binary search failed because there's no frame at the given tick (it's a gap)." );
+		return 0; //LinearTickToFrame( data, tick );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	using namespace viz;
+
+	struct FrameBatch_s
+	{
+		IndexRange Frames;
+	};
+
+	static void FlushBatch( const FrameBatch_s& batch, EnumFrameGroupsFunc func, void* context )
+	{
+		if (!batch.Frames.Count)
+			return;
+
+		const FrameGroup group = 
+		{ batch.Frames 
+		};
+		func( context, group );
+	}
+
+	static void EnumFrameGroupsLod( const ParsedData_s& data, const FrameRange& cull, const FrameGroupSetup& setup, EnumFrameGroupsFunc func, void* context )
+	{
+		if (!cull.Frames.Count)
+			return;
+
+		FrameBatch_s batch = {};
+		batch.Frames.First = cull.Frames.Begin();
+
+		const int frame_end = cull.Frames.End();
+		for ( int frame_index = cull.Frames.Begin(); frame_index < frame_end; ++frame_index )
+		{
+			const Frame& frame = data.GetFrame( frame_index );
+
+			// accumulate
+			if (frame.Time.Duration() < setup.MinFrameTicks)
+			{
+				++batch.Frames.Count;
+				continue;
+			}
+
+			// flush
+			FlushBatch( batch, func, context );
+
+			// reset
+			batch.Frames.First = frame_index;
+			batch.Frames.Count = 1;
+		}
+
+		// flush last batch
+		FlushBatch( batch, func, context );
+	}
+
+	/// Determines the visible set of frames and their local placement.
+	void ParsedData_EnumFrameGroups( const ParsedData_s& data, const FrameRange& cull, const FrameGroupSetup& setup, EnumFrameGroupsFunc func, void* context )
+	{
+		//NePerfScope("cull frames");
+		EnumFrameGroupsLod( data, cull, setup, func, context );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	using namespace viz;
+
+	struct ZoneBatch_s
+	{
+		Zone_s Zone;
+		int Count;
+	};
+
+	struct ZoneCullInfo_s
+	{
+		TickInterval View;
+		Tick LastFrameEndTick;
+		Tick MinGroupTicks;
+		Tick MinZoneTicks;
+		Tick ThresholdTicks;
+		int MaxZoneLevel;
+	};
+
+	static void FlushBatch( const ZoneBatch_s& batch, const ZoneCullInfo_s& cull, EnumZoneGroupsFunc func, void* context )
+	{
+		// handle empty batch
+		if (batch.Count == 0)
+			return;
+
+		//NeAssert( batch.Zone.Thread	>= 0 );
+		NeAssert( batch.Zone.Time.Begin >= 0 );
+		NeAssert( batch.Zone.Time.End   >= 0 );
+		NeAssert( batch.Zone.Time.End   >= batch.Zone.Time.Begin );
+
+		// cull group
+		if ( batch.Zone.Time.Duration() < cull.MinGroupTicks )
+			return;
+
+		if ( !batch.Zone.Time.Intersects( cull.View ) )
+			return;
+
+		// output the item
+		const ZoneGroup item = 
+		{ batch.Zone.Time
+		, batch.Zone.Location
+		, batch.Zone.Thread
+		, batch.Zone.Level
+		, batch.Zone.Type
+		, batch.Zone.Cpu0
+		, batch.Zone.Cpu1
+		, batch.Zone.Flags
+		, batch.Zone.EnterScope
+		, (uint32_t)batch.Count
+		};
+		func( context, item );
+	}
+
+	static void AddZoneToBatch( ZoneBatch_s& batch, const Zone_s& zone, int num_zones, const ParsedData_s& data, const ZoneCullInfo_s& cull, EnumZoneGroupsFunc func, void* context )
+	{
+		// depth-cull zone
+		if ( zone.Level > cull.MaxZoneLevel )
+			return;
+
+		// group zone
+		const Tick zone_duration = zone.Time.Duration();
 		const bool is_open = (batch.Count > 0);
 		const bool is_tiny = (zone_duration < cull.MinZoneTicks);
 		const bool is_same = (batch.Zone.Location == zone.Location) && (batch.Zone.Level == zone.Level);
 
-		// accumulate zones
-		if ( is_tiny && is_same && is_open )
+		// accumulate zones
+		if ( is_tiny && is_same && is_open )
+		{
+			const Tick gap_ticks = zone.Time.Begin - batch.Zone.Time.End;
+			const bool is_near = gap_ticks < cull.ThresholdTicks;
+			if (is_near)
+			{
+				if (zone.Time.Begin < batch.Zone.Time.Begin) batch.Zone.Time.Begin = zone.Time.Begin;
+				if (zone.Time.End   > batch.Zone.Time.End)	 batch.Zone.Time.End   = zone.Time.End;
+				batch.Count += num_zones;
+				return;
+			}
+		}
+
+		// flush current batch
+		FlushBatch( batch, cull, func, context );
+
+		// begin batch
+		batch.Zone = zone;
+		batch.Count = num_zones;
+	}
+
+	static void EnumZoneGroupsLod( const ParsedData_s& data, const FrameRange& cull, const ZoneGroupSetup& setup, int thread_index, EnumZoneGroupsFunc func, void* context )
+	{
+		if (!cull.Frames.Count)
+			return;
+
+		// setup constants
+		const int frame_end = NeMin(cull.Frames.End()+2, data.NumFrames());
+		const Tick last_end_tick = data.GetFrame( frame_end-1 ).Time.End;
+
+		const ZoneCullInfo_s zone_cull = 
+		{ cull.Time
+		, last_end_tick
+		, setup.MinGroupTicks
+		, setup.MinZoneTicks
+		, setup.MaxGroupSpacingTicks
+		, setup.MaxZoneLevel
+		};
+
+		// thread data
+		const ParsedZones_s& zones = data.Zones[ thread_index ];
+
+		// pick the coarsest level of detail that only merges zones too short to be drawn on their own,
+		// and whose gaps are within the group spacing
+		const ParsedZoneLod_s* lod = nullptr;
+		for ( int i = 0; i < NUM_ZONE_LODS; ++i )
+		{
+			if ((zones.Lod[i].MaxTicks <= setup.MinGroupTicks) && (zones.Lod[i].MaxTicks <= setup.MaxGroupSpacingTicks))
+				lod = &zones.Lod[i];
+		}
+
+		// init batch
+		const ZoneBatch_s empty_batch = {};
+		ZoneBatch_s batch = empty_batch;
+
+		// cull frames
+		for ( int frame_index = cull.Frames.First; frame_index < frame_end; ++frame_index )
+		{
+			// cull frame
+			const Frame& frame = data.GetFrame( frame_index );
+			if (frame.Time.Duration() < setup.MinFrameTicks)
+				continue;
+
+			// cull groups
+			const uint32_t frame_abs = data.Frames.First + frame_index;
+			if (lod)
+			{
+				const uint32_t end = ParsedZoneLod_FrameBegin( *lod, frame_abs+1 );
+				for ( uint32_t i = ParsedZoneLod_FrameBegin( *lod, frame_abs ); i != end; ++i )
+				{
+					const ParsedZoneGroup_s& group = lod->Item[i];
+					AddZoneToBatch( batch, MakeZone( group, thread_index ), group.NumZones, data, zone_cull, func, context );
+				}
+				continue;
+			}
+
+			// cull zones
+			{
+				const uint32_t end = ParsedZones_FrameBegin( zones, frame_abs+1 );
+				for ( uint32_t i = ParsedZones_FrameBegin( zones, frame_abs ); i != end; ++i )
+				{
+					const ParsedZone_s& zone = zones.Item[i];
+					if (zone.Open)
+						continue;
+					AddZoneToBatch( batch, MakeZone( zone, thread_index ), 1, data, zone_cull, func, context );
+				}
+			}
+		}
+
+		FlushBatch( batch, zone_cull, func, context );
+	}
+
+	/// Enumerates the visible set of zones and their local placement.
+	void ParsedData_EnumZoneGroups( const ParsedData_s& data, const FrameRange& cull, const ZoneGroupSetup& setup, int thread_index, EnumZoneGroupsFunc func, void* context )
+	{
+		//NePerfScope("cull zones");
+		if (!data.NumFrames())
+			return;
+		EnumZoneGroupsLod( data, cull, setup, thread_index, func, context );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	using namespace viz;
+
+	struct CpuBatch_s
+	{
+		TickInterval Time;
+		uint32_t NumEvents;
+		uint8_t Thread;
+		uint8_t Level;
+		uint8_t Cpu;
+		uint8_t Cpu2;
+		uint8_t Initialized;
+		uint8_t _pad_[3];
+	};
+
+	static void FlushBatch( const CpuBatch_s& batch, EnumCpuGroupsFunc func, void* context )
+	{
+		if (!batch.NumEvents)
+			return;
+
+		const CpuGroup group = 
+		{ batch.Time
+		, batch.Thread
+		, batch.Cpu
+		, batch.Cpu2
+		};
+		func( context, group );
+	}
+
+	static void ParseEvent( CpuBatch_s& batch, const ScopeEvent& ev, EnumCpuGroupsFunc func, void* context )
+	{
+		if (!batch.Initialized)
+		{
+			if (!ev.Enter)
+				return;
+			batch.Time.Begin = ev.Time;
+			batch.Time.End = ev.Time;
+			batch.NumEvents = 1;
+			batch.Thread = ev.Thread;
+			batch.Cpu = ev.Cpu;
+			batch.Cpu2 = ev.Cpu;
+			batch.Initialized = true;
+			batch.Level = 1;
+			return;
+		}
+
+		NeAssert(batch.Thread == ev.Thread);
+		if (batch.Cpu != ev.Cpu)
 		{
-			const Tick gap_ticks = zone.Time.Begin - batch.Zone.Time.End;
-			const bool is_near = gap_ticks < cull.ThresholdTicks;
-			if (is_near)
+			// flush the 'old cpu' batch
+			FlushBatch( batch, func, context );
+
+			// fill in and immediately flush the
+			// 'switch between cpus' batch
+			batch.Time.Begin = batch.Time.End;
+			batch.Time.End = ev.Time;
+			batch.Cpu2 = ev.Cpu;
+			batch.NumEvents = 1;
+			FlushBatch( batch, func, context );
+
+			// begin the 'new cpu' batch
+			batch.Cpu = ev.Cpu;
+			batch.Time.Begin = ev.Time;
+			batch.NumEvents = ev.Enter ? 1 : 0;
+			batch.Level += (ev.Enter ? 1 : -1);
+			return;
+		}
+
+		batch.Time.End = ev.Time;
+		batch.Level += (ev.Enter ? 1 : -1);
+		++batch.NumEvents;
+
+		if (ev.Enter)
+		{
+			if (1 == batch.NumEvents)
+				batch.Time.Begin = ev.Time;
+			return;
+		}
+
+		if (batch.Level > 0)
+			return;
+
+		FlushBatch( batch, func, context );
+		batch.NumEvents = 0;
+	}
+
+	void ParsedData_EnumCpuGroups( const ParsedData_s& data, const FrameRange& cull, const CpuGroupSetup& setup, int thread_index, EnumCpuGroupsFunc func, void* context )
+	{
+		CpuBatch_s batch;
+		NeZero( batch );
+
+		// the thread's events are contiguous across frames
+		const ParsedScopes_s& scopes = data.Scopes[ thread_index ];
+		const uint32_t event_end = ParsedScopes_FrameBegin( scopes, data.Frames.First + cull.Frames.End() );
+		for ( uint32_t event_index = ParsedScopes_FrameBegin( scopes, data.Frames.First + cull.Frames.First ); event_index != event_end; ++event_index )
+		{
+			const ScopeEvent ev = ParsedScopes_Get( data.ScopeCache, scopes, event_index, thread_index );
+			ParseEvent( batch, ev, func, context );
+		}
+
+		batch.Time.End = cull.Time.End;
+		FlushBatch( batch, func, context );
+	}
+
+	/// Returns the location of a scope event, or -1 if the event isn't retained.
+	int ParsedData_GetScopeLocation( const ParsedData_s& data, int thread_index, uint32_t event_index )
+	{
+		if ((thread_index < 0) || (thread_index >= data.Threads.Count))
+			return -1;
+		const ParsedScopes_s& scopes = data.Scopes[ thread_index ];
+		if ((event_index - scopes.Time.First) >= scopes.Time.Count())
+			return -1;
+		return (int)ParsedScopes_Get( data.ScopeCache, scopes, event_index, thread_index ).Location;
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	using namespace viz;
+
+	/// Returns the range of lock events recorded in the given frames.
+	/// Fails if none of the frames have been parsed.
+	static bool ParsedData_GetLockEvents( const ParsedData_s& data, const IndexRange& frames, uint32_t& first_event, uint32_t& end_event )
+	{
+		const int first = NeMax( 0, frames.First );
+		const int end = NeMin( data.NumFrames(), frames.End() );
+		if (first >= end)
+			return false;
+		const Frame& last = data.GetFrame( end-1 );
+		first_event = data.GetFrame( first ).FirstLockEvent;
+		end_event = last.FirstLockEvent + last.NumLockEvents;
+		return true;
+	}
+
+	/// Enumerates the events of a lock in time order, or of all locks if the index is negative.
+	void ParsedData_EnumLockEvents( const ParsedData_s& data, int lock_index, int first_frame, int num_frames, EnumLockEventFunc func, void* context )
+	{
+		if (lock_index >= 0)
+		{
+			const IndexRange frames = { first_frame, num_frames };
+			uint32_t first_event, end_event;
+			if ((lock_index >= data.LockIndex.Count) || !ParsedData_GetLockEvents( data, frames, first_event, end_event ))
+				return;
+			const LockIndex_s& index = data.LockIndex[ lock_index ];
+			for ( int i = LockIndex_LowerBound( index, first_event ); i < index.Event.Count; ++i )
 			{
-				if (zone.Time.Begin < batch.Zone.Time.Begin) batch.Zone.Time.Begin = zone.Time.Begin;
-				if (zone.Time.End   > batch.Zone.Time.End)	 batch.Zone.Time.End   = zone.Time.End;
-				++batch.Count;
+				const uint32_t event_index = index.Event[i];
+				if ((int32_t)(event_index - end_event) >= 0)
+					break;
+				func( context, data.LockEvents[ event_index ], (int)event_index );
+			}
+			return;
+		}
+
+		const int frame_end = first_frame + num_frames;
+		for ( int frame_index = first_frame; frame_index < frame_end; ++frame_index )
+		{
+			const Frame& frame = data.GetFrame( frame_index );
+			const uint32_t event_end = frame.FirstLockEvent + frame.NumLockEvents;
+			for ( uint32_t event_index = frame.FirstLockEvent; event_index != event_end; ++event_index )
+				func( context, data.LockEvents[ event_index ], (int)event_index );
+		}
+	}
+
+	static void LockStats_AddWaiter( LockStats& stats, int thread_index, Tick wait_ticks, uint32_t num_waits )
+	{
+		int pos = (int)stats.NumWaiters;
+		if (pos == LockStats::MAX_WAITERS)
+		{
+			if (stats.Waiters[ pos-1 ].WaitTicks >= wait_ticks)
 				return;
+			--pos;
+		}
+		else
+		{
+			++stats.NumWaiters;
+		}
+		for ( ; (pos > 0) && (stats.Waiters[ pos-1 ].WaitTicks < wait_ticks); --pos )
+			stats.Waiters[ pos ] = stats.Waiters[ pos-1 ];
+
+		LockWaiter& waiter = stats.Waiters[ pos ];
+		NeZero( waiter );
+		waiter.WaitTicks = wait_ticks;
+		waiter.NumWaits = num_waits;
+		waiter.Thread = (uint8_t)thread_index;
+	}
+
+	/// Replays the events of a lock in time order.
+	/// A thread acquires the lock when it entered it and the previous owner left it.
+	static void LockIndex_GetStats( const ParsedData_s& data, const LockIndex_s& index, uint32_t first_event, uint32_t end_event, LockStats& stats )
+	{
+		Tick	 wait_ticks[ MAX_NUM_THREADS ] = {};
+		uint32_t num_waits [ MAX_NUM_THREADS ] = {};
+		Tick	 request   [ MAX_NUM_THREADS ] = {};
+		bool	 pending   [ MAX_NUM_THREADS ] = {};
+		uint32_t num_pending = 0;
+		bool has_release = false;
+		Tick release = 0;
+
+		NeZero( stats );
+		for ( int i = LockIndex_LowerBound( index, first_event ); i < index.Event.Count; ++i )
+		{
+			const uint32_t event_index = index.Event[i];
+			if ((int32_t)(event_index - end_event) >= 0)
+				break;
+
+			const LockEvent& ev = data.LockEvents[ event_index ];
+			const int thread = ev.Thread;
+			if (ev.Enter)
+			{
+				if (num_pending)
+					++stats.NumContended;
+				if (!pending[ thread ])
+					++num_pending;
+				pending[ thread ] = true;
+				request[ thread ] = ev.Tick;
+				stats.MaxWaiters = NeMax( stats.MaxWaiters, num_pending-1 );
+				continue;
 			}
+
+			// match the release with its enter, locks entered before the range have none
+			if (pending[ thread ])
+			{
+				const Tick acquire = NeMin( ev.Tick, has_release ? NeMax( request[ thread ], release ) : request[ thread ] );
+				const Tick wait = acquire - request[ thread ];
+				stats.WaitTicks += wait;
+				stats.HoldTicks += ev.Tick - acquire;
+				++stats.NumAcquires;
+				if (wait > 0)
+				{
+					wait_ticks[ thread ] += wait;
+					++num_waits[ thread ];
+				}
+				pending[ thread ] = false;
+				--num_pending;
+			}
+			has_release = true;
+			release = ev.Tick;
 		}
 
-		// flush current batch
-		FlushBatch( batch, cull, func, context );
+		for ( int i = 0; i < MAX_NUM_THREADS; ++i )
+		{
+			if (wait_ticks[i] > 0)
+				LockStats_AddWaiter( stats, i, wait_ticks[i], num_waits[i] );
+		}
+	}
 
-		// begin batch
-		batch.Zone = zone;
-		batch.Count = 1;
+	/// Calculates wait and hold times of a lock within the given frames.
+	bool ParsedData_GetLockStats( const ParsedData_s& data, uint32_t lock_index, const IndexRange& frames, LockStats& stats )
+	{
+		NeZero( stats );
+		uint32_t first_event, end_event;
+		if (((int)lock_index >= data.LockIndex.Count) || !ParsedData_GetLockEvents( data, frames, first_event, end_event ))
+			return false;
+		LockIndex_GetStats( data, data.LockIndex[ lock_index ], first_event, end_event, stats );
+		return stats.NumAcquires > 0;
+	}
+
+	/// Returns the locks with the longest wait times within the given frames, longest first.
+	int ParsedData_GetContendedLocks( const ParsedData_s& data, const IndexRange& frames, int* locks, LockStats* stats, int max_items )
+	{
+		uint32_t first_event, end_event;
+		if ((max_items <= 0) || !ParsedData_GetLockEvents( data, frames, first_event, end_event ))
+			return 0;
+
+		int num_items = 0;
+		LockStats item;
+		for ( int i = 0; i < data.LockIndex.Count; ++i )
+		{
+			LockIndex_GetStats( data, data.LockIndex[i], first_event, end_event, item );
+			if (!item.WaitTicks)
+				continue;
+
+			int pos = num_items;
+			if (pos == max_items)
+			{
+				if (stats[ pos-1 ].WaitTicks >= item.WaitTicks)
+					continue;
+				--pos;
+			}
+			else
+			{
+				++num_items;
+			}
+			for ( ; (pos > 0) && (stats[ pos-1 ].WaitTicks < item.WaitTicks); --pos )
+			{
+				locks[ pos ] = locks[ pos-1 ];
+				stats[ pos ] = stats[ pos-1 ];
+			}
+			locks[ pos ] = i;
+			stats[ pos ] = item;
+		}
+		return num_items;
 	}
 
-	static void FlushOpenZones( ZoneStack_s& stack, ZoneBatch_s& batch, const ParsedData_s& data, const ZoneCullInfo_s& cull, EnumZoneGroupsFunc func, void* context )
+	static void AddHotSpots( HotSpotGroup& group, const ParsedHotSpot_s* item, uint32_t count, int sign )
 	{
-		while (stack.NumItems)
+		for ( uint32_t i = 0; i < count; ++i )
 		{
-			const int index = --stack.NumItems;
-			Zone_s& zone = stack.Item[index];
-			zone.Time.End = cull.LastFrameEndTick;
-			AddZoneToBatch( batch, zone, data, cull, func, context );
+			const ParsedHotSpot_s& src = item[i];
+			HotSpot& dst = group.Data[ src.Location ];
+			dst.NumSamples	 += sign * src.NumCalls;
+			dst.Duration	 += sign * src.InclusiveTicks;
+			dst.SelfDuration += sign * src.ExclusiveTicks;
 		}
 	}
 
-	static void EnumZoneGroupsLod( const ParsedData_s& data, const FrameRange& cull, const ZoneGroupSetup& setup, int thread_index, EnumZoneGroupsFunc func, void* context )
+	static void AddHotSpots( HotSpotGroup& group, const ParsedHotSpots_s& spots, uint32_t first_frame, uint32_t end_frame )
 	{
-		if (!cull.Frames.Count)
+		const uint32_t end = FrameIndex_Begin( spots.FrameEnd, spots.Item.First, spots.Item.End, end_frame );
+		for ( uint32_t i = FrameIndex_Begin( spots.FrameEnd, spots.Item.First, spots.Item.End, first_frame ); i != end; ++i )
+			AddHotSpots( group, &spots.Item[i], 1, 1 );
+	}
+
+	static int NE_CALLBK SortHotSpots( void*, const void* l, const void* r )
+	{
+		const HotSpot& lhs = *static_cast<const HotSpot*>(l);
+		const HotSpot& rhs = *static_cast<const HotSpot*>(r);
+		if (lhs.Duration > rhs.Duration)
+			return -1;
+		if (lhs.Duration < rhs.Duration)
+			return 1;
+		return 0;
+	}
+
+	/// Builds hots spots for a given range for frames.
+	/// The totals of whole strides of frames come from the sums, only the frames at the edges are visited.
+	void ParsedData_BuildHotSpots( const ParsedData_s& data, const HotSpotRange& range, HotSpotGroup& group )
+	{
+		const ParsedHotSpots_s& spots = data.HotSpots;
+
+		// reset data
+		group.Data.Resize( spots.Total.Count );
+		for ( int i = 0; i < group.Data.Count; ++i )
+			NeZero( group.Data[i] );
+
+		// clip range to the aggregated frames
+		uint32_t first_frame = data.Frames.First + range.FirstFrame;
+		uint32_t end_frame = first_frame + range.NumFrames;
+		if ((int32_t)(first_frame - spots.FrameEnd.First) < 0)
+			first_frame = spots.FrameEnd.First;
+		if ((int32_t)(end_frame - spots.FrameEnd.End) > 0)
+			end_frame = spots.FrameEnd.End;
+
+		// build data
+		if ((int32_t)(end_frame - first_frame) > 0)
+		{
+			const uint32_t first_sums = (first_frame + HOTSPOT_SUM_STRIDE - 1) >> HOTSPOT_SUM_SHIFT;
+			const uint32_t last_sums = end_frame >> HOTSPOT_SUM_SHIFT;
+			const bool has_sums 
+				=  ((int32_t)(last_sums - first_sums) > 0)
+				&& ((first_sums - spots.Sums.First) < spots.Sums.Count())
+				&& ((last_sums  - spots.Sums.First) < spots.Sums.Count());
+			if (has_sums)
+			{
+				const HotSpotSums_s& sums_0 = spots.Sums[ first_sums ];
+				const HotSpotSums_s& sums_1 = spots.Sums[ last_sums ];
+				AddHotSpots( group, sums_1.Item, sums_1.Count,  1 );
+				AddHotSpots( group, sums_0.Item, sums_0.Count, -1 );
+				AddHotSpots( group, spots, first_frame, first_sums << HOTSPOT_SUM_SHIFT );
+				AddHotSpots( group, spots, last_sums << HOTSPOT_SUM_SHIFT, end_frame );
+			}
+			else
+			{
+				AddHotSpots( group, spots, first_frame, end_frame );
+			}
+		}
+
+		// remove locations without samples
+		int count = 0;
+		for ( int i = 0; i < group.Data.Count; ++i )
+		{
+			if (!group.Data[i].NumSamples)
+				continue;
+			group.Data[count] = group.Data[i];
+			group.Data[count].Location = (uint32_t)i;
+			++count;
+		}
+		group.Data.Resize( count );
+
+		// sort hot-spots
+		const SortClient_s sorter = { SortHotSpots, nullptr };
+		Sort_Quick( group.Data.Data, group.Data.Count, sizeof(group.Data.Data[0]), sorter );
+		if ((range.NumHotSpotsPerFrame > 0) && (group.Data.Count > range.NumHotSpotsPerFrame))
+			group.Data.Resize( range.NumHotSpotsPerFrame );
+	}
+
+	/// Adds the zones of a thread which were left in the given frames, the frame the chunk statistics count them in.
+	/// The events are paired like ParsedZones_Build does. The zones open when the first frame begins
+	/// are the last zone entered before it and its parents, minus those left in between.
+	static void AddZoneStats( const ParsedData_s& data, int thread_index, uint32_t location, uint32_t first_frame, uint32_t end_frame, StatsAccum_s& accum )
+	{
+		const ParsedScopes_s& scopes = data.Scopes[ thread_index ];
+		const ParsedZones_s& zones = data.Zones[ thread_index ];
+		const uint32_t event_first = ParsedScopes_FrameBegin( scopes, first_frame );
+		const uint32_t event_end = ParsedScopes_FrameBegin( scopes, end_frame );
+		uint32_t next_zone = ParsedZones_FrameBegin( zones, first_frame );
+		uint32_t event_index = event_first;
+
+		uint32_t stack[ MAX_ZONE_DEPTH ];
+		uint32_t depth = 0;
+		uint32_t skipped = 0;
+		if ((next_zone != zones.Item.First) && ((int32_t)(zones.Item[ next_zone-1 ].EnterScope - scopes.Time.First) >= 0))
+		{
+			uint32_t chain[ MAX_ZONE_DEPTH ];
+			for ( uint32_t i = next_zone-1; ((i - zones.Item.First) < zones.Item.Count()) && (depth < MAX_ZONE_DEPTH); i = zones.Item[i].Parent )
+				chain[ depth++ ] = i;
+			for ( uint32_t i = 0; i < depth; ++i )
+				stack[i] = chain[ depth-1-i ];
+			event_index = zones.Item[ next_zone-1 ].EnterScope + 1;
+		}
+
+		for ( ; event_index != event_end; ++event_index )
+		{
+			const viz::ScopeEvent ev = ParsedScopes_Get( data.ScopeCache, scopes, event_index, thread_index );
+			if (ev.Enter)
+			{
+				if ((depth < MAX_ZONE_DEPTH) && (next_zone != zones.Item.End) && (zones.Item[ next_zone ].EnterScope == event_index))
+					stack[ depth++ ] = next_zone++;
+				else
+					++skipped;
+				continue;
+			}
+			if (skipped)
+			{
+				--skipped;
+				continue;
+			}
+			if (!depth)
+				continue;
+
+			const ParsedZone_s& zone = zones.Item[ stack[ --depth ] ];
+			if (((int32_t)(event_index - event_first) >= 0) && (zone.Location == location) && !zone.Open)
+				StatsAccum_Add( accum, zone.Time.Duration() );
+		}
+	}
+
+	static void AddZoneStats( const ParsedData_s& data, uint32_t location, uint32_t first_frame, uint32_t end_frame, StatsAccum_s& accum )
+	{
+		if (first_frame == end_frame)
 			return;
+		for ( int i = 0; i < data.Threads.Count; ++i )
+			AddZoneStats( data, i, location, first_frame, end_frame, accum );
+	}
 
-		// setup constants
-		const int frame_end = NeMin(cull.Frames.End()+2, data.Frames.Count);
-		const Tick last_end_tick = data.Frames.Data[ frame_end-1 ].Time.End;
+	/// Computes the duration statistics of a location over a range of frames.
+	/// Whole chunks come from the aggregated statistics, only the zones of the frames around them are visited.
+	bool ParsedData_GetLocationStats( const ParsedData_s& data, uint32_t location, const IndexRange& frames, LocationStats& stats )
+	{
+		uint32_t bins[ NUM_STATS_BUCKETS ] = {};
+		StatsAccum_s accum = {};
+		accum.Bins = bins;
+
+		// clip range to the retained frames
+		const int first = NeMax( 0, frames.First );
+		const int end = NeMin( data.NumFrames(), frames.End() );
+		if (first < end)
+		{
+			const uint32_t first_frame = data.Frames.First + first;
+			const uint32_t end_frame = data.Frames.First + end;
+			uint32_t chunk_first = 0;
+			uint32_t chunk_end = 0;
+			ParsedStats_Gather( data.Stats, location, first_frame, end_frame, accum, chunk_first, chunk_end );
+			AddZoneStats( data, location, first_frame, chunk_first, accum );
+			AddZoneStats( data, location, chunk_end, end_frame, accum );
+		}
 
-		const ZoneCullInfo_s zone_cull = 
-		{ cull.Time
-		, last_end_tick
-		, setup.MinGroupTicks
-		, setup.MinZoneTicks
-		, setup.MaxGroupSpacingTicks
-		, setup.MaxZoneLevel
-		};
+		StatsAccum_GetResult( accum, stats );
+		return stats.Count > 0;
+	}
 
-		// init batch
-		const ZoneBatch_s empty_batch = {};
-		ZoneBatch_s batch = empty_batch;
-		ZoneStack_s stack = {};
+} }
 
-		// cull frames
-		for ( int frame_index = cull.Frames.First; frame_index < frame_end; ++frame_index )
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	using namespace viz;
+
+	/// Zones of a single thread within a segment and, when grouping by frame, within a single frame.
+	struct ZoneMorsel_s
+	{
+		uint32_t	First;
+		uint32_t	Count;
+		uint32_t	Key;
+		uint8_t		Thread;
+		uint8_t		_pad_[3];
+	};
+
+	struct ZoneQuery_s
+	{
+		const ParsedData_s*		Data;
+		ZoneQuery				Query;
+		uint32_t				Location;
+		uint32_t				MaxLevel;
+		uint32_t				NumKeys;
+		uint32_t				_pad_;
+		Array<ZoneMorsel_s>		Morsels;
+		Array<ZoneQueryRow>		Rows;		///< NumKeys rows per slot
+	};
+
+	static uint32_t ZoneQuery_GetNumKeys( const ParsedData_s& data, const ZoneQuery& query, const IndexRange& frames )
+	{
+		switch (query.GroupBy)
 		{
-			// cull frame
-			const Frame& frame = data.Frames.Data[ frame_index ];
-			if (frame.Time.Duration() < setup.MinFrameTicks)
+		case ZoneQuery::Group::Location:	return (uint32_t)data.Locations.Count + 1;	// last key for unknown locations
+		case ZoneQuery::Group::Thread:		return MAX_NUM_THREADS;
+		case ZoneQuery::Group::Level:		return 256;
+		case ZoneQuery::Group::Frame:		return (uint32_t)frames.Count;
+		default:							return 0;
+		}
+	}
+
+	/// Splits the zones of a thread at segment boundaries.
+	static void ZoneQuery_AddMorsels( ZoneQuery_s& q, uint8_t thread, uint32_t first, uint32_t end, uint32_t key )
+	{
+		while (first != end)
+		{
+			const uint32_t in_segment = ZoneArray_s::SEGMENT_SIZE - (first & ZoneArray_s::SEGMENT_MASK);
+			const ZoneMorsel_s morsel = { first, NeMin( end - first, in_segment ), key, thread };
+			q.Morsels.Append( morsel );
+			first += morsel.Count;
+		}
+	}
+
+	/// Filters the zones of a morsel into a selection vector and aggregates the selected ones.
+	/// Both loops are free of data dependent branches.
+	static void ZoneQuery_RunMorsel( void* context, int slot, int morsel_index )
+	{
+		const ZoneQuery_s& q = *(const ZoneQuery_s*)context;
+		const ZoneMorsel_s& morsel = q.Morsels[ morsel_index ];
+		const ParsedZone_s* zones = &q.Data->Zones[ morsel.Thread ].Item[ morsel.First ];
+		ZoneQueryRow* rows = q.Rows.Data + slot * q.NumKeys;
+
+		uint16_t selected[ ZoneArray_s::SEGMENT_SIZE ];
+		uint32_t num_selected = 0;
+		for ( uint32_t i = 0; i < morsel.Count; ++i )
+		{
+			const ParsedZone_s& zone = zones[i];
+			const Tick duration = zone.Time.End - zone.Time.Begin;
+			selected[ num_selected ] = (uint16_t)i;
+			num_selected += (uint32_t)
+				( (duration >= q.Query.MinDuration)
+				& (zone.Level >= q.Query.MinLevel)
+				& (zone.Level <= q.MaxLevel)
+				& ((zone.Location == q.Location) | (q.Location == ~0u))
+				& (zone.Open == 0) );
+		}
+
+		for ( uint32_t i = 0; i < num_selected; ++i )
+		{
+			const ParsedZone_s& zone = zones[ selected[i] ];
+			const Tick duration = zone.Time.End - zone.Time.Begin;
+			uint32_t key = morsel.Key;
+			if (q.Query.GroupBy == ZoneQuery::Group::Location)
+				key = (zone.Location != UNKNOWN_LOCATION) ? zone.Location : q.NumKeys-1;
+			else if (q.Query.GroupBy == ZoneQuery::Group::Level)
+				key = zone.Level;
+			NeAssert(key < q.NumKeys);
+
+			ZoneQueryRow& row = rows[ key ];
+			row.NumZones   += 1;
+			row.TotalTicks += duration;
+			row.SelfTicks  += zone.SelfTicks;
+			row.MinTicks	= NeMin( row.MinTicks, duration );
+			row.MaxTicks	= NeMax( row.MaxTicks, duration );
+		}
+	}
+
+	static void ZoneQuery_Merge( ZoneQueryRow& dst, const ZoneQueryRow& src )
+	{
+		dst.NumZones   += src.NumZones;
+		dst.TotalTicks += src.TotalTicks;
+		dst.SelfTicks  += src.SelfTicks;
+		dst.MinTicks	= NeMin( dst.MinTicks, src.MinTicks );
+		dst.MaxTicks	= NeMax( dst.MaxTicks, src.MaxTicks );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	using namespace viz;
+
+	/// Aggregates the zones selected by a query per group.
+	/// Fills the groups with the longest total time in descending order and returns their number.
+	/// Large queries are split into morsels which run on the query workers.
+	int ParsedData_QueryZones( const ParsedData_s& data, QueryPool_s& pool, const ZoneQuery& query, ZoneQueryRow* rows, int max_rows )
+	{
+		const int first_frame = NeMax( query.Frames.First, 0 );
+		const int end_frame	  = NeMin( query.Frames.End(), data.NumFrames() );
+		if ((max_rows <= 0) || (first_frame >= end_frame))
+			return 0;
+		const IndexRange frames = { first_frame, end_frame - first_frame };
+
+		Allocator_t alloc = data.Frames.Segment.Alloc;
+		ZoneQuery_s q;
+		q.Data	   = &data;
+		q.Query	   = query;
+		q.Location = (query.Location < 0) ? ~0u : (uint32_t)query.Location;
+		q.MaxLevel = query.MaxLevel ? query.MaxLevel : 255;
+		q.NumKeys  = ZoneQuery_GetNumKeys( data, query, frames );
+		q.Morsels.Init( alloc );
+		q.Rows.Init( alloc );
+		if (!q.NumKeys)
+			return 0;
+
+		// split the zones of the selected threads
+		uint32_t num_zones = 0;
+		const uint32_t frame_begin = data.Frames.First + (uint32_t)frames.First;
+		const uint32_t frame_end   = data.Frames.First + (uint32_t)frames.End();
+		for ( int i = 0; i < data.Threads.Count; ++i )
+		{
+			if (query.Threads && !(query.Threads & (1ull << i)))
+				continue;
+			const ParsedZones_s& zones = data.Zones[i];
+			if (query.GroupBy == ZoneQuery::Group::Frame)
+			{
+				for ( uint32_t f = frame_begin; f != frame_end; ++f )
+					ZoneQuery_AddMorsels( q, (uint8_t)i, ParsedZones_FrameBegin( zones, f ), ParsedZones_FrameBegin( zones, f+1 ), f - frame_begin );
+			}
+			else
 			{
-				stack.NumItems = 0;
+				ZoneQuery_AddMorsels( q, (uint8_t)i, ParsedZones_FrameBegin( zones, frame_begin ), ParsedZones_FrameBegin( zones, frame_end ), (uint32_t)i );
+			}
+		}
+		for ( int i = 0; i < q.Morsels.Count; ++i )
+			num_zones += q.Morsels[i].Count;
+
+		// run the morsels
+		const bool parallel = (num_zones >= QUERY_PARALLEL_MIN_ZONES) && (q.Morsels.Count > 1);
+		const uint32_t num_slots = parallel ? NUM_QUERY_SLOTS : 1;
+		ZoneQueryRow empty;
+		NeZero( empty );
+		empty.MinTicks = INT64_MAX;
+		q.Rows.Resize( (int)(num_slots * q.NumKeys) );
+		for ( int i = 0; i < q.Rows.Count; ++i )
+			q.Rows[i] = empty;
+		if (parallel)
+		{
+			QueryPool_Run( pool, q.Morsels.Count, ZoneQuery_RunMorsel, &q );
+		}
+		else
+		{
+			for ( int i = 0; i < q.Morsels.Count; ++i )
+				ZoneQuery_RunMorsel( &q, 0, i );
+		}
+
+		// merge the slots and keep the longest groups
+		int num_rows = 0;
+		for ( uint32_t key = 0; key < q.NumKeys; ++key )
+		{
+			ZoneQueryRow item = q.Rows[ key ];
+			for ( uint32_t slot = 1; slot < num_slots; ++slot )
+				ZoneQuery_Merge( item, q.Rows[ slot * q.NumKeys + key ] );
+			if (!item.NumZones)
 				continue;
-			}
+			const bool is_unknown = (query.GroupBy == ZoneQuery::Group::Location) && (key == q.NumKeys-1);
+			item.Key = is_unknown ? UNKNOWN_LOCATION : key;
 
-			// cull zones
+			int pos = num_rows;
+			if (pos == max_rows)
 			{
-				const int end = frame.FirstScopeEvent + frame.NumScopeEvents;
-				for ( int i = frame.FirstScopeEvent; i < end; ++i )
-				{
-					const ScopeEvent& ev = data.Scopes.Data[ i ];
-					if (ev.Thread != thread_index)
-						continue;
-
-					const int index = stack.Parse( ev, i );
-					if (index < 0)
-						continue;
-
-					const Zone_s& zone = stack.Item[index];
-					AddZoneToBatch( batch, zone, data, zone_cull, func, context );
-				}
+				if (rows[ pos-1 ].TotalTicks >= item.TotalTicks)
+					continue;
+				--pos;
+			}
+			else
+			{
+				++num_rows;
 			}
+			for ( ; (pos > 0) && (rows[ pos-1 ].TotalTicks < item.TotalTicks); --pos )
+				rows[ pos ] = rows[ pos-1 ];
+			rows[ pos ] = item;
 		}
 
-		//FlushOpenZones( stack, batch, data, zone_cull, func, context );
-		FlushBatch( batch, zone_cull, func, context );
+		q.Morsels.Clear();
+		q.Rows.Clear();
+		return num_rows;
 	}
 
-	/// Enumerates the visible set of zones and their local placement.
-	void ParsedData_EnumZoneGroups( const ParsedData_s& data, const FrameRange& cull, const ZoneGroupSetup& setup, int thread_index, EnumZoneGroupsFunc func, void* context )
+	/// Fills the row a query would add for a single zone, keyed by its location.
+	/// Fails while the zone is open and once it has been evicted.
+	bool ParsedData_QueryZone( const ParsedData_s& data, int thread_index, uint32_t zone_index, ZoneQueryRow& row )
 	{
-		//NePerfScope("cull zones");
-		if (!data.Frames.Count)
-			return;
-		EnumZoneGroupsLod( data, cull, setup, thread_index, func, context );
+		if ((thread_index < 0) || (thread_index >= data.Threads.Count))
+			return false;
+		const ParsedZones_s& zones = data.Zones[ thread_index ];
+		if ((zone_index - zones.Item.First) >= zones.Item.Count())
+			return false;
+		const ParsedZone_s& zone = zones.Item[ zone_index ];
+		if (zone.Open)
+			return false;
+		const Tick duration = zone.Time.End - zone.Time.Begin;
+		row.Key		   = zone.Location;
+		row.NumZones   = 1;
+		row.TotalTicks = duration;
+		row.SelfTicks  = zone.SelfTicks;
+		row.MinTicks   = duration;
+		row.MaxTicks   = duration;
+		return true;
+	}
+
+	/// Returns the indices of the zones a thread has entered but not left yet, outermost first.
+	int ParsedData_GetOpenZones( const ParsedData_s& data, int thread_index, uint32_t* zones, int max_zones )
+	{
+		if ((thread_index < 0) || (thread_index >= data.Threads.Count))
+			return 0;
+		const ParsedZones_s& thread = data.Zones[ thread_index ];
+		const int count = NeMin( (int)thread.Depth, max_zones );
+		for ( int i = 0; i < count; ++i )
+			zones[i] = thread.Stack[i].Index;
+		return count;
 	}
 
 } }
@@ -425,111 +2424,257 @@ namespace nemesis { namespace profiling
 {
 	using namespace viz;
 
-	struct CpuBatch_s
+	struct Posting_s
 	{
-		TickInterval Time;
-		uint32_t NumEvents;
-		uint8_t Thread;
-		uint8_t Level;
-		uint8_t Cpu;
-		uint8_t Cpu2;
-		uint8_t Initialized;
-		uint8_t _pad_[3];
+		uint32_t	Frame;
+		uint32_t	Offset;
+		int			Thread;
 	};
 
-	static void FlushBatch( const CpuBatch_s& batch, EnumCpuGroupsFunc func, void* context )
+	struct PostingCursor_s
 	{
-		if (!batch.NumEvents)
-			return;
+		const PostingList_s* List;
+		int			Block;
+		uint32_t	Pos;
+		uint32_t	Left;
+		uint32_t	Frame;
+	};
 
-		const CpuGroup group = 
-		{ batch.Time
-		, batch.Thread
-		, batch.Cpu
-		, batch.Cpu2
-		};
-		func( context, group );
+	static void PostingCursor_Seek( PostingCursor_s& cursor, const PostingList_s& list, int block_index )
+	{
+		const PostingBlock_s& block = list.Block[ block_index ];
+		cursor.List	 = &list;
+		cursor.Block = block_index;
+		cursor.Pos	 = block.Offset;
+		cursor.Left	 = block.Count;
+		cursor.Frame = block.Frame;
 	}
 
-	static void ParseEvent( CpuBatch_s& batch, const Frame& frame, const ScopeEvent& ev, EnumCpuGroupsFunc func, void* context )
+	/// Decodes the next occurrence, moving on to the next block at the end of the current one.
+	static bool PostingCursor_Next( PostingCursor_s& cursor, Posting_s& posting )
 	{
-		if (!batch.Initialized)
+		const PostingList_s& list = *cursor.List;
+		if (!cursor.Left)
 		{
-			if (!ev.Enter)
-				return;
-			batch.Time.Begin = ev.Time;
-			batch.Time.End = ev.Time;
-			batch.NumEvents = 1;
-			batch.Thread = ev.Thread;
-			batch.Cpu = ev.Cpu;
-			batch.Cpu2 = ev.Cpu;
-			batch.Initialized = true;
-			batch.Level = 1;
-			return;
+			if (cursor.Block+1 >= list.Block.Count)
+				return false;
+			PostingCursor_Seek( cursor, list, cursor.Block+1 );
 		}
 
-		NeAssert(batch.Thread == ev.Thread);
-		if (batch.Cpu != ev.Cpu)
+		const uint8_t* data = list.Data.Data;
+		cursor.Frame += Posting_ReadVarint( data, cursor.Pos );
+		posting.Frame = cursor.Frame;
+		posting.Thread = data[ cursor.Pos++ ];
+		posting.Offset = Posting_ReadVarint( data, cursor.Pos );
+		--cursor.Left;
+		return true;
+	}
+
+	/// Returns the last block starting before the given frame, which is the first one that may hold the frame's occurrences.
+	static int PostingList_FindBlock( const PostingList_s& list, uint32_t frame_index )
+	{
+		int found = 0;
+		int lo = 0;
+		int hi = list.Block.Count-1;
+		while (lo <= hi)
 		{
-			// flush the 'old cpu' batch
-			FlushBatch( batch, func, context );
+			const int mid = (lo + hi) / 2;
+			if ((int32_t)(list.Block[ mid ].Frame - frame_index) < 0)
+			{
+				found = mid;
+				lo = mid + 1;
+			}
+			else
+			{
+				hi = mid - 1;
+			}
+		}
+		return found;
+	}
 
-			// fill in and immediately flush the
-			// 'switch between cpus' batch
-			batch.Time.Begin = batch.Time.End;
-			batch.Time.End = ev.Time;
-			batch.Cpu2 = ev.Cpu;
-			batch.NumEvents = 1;
-			FlushBatch( batch, func, context );
+	static const PostingList_s* ParsedData_GetPostings( const ParsedData_s& data, uint32_t location )
+	{
+		if (((uint32_t)data.Postings.Count <= location) || !data.NumFrames())
+			return nullptr;
+		const PostingList_s& list = data.Postings[ location ];
+		return list.Block.Count ? &list : nullptr;
+	}
 
-			// begin the 'new cpu' batch
-			batch.Cpu = ev.Cpu;
-			batch.Time.Begin = ev.Time;
-			batch.NumEvents = ev.Enter ? 1 : 0;
-			batch.Level += (ev.Enter ? 1 : -1);
-			return;
-		}
+	/// Returns the closed zone of an occurrence or null if it has been evicted.
+	static const ParsedZone_s* ParsedData_GetPostingZone( const ParsedData_s& data, const Posting_s& posting )
+	{
+		if ((posting.Frame - data.Frames.First) >= data.Frames.Count())
+			return nullptr;
 
-		batch.Time.End = ev.Time;
-		batch.Level += (ev.Enter ? 1 : -1);
-		++batch.NumEvents;
+		const ParsedZones_s& zones = data.Zones[ posting.Thread ];
+		const uint32_t index = ParsedZones_FrameBegin( zones, posting.Frame ) + posting.Offset;
+		if ((index - zones.Item.First) >= zones.Item.Count())
+			return nullptr;
 
-		if (ev.Enter)
+		const ParsedZone_s& zone = zones.Item[ index ];
+		return zone.Open ? nullptr : &zone;
+	}
+
+	static void MakeOccurrence( const ParsedData_s& data, const Posting_s& posting, const ParsedZone_s& zone, Occurrence& item )
+	{
+		NeZero( item );
+		item.Time	= zone.Time;
+		item.Frame	= (int)(posting.Frame - data.Frames.First);
+		item.Zone	= zone.EnterScope;
+		item.Thread = (uint8_t)posting.Thread;
+		item.Level	= zone.Level;
+	}
+
+	/// Finds the first occurrence of a location beginning after the given tick.
+	bool ParsedData_FindNextOccurrence( const ParsedData_s& data, uint32_t location, Tick tick, Occurrence& item )
+	{
+		const PostingList_s* list = ParsedData_GetPostings( data, location );
+		if (!list)
+			return false;
+
+		const uint32_t frame_index = data.Frames.First + ParsedData_TickToFrameIndex( data, tick );
+		PostingCursor_s cursor;
+		PostingCursor_Seek( cursor, *list, PostingList_FindBlock( *list, frame_index ) );
+
+		// the occurrences of a frame are ordered by thread, so the frame of the first match is searched to its end
+		bool found = false;
+		uint32_t found_frame = 0;
+		Posting_s posting;
+		while (PostingCursor_Next( cursor, posting ))
 		{
-			if (1 == batch.NumEvents)
-				batch.Time.Begin = ev.Time;
-			return;
-		}
+			if ((int32_t)(posting.Frame - frame_index) < 0)
+				continue;
+			if (found && ((int32_t)(posting.Frame - found_frame) > 0))
+				break;
 
-		if (batch.Level > 0)
-			return;
+			const ParsedZone_s* zone = ParsedData_GetPostingZone( data, posting );
+			if (!zone || (zone->Time.Begin <= tick))
+				continue;
+			if (found && (zone->Time.Begin >= item.Time.Begin))
+				continue;
 
-		FlushBatch( batch, func, context );
-		batch.NumEvents = 0;
+			MakeOccurrence( data, posting, *zone, item );
+			found = true;
+			found_frame = posting.Frame;
+		}
+		return found;
 	}
 
-	void ParsedData_EnumCpuGroups( const ParsedData_s& data, const FrameRange& cull, const CpuGroupSetup& setup, int thread_index, EnumCpuGroupsFunc func, void* context )
+	/// Finds the last occurrence of a location beginning before the given tick.
+	bool ParsedData_FindPrevOccurrence( const ParsedData_s& data, uint32_t location, Tick tick, Occurrence& item )
 	{
-		CpuBatch_s batch;
-		NeZero( batch );
+		const PostingList_s* list = ParsedData_GetPostings( data, location );
+		if (!list)
+			return false;
+
+		// blocks can only be decoded forwards, so walk them backwards until one holds a match
+		const uint32_t frame_index = data.Frames.First + ParsedData_TickToFrameIndex( data, tick );
+		bool found = false;
+		uint32_t found_frame = 0;
+		for ( int block_index = PostingList_FindBlock( *list, frame_index+1 ); block_index >= 0; --block_index )
+		{
+			if (found && ((int32_t)(list->Block[ block_index+1 ].Frame - found_frame) < 0))
+				break;
 
-		const int frame_end = cull.Frames.End();
-		for ( int frame_index = cull.Frames.First; frame_index < frame_end; ++frame_index )
+			PostingCursor_s cursor;
+			PostingCursor_Seek( cursor, *list, block_index );
+
+			Posting_s posting;
+			while (cursor.Left && PostingCursor_Next( cursor, posting ))
+			{
+				if ((int32_t)(posting.Frame - frame_index) > 0)
+					break;
+
+				const ParsedZone_s* zone = ParsedData_GetPostingZone( data, posting );
+				if (!zone || (zone->Time.Begin >= tick))
+					continue;
+				if (found && (zone->Time.Begin <= item.Time.Begin))
+					continue;
+
+				MakeOccurrence( data, posting, *zone, item );
+				found = true;
+				found_frame = posting.Frame;
+			}
+		}
+		return found;
+	}
+
+	/// Finds the longest occurrence of a location within the given frames.
+	/// Blocks whose longest occurrence is shorter than the current match are skipped.
+	bool ParsedData_FindLongestOccurrence( const ParsedData_s& data, uint32_t location, const IndexRange& frames, Occurrence& item )
+	{
+		const PostingList_s* list = ParsedData_GetPostings( data, location );
+		if (!list)
+			return false;
+
+		const int first = NeMax( 0, frames.First );
+		const int end = NeMin( data.NumFrames(), frames.End() );
+		if (first >= end)
+			return false;
+
+		const uint32_t first_frame = data.Frames.First + first;
+		const uint32_t end_frame = data.Frames.First + end;
+		bool found = false;
+		Tick found_ticks = 0;
+		for ( int block_index = PostingList_FindBlock( *list, first_frame ); block_index < list->Block.Count; ++block_index )
 		{
-			const Frame& frame = data.Frames.Data[ frame_index ];
+			const PostingBlock_s& block = list->Block[ block_index ];
+			if ((int32_t)(block.Frame - end_frame) >= 0)
+				break;
+			if (found && (block.MaxTicks <= found_ticks))
+				continue;
+
+			PostingCursor_s cursor;
+			PostingCursor_Seek( cursor, *list, block_index );
 
-			const int event_end = frame.FirstScopeEvent + frame.NumScopeEvents;
-			for ( int event_index = frame.FirstScopeEvent; event_index < event_end; ++event_index )
+			Posting_s posting;
+			while (cursor.Left && PostingCursor_Next( cursor, posting ))
 			{
-				const ScopeEvent& ev = data.Scopes.Data[ event_index ];
-				if (ev.Thread != thread_index)
+				if ((int32_t)(posting.Frame - first_frame) < 0)
+					continue;
+				if ((int32_t)(posting.Frame - end_frame) >= 0)
+					break;
+
+				const ParsedZone_s* zone = ParsedData_GetPostingZone( data, posting );
+				if (!zone || (found && (zone->Time.Duration() <= found_ticks)))
 					continue;
-				ParseEvent( batch, frame, ev, func, context );
+
+				MakeOccurrence( data, posting, *zone, item );
+				found = true;
+				found_ticks = zone->Time.Duration();
 			}
 		}
+		return found;
+	}
 
-		batch.Time.End = cull.Time.End;
-		FlushBatch( batch, func, context );
+	/// Enumerates the occurrences of a location entered in the frames of the given time range.
+	void ParsedData_EnumOccurrences( const ParsedData_s& data, uint32_t location, const TickInterval& time, EnumOccurrencesFunc func, void* context )
+	{
+		const PostingList_s* list = ParsedData_GetPostings( data, location );
+		if (!list)
+			return;
+
+		const uint32_t first_frame = data.Frames.First + ParsedData_TickToFrameIndex( data, time.Begin );
+		const uint32_t last_frame = data.Frames.First + ParsedData_TickToFrameIndex( data, time.End );
+		PostingCursor_s cursor;
+		PostingCursor_Seek( cursor, *list, PostingList_FindBlock( *list, first_frame ) );
+
+		Posting_s posting;
+		while (PostingCursor_Next( cursor, posting ))
+		{
+			if ((int32_t)(posting.Frame - first_frame) < 0)
+				continue;
+			if ((int32_t)(posting.Frame - last_frame) > 0)
+				break;
+
+			const ParsedZone_s* zone = ParsedData_GetPostingZone( data, posting );
+			if (!zone || !zone->Time.Intersects( time ))
+				continue;
+
+			Occurrence item;
+			MakeOccurrence( data, posting, *zone, item );
+			func( context, item );
+		}
 	}
 
 } }
@@ -537,77 +2682,71 @@ namespace nemesis { namespace profiling
 //======================================================================================
 namespace nemesis { namespace profiling
 {
-	using namespace viz;
-
-	/// Enumerates lock events in the given range of frames.
-	/// If the given lock index is < 0, the function enumerates all lock events, otherwise only the lock events for the given lock index.
-	void ParsedData_EnumLockEvents( const ParsedData_s& data, int lock_index, int first_frame, int num_frames, EnumLockEventFunc func, void* context )
+	/// Returns the largest summary which starts at the given sample and fits into the range and bucket.
+	static void CounterColumn_GetPiece( const CounterColumn_s& column, uint32_t first, uint32_t end, Tick bucket_ticks, CounterSummary_s& piece, uint32_t& num_samples )
 	{
-		const int frame_end = first_frame + num_frames;
-		for ( int frame_index = first_frame; frame_index < frame_end; ++frame_index )
+		CounterSummary_Make( piece, column.Time[ first ], column.Value[ first ] );
+		num_samples = 1;
+		for ( int i = 0; i < NUM_COUNTER_LEVELS; ++i )
 		{
-			const Frame& frame = data.Frames.Data[frame_index];
-			const int event_end = frame.FirstLockEvent + frame.NumLockEvents;
-			for ( int event_index = frame.FirstLockEvent; event_index < event_end; ++event_index )
-			{
-				const LockEvent& ev = data.LockEvents.Data[event_index];
-				if ((lock_index < 0) || (ev.Lock == lock_index))
-					func( context, ev, event_index );
-			}
+			const uint32_t shift = (i+1) * COUNTER_LEVEL_SHIFT;
+			const uint32_t size = 1 << shift;
+			const uint32_t index = first >> shift;
+			const CounterSummaryArray_s& items = column.Level[i];
+			if ((first & (size-1)) || ((end - first) < size) || ((index - items.First) >= items.Count()))
+				return;
+			const CounterSummary_s& item = items[ index ];
+			if ((item.Count != size) || ((item.Time.End - item.Time.Begin) > bucket_ticks))
+				return;
+			piece = item;
+			num_samples = size;
 		}
 	}
 
-	/// Builds hots spots for a given range for frames.
-	void ParsedData_BuildHotSpots( const ParsedData_s& data, const HotSpotRange& range, HotSpotGroup& group )
+	static void CounterRange_Make( const CounterSummary_s& summary, CounterRange& item )
 	{
-		/*
-		// reset data
-		group.Data.Resize(data.Locations.Count);
-		ZeroMemory( group.Data.Data, Array_GetCountSize( group.Data ) );
+		item.Time	   = summary.Time;
+		item.Min	   = summary.Min;
+		item.Max	   = summary.Max;
+		item.Avg	   = (float)(summary.Sum / summary.Count);
+		item.NumValues = summary.Count;
+	}
 
-		// build data
-		for ( int i = 0; i < range.NumFrames; ++i )
-		{
-			// gather hot spots
-			const int frame_index = i + range.FirstFrame;
-			const Frame& frame = data.Frames.Data[ frame_index ];
-			for ( uint32_t j = 0; j < frame.NumZones; ++j )
-			{
-				const int zone_index = j + frame.FirstZone;
-				const ScopeEvent& zone = data.Scopes.Data.Data[ zone_index ];
-				switch (zone.Type)
-				{
-				default:
-					break;
-				case ScopeType::Idle:
-					continue;
-				}
-				const Tick duration = zone.Time.Duration();
-				HotSpot& spot = group.Data.Data[ zone.Location ];
-				spot.Location = zone.Location;
-				spot.Duration += duration;
-				++spot.NumSamples;
-			}
-		}
+	/// Gathers the values of a counter in at most max_items buckets of equal duration.
+	/// Returns the number of non-empty buckets written to the item array.
+	int ParsedData_GetCounterSeries( const ParsedData_s& data, int counter_index, const TickInterval& time, CounterRange* items, int max_items )
+	{
+		if ((counter_index < 0) || (counter_index >= data.Counters.Count) || (max_items <= 0) || (time.End <= time.Begin))
+			return 0;
+		const uint32_t series = data.Counters[ counter_index ].Series;
+		if ((int)series >= data.CounterColumns.Count)
+			return 0;
 
-		// sort hot-spots
-		struct Sorter
+		const CounterColumn_s& column = data.CounterColumns[ series ];
+		const uint32_t end = CounterColumn_LowerBound( column, time.End );
+		const Tick bucket_ticks = NeMax( (Tick)1, (time.End - time.Begin) / max_items );
+
+		int num_items = 0;
+		int bucket = -1;
+		CounterSummary_s summary = {};
+		uint32_t num_samples = 0;
+		for ( uint32_t i = CounterColumn_LowerBound( column, time.Begin ); i != end; i += num_samples )
 		{
-			static int SortHotSpots( void* , const void* l, const void* r )
+			CounterSummary_s piece;
+			CounterColumn_GetPiece( column, i, end, bucket_ticks, piece, num_samples );
+
+			const int piece_bucket = (int)NeMin( (piece.Time.Begin - time.Begin) / bucket_ticks, (Tick)max_items-1 );
+			if ((piece_bucket != bucket) && summary.Count)
 			{
-				const HotSpot& lhs = *static_cast<const HotSpot*>(l);
-				const HotSpot& rhs = *static_cast<const HotSpot*>(r);
-				const Tick diff = (rhs.Duration - lhs.Duration);
-				if (diff < 0)
-					return -1;
-				if (diff > 0)
-					return 1;
-				return 0;
+				CounterRange_Make( summary, items[ num_items++ ] );
+				summary.Count = 0;
 			}
-		};
-
-		qsort_s( group.Data.Data, group.Data.Count, sizeof(group.Data.Data[0]), Sorter::SortHotSpots, nullptr );
-		*/
+			bucket = piece_bucket;
+			CounterSummary_Merge( summary, piece );
+		}
+		if (summary.Count)
+			CounterRange_Make( summary, items[ num_items++ ] );
+		return num_items;
 	}
 
 } }
@@ -619,59 +2758,263 @@ namespace nemesis { namespace profiling
 	void ParsedData_Initialize( ParsedData_s& data, Allocator_t alloc )
 	{
 		NeZero( data );
-		data.Frames.Alloc			= alloc;
-		data.Scopes.Alloc			= alloc;
-		data.LockEvents.Alloc		= alloc;
-		data.CounterValues.Alloc	= alloc;
+		SegmentArray_Init( data.Frames		 , alloc );
+		SegmentArray_Init( data.LockEvents	 , alloc );
+		SegmentArray_Init( data.CounterValues, alloc );
+		SegmentArray_Init( data.LogItems	 , alloc );
 		data.Locks.Alloc			= alloc;
 		data.Counters.Alloc			= alloc;
 		data.CounterGroups.Alloc	= alloc;
 		data.Locations.Alloc		= alloc;
-		data.Locations.Alloc		= alloc;
-		data.LogItems.Alloc			= alloc;
+		for ( int i = 0; i < MAX_NUM_THREADS; ++i )
+		{
+			ParsedScopes_Init( data.Scopes[i], alloc );
+			ParsedZones_Init( data.Zones[i], alloc );
+		}
+		ParsedHotSpots_Init( data.HotSpots, alloc );
+		ParsedStats_Initialize( data.Stats, alloc );
+		data.Postings.Init( alloc );
+		data.CounterColumns.Init( alloc );
+		data.LockIndex.Init( alloc );
+		SpillStore_Initialize( data.Spill, alloc );
+		data.Size = ParsedData_MeasureSize( data );
+	}
+
+	/// Removes all items and drops the segments within the given memory range.
+	static void ParsedData_DetachRange( ParsedData_s& data, cptr_t begin, cptr_t end )
+	{
+		SegmentArray_Detach( data.Frames, begin, end );
+		for ( int i = 0; i < MAX_NUM_THREADS; ++i )
+		{
+			SegmentArray_Detach( data.Scopes[i].Time	, begin, end );
+			SegmentArray_Detach( data.Scopes[i].Location, begin, end );
+			SegmentArray_Detach( data.Scopes[i].Flags	, begin, end );
+			SegmentArray_Detach( data.Scopes[i].FrameEnd, begin, end );
+			SegmentArray_Detach( data.Zones[i].Item		, begin, end );
+		}
+		SegmentArray_Detach( data.LockEvents   , begin, end );
+		SegmentArray_Detach( data.CounterValues, begin, end );
+		SegmentArray_Detach( data.LogItems	   , begin, end );
+	}
+
+	/// Drops the columns stored in a mapped file or spilled to disk before they are reset or freed.
+	static void ParsedData_Detach( ParsedData_s& data )
+	{
+		if (data.MappedBegin)
+			ParsedData_DetachRange( data, data.MappedBegin, data.MappedEnd );
+		data.MappedBegin = data.MappedEnd = nullptr;
+
+		// spilled segments are dropped when their columns are reset
+		SpillStore_Reset( data.Spill );
 	}
 
 	/// Frees dynamic memory allocated by the data set.
 	void ParsedData_Shutdown( ParsedData_s& data )
 	{
-		data.Frames.Clear();
-		data.Scopes.Clear();
-		data.LockEvents.Clear();
-		data.CounterValues.Clear();
+		ParsedData_Detach( data );
+		SegmentArray_Clear( data.Frames );
+		for ( int i = 0; i < MAX_NUM_THREADS; ++i )
+		{
+			ParsedScopes_Clear( data.Scopes[i] );
+			ParsedZones_Clear( data.Zones[i] );
+		}
+		ParsedHotSpots_Clear( data.HotSpots );
+		ParsedStats_Shutdown( data.Stats );
+		ParsedPostings_Free( data.Postings );
+		data.Postings.Clear();
+		ParsedCounters_Free( data.CounterColumns );
+		data.CounterColumns.Clear();
+		ParsedLocks_Free( data.LockIndex );
+		data.LockIndex.Clear();
+		SegmentArray_Clear( data.LockEvents );
+		SegmentArray_Clear( data.CounterValues );
+		SegmentArray_Clear( data.LogItems );
 		data.Locks.Clear();
 		data.Counters.Clear();
 		data.CounterGroups.Clear();
 		data.Locations.Clear();
-		data.LogItems.Clear();
+		SpillStore_Close( data.Spill );
+		Mem_Free( data.Frames.Segment.Alloc, data.ScopeCache );
+		data.ScopeCache = nullptr;
 	}
 
 	/// Resets data members without freeing allocated memory.
 	void ParsedData_Reset( ParsedData_s& data )
 	{
+		ParsedData_Detach( data );
 		NeZero( data.Threads );
 		data.MaxFrameDuration = 0;
 		data.LastFrameNumber  = 0;
 		NeZero(data.Clock);
-		data.Frames.Reset();
-		data.Scopes.Reset();
-		data.LockEvents.Reset();
-		data.CounterValues.Reset();
-		data.LogItems.Reset();
+		SegmentArray_Reset( data.Frames );
+		for ( int i = 0; i < MAX_NUM_THREADS; ++i )
+		{
+			ParsedScopes_Reset( data.Scopes[i] );
+			ParsedZones_Reset( data.Zones[i] );
+		}
+		ParsedHotSpots_Reset( data.HotSpots );
+		ParsedStats_Reset( data.Stats );
+		ParsedPostings_Free( data.Postings );
+		data.Postings.Reset();
+		ParsedCounters_Free( data.CounterColumns );
+		data.CounterColumns.Reset();
+		ParsedLocks_Free( data.LockIndex );
+		data.LockIndex.Reset();
+		SegmentArray_Reset( data.LockEvents );
+		SegmentArray_Reset( data.CounterValues );
+		SegmentArray_Reset( data.LogItems );
 		data.Locks.Reset();
 		data.Counters.Reset();
 		data.CounterGroups.Reset();
 		data.Locations.Reset();
+		data.Size = ParsedData_MeasureSize( data );
 	}
 
 	void ParsedData_ResetFrames( ParsedData_s& data )
 	{
-		data.Frames.Reset();
-		data.Scopes.Reset();
-		data.LockEvents.Reset();
-		data.CounterValues.Reset();
-		data.LogItems.Reset();
+		ParsedData_Detach( data );
+		SegmentArray_Reset( data.Frames );
+		for ( int i = 0; i < MAX_NUM_THREADS; ++i )
+		{
+			ParsedScopes_Reset( data.Scopes[i] );
+			ParsedZones_Reset( data.Zones[i] );
+		}
+		ParsedHotSpots_Reset( data.HotSpots );
+		ParsedStats_Reset( data.Stats );
+		ParsedPostings_Free( data.Postings );
+		data.Postings.Reset();
+		ParsedCounters_Free( data.CounterColumns );
+		data.CounterColumns.Reset();
+		ParsedLocks_Free( data.LockIndex );
+		data.LockIndex.Reset();
+		SegmentArray_Reset( data.LockEvents );
+		SegmentArray_Reset( data.CounterValues );
+		SegmentArray_Reset( data.LogItems );
 		data.MaxFrameDuration = 0;
 		data.LastFrameNumber = 0;
+		data.Size = ParsedData_MeasureSize( data );
+	}
+
+	static bool ParsedData_HasRoomForFrames( const ParsedData_s& data, const Limit_s& limit, uint32_t num_frames )
+	{
+		return (limit.MaxNumFrames <= 0) || ((data.Frames.Count() + num_frames) < limit.MaxNumFrames);
+	}
+
+	/// Returns the number of bytes to free before the given number of data bytes fit.
+	static size_t ParsedData_GetShortfall( const ParsedData_s& data, const Limit_s& limit, size_t num_bytes )
+	{
+		const size_t size = data.TotalSize() + num_bytes;
+		return ((limit.MaxNumBytes <= 0) || (size < limit.MaxNumBytes)) ? 0 : size - limit.MaxNumBytes + 1;
+	}
+
+	/// Packs the oldest plain segment of a thread's scope events.
+	static void ParsedScopes_Pack( ParsedData_s& data, ParsedScopes_s& scopes )
+	{
+		if (!data.ScopeCache)
+		{
+			data.ScopeCache = Mem_Alloc<ScopeCache_s>( scopes.Packed.Alloc, 1 );
+			NeZero( *data.ScopeCache );
+		}
+
+		const int index = scopes.Packed.Count;
+		Tick*		  time	   = scopes.Time	.Segment[ index ];
+		uint32_t*	  location = scopes.Location.Segment[ index ];
+		ScopeFlags_s* flags	   = scopes.Flags	.Segment[ index ];
+		ScopePack_s*  pack	   = ScopePack_Create( scopes.Packed.Alloc, ++data.ScopeCache->NextId, time, location, flags );
+		scopes.Packed.Append( pack );
+		scopes.PackedSize += pack->Size;
+
+		if (!ParsedData_IsMapped( data, time ))
+		{
+			Mem_Free( scopes.Time	 .Segment.Alloc, time );
+			Mem_Free( scopes.Location.Segment.Alloc, location );
+			Mem_Free( scopes.Flags	 .Segment.Alloc, flags );
+		}
+		scopes.Time	   .Segment[ index ] = nullptr;
+		scopes.Location.Segment[ index ] = nullptr;
+		scopes.Flags   .Segment[ index ] = nullptr;
+		++scopes.Time.Spilled;
+		++scopes.Location.Spilled;
+		++scopes.Flags.Spilled;
+		data.Size += pack->Size + sizeof(pack) - TickArray_s::SEGMENT_SIZE * (sizeof(*time) + sizeof(*location) + sizeof(*flags));
+	}
+
+	/// Packs the oldest plain scope segment of the thread with the most packable events.
+	/// Segments holding events of the hot frames stay plain.
+	static bool ParsedData_Pack( ParsedData_s& data, const Limit_s& limit )
+	{
+		if (data.Frames.Count() <= limit.NumHotFrames)
+			return false;
+
+		const uint32_t hot_frame = data.Frames.End - limit.NumHotFrames;
+		int best = -1;
+		int32_t best_count = TickArray_s::SEGMENT_SIZE - 1;
+		for ( int i = 0; i < data.Threads.Count; ++i )
+		{
+			const ParsedScopes_s& scopes = data.Scopes[i];
+			const uint32_t first_plain = scopes.Time.Base + ((uint32_t)scopes.Packed.Count << EVENT_SEGMENT_SHIFT);
+			const int32_t count = (int32_t)(ParsedScopes_FrameBegin( scopes, hot_frame ) - first_plain);
+			if (count > best_count)
+			{
+				best = i;
+				best_count = count;
+			}
+		}
+		if (best < 0)
+			return false;
+		ParsedScopes_Pack( data, data.Scopes[ best ] );
+		return true;
+	}
+
+	/// Moves the oldest heap segment of the largest column into the spill file.
+	/// Frames, scope events and the indices derived from the columns stay on the heap,
+	/// scope events are packed instead.
+	static bool ParsedData_Spill( ParsedData_s& data )
+	{
+		if (!data.Spill.View)
+			return false;
+
+		SpillCandidate_s best = {};
+		for ( int i = 0; i < data.Threads.Count; ++i )
+			SpillCandidate_Add( best, data.Zones[i].Item );
+		SpillCandidate_Add( best, data.LockEvents );
+		SpillCandidate_Add( best, data.CounterValues );
+		SpillCandidate_Add( best, data.LogItems );
+		return best.Column && best.Spill( data, best.Column );
+	}
+
+	/// Drops the oldest segment of frames along with the events recorded in them.
+	/// Fails if that would remove every frame.
+	static bool ParsedData_EvictFrames( ParsedData_s& data )
+	{
+		const uint32_t first_frame = data.Frames.Base + FrameArray_s::SEGMENT_SIZE;
+		if ((first_frame - data.Frames.First) >= data.Frames.Count())
+			return false;
+
+		for ( int i = 0; i < data.Threads.Count; ++i )
+		{
+			ParsedScopes_Evict( data.Scopes[i], data.Spill, first_frame );
+			ParsedZones_Evict( data.Zones[i], data.Spill, first_frame );
+		}
+		ParsedHotSpots_Evict( data.HotSpots, first_frame );
+		ParsedStats_Evict( data.Stats, first_frame );
+		for ( int i = 0; i < data.Postings.Count; ++i )
+			PostingList_Evict( data.Postings[i], first_frame );
+
+		const Frame& frame = data.Frames[ first_frame ];
+		for ( int i = 0; i < data.CounterColumns.Count; ++i )
+			CounterColumn_Evict( data.CounterColumns[i], frame.Time.Begin+1 );
+		for ( int i = 0; i < data.LockIndex.Count; ++i )
+			LockIndex_Evict( data.LockIndex[i], frame.FirstLockEvent );
+		SegmentArray_ReleaseSpilled( data.Spill, data.LockEvents   , frame.FirstLockEvent	 );
+		SegmentArray_ReleaseSpilled( data.Spill, data.CounterValues, frame.FirstCounterValue );
+		SegmentArray_ReleaseSpilled( data.Spill, data.LogItems	   , frame.FirstLogItem		 );
+		SegmentArray_Evict( data.LockEvents	  , frame.FirstLockEvent	);
+		SegmentArray_Evict( data.CounterValues, frame.FirstCounterValue );
+		SegmentArray_Evict( data.LogItems	  , frame.FirstLogItem		);
+		SegmentArray_Evict( data.Frames		  , first_frame				);
+		data.Size = ParsedData_MeasureSize( data );
+		return true;
 	}
 
 	/// Removes frames from the beginning of the data set until there's enough
@@ -679,19 +3022,31 @@ namespace nemesis { namespace profiling
 	void ParsedData_MakeRoom( ParsedData_s& data, const Limit_s& limit, uint32_t num_frames, size_t num_bytes )
 	{
 		//NePerfScope("make room");
-		if (	((limit.MaxNumFrames <= 0) || ((data.Frames.Count + num_frames) < limit.MaxNumFrames))
-			 && ((limit.MaxNumBytes  <= 0) || ((data.TotalSize()  + num_bytes ) < limit.MaxNumBytes )) )
+		size_t shortfall = ParsedData_GetShortfall( data, limit, num_bytes );
+		for ( ;; )
 		{
-			return;
+			const bool has_frames = ParsedData_HasRoomForFrames( data, limit, num_frames );
+			if (has_frames && !shortfall)
+				return;
+			const size_t size = data.TotalSize();
+			if (has_frames && (ParsedData_Pack( data, limit ) || ParsedData_Spill( data )))
+			{
+				shortfall -= NeMin( shortfall, size - NeMin( size, data.TotalSize() ) );
+				continue;
+			}
+			if (!ParsedData_EvictFrames( data ))
+			{
+				ParsedData_ResetFrames( data );
+				return;
+			}
+			shortfall = ParsedData_GetShortfall( data, limit, num_bytes );
 		}
-
-		ParsedData_ResetFrames( data );
 	}
 
 	void ParsedData_Append( ParsedData_s& dst, const ParsedData_s& src )
 	{
 		// no frames yet?
-		if (src.Frames.Count == 0)
+		if (src.Frames.Count() == 0)
 			return;
 
 		// merge threads
@@ -721,28 +3076,145 @@ namespace nemesis { namespace profiling
 			dst.Counters[i] = src.Counters[i];
 
 		// src items
-		const int first_frame = dst.Frames.Count;
-		const int first_scope_event = dst.Scopes.Count;
-		const int first_lock_event = dst.LockEvents.Count;
-		const int first_counter_value = dst.CounterValues.Count;
-		dst.Frames.Append( src.Frames );
-		dst.Scopes.Append( src.Scopes );
-		dst.LockEvents.Append( src.LockEvents );
-		dst.CounterValues.Append( src.CounterValues );
-		dst.LogItems.Append( src.LogItems );
-
-		// adjust frame ranges
-		for ( int i = first_frame; i < dst.Frames.Count; ++i )
+		const uint32_t first_frame = dst.Frames.End;
+		const uint32_t lock_event_offset = dst.LockEvents.End - src.LockEvents.First;
+		const uint32_t counter_value_offset = dst.CounterValues.End - src.CounterValues.First;
+		const uint32_t log_item_offset = dst.LogItems.End - src.LogItems.First;
+		SegmentArray_Append( dst.Frames, src.Frames );
+		SegmentArray_Append( dst.LockEvents, src.LockEvents );
+		SegmentArray_Append( dst.CounterValues, src.CounterValues );
+		SegmentArray_Append( dst.LogItems, src.LogItems );
+
+		for ( int i = 0; i < src.Threads.Count; ++i )
+			ParsedScopes_Append( dst.Scopes[i], src.Scopes[i], first_frame + (src.Scopes[i].FrameEnd.First - src.Frames.First) );
+
+		// rebase frame ranges
+		for ( uint32_t i = first_frame; i != dst.Frames.End; ++i )
 		{
-			dst.Frames.Data[i].FirstScopeEvent += first_scope_event;
-			dst.Frames.Data[i].FirstLockEvent += first_lock_event;
-			dst.Frames.Data[i].FirstCounterValue += first_counter_value;
+			Frame& frame = dst.Frames[i];
+			frame.FirstLockEvent += lock_event_offset;
+			frame.FirstCounterValue += counter_value_offset;
+			frame.FirstLogItem += log_item_offset;
 		}
 
 		// update totals
 		dst.Clock = src.Clock;
 		dst.MaxFrameDuration = NeMax( dst.MaxFrameDuration, src.MaxFrameDuration );
 		dst.LastFrameNumber = src.LastFrameNumber;
+		dst.Size = ParsedData_MeasureSize( dst );
+	}
+
+	static void ParsedStats_UnitTest( Allocator_t alloc )
+	{
+	#if UNIT_TEST_ZONES
+		ParsedData_s* data = Mem_Alloc<ParsedData_s>( alloc );
+		ParsedData_Initialize( *data, alloc );
+		data->Threads.Count = 1;
+
+		// a zone per frame, and one entered in the last frame of the first chunk and left in the next
+		const uint32_t num_frames = 2*STATS_CHUNK_STRIDE;
+		for ( uint32_t i = 0; i < num_frames; ++i )
+		{
+			const Tick begin = 100 * (Tick)i;
+			if (i == STATS_CHUNK_STRIDE)
+			{
+				const ScopeEvent enter = { begin+10, 0, 0, 0, ScopeType::Regular, 1 };
+				const ScopeEvent leave = { begin+20, 0, 0, 0, 0, 0 };
+				const ScopeEvent outer = { begin+50, 0, 0, 0, 0, 0 };
+				ParsedScopes_Append( data->Scopes[0], enter );
+				ParsedScopes_Append( data->Scopes[0], leave );
+				ParsedScopes_Append( data->Scopes[0], outer );
+			}
+			else
+			{
+				const ScopeEvent enter = { begin+10, 0, 0, 0, ScopeType::Regular, 1 };
+				const ScopeEvent leave = { begin+20, 0, 0, 0, 0, 0 };
+				ParsedScopes_Append( data->Scopes[0], enter );
+				ParsedScopes_Append( data->Scopes[0], leave );
+			}
+			if (i == STATS_CHUNK_STRIDE-1)
+			{
+				const ScopeEvent outer = { begin+50, 1, 0, 0, ScopeType::Regular, 1 };
+				ParsedScopes_Append( data->Scopes[0], outer );
+			}
+
+			Frame& frame = ParsedData_AppendFrame( *data );
+			NeZero( frame );
+			frame.Time.Begin = begin;
+			frame.Time.End = begin+100;
+		}
+		ParsedData_BuildIndices( *data );
+
+		// the spanning zone counts in the frame it was left in, by chunk and by the frames around the chunks
+		LocationStats stats;
+		const IndexRange all		 = { 1, (int)num_frames-1 };
+		const IndexRange first_chunk = { 1, STATS_CHUNK_STRIDE-1 };
+		const IndexRange left_frame	 = { 0, STATS_CHUNK_STRIDE+1 };
+		const IndexRange after_left	 = { STATS_CHUNK_STRIDE+1, STATS_CHUNK_STRIDE-1 };
+		ParsedData_GetLocationStats( *data, 1, all, stats );
+		NeAssert((stats.Count == 1) && (stats.Total == 100));
+		ParsedData_GetLocationStats( *data, 1, first_chunk, stats );
+		NeAssert(stats.Count == 0);
+		ParsedData_GetLocationStats( *data, 1, left_frame, stats );
+		NeAssert((stats.Count == 1) && (stats.Total == 100));
+		ParsedData_GetLocationStats( *data, 1, after_left, stats );
+		NeAssert(stats.Count == 0);
+		ParsedData_GetLocationStats( *data, 0, all, stats );
+		NeAssert(stats.Count == num_frames-1);
+
+		ParsedData_Shutdown( *data );
+		Mem_Free( alloc, data );
+	#else
+		NeUnused(alloc);
+	#endif
+	}
+
+	static void ParsedHotSpots_UnitTest( Allocator_t alloc )
+	{
+	#if UNIT_TEST_ZONES
+		ParsedData_s* data = Mem_Alloc<ParsedData_s>( alloc );
+		ParsedData_Initialize( *data, alloc );
+		data->Threads.Count = 1;
+
+		// a regular zone followed by an idle one and one of an unknown location
+		const ScopeEvent events[] =
+		{ { 10, 0, 0, 0, ScopeType::Regular, 1 }
+		, { 20, 0, 0, 0, 0, 0 }
+		, { 30, 1, 0, 0, ScopeType::Idle, 1 }
+		, { 90, 0, 0, 0, 0, 0 }
+		, { 92, UNKNOWN_LOCATION, 0, 0, ScopeType::Regular, 1 }
+		, { 95, 0, 0, 0, 0, 0 }
+		};
+		for ( int i = 0; i < (int)NeCountOf(events); ++i )
+			ParsedScopes_Append( data->Scopes[0], events[i] );
+		Frame& frame = ParsedData_AppendFrame( *data );
+		NeZero( frame );
+		frame.Time.Begin = 0;
+		frame.Time.End = 100;
+		ParsedData_BuildIndices( *data );
+
+		// only the regular zone is a hot spot
+		const ParsedHotSpots_s& spots = data->HotSpots;
+		NeAssert((spots.Total.Count >= 1) && (spots.Total[0].NumCalls == 1) && (spots.Total[0].InclusiveTicks == 10));
+		NeAssert((spots.Total.Count < 2) || (spots.Total[1].NumCalls == 0));
+		NeAssert(spots.Item.Count() == 1);
+
+		// the unknown location has neither stats nor postings
+		NeAssert((data->Stats.Total.Count <= 2) && (data->Postings.Count <= 2));
+
+		ParsedData_Shutdown( *data );
+		Mem_Free( alloc, data );
+	#else
+		NeUnused(alloc);
+	#endif
+	}
+
+	/// Runs the unit tests enabled by UNIT_TEST_ZONES.
+	void ParsedData_UnitTest( Allocator_t alloc )
+	{
+		ParsedZoneLod_UnitTest( alloc );
+		ParsedStats_UnitTest( alloc );
+		ParsedHotSpots_UnitTest( alloc );
 	}
 
 } }
@@ -15,6 +15,9 @@
 //======================================================================================
 #include "Types.h"
 #include "Constants.h"
+#include "SegmentArray.h"
+#include "SpillStore.h"
+#include "LocationStats.h"
 
 //======================================================================================
 #include <Nemesis/Core/Map.h>
@@ -33,47 +36,357 @@ namespace nemesis { namespace profiling
 
 } }
 
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	struct QueryPool_s;
+
+	struct ScopeFlags_s
+	{
+		uint8_t Cpu;
+		uint8_t Type;
+		uint8_t Enter;
+		uint8_t _pad_;
+	};
+
+	typedef SegmentArray<viz::Frame		  , FRAME_SEGMENT_SHIFT> FrameArray_s;
+	typedef SegmentArray<uint32_t		  , FRAME_SEGMENT_SHIFT> FrameIndexArray_s;
+	typedef SegmentArray<Tick			  , EVENT_SEGMENT_SHIFT> TickArray_s;
+	typedef SegmentArray<uint32_t		  , EVENT_SEGMENT_SHIFT> IndexArray_s;
+	typedef SegmentArray<float			  , EVENT_SEGMENT_SHIFT> FloatArray_s;
+	typedef SegmentArray<ScopeFlags_s	  , EVENT_SEGMENT_SHIFT> ScopeFlagsArray_s;
+	typedef SegmentArray<viz::LockEvent	  , EVENT_SEGMENT_SHIFT> LockEventArray_s;
+	typedef SegmentArray<viz::CounterValue, EVENT_SEGMENT_SHIFT> CounterValueArray_s;
+	typedef SegmentArray<viz::LogItem	  , EVENT_SEGMENT_SHIFT> LogItemArray_s;
+
+	/// Scope events of a whole segment in packed form, followed by
+	/// the location and flags dictionaries, their bit packed indices and the zigzag varint deltas of the ticks.
+	struct ScopePack_s
+	{
+		uint32_t	Id;
+		uint32_t	Size;
+		Tick		FirstTime;
+		uint16_t	NumLocations;
+		uint16_t	NumFlags;
+		uint8_t		LocationBits;
+		uint8_t		FlagsBits;
+		uint8_t		_pad_[2];
+	};
+
+	/// Scope events of a whole segment in plain form.
+	struct ScopeSegment_s
+	{
+		Tick			Time	[ TickArray_s::SEGMENT_SIZE ];
+		uint32_t		Location[ TickArray_s::SEGMENT_SIZE ];
+		ScopeFlags_s	Flags	[ TickArray_s::SEGMENT_SIZE ];
+	};
+
+	/// Recently unpacked segments, recycled least recently used first.
+	struct ScopeCache_s
+	{
+		uint32_t			NextId;
+		uint32_t			Clock;
+		const ScopePack_s*	Pack[ SCOPE_CACHE_SIZE ];
+		uint32_t			Id	[ SCOPE_CACHE_SIZE ];
+		uint32_t			Used[ SCOPE_CACHE_SIZE ];
+		ScopeSegment_s		Item[ SCOPE_CACHE_SIZE ];
+	};
+
+	/// Scope events of a single thread, stored as columns.
+	/// FrameEnd holds the end of the thread's events for each frame and is indexed like the frames.
+	/// The oldest segments may be packed. Their column segments are null and counted as spilled.
+	struct ParsedScopes_s
+	{
+		TickArray_s			Time;
+		IndexArray_s		Location;
+		ScopeFlagsArray_s	Flags;
+		FrameIndexArray_s	FrameEnd;
+		Array<ScopePack_s*>	Packed;
+		size_t				PackedSize;
+	};
+
+	/// A scope of a single thread, from entering to leaving it.
+	struct ParsedZone_s
+	{
+		TickInterval	Time;
+		Tick			SelfTicks;
+		uint32_t		Location;
+		uint32_t		Parent;
+		uint32_t		EnterScope;
+		uint8_t			Level;
+		uint8_t			Type : 4;
+		uint8_t			Open : 4;
+		uint8_t			Cpu0;
+		uint8_t			Cpu1;
+	};
+
+	typedef SegmentArray<ParsedZone_s, EVENT_SEGMENT_SHIFT> ZoneArray_s;
+
+	static const uint32_t INVALID_ZONE = 0xffffffff;
+
+	struct OpenZone_s
+	{
+		uint32_t	Index;
+		uint32_t	Location;
+		uint32_t	Block;
+		uint8_t		Type;
+		uint8_t		_pad_[3];
+		Tick		Begin;
+		Tick		ChildTicks;
+	};
+
+	/// Run of adjacent zones of the same level merged into a single record.
+	struct ParsedZoneGroup_s
+	{
+		TickInterval	Time;
+		uint32_t		Location;
+		uint32_t		EnterScope;
+		uint32_t		NumZones;
+		uint8_t			Level;
+		uint8_t			Type;
+		uint8_t			Cpu0;
+		uint8_t			Cpu1;
+	};
+
+	typedef SegmentArray<ParsedZoneGroup_s, EVENT_SEGMENT_SHIFT> ZoneGroupArray_s;
+
+	/// One level of detail of a thread's zones.
+	/// Zones shorter than MaxTicks are merged with their neighbours when the gap between them is shorter as well.
+	/// Groups never span frames and FrameEnd holds the end of the groups closed in each frame.
+	struct ParsedZoneLod_s
+	{
+		ZoneGroupArray_s			Item;
+		FrameIndexArray_s			FrameEnd;
+		Array<ParsedZoneGroup_s>	Open;
+		Tick						MaxTicks;
+	};
+
+	/// Zones of a single thread, sorted by the time they were entered.
+	/// Built from the thread's scope events after they have been added to the database.
+	/// FrameEnd holds the end of the zones entered in each frame and is indexed like the frames.
+	struct ParsedZones_s
+	{
+		ZoneArray_s			Item;
+		FrameIndexArray_s	FrameEnd;
+		uint32_t			NextEvent;
+		uint32_t			Depth;
+		uint32_t			Skipped;
+		uint32_t			_pad_;
+		OpenZone_s			Stack[ MAX_ZONE_DEPTH ];
+		ParsedZoneLod_s		Lod[ NUM_ZONE_LODS ];
+	};
+
+	/// Time spent in a location by all threads.
+	struct ParsedHotSpot_s
+	{
+		uint32_t	Location;
+		uint32_t	NumCalls;
+		Tick		InclusiveTicks;
+		Tick		ExclusiveTicks;
+	};
+
+	typedef SegmentArray<ParsedHotSpot_s, EVENT_SEGMENT_SHIFT> HotSpotArray_s;
+
+	/// Totals of all locations before a frame, indexed by location.
+	struct HotSpotSums_s
+	{
+		ParsedHotSpot_s*	Item;
+		uint32_t			Count;
+		uint32_t			_pad_;
+	};
+
+	typedef SegmentArray<HotSpotSums_s, FRAME_SEGMENT_SHIFT> HotSpotSumsArray_s;
+
+	/// Hot spots aggregated per frame as the zones close.
+	/// Item holds the locations touched in each frame and FrameEnd the end of each frame's run.
+	/// Sums holds the running totals every HOTSPOT_SUM_STRIDE frames, so a range of frames only 
+	/// needs to visit the frames between the closest sums.
+	struct ParsedHotSpots_s
+	{
+		HotSpotArray_s			Item;
+		FrameIndexArray_s		FrameEnd;
+		HotSpotSumsArray_s		Sums;
+		Array<ParsedHotSpot_s>	Total;
+		Array<ParsedHotSpot_s>	Open;
+		Array<uint32_t>			Touched;
+	};
+
+	/// Block of a location's occurrences, decoding starts at its first entry.
+	struct PostingBlock_s
+	{
+		uint32_t	Offset;
+		uint32_t	Frame;
+		uint32_t	Count;
+		uint32_t	_pad_;
+		Tick		MaxTicks;
+	};
+
+	/// Occurrences of a location ordered by frame.
+	/// Each entry holds the distance to the previous entry's frame, the thread and the offset 
+	/// of the zone within the thread's frame, the numbers are stored as varints.
+	/// BlockBase counts the evicted blocks so block indices stay valid.
+	struct PostingList_s
+	{
+		Array<uint8_t>			Data;
+		Array<PostingBlock_s>	Block;
+		uint32_t				BlockBase;
+		uint32_t				LastFrame;
+	};
+
+	/// Events of a single lock, sorted by time within each frame.
+	struct LockIndex_s
+	{
+		Array<uint32_t>	Event;
+		int32_t			First;
+		uint32_t		_pad_;
+	};
+
+	/// Values of a counter over a run of samples.
+	struct CounterSummary_s
+	{
+		TickInterval	Time;
+		float			Min;
+		float			Max;
+		double			Sum;
+		uint32_t		Count;
+		uint32_t		_pad_;
+	};
+
+	typedef SegmentArray<CounterSummary_s, FRAME_SEGMENT_SHIFT> CounterSummaryArray_s;
+
+	/// Samples of a single counter, stamped with the end of their frame.
+	/// Level[i] summarizes the runs of 2^((i+1)*COUNTER_LEVEL_SHIFT) samples aligned to their index.
+	struct CounterColumn_s
+	{
+		TickArray_s				Time;
+		FloatArray_s			Value;
+		CounterSummaryArray_s	Level[ NUM_COUNTER_LEVELS ];
+	};
+
+	inline size_t ParsedScopes_GetSize( const ParsedScopes_s& scopes )
+	{
+		return SegmentArray_GetSize( scopes.Time )
+			 + SegmentArray_GetSize( scopes.Location )
+			 + SegmentArray_GetSize( scopes.Flags )
+			 + SegmentArray_GetSize( scopes.FrameEnd )
+			 + Array_GetCountSize( scopes.Packed )
+			 + scopes.PackedSize;
+	}
+
+	inline size_t ParsedHotSpots_GetSize( const ParsedHotSpots_s& spots )
+	{
+		size_t size = SegmentArray_GetSize( spots.Item ) + SegmentArray_GetSize( spots.FrameEnd ) + SegmentArray_GetSize( spots.Sums );
+		for ( uint32_t i = spots.Sums.First; i != spots.Sums.End; ++i )
+			size += spots.Sums[i].Count * sizeof(ParsedHotSpot_s);
+		return size;
+	}
+
+	inline size_t ParsedPostings_GetSize( const Array<PostingList_s>& postings )
+	{
+		size_t size = Array_GetCapacitySize( postings );
+		for ( int i = 0; i < postings.Count; ++i )
+			size += Array_GetCapacitySize( postings[i].Data ) + Array_GetCapacitySize( postings[i].Block );
+		return size;
+	}
+
+	inline size_t ParsedLocks_GetSize( const Array<LockIndex_s>& locks )
+	{
+		size_t size = Array_GetCapacitySize( locks );
+		for ( int i = 0; i < locks.Count; ++i )
+			size += Array_GetCapacitySize( locks[i].Event );
+		return size;
+	}
+
+	inline size_t ParsedCounters_GetSize( const Array<CounterColumn_s>& columns )
+	{
+		size_t size = Array_GetCapacitySize( columns );
+		for ( int i = 0; i < columns.Count; ++i )
+		{
+			size += SegmentArray_GetSize( columns[i].Time ) + SegmentArray_GetSize( columns[i].Value );
+			for ( int j = 0; j < NUM_COUNTER_LEVELS; ++j )
+				size += SegmentArray_GetSize( columns[i].Level[j] );
+		}
+		return size;
+	}
+
+	inline size_t ParsedZones_GetSize( const ParsedZones_s& zones )
+	{
+		size_t size = SegmentArray_GetSize( zones.Item ) + SegmentArray_GetSize( zones.FrameEnd );
+		for ( int i = 0; i < NUM_ZONE_LODS; ++i )
+			size += SegmentArray_GetSize( zones.Lod[i].Item ) + SegmentArray_GetSize( zones.Lod[i].FrameEnd );
+		return size;
+	}
+
+} }
+
 //======================================================================================
 namespace nemesis { namespace profiling
 {
 	struct ParsedData_s
 	{
-		Clock		Clock;
+		profiling::Clock Clock;
 		uint8_t		NumCpus;
 		uint8_t		_padding_[3];
 		int64_t		MaxFrameDuration;
 		uint32_t	LastFrameNumber;
 
 		ParsedThreadTable_s			Threads;
-		Array<viz::Frame>			Frames;
-		Array<viz::ScopeEvent>		Scopes;
-		Array<viz::LockEvent>		LockEvents;
-		Array<viz::CounterValue>	CounterValues;
+		cptr_t						MappedBegin;
+		cptr_t						MappedEnd;
+		size_t						Size;
+		SpillStore_s				Spill;
+		ScopeCache_s*				ScopeCache;
+		FrameArray_s				Frames;
+		ParsedScopes_s				Scopes[ MAX_NUM_THREADS ];
+		ParsedZones_s				Zones [ MAX_NUM_THREADS ];
+		ParsedHotSpots_s			HotSpots;
+		ParsedStats_s				Stats;
+		Array<PostingList_s>		Postings;
+		Array<CounterColumn_s>		CounterColumns;
+		Array<LockIndex_s>			LockIndex;
+		LockEventArray_s			LockEvents;
+		CounterValueArray_s			CounterValues;
 		Array<viz::Lock>			Locks;
 		Array<viz::Counter>			Counters;
 		Array<viz::CounterGroup>	CounterGroups;
 		Array<NamedLocation>		Locations;
-		Array<viz::LogItem>			LogItems;
-
-		uint32_t FirstFrameNumber()	const { return LastFrameNumber-Frames.Count+1; }
-
-		uint32_t TotalSize() const
-		{ return (uint32_t)
-			( sizeof(*this)
-			+ Array_GetCountSize(Frames)
-			+ Array_GetCountSize(Scopes)
-			+ Array_GetCountSize(LockEvents)
-			+ Array_GetCountSize(CounterValues)
-			+ Array_GetCountSize(Locks)
-			+ Array_GetCountSize(Counters)
-			+ Array_GetCountSize(CounterGroups)
-			+ Array_GetCountSize(Locations)
-			);
+		LogItemArray_s				LogItems;
+
+		int NumFrames() const { return (int)Frames.Count(); }
+
+		/// Returns a frame by its index relative to the first retained frame.
+		const viz::Frame& GetFrame( int index ) const { return Frames[ Frames.First + index ]; }
+
+		uint32_t FirstFrameNumber()	const { return LastFrameNumber-NumFrames()+1; }
+
+		uint32_t NumScopes() const
+		{
+			uint32_t count = 0;
+			for ( int i = 0; i < Threads.Count; ++i )
+				count += Scopes[i].Time.Count();
+			return count;
 		}
+
+		/// Returns the number of heap bytes held by the data set.
+		size_t TotalSize() const { return Size; }
 	};
 
 } }
 
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	void ParsedScopes_Append( ParsedScopes_s& scopes, const viz::ScopeEvent& ev );
+	void ScopePack_Unpack	( const ScopePack_s* pack, ScopeSegment_s& segment );
+	viz::Frame& ParsedData_AppendFrame( ParsedData_s& data );
+
+	/// Returns the first zone the thread entered in the given absolute frame index.
+	uint32_t ParsedZones_FrameBegin	 ( const ParsedZones_s& zones, uint32_t frame_index );
+	/// Returns the first sample stamped at or after the given tick.
+	uint32_t CounterColumn_LowerBound( const CounterColumn_s& column, Tick tick );
+
+} }
+
 //======================================================================================
 namespace nemesis { namespace profiling
 {
@@ -94,8 +407,20 @@ namespace nemesis { namespace profiling
 	void ParsedData_EnumFrameGroups( const ParsedData_s& data, const viz::FrameRange& cull, const viz::FrameGroupSetup& setup, EnumFrameGroupsFunc func, void* context );
 	void ParsedData_EnumZoneGroups( const ParsedData_s& data, const viz::FrameRange& cull, const viz::ZoneGroupSetup& setup, int thread_index, EnumZoneGroupsFunc func, void* context );
 	void ParsedData_EnumCpuGroups( const ParsedData_s& data, const viz::FrameRange& cull, const viz::CpuGroupSetup& setup, int thread_index, EnumCpuGroupsFunc func, void* context );
+	int  ParsedData_GetScopeLocation( const ParsedData_s& data, int thread_index, uint32_t event_index );
 	void ParsedData_EnumLockEvents( const ParsedData_s& data, int lock_index, int first_frame, int num_frames, EnumLockEventFunc func, void* context );
+	bool ParsedData_GetLockStats( const ParsedData_s& data, uint32_t lock_index, const IndexRange& frames, viz::LockStats& stats );
+	int  ParsedData_GetContendedLocks( const ParsedData_s& data, const IndexRange& frames, int* locks, viz::LockStats* stats, int max_items );
+	int  ParsedData_QueryZones( const ParsedData_s& data, QueryPool_s& pool, const viz::ZoneQuery& query, viz::ZoneQueryRow* rows, int max_rows );
+	bool ParsedData_QueryZone( const ParsedData_s& data, int thread_index, uint32_t zone_index, viz::ZoneQueryRow& row );
+	int  ParsedData_GetOpenZones( const ParsedData_s& data, int thread_index, uint32_t* zones, int max_zones );
 	void ParsedData_BuildHotSpots( const ParsedData_s& data, const viz::HotSpotRange& range, viz::HotSpotGroup& group );
+	bool ParsedData_GetLocationStats( const ParsedData_s& data, uint32_t location, const IndexRange& frames, viz::LocationStats& stats );
+	bool ParsedData_FindNextOccurrence( const ParsedData_s& data, uint32_t location, Tick tick, viz::Occurrence& item );
+	bool ParsedData_FindPrevOccurrence( const ParsedData_s& data, uint32_t location, Tick tick, viz::Occurrence& item );
+	bool ParsedData_FindLongestOccurrence( const ParsedData_s& data, uint32_t location, const IndexRange& frames, viz::Occurrence& item );
+	int  ParsedData_GetCounterSeries( const ParsedData_s& data, int counter_index, const TickInterval& time, viz::CounterRange* items, int max_items );
+	void ParsedData_EnumOccurrences( const ParsedData_s& data, uint32_t location, const TickInterval& time, EnumOccurrencesFunc func, void* context );
 
 } }
 
@@ -106,6 +431,7 @@ namespace nemesis { namespace profiling
 	{
 		uint32_t MaxNumBytes;
 		uint32_t MaxNumFrames;
+		uint32_t NumHotFrames;
 	};
 
 	void ParsedData_Initialize	( ParsedData_s& data, Allocator_t alloc );
@@ -114,5 +440,7 @@ namespace nemesis { namespace profiling
 	void ParsedData_ResetFrames	( ParsedData_s& data );
 	void ParsedData_MakeRoom	( ParsedData_s& data, const Limit_s& limit, uint32_t num_frames, size_t num_bytes );
 	void ParsedData_Append		( ParsedData_s& data, const ParsedData_s& src );
+	void ParsedData_BuildIndices( ParsedData_s& data );
+	void ParsedData_UnitTest	( Allocator_t alloc );
 	
 } }
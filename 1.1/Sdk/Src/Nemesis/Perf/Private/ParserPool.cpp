@@ -0,0 +1,151 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#include "stdafx.h"
+#include "ParserPool.h"
+
+//======================================================================================
+#include "ParserState.h"
+
+//======================================================================================
+#include <Nemesis/Core/Atomic.h>
+#include <Nemesis/Core/Process.h>
+
+//======================================================================================
+using namespace nemesis::system;
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	void ParsedPart_Initialize( ParsedPart_s& part, Allocator_t alloc )
+	{
+		part.Scopes.Init( alloc );
+		part.LockEvents.Init( alloc );
+		part.Pending.Init( alloc );
+		ParsedPart_Reset( part );
+	}
+
+	void ParsedPart_Shutdown( ParsedPart_s& part )
+	{
+		part.Scopes.Clear();
+		part.LockEvents.Clear();
+		part.Pending.Clear();
+	}
+
+	void ParsedPart_ResetFrame( ParsedPart_s& part )
+	{
+		part.Scopes.Reset();
+		part.LockEvents.Reset();
+		part.Pending.Reset();
+		NeZero(part.NumLevels);
+		part.NumCpus = 0;
+	}
+
+	void ParsedPart_Reset( ParsedPart_s& part )
+	{
+		ParsedPart_ResetFrame( part );
+		NeZero(part.ZoneLevels);
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static void ParserWorker_Run( ParserWorker_s* worker )
+	{
+		while ( worker->Worker.Continue )
+		{
+			const Packet* packet = PacketQueue_Peek( worker->Queue );
+			if (!packet)
+				continue;
+			ParsedPart_ParseChunks( worker->Part, *worker->State, (const Chunk*)(packet+1), packet->DataSize() );
+			PacketQueue_Pop( worker->Queue );
+
+			// only the worker writes the completion count
+			Interlocked_Exchange( &worker->Completed, worker->Completed + 1 );
+			if (Interlocked_Load( &worker->Waiting ))
+				Semaphore_Signal( worker->Idle, 1 );
+		}
+	}
+
+	static void NE_CALLBK ParserWorker_Proc( void* worker )
+	{
+		ParserWorker_Run( (ParserWorker_s*) worker );
+	}
+
+	static void ParserWorker_Join( ParserWorker_s& worker )
+	{
+		if (Interlocked_Load( &worker.Completed ) == worker.Submitted)
+			return;
+		Interlocked_Exchange( &worker.Waiting, 1 );
+		while (Interlocked_Load( &worker.Completed ) != worker.Submitted)
+			Semaphore_Wait( worker.Idle );
+		Interlocked_Exchange( &worker.Waiting, 0 );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	void ParserPool_Initialize( ParserPool_s& pool, Allocator_t alloc, const ParserState_s* state )
+	{
+		pool.NumWorkers = MAX_NUM_PARSE_WORKERS;
+		for ( int i = 0; i < pool.NumWorkers; ++i )
+		{
+			ParserWorker_s& worker = pool.Worker[i];
+			worker.State = state;
+			worker.Idle	 = Semaphore_Create( 0, 1 );
+			ParsedPart_Initialize( worker.Part, alloc );
+			PacketQueue_Initialize( worker.Queue, alloc, PARSE_WORKER_QUEUE_SIZE );
+
+			const ThreadSetup_s thread_setup = { "[NePerf] Parse Worker", ParserWorker_Proc, &worker };
+			Worker_Start( &worker.Worker, thread_setup );
+		}
+	}
+
+	void ParserPool_Shutdown( ParserPool_s& pool )
+	{
+		for ( int i = 0; i < pool.NumWorkers; ++i )
+		{
+			ParserWorker_s& worker = pool.Worker[i];
+			Worker_Stop( &worker.Worker );
+			PacketQueue_Close( worker.Queue );
+			Worker_Wait( &worker.Worker );
+			PacketQueue_Shutdown( worker.Queue );
+			ParsedPart_Shutdown( worker.Part );
+			Semaphore_Destroy( worker.Idle );
+		}
+		pool.NumWorkers = 0;
+	}
+
+	void ParserPool_Submit( ParserPool_s& pool, int thread, const Chunk* head, uint32_t size )
+	{
+		if (!size)
+			return;
+		ParserWorker_s& worker = pool.Worker[ thread % pool.NumWorkers ];
+		const Packet packet = { { chunk::Type::Packet, (uint32_t)sizeof(Packet) + size } };
+		PacketQueue_Push( worker.Queue, packet, head );
+		++worker.Submitted;
+	}
+
+	void ParserPool_Join( ParserPool_s& pool )
+	{
+		for ( int i = 0; i < pool.NumWorkers; ++i )
+			ParserWorker_Join( pool.Worker[i] );
+	}
+
+	void ParserPool_Reset( ParserPool_s& pool )
+	{
+		ParserPool_Join( pool );
+		for ( int i = 0; i < pool.NumWorkers; ++i )
+			ParsedPart_Reset( pool.Worker[i].Part );
+	}
+
+} }
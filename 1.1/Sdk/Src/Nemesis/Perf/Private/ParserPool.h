@@ -0,0 +1,87 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+#include "PacketQueue.h"
+#include "ParserData.h"
+#include "Worker.h"
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	struct ParserState_s;
+
+	struct ParsedLockEvent_s
+	{
+		Tick		Time;
+		uint64_t	Handle;
+		uint8_t		Thread;
+		uint8_t		Enter;
+		uint8_t		_pad_[6];
+	};
+
+	/// A dynamic scope whose location did not exist yet when the worker parsed it.
+	struct ParsedDynamicScope_s
+	{
+		uint32_t Scope;
+		uint32_t Location;
+		uint64_t Name;
+	};
+
+	/// Events of the open frame parsed by a single worker.
+	/// Thread fields hold the recording thread ids until the part is merged.
+	struct ParsedPart_s
+	{
+		Array<viz::ScopeEvent>			Scopes;
+		Array<ParsedLockEvent_s>		LockEvents;
+		Array<ParsedDynamicScope_s>		Pending;
+		uint8_t							ZoneLevels[ MAX_NUM_THREADS ];
+		uint8_t							NumLevels [ MAX_NUM_THREADS ];
+		uint8_t							NumCpus;
+		uint8_t							_pad_[7];
+	};
+
+	void ParsedPart_Initialize( ParsedPart_s& part, Allocator_t alloc );
+	void ParsedPart_Shutdown( ParsedPart_s& part );
+	void ParsedPart_ResetFrame( ParsedPart_s& part );
+	void ParsedPart_Reset( ParsedPart_s& part );
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	struct ParserWorker_s
+	{
+		Worker_s				Worker;
+		PacketQueue_s			Queue;
+		ParsedPart_s			Part;
+		const ParserState_s*	State;
+		system::Semaphore_t		Idle;
+		Atomic32				Completed;
+		Atomic32				Waiting;
+		int32_t					Submitted;
+	};
+
+	/// Parses scope and lock events on a pool of workers.
+	/// Packets are fanned out by recording thread, so each thread's events stay in order.
+	struct ParserPool_s
+	{
+		int				NumWorkers;
+		ParserWorker_s	Worker[ MAX_NUM_PARSE_WORKERS ];
+	};
+
+	void ParserPool_Initialize	( ParserPool_s& pool, Allocator_t alloc, const ParserState_s* state );
+	void ParserPool_Shutdown	( ParserPool_s& pool );
+	void ParserPool_Submit		( ParserPool_s& pool, int thread, const Chunk* head, uint32_t size );
+	void ParserPool_Join		( ParserPool_s& pool );
+	void ParserPool_Reset		( ParserPool_s& pool );
+
+} }
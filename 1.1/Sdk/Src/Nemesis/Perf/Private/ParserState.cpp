@@ -14,6 +14,7 @@
 
 //======================================================================================
 #include <Nemesis/Core/String.h>
+#include <Nemesis/Core/Hash.h>
 #include <Nemesis/Core/Process.h>
 #include <float.h>
 
@@ -49,16 +50,6 @@ namespace nemesis { namespace profiling
 		return StringPool_Alloc( pool, text, 1+Str_Len( text ) );
 	}
 
-	static cstr_t NameTable_Ensure( Array<cstr_t>& names, Stack_s& pool, cstr_t name ) 
-	{
-		const int pos = Array_BinaryFind<StringComparer>( names, name );
-		if (pos >= 0)
-			return names[ pos ];
-		const char* clone = StringPool_Alloc( pool, name );
-		names.InsertAt( ~pos, clone );
-		return clone;
-	}
-
 	static void NameMap_Ensure( BinaryArrayMap<uint64_t, cstr_t>& map, Stack_s& pool, uint64_t key, uint16_t len, const char* value )
 	{
 		if (map.Contains( key ))
@@ -159,12 +150,16 @@ namespace nemesis { namespace profiling
 	//==================================================================================
 	static const NamedLocation INVALID_LOCATION = { "Unknown", "Unknown", "Unknown", 0 };
 
-	static uint64_t MakeLocationKey( const uint32_t thread_id, const uint32_t location_id )
+	/// Locations are registered process wide and do not depend on the recording thread.
+	static uint64_t MakeLocationKey( const uint32_t location_id )
 	{
-		U64_LH key;
-		key.High = thread_id;
-		key.Low = location_id;
-		return key.Value;
+		return location_id;
+	}
+
+	/// Dynamic names are tagged content hashes, so the combined key never clashes with a plain location id.
+	static uint64_t MakeDynamicLocationKey( const uint32_t location_id, const uint64_t name_id )
+	{
+		return name_id ^ (((uint64_t)location_id) << 32);
 	}
 
 	static void EnsureLocation( ParserState_s& state, ParsedData_s& data, uint64_t key, const NamedLocation& location )
@@ -185,9 +180,7 @@ namespace nemesis { namespace profiling
 	{
 		// chunks are sent after locations.
 		// names are sent before locations.
-		// however, names are not associated with particular threads.
-		const int thread_index = ParsedThreadTable_Ensure( data.Threads, chunk.threadId );
-		NeUnused(thread_index);
+		// neither names nor locations are associated with particular threads.
 
 		// register each location
 		NamedLocation location = INVALID_LOCATION;
@@ -199,21 +192,18 @@ namespace nemesis { namespace profiling
 			state.Names.Lookup( it.file, location.Location.File		);
 			location.Location.Line = it.line;
 
-			const uint64_t key = MakeLocationKey( chunk.threadId, it.id );
+			const uint64_t key = MakeLocationKey( it.id );
 			EnsureLocation( state, data, key, location );
 		}
 	}
 
 	static void RegisterLocations_BigEndian( ParserState_s& state, ParsedData_s& data, const chunk::LocationList& chunk )
 	{
-		const uint32_t threadId = EndianSwap( chunk.threadId );
 		const uint32_t numItems = EndianSwap( chunk.numItems );
 
 		// chunks are sent after locations.
 		// names are sent before locations.
-		// however, names are not associated with particular threads.
-		const int thread_index = ParsedThreadTable_Ensure( data.Threads, threadId );
-		NeUnused(thread_index);
+		// neither names nor locations are associated with particular threads.
 
 		// register each location
 		NamedLocation location = INVALID_LOCATION;
@@ -225,32 +215,26 @@ namespace nemesis { namespace profiling
 			state.Names.Lookup( EndianSwap( it.func ), location.Location.Function	);
 			state.Names.Lookup( EndianSwap( it.file ), location.Location.File		);
 			location.Location.Line = EndianSwap( it.line );
-			EnsureLocation( state, data, MakeLocationKey( threadId, EndianSwap( it.id ) ), location );
+			EnsureLocation( state, data, MakeLocationKey( EndianSwap( it.id ) ), location );
 		}
 	}
 
 	//==================================================================================
 
-	/// Parses a single "enter scope_event" chunk.
-	static void EnterScopeEvent( ParserState_s& state, ParsedData_s& data, const chunk::EnterScope& chunk, ScopeType::Enum type )
+	static void AppendEnterScope( ParserState_s& state, ParsedData_s& data, uint8_t thread_id, uint8_t cpu_id, int location_index, int64_t time, ScopeType::Enum type )
 	{
-		AssertChunkSize();
-
-		const uint64_t location_key = MakeLocationKey( chunk.threadId, chunk.location );
-		const bool has_locaction = state.Locations.Contains( location_key );
-		const int location_index = has_locaction ? state.Locations[ location_key ] : -1;
-		const int thread_index = ParsedThreadTable_Ensure( data.Threads, chunk.threadId );
-		const int cpu_index = ParsedData_EnsureCpu( data, chunk.cpuId );
+		const int thread_index = ParsedThreadTable_Ensure( data.Threads, thread_id );
+		const int cpu_index = ParsedData_EnsureCpu( data, cpu_id );
 
 		const ScopeEvent ev = 
-		{ chunk.timeStamp
+		{ time
 		, (uint32_t)location_index
 		, (uint8_t)thread_index
 		, (uint8_t)cpu_index
 		, (uint8_t)type
 		, 1
 		};
-		data.Scopes.Append( ev );
+		ParsedScopes_Append( data.Scopes[ thread_index ], ev );
 
 		// state
 		++state.OpenFrame.NumScopeEvents;
@@ -260,6 +244,48 @@ namespace nemesis { namespace profiling
 		data.Threads.Item[ thread_index ].NumLevels = NeMax(data.Threads.Item[ thread_index ].NumLevels, state.ZoneLevels[ thread_index ]);
 	}
 
+	/// Returns the location index for a name at the given call site.
+	/// Until the name has arrived the call site itself is returned and nothing is cached,
+	/// so the next scope with that name retries.
+	static int EnsureDynamicLocation( ParserState_s& state, ParsedData_s& data, uint32_t location_id, uint64_t name_id )
+	{
+		const uint64_t location_key = MakeDynamicLocationKey( location_id, name_id );
+		const int key_idx = state.Locations.IndexOf( location_key );
+		if (key_idx >= 0)
+			return state.Locations.Values[ key_idx ];
+
+		const int site_idx = state.Locations.IndexOf( MakeLocationKey( location_id ) );
+		const int site_index = (site_idx >= 0) ? state.Locations.Values[ site_idx ] : -1;
+
+		NamedLocation location = (site_index >= 0) ? data.Locations[ site_index ] : INVALID_LOCATION;
+		if (!state.Names.Lookup( name_id, location.Name ))
+			return site_index;
+
+		EnsureLocation( state, data, location_key, location );
+		return state.Locations[ location_key ];
+	}
+
+	/// Parses a single "enter scope_event" chunk.
+	static void EnterScopeEvent( ParserState_s& state, ParsedData_s& data, const chunk::EnterScope& chunk, ScopeType::Enum type )
+	{
+		AssertChunkSize();
+
+		const uint64_t location_key = MakeLocationKey( chunk.location );
+		const bool has_locaction = state.Locations.Contains( location_key );
+		const int location_index = has_locaction ? state.Locations[ location_key ] : -1;
+		AppendEnterScope( state, data, chunk.threadId, chunk.cpuId, location_index, chunk.timeStamp, type );
+	}
+
+	/// Parses a single "enter dynamic scope_event" chunk.
+	/// Each distinct name at a call site becomes a location of its own.
+	static void EnterDynamicScopeEvent( ParserState_s& state, ParsedData_s& data, const chunk::EnterDynamicScope& chunk )
+	{
+		AssertChunkSize();
+
+		const int location_index = EnsureDynamicLocation( state, data, chunk.location, chunk.name );
+		AppendEnterScope( state, data, chunk.threadId, chunk.cpuId, location_index, chunk.timeStamp, (ScopeType::Enum)chunk.type );
+	}
+
 	/// Parses a single "leave scope_event" chunk.
 	static void LeaveScopeEvent( ParserState_s& state, ParsedData_s& data, const chunk::LeaveScope& chunk )
 	{
@@ -276,7 +302,7 @@ namespace nemesis { namespace profiling
 		, 0
 		, 0
 		};
-		data.Scopes.Append( ev );
+		ParsedScopes_Append( data.Scopes[ thread_index ], ev );
 
 		// state
 		++state.OpenFrame.NumScopeEvents;
@@ -286,28 +312,36 @@ namespace nemesis { namespace profiling
 
 	//==================================================================================
 
-	/// Return a lock index for the given lock name
-	/// or -1 if the lock name has not yet been registered.
-	static int FindLock( const ParsedData_s& data, uint64_t handle )
+	/// Returns a hash table key which is never the empty key.
+	/// Keys may collide, so colliding entries probe the following keys and every hit is compared with its source.
+	static uint64_t MakeRegistryKey( uint64_t hash )
 	{
-		for ( int i = 0; i < data.Locks.Count; ++i )
-		{
-			if ( data.Locks[i].Handle_t == handle )
-				return i;
-		}
-		return -1;
+		return (hash == ~0ull) ? 0 : hash;
 	}
 
-	/// Return a lock index for the given lock name.
-	static int EnsureLock( ParsedData_s& data, uint64_t handle )
+	static uint64_t NextRegistryKey( uint64_t key )
 	{
-		const int existing = FindLock( data, handle );
-		if (existing >= 0)
-			return existing;
-		
+		return MakeRegistryKey( key+1 );
+	}
+
+	/// Return a lock index for the given lock handle.
+	/// Handles are unique, so they are used as keys directly.
+	static uint32_t EnsureLock( ParserState_s& state, ParsedData_s& data, uint64_t handle )
+	{
+		uint64_t key = MakeRegistryKey( handle );
+		for ( ;; key = NextRegistryKey( key ) )
+		{
+			const uint32_t found = HashTable_Get( state.Locks, key, ~0u );
+			if (found == ~0u)
+				break;
+			if (data.Locks[ found ].Handle_t == handle)
+				return found;
+		}
+
 		Lock& lock = data.Locks.Append();
 		lock.Handle_t = handle;
-		return data.Locks.Count-1;
+		HashTable_Set( state.Locks, key, (uint32_t)data.Locks.Count-1 );
+		return (uint32_t)data.Locks.Count-1;
 	}
 
 	/// Parses a single "enter lock" chunk.
@@ -316,10 +350,10 @@ namespace nemesis { namespace profiling
 		AssertChunkSize();
 
 		const int thread_index = ParsedThreadTable_Ensure( data.Threads, chunk.threadId );
-		const int lock_index = EnsureLock( data, chunk.lockId );
-		LockEvent& ev = data.LockEvents.Append();
+		const uint32_t lock_index = EnsureLock( state, data, chunk.lockId );
+		LockEvent& ev = SegmentArray_Append( data.LockEvents );
 		ev.Enter = true;
-		ev.Lock = (uint8_t)lock_index;
+		ev.Lock = lock_index;
 		ev.Thread = (uint8_t)thread_index;
 		ev.Tick = chunk.timeStamp;
 		++state.OpenFrame.NumLockEvents;
@@ -331,10 +365,10 @@ namespace nemesis { namespace profiling
 		AssertChunkSize();
 
 		const int thread_index = ParsedThreadTable_Ensure( data.Threads, chunk.threadId );
-		const int lock_index = EnsureLock( data, chunk.lockId );
-		LockEvent& ev = data.LockEvents.Append();
+		const uint32_t lock_index = EnsureLock( state, data, chunk.lockId );
+		LockEvent& ev = SegmentArray_Append( data.LockEvents );
 		ev.Enter = false;
-		ev.Lock = (uint8_t)lock_index;
+		ev.Lock = lock_index;
 		ev.Thread = (uint8_t)thread_index;
 		ev.Tick = chunk.timeStamp;
 		++state.OpenFrame.NumLockEvents;
@@ -342,30 +376,11 @@ namespace nemesis { namespace profiling
 
 	static void RegisterLockName( ParserState_s& state, ParsedData_s& data, const chunk::MutexInfo& chunk )
 	{
-		const int lock_index = EnsureLock( data, chunk.handle );
+		const uint32_t lock_index = EnsureLock( state, data, chunk.handle );
 		state.Names.Lookup( chunk.name, data.Locks[ lock_index ].Name );
 	}
 
 	//==================================================================================
-	namespace 
-	{
-		struct CounterGroupComparer
-		{
-			static bool Equals( const CounterGroup& lhs, const CounterGroup& rhs )
-			{
-				if (lhs.Length != rhs.Length)
-					return false;
-				return (0 == Str_Cmp( lhs.Name, rhs.Name, lhs.Length ));
-			}
-		};
-
-		struct CounterComparer
-		{
-			static int Compare( const Counter& counter, const char* name )
-			{ return StringComparer::Compare( counter.Name, name ); }
-		};
-	}
-
 	/// Return a counter group index for the given counter name.
 	static int EnsureRootCounterGroup( ParsedData_s& data )
 	{
@@ -376,19 +391,27 @@ namespace nemesis { namespace profiling
 		return 0;
 	}
 
-	/// Return a counter group index for the given counter name.
-	static int EnsureCounterGroup( ParsedData_s& data, const char* name, uint32_t len, int32_t parent )
+	/// Return a counter group index for the given prefix of a counter name.
+	static int EnsureCounterGroup( ParserState_s& state, ParsedData_s& data, const char* name, uint32_t len, int32_t parent )
 	{
+		uint64_t key = MakeRegistryKey( Hash_Xx64( name, len, 0 ) );
+		for ( ;; key = NextRegistryKey( key ) )
+		{
+			const uint32_t found = HashTable_Get( state.CounterGroups, key, ~0u );
+			if (found == ~0u)
+				break;
+			const CounterGroup& group = data.CounterGroups[ found ];
+			if ((group.Length == len) && (Mem_Cmp( group.Name, name, len ) == 0))
+				return (int)found;
+		}
 		const CounterGroup item = { name, len, parent };
-		const int found = Array_LinearFind<CounterGroupComparer>( data.CounterGroups, item );
-		if (found >= 0)
-			return found;
 		data.CounterGroups.Append( item );
+		HashTable_Set( state.CounterGroups, key, (uint32_t)data.CounterGroups.Count - 1 );
 		return data.CounterGroups.Count - 1;
 	}
 
 	/// Return a counter group index for the given counter name.
-	static int EnsureCounterGroup( ParsedData_s& data, const char* name )
+	static int EnsureCounterGroup( ParserState_s& state, ParsedData_s& data, const char* name )
 	{
 		const char* next = name;
 		int32_t parent = EnsureRootCounterGroup( data );
@@ -397,80 +420,87 @@ namespace nemesis { namespace profiling
 			next = Str_Chr( next + 1, '/' );
 			if (!next)
 				break;
-			parent = EnsureCounterGroup( data, name, (int)(next-name), parent );
+			parent = EnsureCounterGroup( state, data, name, (int)(next-name), parent );
 		}
 		return parent;
 	}
 
-	/// Return a counter index for the given counter name.
-	static int EnsureCounter( ParsedData_s& data, const char* name )
+	/// Returns the name of a counter, prefixed by its path if it has one.
+	static const char* MakeCounterName( ParserState_s& state, uint64_t path_id, uint64_t name_id )
 	{
-		const int pos = Array_BinaryFind<CounterComparer>( data.Counters, name );
-		if (pos >= 0)
-			return pos;
+		const char* name = "<missing>";
+		state.Names.Lookup( name_id, name );
+		if (!path_id)
+			return name;
+
+		const char* path = "<missing>";
+		state.Names.Lookup( path_id, path );
+
+		const uint32_t path_len = (uint32_t)Str_Len( path );
+		const uint32_t name_len = (uint32_t)Str_Len( name );
+		char* merged = (char*)state.Db->StringPool.Alloc( path_len + name_len + 1 );
+		Mem_Cpy( merged, path, path_len );
+		Mem_Cpy( merged + path_len, name, name_len + 1 );
+		return merged;
+	}
+
+	/// Return a counter index for the given path and name ids.
+	/// Counters keep their index once created.
+	static int EnsureCounter( ParserState_s& state, ParsedData_s& data, uint64_t path_id, uint64_t name_id )
+	{
+		const ParsedCounterKey_s ids = { path_id, name_id };
+		uint64_t key = MakeRegistryKey( Hash_Xx64( &ids, sizeof(ids) ) );
+		for ( ;; key = NextRegistryKey( key ) )
+		{
+			const uint32_t found = HashTable_Get( state.Counters, key, ~0u );
+			if (found == ~0u)
+				break;
+			const ParsedCounterKey_s& other = state.CounterKeys[ found ];
+			if ((other.Path == path_id) && (other.Name == name_id))
+				return (int)found;
+		}
 
 		Counter counter = {};
-		counter.Name = name;
-		counter.Group = EnsureCounterGroup( data, name );
+		counter.Name = MakeCounterName( state, path_id, name_id );
+		counter.Group = EnsureCounterGroup( state, data, counter.Name );
 		counter.Minimum =  FLT_MAX;
 		counter.Maximum = -FLT_MAX;
-
-		const int idx = ~pos;
-		data.Counters.InsertAt( idx, counter );
-		return idx;
+		counter.Series = (uint32_t)data.Counters.Count;
+		data.Counters.Append( counter );
+		state.CounterKeys.Append( ids );
+		HashTable_Set( state.Counters, key, counter.Series );
+		return (int)counter.Series;
 	}
 
-	static void RegisterCounter( ParserState_s& state, ParsedData_s& data, const char* name, float float_value )
+	static void RegisterCounter( ParserState_s& state, ParsedData_s& data, uint64_t path_id, uint64_t name_id, float float_value )
 	{
-		const int counter_index = EnsureCounter( data, name );
+		Counter& counter = data.Counters[ EnsureCounter( state, data, path_id, name_id ) ];
 
-		CounterValue& value = data.CounterValues.Append();
-		value.Name = name;
+		CounterValue& value = SegmentArray_Append( data.CounterValues );
+		value.Name = counter.Name;
 		value.Value = float_value;
+		value.Series = counter.Series;
 
-		Counter& counter = data.Counters[ counter_index ];
 		counter.Minimum = NeMin( counter.Minimum, float_value );
 		counter.Maximum = NeMax( counter.Maximum, float_value );
 
 		++state.OpenFrame.NumCounterValues;
 	}
 
-	static void RegisterCounter( ParserState_s& state, ParsedData_s& data, uint64_t name_id, float float_value )
-	{
-		const char* name = "<missing>";
-		state.Names.Lookup( name_id, name );
-		RegisterCounter( state, data, name, float_value );
-	}
-	
 	static void RegisterCounter( ParserState_s& state, ParsedData_s& data, const chunk::Counter_U32_64& chunk )
-	{ RegisterCounter( state, data, chunk.name, (float) chunk.value ); }
+	{ RegisterCounter( state, data, 0, chunk.name, (float) chunk.value ); }
 
 	static void RegisterCounter( ParserState_s& state, ParsedData_s& data, const chunk::Counter_U32_32& chunk )
-	{ RegisterCounter( state, data, chunk.name, (float) chunk.value ); }
+	{ RegisterCounter( state, data, 0, chunk.name, (float) chunk.value ); }
 
 	static void RegisterCounter( ParserState_s& state, ParsedData_s& data, const chunk::Counter_Float_64& chunk )
-	{ RegisterCounter( state, data, chunk.name, (float) chunk.value ); }
+	{ RegisterCounter( state, data, 0, chunk.name, (float) chunk.value ); }
 
 	static void RegisterCounter( ParserState_s& state, ParsedData_s& data, const chunk::Counter_Float_32& chunk )
-	{ RegisterCounter( state, data, chunk.name, (float) chunk.value ); }
+	{ RegisterCounter( state, data, 0, chunk.name, (float) chunk.value ); }
 
 	//==================================================================================
 
-	static void RegisterCounter( ParserState_s& state, ParsedData_s& data, uint64_t path_id, uint64_t name_id, float float_value )
-	{
-		const char* path = "<missing>";
-		const char* name = "<missing>";
-		state.Names.Lookup( path_id, path );
-		state.Names.Lookup( name_id, name );
-
-		static char merged[256] = "";
-		Str_Cpy( merged, path );
-		Str_Cat( merged, name );
-		
-		const char* unique = NameTable_Ensure( state.Db->NameTable, state.Db->StringPool, merged );
-		RegisterCounter( state, data, unique, float_value );
-	}
-
 	static void RegisterCounter( ParserState_s& state, ParsedData_s& data, const chunk::Counter_Path_U32_64& chunk )
 	{ RegisterCounter( state, data, chunk.path, chunk.name, (float) chunk.value ); }
 
@@ -487,14 +517,15 @@ namespace nemesis { namespace profiling
 
 	static void RegisterLog( ParserState_s& state, ParsedData_s& data, const chunk::Log& chunk )
 	{
-		const uint64_t location_key = MakeLocationKey( chunk.threadId, chunk.location );
+		const uint64_t location_key = MakeLocationKey( chunk.location );
 		const int thread_index = ParsedThreadTable_Ensure( data.Threads, chunk.threadId );
 		const int location_index = state.Locations[ location_key ];
 		const int text_len = chunk.header.size - sizeof(chunk);
-		LogItem& item = data.LogItems.Append();
+		LogItem& item = SegmentArray_Append( data.LogItems );
 		item.Text = StringPool_Alloc( state.Db->StringPool, chunk.text, text_len );;
 		item.Location = location_index;
 		item.Thread = (uint8_t)thread_index;
+		++state.OpenFrame.NumLogItems;
 	}
 
 	//==================================================================================
@@ -511,7 +542,7 @@ namespace nemesis { namespace profiling
 
 		// update parsed chunks data
 		{
-			Frame& frame = instance.ParsedChunks.Frames.Append();
+			Frame& frame = ParsedData_AppendFrame( instance.ParsedChunks );
 			frame = instance.State.OpenFrame;
 
 			// update limits
@@ -529,20 +560,21 @@ namespace nemesis { namespace profiling
 		// re-open frame
 		{
 			instance.State.OpenFrame.Time.End = instance.State.OpenFrame.Time.Begin;
-			instance.State.OpenFrame.FirstScopeEvent = 0;
 			instance.State.OpenFrame.NumScopeEvents = 0;
 			instance.State.OpenFrame.FirstLockEvent = 0;
 			instance.State.OpenFrame.NumLockEvents = 0;
 			instance.State.OpenFrame.FirstCounterValue = 0;
 			instance.State.OpenFrame.NumCounterValues = 0;
+			instance.State.OpenFrame.FirstLogItem = 0;
+			instance.State.OpenFrame.NumLogItems = 0;
 			instance.State.OpenFrame.ParsedBytes = 0;
 		}
 
 		// move completed frame to parsed frame data
 		{
-			NeLock/*Profiled*/( instance.ParsedFramesMutex );
-			ParsedData_Append( instance.ParsedFrames, instance.ParsedChunks );
+			ParsedData_Append( instance.ParsedFrames[ instance.WriteFrames ].Data, instance.ParsedChunks );
 			ParsedData_ResetFrames( instance.ParsedChunks );
+			ParserInstance_Publish( instance );
 		}
 	}
 
@@ -584,6 +616,10 @@ namespace nemesis { namespace profiling
 				EnterScopeEvent( state, data, *reinterpret_cast<const chunk::EnterScope*>(pos), GetEnterScopeType( pos->id ) );
 				break;
 
+			case chunk::Type::EnterDynamicScope:
+				EnterDynamicScopeEvent( state, data, *reinterpret_cast<const chunk::EnterDynamicScope*>(pos) );
+				break;
+
 			case chunk::Type::LeaveScope:
 				LeaveScopeEvent( state, data, *reinterpret_cast<const chunk::LeaveScope*>(pos) );
 				break;
@@ -648,6 +684,10 @@ namespace nemesis { namespace profiling
 				RegisterLocations( state, data, *reinterpret_cast<const chunk::LocationList*>(pos) );
 				break;
 
+			case chunk::Type::NameRelease:
+				// names stay valid for the frames already parsed
+				break;
+
 			case chunk::Type::Log:
 				RegisterLog( state, data, *reinterpret_cast<const chunk::Log*>(pos) );
 				break;
@@ -678,6 +718,7 @@ namespace nemesis { namespace profiling
 		union
 		{
 			chunk::EnterScope				enter_scope				;
+			chunk::EnterDynamicScope		enter_dynamic_scope		;
 			chunk::LeaveScope				leave_scope				;
 			chunk::EnterLock				enter_lock				;
 			chunk::LeaveLock				leave_lock				;
@@ -712,6 +753,11 @@ namespace nemesis { namespace profiling
 				EnterScopeEvent( state, data, enter_scope, GetEnterScopeType( enter_scope.header.id ) );
 				break;
 
+			case chunk::Type::EnterDynamicScope:
+				EndianSwap( *reinterpret_cast<const chunk::EnterDynamicScope*>(pos), enter_dynamic_scope );
+				EnterDynamicScopeEvent( state, data, enter_dynamic_scope );
+				break;
+
 			case chunk::Type::LeaveScope:
 				EndianSwap( *reinterpret_cast<const chunk::LeaveScope*>(pos), leave_scope );
 				LeaveScopeEvent( state, data, leave_scope );
@@ -790,6 +836,9 @@ namespace nemesis { namespace profiling
 				RegisterLocations_BigEndian( state, data, *reinterpret_cast<const chunk::LocationList*>(pos) );
 				break;
 
+			case chunk::Type::NameRelease:
+				break;
+
 			case chunk::Type::Log:
 				break;
 
@@ -809,6 +858,244 @@ namespace nemesis { namespace profiling
 
 } }
 
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static void AppendPartScope( ParsedPart_s& part, const ScopeEvent& ev )
+	{
+		NeAssert( ev.Thread < MAX_NUM_THREADS );
+		part.Scopes.Append( ev );
+		part.NumCpus = NeMax( part.NumCpus, (uint8_t)(1+ev.Cpu) );
+		if (ev.Enter)
+		{
+			++part.ZoneLevels[ ev.Thread ];
+			part.NumLevels[ ev.Thread ] = NeMax( part.NumLevels[ ev.Thread ], part.ZoneLevels[ ev.Thread ] );
+		}
+		else if (part.ZoneLevels[ ev.Thread ] > 0)
+		{
+			--part.ZoneLevels[ ev.Thread ];
+		}
+	}
+
+	/// Parses a single "enter scope_event" chunk on a worker.
+	static void EnterScopeEvent( ParsedPart_s& part, const ParserState_s& state, const chunk::EnterScope& chunk, ScopeType::Enum type )
+	{
+		AssertChunkSize();
+
+		const int key_idx = state.Locations.IndexOf( MakeLocationKey( chunk.location ) );
+		const int location_index = (key_idx >= 0) ? state.Locations.Values[ key_idx ] : -1;
+		const ScopeEvent ev = { chunk.timeStamp, (uint32_t)location_index, chunk.threadId, chunk.cpuId, (uint8_t)type, 1 };
+		AppendPartScope( part, ev );
+	}
+
+	/// Parses a single "enter dynamic scope_event" chunk on a worker.
+	/// Locations seen for the first time are created when the part is merged.
+	static void EnterDynamicScopeEvent( ParsedPart_s& part, const ParserState_s& state, const chunk::EnterDynamicScope& chunk )
+	{
+		AssertChunkSize();
+
+		const int key_idx = state.Locations.IndexOf( MakeDynamicLocationKey( chunk.location, chunk.name ) );
+		if (key_idx < 0)
+		{
+			const ParsedDynamicScope_s pending = { (uint32_t)part.Scopes.Count, chunk.location, chunk.name };
+			part.Pending.Append( pending );
+		}
+		const int location_index = (key_idx >= 0) ? state.Locations.Values[ key_idx ] : -1;
+		const ScopeEvent ev = { chunk.timeStamp, (uint32_t)location_index, chunk.threadId, chunk.cpuId, chunk.type, 1 };
+		AppendPartScope( part, ev );
+	}
+
+	/// Parses a single "leave scope_event" chunk on a worker.
+	static void LeaveScopeEvent( ParsedPart_s& part, const chunk::LeaveScope& chunk )
+	{
+		AssertChunkSize();
+
+		const ScopeEvent ev = { chunk.timeStamp, 0, chunk.threadId, chunk.cpuId, 0, 0 };
+		AppendPartScope( part, ev );
+	}
+
+	/// Parses a single "enter lock" or "leave lock" chunk on a worker.
+	static void AppendPartLock( ParsedPart_s& part, Tick time, uint64_t handle, uint8_t thread_id, bool enter )
+	{
+		ParsedLockEvent_s& ev = part.LockEvents.Append();
+		ev.Time = time;
+		ev.Handle = handle;
+		ev.Thread = thread_id;
+		ev.Enter = enter ? 1 : 0;
+	}
+
+	/// Parses the scope and lock events of a single recording thread.
+	/// Only reads the parser state, which does not change until the pool is joined.
+	void ParsedPart_ParseChunks( ParsedPart_s& part, const ParserState_s& state, const Chunk* head, uint32_t size )
+	{
+		const Chunk* pos = head;
+		const Chunk* end = NeSkip(pos, size);
+		for ( ; pos < end; pos = NeSkip( pos, pos->size ) )
+		{
+			switch ( pos->id )
+			{
+			case chunk::Type::EnterLockScope:
+			case chunk::Type::EnterIdleScope:
+			case chunk::Type::EnterScope:
+				EnterScopeEvent( part, state, *reinterpret_cast<const chunk::EnterScope*>(pos), GetEnterScopeType( pos->id ) );
+				break;
+
+			case chunk::Type::EnterDynamicScope:
+				EnterDynamicScopeEvent( part, state, *reinterpret_cast<const chunk::EnterDynamicScope*>(pos) );
+				break;
+
+			case chunk::Type::LeaveScope:
+				LeaveScopeEvent( part, *reinterpret_cast<const chunk::LeaveScope*>(pos) );
+				break;
+
+			case chunk::Type::EnterLock:
+				{
+					const chunk::EnterLock& chunk = *reinterpret_cast<const chunk::EnterLock*>(pos);
+					AssertChunkSize();
+					AppendPartLock( part, chunk.timeStamp, chunk.lockId, chunk.threadId, true );
+				}
+				break;
+
+			case chunk::Type::LeaveLock:
+				{
+					const chunk::LeaveLock& chunk = *reinterpret_cast<const chunk::LeaveLock*>(pos);
+					AssertChunkSize();
+					AppendPartLock( part, chunk.timeStamp, chunk.lockId, chunk.threadId, false );
+				}
+				break;
+
+			default:
+				// everything else is parsed on the parser thread
+				break;
+			}
+		}
+	}
+
+	//==================================================================================
+
+	/// Appends the events of a worker to the open frame.
+	/// Thread ids are translated to thread indices and pending locations are created.
+	static void MergePart( ParserState_s& state, ParsedData_s& data, ParsedPart_s& part )
+	{
+		for ( int i = 0; i < part.Pending.Count; ++i )
+		{
+			const ParsedDynamicScope_s& pending = part.Pending[i];
+			part.Scopes[ pending.Scope ].Location = (uint32_t)EnsureDynamicLocation( state, data, pending.Location, pending.Name );
+		}
+
+		int thread_index[ MAX_NUM_THREADS ];
+		for ( int i = 0; i < MAX_NUM_THREADS; ++i )
+			thread_index[i] = -1;
+
+		for ( int i = 0; i < part.Scopes.Count; ++i )
+		{
+			const ScopeEvent& ev = part.Scopes[i];
+			if (thread_index[ ev.Thread ] < 0)
+				thread_index[ ev.Thread ] = ParsedThreadTable_Ensure( data.Threads, ev.Thread );
+			ParsedScopes_Append( data.Scopes[ thread_index[ ev.Thread ] ], ev );
+		}
+
+		for ( int i = 0; i < MAX_NUM_THREADS; ++i )
+		{
+			if (thread_index[i] < 0)
+				continue;
+			Thread& thread = data.Threads.Item[ thread_index[i] ];
+			thread.NumLevels = NeMax( thread.NumLevels, part.NumLevels[i] );
+		}
+		data.NumCpus = NeMax( data.NumCpus, part.NumCpus );
+
+		for ( int i = 0; i < part.LockEvents.Count; ++i )
+		{
+			const ParsedLockEvent_s& it = part.LockEvents[i];
+			LockEvent& ev = SegmentArray_Append( data.LockEvents );
+			ev.Enter = it.Enter;
+			ev.Lock = EnsureLock( state, data, it.Handle );
+			ev.Thread = (uint8_t)ParsedThreadTable_Ensure( data.Threads, it.Thread );
+			ev.Tick = it.Time;
+		}
+
+		state.OpenFrame.NumScopeEvents += part.Scopes.Count;
+		state.OpenFrame.NumLockEvents += part.LockEvents.Count;
+		ParsedPart_ResetFrame( part );
+	}
+
+	static uint32_t ChunkBytes( const Chunk* begin, const Chunk* end )
+	{
+		return (uint32_t)((const uint8_t*)end - (const uint8_t*)begin);
+	}
+
+	/// Merges the workers in a fixed order, so the result does not depend on timing.
+	static void MergeParts( ParserInstance_s& instance )
+	{
+		ParserPool_s& pool = instance.Pool;
+		for ( int i = 0; i < pool.NumWorkers; ++i )
+			MergePart( instance.State, instance.ParsedChunks, pool.Worker[i].Part );
+	}
+
+	/// Parses chunks of a single recording thread generated by a little-endian machine.
+	/// Scope and lock events go to the worker pool, everything else is parsed in place.
+	static void ParseChunksParallel( ParserInstance_s& instance, int thread, const Chunk* head, uint32_t size )
+	{
+		ParserPool_s& pool = instance.Pool;
+
+		const Chunk* segment = head;
+		const Chunk* pos = head;
+		const Chunk* end = NeSkip(pos, size);
+		for ( ; pos < end; pos = NeSkip( pos, pos->size ) )
+		{
+			switch ( pos->id )
+			{
+			case chunk::Type::EnterLockScope:
+			case chunk::Type::EnterIdleScope:
+			case chunk::Type::EnterScope:
+			case chunk::Type::EnterDynamicScope:
+			case chunk::Type::LeaveScope:
+			case chunk::Type::EnterLock:
+			case chunk::Type::LeaveLock:
+				instance.State.OpenFrame.ParsedBytes += pos->size;
+				break;
+
+			case chunk::Type::Counter_U32_32:
+			case chunk::Type::Counter_U32_64:
+			case chunk::Type::Counter_Float_32:
+			case chunk::Type::Counter_Float_64:
+			case chunk::Type::Counter_Path_U32_32:
+			case chunk::Type::Counter_Path_U32_64:
+			case chunk::Type::Counter_Path_Float_32:
+			case chunk::Type::Counter_Path_Float_64:
+			case chunk::Type::Log:
+				// independent of the events the workers are parsing
+				ParseChunksLittleEndian( instance, pos, pos->size );
+				break;
+
+			case chunk::Type::EndFrame:
+			case chunk::Type::NameList:
+			case chunk::Type::LocationList:
+			case chunk::Type::ThreadInfo:
+			case chunk::Type::MutexInfo:
+			case chunk::Type::NameRelease:
+			case chunk::Type::Connect:
+				// the workers read the parser state, so they must be idle while it changes
+				ParserPool_Submit( pool, thread, segment, ChunkBytes( segment, pos ) );
+				ParserPool_Join( pool );
+				if (pos->id == chunk::Type::EndFrame)
+					MergeParts( instance );
+				ParseChunksLittleEndian( instance, pos, pos->size );
+				segment = NeSkip( pos, pos->size );
+				break;
+
+			default:
+				// stop parsing here because the size field
+				//	cannot be relied updon
+				end = pos;
+				break;
+			}
+		}
+		ParserPool_Submit( pool, thread, segment, ChunkBytes( segment, end ) );
+	}
+
+} }
+
 //======================================================================================
 namespace nemesis { namespace profiling
 {
@@ -819,6 +1106,10 @@ namespace nemesis { namespace profiling
 		state.Names.Values.Alloc = alloc;
 		state.Locations.Keys.Alloc = alloc;
 		state.Locations.Values.Alloc = alloc;
+		HashTable_Init( state.Counters, alloc );
+		state.CounterKeys.Init( alloc );
+		HashTable_Init( state.CounterGroups, alloc );
+		HashTable_Init( state.Locks, alloc );
 	}
 
 	/// Frees dynamic memory allocated by the data set.
@@ -826,6 +1117,10 @@ namespace nemesis { namespace profiling
 	{
 		state.Names.Clear();
 		state.Locations.Clear();
+		HashTable_Clear( state.Counters );
+		state.CounterKeys.Clear();
+		HashTable_Clear( state.CounterGroups );
+		HashTable_Clear( state.Locks );
 	}
 
 	/// Resets data members withot freeing allocated memory.
@@ -835,7 +1130,10 @@ namespace nemesis { namespace profiling
 		NeZero(state.ZoneLevels);
 		state.Names.Reset();
 		state.Locations.Reset();
-		Database_ResetStrings( state.Db );
+		HashTable_Reset( state.Counters );
+		state.CounterKeys.Reset();
+		HashTable_Reset( state.CounterGroups );
+		HashTable_Reset( state.Locks );
 	}
 
 } }
@@ -846,51 +1144,99 @@ namespace nemesis { namespace profiling
 	/// Initializes data member for first use.
 	void ParserInstance_Initialize( ParserInstance_s& instance, Allocator_t alloc, Database_t db )
 	{
-		CriticalSection_Create( instance.ParsedFramesMutex );
 		ParserState_Initialize( instance.State, alloc );
 		ParsedData_Initialize( instance.ParsedChunks , alloc );
-		ParsedData_Initialize( instance.ParsedFrames , alloc );
+		for ( int i = 0; i < 2; ++i )
+		{
+			ParsedData_Initialize( instance.ParsedFrames[i].Data, alloc );
+			instance.ParsedFrames[i].RetiredStrings.Init( db->StringPool.Pages.Alloc );
+			instance.ParsedFrames[i].Reset = 0;
+		}
+		instance.WriteFrames = 0;
+		instance.JoinRequest = 1;
+		ParserPool_Initialize( instance.Pool, alloc, &instance.State );
 		instance.State.Db = db;
 	}
 
 	/// Frees dynamic memory.
 	void ParserInstance_Shutdown( ParserInstance_s& instance )
 	{
+		ParserPool_Shutdown( instance.Pool );
 		ParserState_Shutdown( instance.State );
 		ParsedData_Shutdown( instance.ParsedChunks );
-		ParsedData_Shutdown( instance.ParsedFrames );
-		CriticalSection_Destroy( instance.ParsedFramesMutex );
+		for ( int i = 0; i < 2; ++i )
+		{
+			ParsedData_Shutdown( instance.ParsedFrames[i].Data );
+			Database_FreeStrings( instance.ParsedFrames[i].RetiredStrings );
+			instance.ParsedFrames[i].RetiredStrings.Clear();
+		}
 	}
 
 	/// Resets data members without freeing allocated memory.
+	/// Frames already handed over are still joined, the joined data is reset before the next ones.
+	/// The strings they refer to are freed by the joining thread along with them.
 	void ParserInstance_Reset( ParserInstance_s& instance )
 	{
-		NeLock/*Profiled*/(instance.ParsedFramesMutex);
+		ParserPool_Reset( instance.Pool );
 		ParserState_Reset( instance.State );
 		ParsedData_Reset( instance.ParsedChunks );
-		ParsedData_Reset( instance.ParsedFrames );
-		instance.State.Reset = true;
+		ParsedFrames_s& frames = instance.ParsedFrames[ instance.WriteFrames ];
+		ParsedData_Reset( frames.Data );
+		Database_RetireStrings( instance.State.Db, frames.RetiredStrings );
+		frames.Reset = 1;
+		ParserInstance_Publish( instance );
 	}
 
 	/// Parses a stream of profiling chunks.
-	void ParserInstance_ParseChunks( ParserInstance_s& instance, const Chunk* head, uint32_t size, bool big_endian )
+	/// Chunks of a known recording thread are spread across the worker pool.
+	void ParserInstance_ParseChunks( ParserInstance_s& instance, int thread, const Chunk* head, uint32_t size, bool big_endian )
 	{
+		if ((thread >= 0) && !big_endian)
+			return ParseChunksParallel( instance, thread, head, size );
+
+		ParserPool_Join( instance.Pool );
 		return big_endian
 			? ParseChunksBigEndian   ( instance, head, size )
 			: ParseChunksLittleEndian( instance, head, size );
 	}
 
-	/// Moves fully parsed frames from the parser to the joined data set. 
+	/// Hands the frames completed so far over to the joining thread if it asked for them.
+	/// Called by the thread owning the parser state.
+	void ParserInstance_Publish( ParserInstance_s& instance )
+	{
+		const ParsedFrames_s& frames = instance.ParsedFrames[ instance.WriteFrames ];
+		if (!frames.Data.Frames.Count() && !frames.Reset)
+			return;
+		if (!Interlocked_Load( &instance.JoinRequest ))
+			return;
+		Interlocked_Exchange( &instance.WriteFrames, instance.WriteFrames ^ 1 );
+		Interlocked_Exchange( &instance.JoinRequest, 0 );
+	}
+
+	/// Returns the frames handed over by the parser or null if there are none yet.
+	const ParsedFrames_s* ParserInstance_GetJoinable( ParserInstance_s& instance )
+	{
+		if (Interlocked_Load( &instance.JoinRequest ))
+			return nullptr;
+		return &instance.ParsedFrames[ Interlocked_Load( &instance.WriteFrames ) ^ 1 ];
+	}
+
+	/// Moves the frames handed over by the parser to the joined data set and asks for the next ones.
 	void ParserInstance_JoinFrames( ParserInstance_s& instance, ParsedData_s& joined )
 	{
-		if (instance.State.Reset)
+		if (Interlocked_Load( &instance.JoinRequest ))
+			return;
+		ParsedFrames_s& frames = instance.ParsedFrames[ Interlocked_Load( &instance.WriteFrames ) ^ 1 ];
+		if (frames.Reset)
 		{
-			instance.State.Reset = false;
+			frames.Reset = 0;
 			ParsedData_Reset( joined );
+			Database_FreeStrings( frames.RetiredStrings );
 		}
-		NeLock/*Profiled*/( instance.ParsedFramesMutex );
-		ParsedData_Append( joined, instance.ParsedFrames );
-		ParsedData_ResetFrames( instance.ParsedFrames );
+		ParsedData_Append( joined, frames.Data );
+		ParsedData_ResetFrames( frames.Data );
+		ParsedData_BuildIndices( joined );
+		Interlocked_Exchange( &instance.JoinRequest, 1 );
 	}
 
 } }
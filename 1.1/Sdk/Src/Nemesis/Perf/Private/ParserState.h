@@ -10,37 +10,70 @@
 
 //======================================================================================
 #include "ParserData.h"
+#include "ParserPool.h"
+
+//======================================================================================
+#include <Nemesis/Core/Atomic.h>
+#include <Nemesis/Core/HashTable.h>
 
 //======================================================================================
 namespace nemesis { namespace profiling
 {
+	/// Source ids of a counter, compared when its hash key is found.
+	struct ParsedCounterKey_s
+	{
+		uint64_t Path;
+		uint64_t Name;
+	};
+
 	struct ParserState_s
 	{
 		Database_t Db;
 		viz::Frame OpenFrame;
 		BinaryArrayMap<uint64_t, cstr_t> Names;
 		BinaryArrayMap<uint64_t, int> Locations;
+		HashTable_64_32_s Counters;
+		Array<ParsedCounterKey_s> CounterKeys;
+		HashTable_64_32_s CounterGroups;
+		HashTable_64_32_s Locks;
 		uint8_t ZoneLevels[ MAX_NUM_THREADS ];
-		uint32_t Reset : 1;
 	};
 
+	void ParsedPart_ParseChunks( ParsedPart_s& part, const ParserState_s& state, const Chunk* head, uint32_t size );
+
 } }
 
 //======================================================================================
 namespace nemesis { namespace profiling
 {
+	/// Completed frames handed from the parser to the joining thread.
+	struct ParsedFrames_s
+	{
+		ParsedData_s	Data;
+		Array<Page_s*>	RetiredStrings;	///< String pages of the data before the reset, freed along with it
+		int32_t			Reset;	///< The joined data is reset before the frames are appended
+		int32_t			_pad_;
+	};
+
+	/// The parser appends completed frames to ParsedFrames[WriteFrames] without locking.
+	/// Once the joining thread has consumed the other buffer it sets JoinRequest,
+	/// and the parser hands over its buffer by flipping WriteFrames and clearing the request.
 	struct ParserInstance_s
 	{
 		ParserState_s		State;
 		ParsedData_s		ParsedChunks;
-		ParsedData_s		ParsedFrames;
-		CriticalSection_t	ParsedFramesMutex;
+		ParsedFrames_s		ParsedFrames[2];
+		Atomic32			WriteFrames;
+		Atomic32			JoinRequest;
+		ParserPool_s		Pool;
 	};
 
 	void ParserInstance_Initialize	( ParserInstance_s& instance, Allocator_t alloc, Database_t db );
 	void ParserInstance_Shutdown	( ParserInstance_s& instance );
 	void ParserInstance_Reset		( ParserInstance_s& instance );
-	void ParserInstance_ParseChunks	( ParserInstance_s& instance, const Chunk* head, uint32_t size, bool big_endian );
+	void ParserInstance_ParseChunks	( ParserInstance_s& instance, int thread, const Chunk* head, uint32_t size, bool big_endian );
+	void ParserInstance_Publish		( ParserInstance_s& instance );
+	const ParsedFrames_s* ParserInstance_GetJoinable( ParserInstance_s& instance );
 	void ParserInstance_JoinFrames	( ParserInstance_s& instance, ParsedData_s& joined );
 
 } }
@@ -0,0 +1,112 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#include "stdafx.h"
+#include "QueryPool.h"
+
+//======================================================================================
+#include <Nemesis/Core/Process.h>
+
+//======================================================================================
+using namespace nemesis::system;
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	/// Processes morsels until all of them are claimed.
+	static void QueryPool_Drain( QueryPool_s& pool, int slot )
+	{
+		for ( ;; )
+		{
+			const int morsel = Interlocked_Add( &pool.NextMorsel, 1 );
+			if (morsel >= pool.NumMorsels)
+				return;
+			pool.Func( pool.Context, slot, morsel );
+		}
+	}
+
+	static void QueryWorker_Run( QueryWorker_s* worker )
+	{
+		QueryPool_s& pool = *worker->Pool;
+		for ( ;; )
+		{
+			Semaphore_Wait( worker->Start );
+			if (!worker->Worker.Continue)
+				return;
+			QueryPool_Drain( pool, worker->Slot );
+			if (Interlocked_Add( &pool.Running, -1 ) == 1)
+				Semaphore_Signal( pool.Done, 1 );
+		}
+	}
+
+	static void NE_CALLBK QueryWorker_Proc( void* worker )
+	{
+		QueryWorker_Run( (QueryWorker_s*) worker );
+	}
+
+	static void QueryPool_Start( QueryPool_s& pool )
+	{
+		pool.Done = Semaphore_Create( 0, 1 );
+		pool.NumWorkers = MAX_NUM_QUERY_WORKERS;
+		for ( int i = 0; i < pool.NumWorkers; ++i )
+		{
+			QueryWorker_s& worker = pool.Worker[i];
+			worker.Pool	 = &pool;
+			worker.Slot	 = i + 1;
+			worker.Start = Semaphore_Create( 0, 1 );
+
+			const ThreadSetup_s thread_setup = { "[NePerf] Query Worker", QueryWorker_Proc, &worker };
+			Worker_Start( &worker.Worker, thread_setup );
+		}
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	void QueryPool_Initialize( QueryPool_s& pool )
+	{
+		NeZero( pool );
+	}
+
+	void QueryPool_Shutdown( QueryPool_s& pool )
+	{
+		for ( int i = 0; i < pool.NumWorkers; ++i )
+		{
+			QueryWorker_s& worker = pool.Worker[i];
+			Worker_Stop( &worker.Worker );
+			Semaphore_Signal( worker.Start, 1 );
+			Worker_Wait( &worker.Worker );
+			Semaphore_Destroy( worker.Start );
+		}
+		if (pool.NumWorkers)
+			Semaphore_Destroy( pool.Done );
+		pool.NumWorkers = 0;
+	}
+
+	/// Processes all morsels on the workers and the calling thread, which uses slot 0.
+	/// Returns once every morsel is done.
+	void QueryPool_Run( QueryPool_s& pool, int num_morsels, QueryMorselFunc func, void* context )
+	{
+		if (!pool.NumWorkers)
+			QueryPool_Start( pool );
+
+		pool.Func		= func;
+		pool.Context	= context;
+		pool.NumMorsels = num_morsels;
+		Interlocked_Exchange( &pool.NextMorsel, 0 );
+		Interlocked_Exchange( &pool.Running, pool.NumWorkers );
+		for ( int i = 0; i < pool.NumWorkers; ++i )
+			Semaphore_Signal( pool.Worker[i].Start, 1 );
+
+		QueryPool_Drain( pool, 0 );
+		Semaphore_Wait( pool.Done );
+	}
+
+} }
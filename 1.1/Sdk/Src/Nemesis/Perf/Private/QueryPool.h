@@ -0,0 +1,56 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+#include "Types.h"
+#include "Constants.h"
+#include "Worker.h"
+
+//======================================================================================
+#include <Nemesis/Core/Atomic.h>
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	struct QueryPool_s;
+
+	/// Processes a single morsel of a query. The slot identifies the calling thread.
+	typedef void (*QueryMorselFunc)( void* context, int slot, int morsel );
+
+	struct QueryWorker_s
+	{
+		Worker_s				Worker;
+		QueryPool_s*			Pool;
+		system::Semaphore_t		Start;
+		int32_t					Slot;
+		int32_t					_pad_;
+	};
+
+	/// Workers which process the morsels of a query alongside the calling thread.
+	/// Workers are started by the first query and claim morsels until none are left.
+	struct QueryPool_s
+	{
+		int					NumWorkers;
+		int					NumMorsels;
+		Atomic32			NextMorsel;
+		Atomic32			Running;
+		QueryMorselFunc		Func;
+		void*				Context;
+		system::Semaphore_t	Done;
+		QueryWorker_s		Worker[ MAX_NUM_QUERY_WORKERS ];
+	};
+
+	enum { NUM_QUERY_SLOTS = MAX_NUM_QUERY_WORKERS + 1 };
+
+	void QueryPool_Initialize	( QueryPool_s& pool );
+	void QueryPool_Shutdown		( QueryPool_s& pool );
+	void QueryPool_Run			( QueryPool_s& pool, int num_morsels, QueryMorselFunc func, void* context );
+
+} }
@@ -13,6 +13,8 @@
 #include "Constants.h"
 
 //======================================================================================
+#include <Nemesis/Core/File.h>
+#include <Nemesis/Core/Memory.h>
 #include <Nemesis/Core/Process.h>
 #include <Nemesis/Core/Socket.h>
 
@@ -28,41 +30,116 @@ namespace nemesis { namespace profiling
 			callback.PacketReceived( callback.UserContext, client, packet, head );
 	}
 
-	static bool Receiver_ReceivePacket( Receiver_s* rcv, Packet& packet )
+	static bool Receiver_ReadHeader( const uint8_t* data, Packet& packet )
 	{
-		rcv->Buffer.Resize( packet.DataSize() );
-		if (!Tcp_Receive( rcv->Socket, rcv->Buffer.Data, rcv->Buffer.Count ))
+		Mem_Cpy( &packet, data, sizeof(packet) );
+		if (packet.header.id == chunk::Type::Packet)
+			return true;
+		if (packet.header.id != EndianSwap((uint32_t)chunk::Type::Packet))
 			return false;
-		ReceiverCallback_Notify( rcv->Callback, rcv->Socket, packet, (Chunk*)rcv->Buffer.Data );
+		packet.header.id = EndianSwap(packet.header.id);
+		packet.header.size = EndianSwap(packet.header.size);
+		packet.flags = Packet::BigEndian;
+		packet.source = EndianSwap(packet.source);
 		return true;
 	}
 
-	static void Receiver_ReceiveFromServer( Receiver_s* rcv )
+	/// Hands every complete packet in [begin, end) to the callback without copying it.
+	static bool Receiver_FramePackets( Receiver_s* rcv, int& begin, int end )
 	{
+		const uint8_t* data = rcv->Buffer.Data;
 		Packet packet;
+		while ( (end - begin) >= (int)sizeof(Packet) )
+		{
+			if (!Receiver_ReadHeader( data + begin, packet ))
+				return false;
+			if ((packet.header.size < sizeof(Packet)) || (packet.header.size > (uint32_t)rcv->Buffer.Count))
+				return false;
+			if ((uint32_t)(end - begin) < packet.header.size)
+				break;
+			ReceiverCallback_Notify( rcv->Callback, rcv->Socket, packet, (const Chunk*)(data + begin + sizeof(Packet)) );
+			begin += packet.header.size;
+		}
+		return true;
+	}
 
-		for ( bool ok = true; ok; )
+	static void Receiver_ReceiveFromServer( Receiver_s* rcv )
+	{
+		uint8_t* data = rcv->Buffer.Data;
+		const int capacity = rcv->Buffer.Count;
+		int begin = 0;
+		int end = 0;
+		for ( ;; )
 		{
 			Event_Wait( rcv->PauseEvent );
-			if (!Tcp_Receive( rcv->Socket, &packet, sizeof(packet) ))
-				return;
 
-			if (packet.header.id == chunk::Type::Packet)
-			{
-				ok = Receiver_ReceivePacket( rcv, packet );
-			}
-			else if (packet.header.id == EndianSwap((uint32_t)chunk::Type::Packet))
+			// move the trailing partial packet to the front
+			if (begin)
 			{
-				packet.header.id = EndianSwap(packet.header.id);
-				packet.header.size = EndianSwap(packet.header.size);
-				packet.flags = Packet::BigEndian;
-				packet.reserved = 0;
-				ok = Receiver_ReceivePacket( rcv, packet );
+				Mem_Mov( data, data + begin, end - begin );
+				end -= begin;
+				begin = 0;
 			}
-			else
+
+			const int read = Tcp_ReceiveSome( rcv->Socket, data + end, capacity - end );
+			if (read <= 0)
+				return;
+			end += read;
+
+			if (!Receiver_FramePackets( rcv, begin, end ))
+				return;
+		}
+	}
+
+	static void Receiver_ReceiveFromFile( Receiver_s* rcv )
+	{
+		uint8_t* data = rcv->Buffer.Data;
+		const int capacity = rcv->Buffer.Count;
+		int begin = 0;
+		int end = 0;
+		while ( rcv->Worker.Continue )
+		{
+			Event_Wait( rcv->PauseEvent );
+
+			// move the trailing partial packet to the front
+			if (begin)
 			{
-				ok = false;
+				Mem_Mov( data, data + begin, end - begin );
+				end -= begin;
+				begin = 0;
 			}
+
+			uint32_t read = 0;
+			if (NeFailed( File_Read( rcv->File, data + end, (uint32_t)(capacity - end), &read ) ) || !read)
+				return;
+			end += (int)read;
+
+			if (!Receiver_FramePackets( rcv, begin, end ))
+				return;
+		}
+	}
+
+	static void Receiver_ReceiveFromRing( Receiver_s* rcv )
+	{
+		SharedRing_s* ring = &rcv->Ring;
+		uint32_t size = 0;
+		while ( rcv->Worker.Continue )
+		{
+			Event_Wait( rcv->PauseEvent );
+			if (SharedRing_IsClosed( ring ))
+				return;
+			if (!SharedRing_IsAttached( ring ))
+				SharedRing_Attach( ring );
+
+			const uint8_t* data = SharedRing_Peek( ring, size, SHARED_RING_WAIT_MS );
+			if (!data)
+				continue;
+
+			// same host, so packets are always in native byte order
+			const Packet* packet = (const Packet*)data;
+			if (packet->header.id == chunk::Type::Packet)
+				ReceiverCallback_Notify( rcv->Callback, nullptr, *packet, (const Chunk*)(packet+1) );
+			SharedRing_Release( ring );
 		}
 	}
 
@@ -83,6 +160,36 @@ namespace nemesis { namespace profiling
 		Receiver_Run( (Receiver_s*) rcv );
 	}
 
+	static void Receiver_CloseFile( Receiver_t rcv )
+	{
+		if (!rcv->File)
+			return;
+		File_Close( rcv->File );
+		rcv->File = nullptr;
+	}
+
+	static void Receiver_RunFile( Receiver_s* rcv )
+	{
+		Receiver_ReceiveFromFile( rcv );
+		Receiver_CloseFile( rcv );
+	}
+
+	static void NE_CALLBK Receiver_FileProc( void* rcv )
+	{
+		Receiver_RunFile( (Receiver_s*) rcv );
+	}
+
+	static void Receiver_RunShared( Receiver_s* rcv )
+	{
+		Receiver_ReceiveFromRing( rcv );
+		SharedRing_Close( &rcv->Ring );
+	}
+
+	static void NE_CALLBK Receiver_SharedProc( void* rcv )
+	{
+		Receiver_RunShared( (Receiver_s*) rcv );
+	}
+
 } }
 
 //======================================================================================
@@ -93,7 +200,7 @@ namespace nemesis { namespace profiling
 		rcv->Alloc		  = alloc;
 		rcv->PauseEvent   = Event_Create( true );
 		rcv->Buffer.Alloc = alloc;
-		rcv->Buffer.Resize( BUFFER_SIZE );
+		rcv->Buffer.Resize( RECEIVE_BUFFER_SIZE );
 	}
 
 	bool Receiver_IsPaused( Receiver_t rcv )
@@ -117,12 +224,12 @@ namespace nemesis { namespace profiling
 
 	bool Receiver_IsConnected( Receiver_t rcv )
 	{
-		return rcv->Socket != nullptr;
+		return (rcv->Socket != nullptr) || (rcv->Ring.Header != nullptr) || (rcv->File != nullptr);
 	}
 
 	Connect::Result Receiver_Connect( Receiver_t rcv, IpAddress_t addr, const ReceiverCallback& callback )
 	{
-		if (rcv->Socket)
+		if (Receiver_IsConnected( rcv ))
 			return Connect::AlreadyConnected;
 
 		rcv->Socket = Tcp_Connect( addr );
@@ -136,12 +243,49 @@ namespace nemesis { namespace profiling
 		return Connect::Ok;
 	}
 
+	Connect::Result Receiver_ConnectShared( Receiver_t rcv, cstr_t name, const ReceiverCallback& callback )
+	{
+		if (Receiver_IsConnected( rcv ))
+			return Connect::AlreadyConnected;
+
+		if (NeFailed(SharedRing_Open( &rcv->Ring, name )))
+			return Connect::Failed;
+
+		rcv->Callback = callback;
+
+		const ThreadSetup_s thread_setup = { "[NePerf] Receiver", Receiver_SharedProc, rcv };
+		Worker_Start( &rcv->Worker, thread_setup );
+		return Connect::Ok;
+	}
+
+	/// Replays a stream of packets recorded to a file.
+	/// The receiver disconnects itself at the end of the file.
+	Connect::Result Receiver_ConnectFile( Receiver_t rcv, cstr_t path, const ReceiverCallback& callback )
+	{
+		if (Receiver_IsConnected( rcv ))
+			return Connect::AlreadyConnected;
+
+		if (NeFailed( File_Create( path, FileCreate::OpenExisting, FileAccess::Read, &rcv->File ) ))
+		{
+			rcv->File = nullptr;
+			return Connect::Failed;
+		}
+
+		rcv->Callback = callback;
+
+		const ThreadSetup_s thread_setup = { "[NePerf] Receiver", Receiver_FileProc, rcv };
+		Worker_Start( &rcv->Worker, thread_setup );
+		return Connect::Ok;
+	}
+
 	void Receiver_Disconnect( Receiver_t rcv )
 	{
 		Receiver_CloseSocket( rcv );
 		Receiver_Pause( rcv, false );
 		Worker_Stop( &rcv->Worker );
 		Worker_Wait( &rcv->Worker );
+		SharedRing_Close( &rcv->Ring );
+		Receiver_CloseFile( rcv );
 	}
 
 	void Receiver_Shutdown( Receiver_t rcv )
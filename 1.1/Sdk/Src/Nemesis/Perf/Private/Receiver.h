@@ -13,6 +13,10 @@
 
 //======================================================================================
 #include "Worker.h"
+#include "SharedRing.h"
+
+//======================================================================================
+#include <Nemesis/Core/FileTypes.h>
 
 //======================================================================================
 namespace nemesis { namespace profiling
@@ -21,6 +25,8 @@ namespace nemesis { namespace profiling
 	{
 		Allocator_t			Alloc;
 		Socket_t			Socket;
+		system::File_t		File;
+		SharedRing_s		Ring;
 		int32_t				Paused;
 		Event_t				PauseEvent;
 		ReceiverCallback	Callback;
@@ -33,6 +39,8 @@ namespace nemesis { namespace profiling
 	void Receiver_Pause( Receiver_t rcv, bool pause );
 	bool Receiver_IsConnected( Receiver_t rcv );
 	Connect::Result Receiver_Connect( Receiver_t rcv, system::IpAddress_t addr, const ReceiverCallback& callback );
+	Connect::Result Receiver_ConnectShared( Receiver_t rcv, cstr_t name, const ReceiverCallback& callback );
+	Connect::Result Receiver_ConnectFile( Receiver_t rcv, cstr_t path, const ReceiverCallback& callback );
 	void Receiver_Disconnect( Receiver_t rcv );
 	void Receiver_Shutdown( Receiver_t rcv );
 
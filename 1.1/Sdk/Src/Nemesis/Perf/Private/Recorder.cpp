@@ -28,99 +28,13 @@ using namespace nemesis::system;
 //======================================================================================
 namespace nemesis { namespace profiling
 {
-	static bool ThreadRecorder_FlushNameTable( ThreadRecorder_t tr, Buffer_t buffer )
+	/// Looks up the thread local cache first and only locks the shared registry on a miss.
+	static void ThreadRecorder_RegisterName( ThreadRecorder_t tr, cstr_t name )
 	{
-		uint64_t id  = 0;
-		uint16_t len = 0;
-		chunk::NameList header = { { (uint32_t)chunk::Type::NameList, 0 }, 1 };
-		for ( int i = tr->FlushName; i < tr->NameVal.Count; ++i )
-		{
-			const size_t chunk_size	 = sizeof(header) + sizeof(id) + sizeof(len) + tr->NameLen[i];
-			const size_t remain_size = sizeof(buffer->Data) - buffer->Count;
-			if (chunk_size > remain_size)
-				return false;
-
-			header.header.size	= (uint32_t)chunk_size;
-			id					= (uint64_t)tr->NameVal[i];
-			len					= tr->NameLen[i];
-			Mem_Cpy( buffer->Data + buffer->Count, &header		 , sizeof(header) ); buffer->Count += sizeof(header);
-			Mem_Cpy( buffer->Data + buffer->Count, &id			 , sizeof(id)	  ); buffer->Count += sizeof(id);
-			Mem_Cpy( buffer->Data + buffer->Count, &len			 , sizeof(len)	  ); buffer->Count += sizeof(len);
-			Mem_Cpy( buffer->Data + buffer->Count, tr->NameVal[i], len			  ); buffer->Count += len;
-			++tr->FlushName;
-		}
-		return true;
-	}
-
-	static bool ThreadRecorder_FlushSiteTable( ThreadRecorder_t tr, Buffer_t buffer )
-	{
-		chunk::LocationItem item   = {};
-		chunk::LocationList header = { { chunk::Type::LocationList, 0 }, 1, tr->Index };
-		for ( int i = tr->FlushSite; i < tr->SiteVal.Count; ++i )
-		{
-			const size_t chunk_size		= sizeof(header) + sizeof(item);
-			const size_t remain_size	= sizeof(buffer->Data) - buffer->Count;
-			if (chunk_size > remain_size)
-				return false;
-			header.header.size	= (uint32_t)chunk_size;
-			const NamedLocation& loc = tr->SiteVal[i];
-			item.name = (size_t)loc.Name;
-			item.func = (size_t)loc.Location.Function;
-			item.file = (size_t)loc.Location.File;
-			item.line = (uint64_t)loc.Location.Line;
-			item.id   = (uint32_t)i;
-			Mem_Cpy( buffer->Data + buffer->Count, &header, sizeof(header) ); buffer->Count += sizeof(header);
-			Mem_Cpy( buffer->Data + buffer->Count, &item  , sizeof(item)   ); buffer->Count += sizeof(item);
-			++tr->FlushSite;
-		}
-		return true;
-	}
-
-	static bool ThreadRecorder_FlushThreadTable( ThreadRecorder_t tr, Buffer_t buffer )
-	{
-		chunk::ThreadInfo header = { { chunk::Type::ThreadInfo, sizeof(header) } };
-		for ( int i = tr->FlushThread; i < tr->ThreadKey.Count; ++i )
-		{
-			const size_t chunk_size = sizeof(header);
-			const size_t remain_size = sizeof(buffer->Data) - buffer->Count;
-			if (chunk_size > remain_size)
-				return false;
-			header.threadId = tr->ThreadKey[i];
-			header.name		= (uint64_t)tr->ThreadVal[i];
-			Mem_Cpy( buffer->Data + buffer->Count, &header, sizeof(header) ); buffer->Count += sizeof(header);
-			++tr->FlushThread;
-		}
-		return true;
-	}
-
-	static bool ThreadRecorder_FlushMutexTable( ThreadRecorder_t tr, Buffer_t buffer )
-	{
-		chunk::MutexInfo header = { { chunk::Type::MutexInfo, sizeof(header) } };
-		for ( int i = tr->FlushMutex; i < tr->MutexKey.Count; ++i )
-		{
-			const size_t chunk_size = sizeof(header);
-			const size_t remain_size = sizeof(buffer->Data) - buffer->Count;
-			if (chunk_size > remain_size)
-				return false;
-			header.handle = (uint64_t)tr->MutexKey[i];
-			header.name   = (uint64_t)tr->MutexVal[i];
-			Mem_Cpy( buffer->Data + buffer->Count, &header, sizeof(header) ); buffer->Count += sizeof(header);
-			++tr->FlushMutex;
-		}
-		return true;
-	}
-
-	static int ThreadRecorder_RegisterName( ThreadRecorder_t tr, cstr_t name )
-	{
-		const uint32_t idx = HashTable_Get( tr->NameMap, (uint64_t)name, UINT32_MAX );
-		if (idx != UINT32_MAX)
-			return (int)idx;
-		const uint32_t id = tr->NameVal.Count;
-		const uint16_t len = (uint16_t)(1+Str_Len( name ));
-		HashTable_Set( tr->NameMap, (uint64_t)name, id );
-		tr->NameVal.Append( name );
-		tr->NameLen.Append( len );
-		return id;
+		if (HashTable_Has( tr->NameCache, (uint64_t)name ))
+			return;
+		const uint32_t id = Registry_RegisterName( tr->Registry, name );
+		HashTable_Set( tr->NameCache, (uint64_t)name, id );
 	}
 
 } }
@@ -133,6 +47,7 @@ namespace nemesis { namespace profiling
 		if (Packet_IsEmpty(buffer))
 			return false;
 		Packet_Finalize( buffer );
+		Packet_SetSource( buffer, tr->Index );
 		const DispatchItem_s item = { buffer, tr->Pool, tr->Index };
 		Sender_Push( tr->Sender, item );
 		return true;
@@ -144,38 +59,10 @@ namespace nemesis { namespace profiling
 		Packet_Initialize( tr->Data );
 	}
 
-	static void ThreadRecorder_AllocMeta( ThreadRecorder_t tr ) 
-	{
-		tr->Meta = BufferPool_AllocBuffer( tr->Pool, BufferType::Meta );
-		Packet_Initialize( tr->Meta );
-	}
-
-	static void ThreadRecorder_DispatchMeta( ThreadRecorder_t tr )
-	{
-		if (ThreadRecorder_DispatchBuffer( tr, tr->Meta ))
-			ThreadRecorder_AllocMeta( tr );
-	}
-
-	static void ThreadRecorder_WriteMeta( ThreadRecorder_t tr )
-	{
-		while (!ThreadRecorder_FlushNameTable( tr, tr->Meta ))
-			ThreadRecorder_DispatchMeta( tr );
-
-		while(!ThreadRecorder_FlushSiteTable( tr, tr->Meta ))
-			ThreadRecorder_DispatchMeta( tr );
-
-		while (!ThreadRecorder_FlushThreadTable( tr, tr->Meta ))
-			ThreadRecorder_DispatchMeta( tr );
-
-		while (!ThreadRecorder_FlushMutexTable( tr, tr->Meta ))
-			ThreadRecorder_DispatchMeta( tr );
-	}
-
 	static void ThreadRecorder_DispatchData( ThreadRecorder_t tr ) 
 	{
 		{
-			ThreadRecorder_WriteMeta( tr );
-			ThreadRecorder_DispatchMeta( tr );
+			Registry_Flush( tr->Registry );
 		}
 		{
 			if (ThreadRecorder_DispatchBuffer( tr, tr->Data ))
@@ -188,100 +75,74 @@ namespace nemesis { namespace profiling
 //======================================================================================
 namespace nemesis { namespace profiling
 {
-	void ThreadRecorder_Initialize( ThreadRecorder_t tr, Allocator_t alloc, uint8_t index, BufferPool_t pool, Sender_s* sender )
+	void ThreadRecorder_Initialize( ThreadRecorder_t tr, Allocator_t alloc, uint8_t index, BufferPool_t pool, Sender_s* sender, Registry_t registry )
 	{
 		system::CriticalSection_Create( tr->Mutex );
 
-		tr->Index	= index;
-		tr->Pool	= pool;
-		tr->Sender	= sender;
+		tr->Index	 = index;
+		tr->Pool	 = pool;
+		tr->Sender	 = sender;
+		tr->Registry = registry;
 
-		HashTable_Init( tr->NameMap, alloc );
-		tr->NameVal	 .Alloc = alloc;
-		tr->NameLen	 .Alloc = alloc;
-		HashTable_Init( tr->SiteMap, alloc );
-		tr->SiteVal	 .Alloc = alloc;
-		tr->ThreadKey.Alloc = alloc;
-		tr->ThreadVal.Alloc = alloc;
-		tr->MutexKey .Alloc = alloc;
-		tr->MutexVal .Alloc = alloc;
+		HashTable_Init( tr->NameCache, alloc );
+		HashTable_Init( tr->SiteCache, alloc );
+		tr->SiteVal.Init( alloc );
+		tr->SiteId .Init( alloc );
+		HashTable_Init( tr->DynamicCache, alloc );
 
 		ThreadRecorder_AllocData( tr );
-		ThreadRecorder_AllocMeta( tr );
 	}
 
 	void ThreadRecorder_Shutdown( ThreadRecorder_t tr )
 	{
-		HashTable_Clear( tr->NameMap );
-		tr->NameVal.Clear();
-		tr->NameLen.Clear();
-		HashTable_Clear( tr->SiteMap );
+		HashTable_Clear( tr->NameCache );
+		HashTable_Clear( tr->SiteCache );
 		tr->SiteVal.Clear();
-		tr->ThreadKey.Clear();
-		tr->ThreadVal.Clear();
-		tr->MutexKey.Clear();
-		tr->MutexVal.Clear();
+		tr->SiteId .Clear();
+		HashTable_Clear( tr->DynamicCache );
 
 		system::CriticalSection_Destroy( tr->Mutex );
 	}
 
-	void ThreadRecorder_GetStats( ThreadRecorder_t tr, ThreadRecorderStats_s& stats )
-	{
-		NeLock(tr->Mutex);
-		stats.NumNames			= tr->NameVal.Count;
-		stats.NumLocations		= tr->SiteVal.Count;
-		stats.NumLocks			= tr->MutexKey.Count;
-		stats.SizeOfNames		= tr->NameMap.Capacity * (sizeof( tr->NameMap.Key[0] ) + sizeof( tr->NameMap.Val[0] ))
-								+ Array_GetCapacitySize( tr->NameVal  ) 
-								+ Array_GetCapacitySize( tr->NameLen  );
-		stats.SizeOfLocations	= tr->SiteMap.Capacity * (sizeof( tr->SiteMap.Key[0] ) + sizeof( tr->SiteMap.Val[0] ))
-								+ Array_GetCapacitySize( tr->SiteVal  );
-		stats.SizeOfLocks		= Array_GetCapacitySize( tr->MutexKey )
-								+ Array_GetCapacitySize( tr->MutexVal );
-	}
-
 	void ThreadRecorder_RegisterNames( ThreadRecorder_t tr, const cstr_t* names, int count )
 	{
-		NeLock(tr->Mutex);
 		for ( int i = 0; i < count; ++i )
 			ThreadRecorder_RegisterName( tr, names[i] );
 	}
 
 	int ThreadRecorder_RegisterCallSite( ThreadRecorder_t tr, const CallSite_s& site )
 	{
-		NeLock(tr->Mutex);
-		// @todo: store ids instead of names -> halves the size of CallSite
-		const int32_t name_id = ThreadRecorder_RegisterName( tr, site.Name );
-		const int32_t func_id = ThreadRecorder_RegisterName( tr, site.Location.File );
-		const int32_t file_id = ThreadRecorder_RegisterName( tr, site.Location.Function );
-		const uint64_t key = (((uint64_t)file_id) << 32) | site.Location.Line;
-		const uint32_t found = HashTable_Get( tr->SiteMap, key, UINT32_MAX );
-		if (found != UINT32_MAX)
-			return (int)found;
-		const uint32_t site_id = tr->SiteVal.Count;
-		HashTable_Set( tr->SiteMap, key, site_id );
+		// the caches are only ever touched by the owning thread.
+		// a hit is compared with the cached site, colliding sites probe the following keys.
+		uint64_t key = Registry_MakeSiteKey( site );
+		for ( ;; ++key )
+		{
+			const uint32_t slot = HashTable_Get( tr->SiteCache, key, UINT32_MAX );
+			if (slot == UINT32_MAX)
+				break;
+			if (Registry_IsSameSite( tr->SiteVal[ slot ], site ))
+				return (int)tr->SiteId[ slot ];
+		}
+		const uint32_t site_id = Registry_RegisterCallSite( tr->Registry, site );
+		HashTable_Set( tr->SiteCache, key, (uint32_t)tr->SiteVal.Count );
 		tr->SiteVal.Append( site );
-		return site_id;
-	}
-
-	void ThreadRecorder_RegisterThread( ThreadRecorder_t tr, uint8_t index, cstr_t name )
-	{
-		NeLock(tr->Mutex);
-		const int idx = Array_LinearFind( tr->ThreadKey, index );
-		if (idx >= 0)
-			return;
-		tr->ThreadKey.Append( index );
-		tr->ThreadVal.Append( name );
-	}
-
-	void ThreadRecorder_RegisterMutex( ThreadRecorder_t tr, cptr_t handle, cstr_t name )
-	{
-		NeLock(tr->Mutex);
-		const int idx = Array_LinearFind( tr->MutexKey, handle );
-		if (idx >= 0)
-			return;
-		tr->MutexKey.Append( handle );
-		tr->MutexVal.Append( name );
+		tr->SiteId .Append( site_id );
+		return (int)site_id;
+	}
+
+	/// Returns the id of a dynamic name, taking the registry lock only for names this thread has not sent yet.
+	/// Cached ids remember the recycle count of the registry and are registered again once any name got recycled.
+	static uint64_t ThreadRecorder_RegisterDynamicName( ThreadRecorder_t tr, cstr_t text )
+	{
+		const uint64_t id = Registry_MakeDynamicNameId( text );
+		const uint32_t epoch = (uint32_t)Interlocked_Load( &tr->Registry->Dynamic.Recycled );
+		if (HashTable_Get( tr->DynamicCache, id, ~epoch ) == epoch)
+			return id;
+		if (tr->DynamicCache.Count >= 2 * MAX_NUM_DYNAMIC_NAMES)
+			HashTable_Reset( tr->DynamicCache );
+		Registry_RegisterDynamicName( tr->Registry, text );
+		HashTable_Set( tr->DynamicCache, id, epoch );
+		return id;
 	}
 
 	void ThreadRecorder_Record( ThreadRecorder_t tr, const Chunk& chunk )
@@ -347,7 +208,7 @@ namespace nemesis { namespace profiling
 		NeLock( mr->Mutex );
 		NeAssertOut( mr->NumThreads < NeCountOf(mr->Thread), "Recorder thread overflow!" );
 		tr = Mem_Calloc<ThreadRecorder_s>( mr->Alloc );
-		ThreadRecorder_Initialize( tr, mr->Alloc, mr->NumThreads, &mr->BufferPool, mr->Sender );
+		ThreadRecorder_Initialize( tr, mr->Alloc, mr->NumThreads, &mr->BufferPool, mr->Sender, &mr->Registry );
 		Tls_SetValue( mr->Tls, tr );
 		mr->Thread[ mr->NumThreads++ ] = tr;
 		return tr;
@@ -366,6 +227,7 @@ namespace nemesis { namespace profiling
 
 		mr->Tls = Tls_Alloc();
 		BufferPool_Initialize( &mr->BufferPool );
+		Registry_Initialize( &mr->Registry, alloc, &mr->BufferPool, sender );
 
 		mr->Frame.header.id = chunk::Type::EndFrame;
 		mr->Frame.header.size = sizeof(mr->Frame);
@@ -383,6 +245,7 @@ namespace nemesis { namespace profiling
 			ThreadRecorder_Shutdown( tr );
 			Mem_Free( mr->Alloc, tr );
 		}
+		Registry_Shutdown( &mr->Registry );
 		CriticalSection_Destroy( mr->Mutex );
 	}
 
@@ -411,8 +274,7 @@ namespace nemesis { namespace profiling
 		NeLock(mr->Mutex);
 		NeZero(stats);
 		stats.NumThreads = mr->NumThreads;
-		for ( int i = 0; i < mr->NumThreads; ++i )
-			ThreadRecorder_GetStats( mr->Thread[i], stats.Thread[i] );
+		Registry_GetStats( &mr->Registry, stats.Registry );
 	}
 
 	void MainRecorder_SetThreadInfo( MainRecorder_t mr, cstr_t name )
@@ -420,8 +282,7 @@ namespace nemesis { namespace profiling
 		if ( !name )
 			return;
 		ThreadRecorder_t thread = MainRecorder_CreateThreadRecorder( mr );
-		ThreadRecorder_RegisterNames( thread, &name, 1 );
-		ThreadRecorder_RegisterThread( thread, thread->Index, name );
+		Registry_RegisterThread( thread->Registry, thread->Index, name );
 	}
 
 	void MainRecorder_EnterScope( MainRecorder_t mr, const CallSite_s& site, ScopeType::Enum type, int64_t tick )
@@ -468,13 +329,38 @@ namespace nemesis { namespace profiling
 		return MainRecorder_LeaveScope( mr, site, tick );
 	}
 
+	void MainRecorder_EnterDynamicScope( MainRecorder_t mr, const CallSite_s& site, cstr_t name, ScopeType::Enum type, int64_t tick )
+	{
+		ThreadRecorder_t thread = MainRecorder_GetCurrentThread( mr );
+		if ( !thread )
+			return;
+		if ( !name )
+			return MainRecorder_EnterScope( mr, site, type, tick );
+		const chunk::EnterDynamicScope chunk = 
+		{ { chunk::Type::EnterDynamicScope, sizeof(chunk) }
+		, thread->Index
+		, (uint8_t)Cpu_GetIndex()
+		, (uint8_t)type
+		, 0
+		, (uint32_t)ThreadRecorder_RegisterCallSite( thread, site )
+		, tick
+		, ThreadRecorder_RegisterDynamicName( thread, name )
+		};
+		ThreadRecorder_Record( thread, chunk.header );
+	}
+
+	void MainRecorder_EnterDynamicScope( MainRecorder_t mr, const CallSite_s& site, cstr_t name, ScopeType::Enum type )
+	{
+		const int64_t tick = Clock_GetTick();
+		return MainRecorder_EnterDynamicScope( mr, site, name, type, tick );
+	}
+
 	void MainRecorder_SetMutexInfo( MainRecorder_t mr, cptr_t handle, cstr_t name )
 	{
 		ThreadRecorder_t thread = MainRecorder_GetCurrentThread( mr );
 		if ( !thread )
 			return;
-		ThreadRecorder_RegisterNames( thread, &name, 1 );
-		ThreadRecorder_RegisterMutex( thread, handle, name );
+		Registry_RegisterMutex( thread->Registry, handle, name );
 	}
 
 	void MainRecorder_EnterMutex( MainRecorder_t mr, cptr_t handle )
@@ -573,7 +459,8 @@ namespace nemesis { namespace profiling
 		, (size_t)path
 		};
 	#endif
-		ThreadRecorder_RegisterNames( thread, &name, 1 );
+		const cstr_t names[] = { path, name };
+		ThreadRecorder_RegisterNames( thread, names, 2 );
 		ThreadRecorder_Record( thread, chunk.header );
 	}
 
@@ -597,7 +484,8 @@ namespace nemesis { namespace profiling
 		, (size_t)path
 		};
 	#endif
-		ThreadRecorder_RegisterNames( thread, &name, 1 );
+		const cstr_t names[] = { path, name };
+		ThreadRecorder_RegisterNames( thread, names, 2 );
 		ThreadRecorder_Record( thread, chunk.header );
 	}
 
@@ -12,6 +12,7 @@
 #include "Types.h"
 #include "Constants.h"
 #include "BufferPool.h"
+#include "Registry.h"
 
 //======================================================================================
 #include <Nemesis/Core/HashTable.h>
@@ -19,47 +20,26 @@
 //======================================================================================
 namespace nemesis { namespace profiling
 {
-	struct ThreadRecorderStats_s
-	{
-		uint32_t NumNames;
-		uint32_t NumLocations;
-		uint32_t NumLocks;
-		size_t	 SizeOfNames;
-		size_t	 SizeOfLocations;
-		size_t	 SizeOfLocks;
-	};
-
 	struct ThreadRecorder_s
 	{
 		CriticalSection_t	Mutex;
 		uint8_t				Index;
 		uint8_t				_pad_[7];
 		Buffer_t			Data;
-		Buffer_t			Meta;
 		BufferPool_t		Pool;
 		Sender_s*			Sender;
-		HashTable_64_32_s	NameMap;
-		Array<cstr_t>		NameVal;
-		Array<uint16_t>		NameLen;
-		HashTable_64_32_s	SiteMap;
+		Registry_t			Registry;
+		HashTable_64_32_s	NameCache;
+		HashTable_64_32_s	SiteCache;
 		Array<CallSite_s>	SiteVal;
-		Array<uint8_t>		ThreadKey;
-		Array<cstr_t>		ThreadVal;
-		Array<cptr_t>		MutexKey;
-		Array<cstr_t>		MutexVal;
-		int					FlushName;
-		int					FlushSite;
-		int					FlushThread;
-		int					FlushMutex;
+		Array<uint32_t>		SiteId;
+		HashTable_64_32_s	DynamicCache;
 	};
 
-	void ThreadRecorder_Initialize		( ThreadRecorder_t tr, Allocator_t alloc, uint8_t index, BufferPool_t pool, Sender_s* sender );
+	void ThreadRecorder_Initialize		( ThreadRecorder_t tr, Allocator_t alloc, uint8_t index, BufferPool_t pool, Sender_s* sender, Registry_t registry );
 	void ThreadRecorder_Shutdown		( ThreadRecorder_t tr );
-	void ThreadRecorder_GetStats		( ThreadRecorder_t tr, ThreadRecorderStats_s& stats );
 	void ThreadRecorder_RegisterNames   ( ThreadRecorder_t tr, const cstr_t* names, int count );
 	int  ThreadRecorder_RegisterCallSite( ThreadRecorder_t tr, const CallSite_s& site );
-	void ThreadRecorder_RegisterThread	( ThreadRecorder_t tr, uint8_t index, cstr_t name );
-	void ThreadRecorder_RegisterMutex	( ThreadRecorder_t tr, cptr_t handle, cstr_t name );
 	void ThreadRecorder_Record			( ThreadRecorder_t tr, const Chunk& chunk );
 	void ThreadRecorder_Flush			( ThreadRecorder_t tr );
 
@@ -70,8 +50,8 @@ namespace nemesis { namespace profiling
 {
 	struct RecorderStats_s
 	{
-		uint32_t			  NumThreads;
-		ThreadRecorderStats_s Thread[ MAX_NUM_THREADS ];
+		uint32_t		NumThreads;
+		RegistryStats_s Registry;
 	};
 
 	struct MainRecorder_s
@@ -84,6 +64,7 @@ namespace nemesis { namespace profiling
 		uint8_t				NumThreads;
 		ThreadRecorder_t	Thread[ MAX_NUM_THREADS ];
 		BufferPool_s		BufferPool;
+		Registry_s			Registry;
 	};
 
 	void MainRecorder_Initialize( MainRecorder_t mr, Allocator_t alloc, Sender_s* sender );
@@ -96,6 +77,8 @@ namespace nemesis { namespace profiling
 	void MainRecorder_LeaveScope( MainRecorder_t mr, const CallSite_s& site, int64_t tick );
 	void MainRecorder_EnterScope( MainRecorder_t mr, const CallSite_s& site, ScopeType::Enum type );
 	void MainRecorder_LeaveScope( MainRecorder_t mr, const CallSite_s& site );
+	void MainRecorder_EnterDynamicScope( MainRecorder_t mr, const CallSite_s& site, cstr_t name, ScopeType::Enum type, int64_t tick );
+	void MainRecorder_EnterDynamicScope( MainRecorder_t mr, const CallSite_s& site, cstr_t name, ScopeType::Enum type );
 
 	void MainRecorder_SetMutexInfo( MainRecorder_t mr, cptr_t handle, cstr_t name );
 	void MainRecorder_EnterMutex( MainRecorder_t mr, cptr_t handle );
@@ -0,0 +1,434 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#include "stdafx.h"
+#include "Registry.h"
+
+//======================================================================================
+#include "Packet.h"
+#include "Sender.h"
+
+//======================================================================================
+#include <Nemesis/Core/Array.h>
+#include <Nemesis/Core/Hash.h>
+#include <Nemesis/Core/String.h>
+#include <Nemesis/Core/Process.h>
+
+//======================================================================================
+using namespace nemesis::system;
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static bool Registry_FlushNameTable( Registry_t reg, Buffer_t buffer )
+	{
+		uint64_t id  = 0;
+		uint16_t len = 0;
+		chunk::NameList header = { { (uint32_t)chunk::Type::NameList, 0 }, 1 };
+		for ( int i = reg->FlushName; i < reg->NameVal.Count; ++i )
+		{
+			const size_t chunk_size	 = sizeof(header) + sizeof(id) + sizeof(len) + reg->NameLen[i];
+			const size_t remain_size = sizeof(buffer->Data) - buffer->Count;
+			if (chunk_size > remain_size)
+				return false;
+
+			header.header.size	= (uint32_t)chunk_size;
+			id					= (uint64_t)reg->NameVal[i];
+			len					= reg->NameLen[i];
+			Mem_Cpy( buffer->Data + buffer->Count, &header		  , sizeof(header) ); buffer->Count += sizeof(header);
+			Mem_Cpy( buffer->Data + buffer->Count, &id			  , sizeof(id)	   ); buffer->Count += sizeof(id);
+			Mem_Cpy( buffer->Data + buffer->Count, &len			  , sizeof(len)	   ); buffer->Count += sizeof(len);
+			Mem_Cpy( buffer->Data + buffer->Count, reg->NameVal[i], len			   ); buffer->Count += len;
+			++reg->FlushName;
+		}
+		return true;
+	}
+
+	static bool Registry_FlushDynamicNames( Registry_t reg, Buffer_t buffer )
+	{
+		Array<uint8_t>& pending = reg->Dynamic.Pending;
+		while (reg->FlushDynamic < pending.Count)
+		{
+			const Chunk* chunk = (const Chunk*)(pending.Data + reg->FlushDynamic);
+			const size_t remain_size = sizeof(buffer->Data) - buffer->Count;
+			if (chunk->size > remain_size)
+				return false;
+			Mem_Cpy( buffer->Data + buffer->Count, chunk, chunk->size ); buffer->Count += chunk->size;
+			reg->FlushDynamic += chunk->size;
+		}
+		pending.Reset();
+		reg->FlushDynamic = 0;
+		return true;
+	}
+
+	static bool Registry_FlushSiteTable( Registry_t reg, Buffer_t buffer )
+	{
+		// locations are process wide, the thread id is not used anymore.
+		chunk::LocationItem item   = {};
+		chunk::LocationList header = { { chunk::Type::LocationList, 0 }, 1, 0 };
+		for ( int i = reg->FlushSite; i < reg->SiteVal.Count; ++i )
+		{
+			const size_t chunk_size		= sizeof(header) + sizeof(item);
+			const size_t remain_size	= sizeof(buffer->Data) - buffer->Count;
+			if (chunk_size > remain_size)
+				return false;
+			header.header.size	= (uint32_t)chunk_size;
+			const NamedLocation& loc = reg->SiteVal[i];
+			item.name = (size_t)loc.Name;
+			item.func = (size_t)loc.Location.Function;
+			item.file = (size_t)loc.Location.File;
+			item.line = (uint64_t)loc.Location.Line;
+			item.id   = (uint32_t)i;
+			Mem_Cpy( buffer->Data + buffer->Count, &header, sizeof(header) ); buffer->Count += sizeof(header);
+			Mem_Cpy( buffer->Data + buffer->Count, &item  , sizeof(item)   ); buffer->Count += sizeof(item);
+			++reg->FlushSite;
+		}
+		return true;
+	}
+
+	static bool Registry_FlushThreadTable( Registry_t reg, Buffer_t buffer )
+	{
+		chunk::ThreadInfo header = { { chunk::Type::ThreadInfo, sizeof(header) } };
+		for ( int i = reg->FlushThread; i < reg->ThreadKey.Count; ++i )
+		{
+			const size_t chunk_size = sizeof(header);
+			const size_t remain_size = sizeof(buffer->Data) - buffer->Count;
+			if (chunk_size > remain_size)
+				return false;
+			header.threadId = reg->ThreadKey[i];
+			header.name		= (uint64_t)reg->ThreadVal[i];
+			Mem_Cpy( buffer->Data + buffer->Count, &header, sizeof(header) ); buffer->Count += sizeof(header);
+			++reg->FlushThread;
+		}
+		return true;
+	}
+
+	static bool Registry_FlushMutexTable( Registry_t reg, Buffer_t buffer )
+	{
+		chunk::MutexInfo header = { { chunk::Type::MutexInfo, sizeof(header) } };
+		for ( int i = reg->FlushMutex; i < reg->MutexKey.Count; ++i )
+		{
+			const size_t chunk_size = sizeof(header);
+			const size_t remain_size = sizeof(buffer->Data) - buffer->Count;
+			if (chunk_size > remain_size)
+				return false;
+			header.handle = (uint64_t)reg->MutexKey[i];
+			header.name   = (uint64_t)reg->MutexVal[i];
+			Mem_Cpy( buffer->Data + buffer->Count, &header, sizeof(header) ); buffer->Count += sizeof(header);
+			++reg->FlushMutex;
+		}
+		return true;
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static void Registry_AllocMeta( Registry_t reg )
+	{
+		reg->Meta = BufferPool_AllocBuffer( reg->Pool, BufferType::Meta );
+		Packet_Initialize( reg->Meta );
+	}
+
+	static void Registry_DispatchMeta( Registry_t reg )
+	{
+		if (Packet_IsEmpty(reg->Meta))
+			return;
+		Packet_Finalize( reg->Meta );
+		const DispatchItem_s item = { reg->Meta, reg->Pool, 0 };
+		Sender_Push( reg->Sender, item );
+		Registry_AllocMeta( reg );
+	}
+
+	static uint32_t Registry_InsertName( Registry_t reg, cstr_t name )
+	{
+		const uint32_t idx = HashTable_Get( reg->NameMap, (uint64_t)name, UINT32_MAX );
+		if (idx != UINT32_MAX)
+			return idx;
+		const uint32_t id = reg->NameVal.Count;
+		const uint16_t len = (uint16_t)(1+Str_Len( name ));
+		HashTable_Set( reg->NameMap, (uint64_t)name, id );
+		reg->NameVal.Append( name );
+		reg->NameLen.Append( len );
+		Interlocked_Add( &reg->Published, 1 );
+		return id;
+	}
+
+	static void DynamicNames_Unlink( DynamicNames_s& names, uint32_t slot )
+	{
+		DynamicName_s& item = names.Item[ slot ];
+		if (item.Prev != UINT32_MAX)
+			names.Item[ item.Prev ].Next = item.Next;
+		else
+			names.Head = item.Next;
+		if (item.Next != UINT32_MAX)
+			names.Item[ item.Next ].Prev = item.Prev;
+		else
+			names.Tail = item.Prev;
+	}
+
+	static void DynamicNames_LinkHead( DynamicNames_s& names, uint32_t slot )
+	{
+		DynamicName_s& item = names.Item[ slot ];
+		item.Prev = UINT32_MAX;
+		item.Next = names.Head;
+		if (names.Head != UINT32_MAX)
+			names.Item[ names.Head ].Prev = slot;
+		names.Head = slot;
+		if (names.Tail == UINT32_MAX)
+			names.Tail = slot;
+	}
+
+	/// Drops the keys of recycled slots once they outnumber the live ones.
+	static void DynamicNames_Compact( DynamicNames_s& names )
+	{
+		if (names.Map.Count < 2 * MAX_NUM_DYNAMIC_NAMES)
+			return;
+		HashTable_Reset( names.Map );
+		for ( uint32_t i = 0; i < names.Count; ++i )
+			HashTable_Set( names.Map, names.Item[i].Id, i );
+	}
+
+	static void DynamicNames_AppendPending( DynamicNames_s& names, const DynamicName_s& item )
+	{
+		const chunk::NameList header = { { (uint32_t)chunk::Type::NameList, (uint32_t)(sizeof(header) + sizeof(item.Id) + sizeof(item.Len) + item.Len) }, 1 };
+		names.Pending.Append( (const uint8_t*)&header  , (int)sizeof(header)   );
+		names.Pending.Append( (const uint8_t*)&item.Id , (int)sizeof(item.Id)  );
+		names.Pending.Append( (const uint8_t*)&item.Len, (int)sizeof(item.Len) );
+		names.Pending.Append( (const uint8_t*)item.Text, (int)item.Len		   );
+	}
+
+	static void DynamicNames_AppendRelease( DynamicNames_s& names, const DynamicName_s& item )
+	{
+		const chunk::NameRelease chunk = { { (uint32_t)chunk::Type::NameRelease, sizeof(chunk) }, item.Id };
+		names.Pending.Append( (const uint8_t*)&chunk, (int)sizeof(chunk) );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	void Registry_Initialize( Registry_t reg, Allocator_t alloc, BufferPool_t pool, Sender_s* sender )
+	{
+		CriticalSection_Create( reg->Mutex );
+
+		reg->Pool	= pool;
+		reg->Sender	= sender;
+
+		HashTable_Init( reg->NameMap, alloc );
+		reg->NameVal  .Alloc = alloc;
+		reg->NameLen  .Alloc = alloc;
+		HashTable_Init( reg->SiteMap, alloc );
+		reg->SiteVal  .Alloc = alloc;
+		reg->ThreadKey.Alloc = alloc;
+		reg->ThreadVal.Alloc = alloc;
+		reg->MutexKey .Alloc = alloc;
+		reg->MutexVal .Alloc = alloc;
+		HashTable_Init( reg->Dynamic.Map, alloc );
+		reg->Dynamic.Pending.Alloc = alloc;
+		reg->Dynamic.Head = UINT32_MAX;
+		reg->Dynamic.Tail = UINT32_MAX;
+
+		Registry_AllocMeta( reg );
+	}
+
+	void Registry_Shutdown( Registry_t reg )
+	{
+		HashTable_Clear( reg->NameMap );
+		reg->NameVal.Clear();
+		reg->NameLen.Clear();
+		HashTable_Clear( reg->SiteMap );
+		reg->SiteVal.Clear();
+		reg->ThreadKey.Clear();
+		reg->ThreadVal.Clear();
+		reg->MutexKey.Clear();
+		reg->MutexVal.Clear();
+		HashTable_Clear( reg->Dynamic.Map );
+		reg->Dynamic.Pending.Clear();
+
+		CriticalSection_Destroy( reg->Mutex );
+	}
+
+	void Registry_GetStats( Registry_t reg, RegistryStats_s& stats )
+	{
+		NeLock(reg->Mutex);
+		stats.NumNames			= reg->NameVal.Count;
+		stats.NumLocations		= reg->SiteVal.Count;
+		stats.NumLocks			= reg->MutexKey.Count;
+		stats.NumDynamicNames	= reg->Dynamic.Count;
+		stats.SizeOfNames		= reg->NameMap.Capacity * (sizeof( reg->NameMap.Key[0] ) + sizeof( reg->NameMap.Val[0] ))
+								+ Array_GetCapacitySize( reg->NameVal  )
+								+ Array_GetCapacitySize( reg->NameLen  )
+								+ reg->Dynamic.Map.Capacity * (sizeof( reg->Dynamic.Map.Key[0] ) + sizeof( reg->Dynamic.Map.Val[0] ))
+								+ Array_GetCapacitySize( reg->Dynamic.Pending )
+								+ sizeof( reg->Dynamic.Item );
+		stats.SizeOfLocations	= reg->SiteMap.Capacity * (sizeof( reg->SiteMap.Key[0] ) + sizeof( reg->SiteMap.Val[0] ))
+								+ Array_GetCapacitySize( reg->SiteVal  );
+		stats.SizeOfLocks		= Array_GetCapacitySize( reg->MutexKey )
+								+ Array_GetCapacitySize( reg->MutexVal );
+	}
+
+	uint32_t Registry_RegisterName( Registry_t reg, cstr_t name )
+	{
+		NeLock(reg->Mutex);
+		return Registry_InsertName( reg, name );
+	}
+
+	uint64_t Registry_RegisterDynamicName( Registry_t reg, cstr_t text )
+	{
+		const size_t len = Str_Len( text );
+		const uint64_t id = Registry_MakeDynamicNameId( text );
+
+		NeLock(reg->Mutex);
+		DynamicNames_s& names = reg->Dynamic;
+
+		// known names just move to the front
+		const uint32_t found = HashTable_Get( names.Map, id, UINT32_MAX );
+		if ((found != UINT32_MAX) && (names.Item[ found ].Id == id))
+		{
+			DynamicNames_Unlink( names, found );
+			DynamicNames_LinkHead( names, found );
+			return id;
+		}
+
+		// recycle the least recently used name once full
+		uint32_t slot;
+		if (names.Count < MAX_NUM_DYNAMIC_NAMES)
+		{
+			slot = names.Count++;
+		}
+		else
+		{
+			slot = names.Tail;
+			DynamicNames_Unlink( names, slot );
+			DynamicNames_AppendRelease( names, names.Item[ slot ] );
+			Interlocked_Add( &names.Recycled, 1 );
+		}
+
+		DynamicName_s& item = names.Item[ slot ];
+		const size_t copy = NeMin( len, (size_t)MAX_DYNAMIC_NAME_SIZE-1 );
+		item.Id	 = id;
+		item.Len = (uint16_t)(copy+1);
+		Mem_Cpy( item.Text, text, copy );
+		item.Text[ copy ] = 0;
+		DynamicNames_LinkHead( names, slot );
+		HashTable_Set( names.Map, id, slot );
+		DynamicNames_Compact( names );
+
+		// the text is sent with the next flush
+		DynamicNames_AppendPending( names, item );
+		Interlocked_Add( &reg->Published, 1 );
+		return id;
+	}
+
+	uint32_t Registry_RegisterCallSite( Registry_t reg, const CallSite_s& site )
+	{
+		NeLock(reg->Mutex);
+		Registry_InsertName( reg, site.Name );
+		Registry_InsertName( reg, site.Location.Function );
+		Registry_InsertName( reg, site.Location.File );
+
+		// probe past hash collisions
+		uint64_t key = Registry_MakeSiteKey( site );
+		for ( ;; ++key )
+		{
+			const uint32_t found = HashTable_Get( reg->SiteMap, key, UINT32_MAX );
+			if (found == UINT32_MAX)
+				break;
+			if (Registry_IsSameSite( reg->SiteVal[found], site ))
+				return found;
+		}
+		const uint32_t site_id = reg->SiteVal.Count;
+		HashTable_Set( reg->SiteMap, key, site_id );
+		reg->SiteVal.Append( site );
+		Interlocked_Add( &reg->Published, 1 );
+		return site_id;
+	}
+
+	void Registry_RegisterThread( Registry_t reg, uint8_t index, cstr_t name )
+	{
+		NeLock(reg->Mutex);
+		Registry_InsertName( reg, name );
+		const int idx = Array_LinearFind( reg->ThreadKey, index );
+		if (idx >= 0)
+			return;
+		reg->ThreadKey.Append( index );
+		reg->ThreadVal.Append( name );
+		Interlocked_Add( &reg->Published, 1 );
+	}
+
+	void Registry_RegisterMutex( Registry_t reg, cptr_t handle, cstr_t name )
+	{
+		NeLock(reg->Mutex);
+		Registry_InsertName( reg, name );
+		const int idx = Array_LinearFind( reg->MutexKey, handle );
+		if (idx >= 0)
+			return;
+		reg->MutexKey.Append( handle );
+		reg->MutexVal.Append( name );
+		Interlocked_Add( &reg->Published, 1 );
+	}
+
+	void Registry_Flush( Registry_t reg )
+	{
+		// entries are only added under the lock and counted once added, so an unchanged count means
+		// everything this thread registered has been dispatched and the lock can be skipped.
+		if (Interlocked_Load( &reg->Published ) == Interlocked_Load( &reg->Flushed ))
+			return;
+
+		// meta data is dispatched while holding the lock so that no recorder
+		// can dispatch data referencing an entry before the entry itself.
+		NeLock(reg->Mutex);
+
+		while (!Registry_FlushNameTable( reg, reg->Meta ))
+			Registry_DispatchMeta( reg );
+
+		while (!Registry_FlushDynamicNames( reg, reg->Meta ))
+			Registry_DispatchMeta( reg );
+
+		while (!Registry_FlushSiteTable( reg, reg->Meta ))
+			Registry_DispatchMeta( reg );
+
+		while (!Registry_FlushThreadTable( reg, reg->Meta ))
+			Registry_DispatchMeta( reg );
+
+		while (!Registry_FlushMutexTable( reg, reg->Meta ))
+			Registry_DispatchMeta( reg );
+
+		Registry_DispatchMeta( reg );
+		Interlocked_Exchange( &reg->Flushed, Interlocked_Load( &reg->Published ) );
+	}
+
+	uint64_t Registry_MakeSiteKey( const CallSite_s& site )
+	{
+		const uint64_t part[] =
+		{ (uint64_t)site.Name
+		, (uint64_t)site.Location.Function
+		, (uint64_t)site.Location.File
+		, (uint64_t)site.Location.Line
+		};
+		return Hash_Xx64( part, sizeof(part) ) >> 1;
+	}
+
+	uint64_t Registry_MakeDynamicNameId( cstr_t text )
+	{
+		const uint64_t id = Hash_Xx64( text, Str_Len( text ), 0 ) | DYNAMIC_NAME_FLAG;
+		return (id == ~0ULL) ? (id ^ 1) : id;
+	}
+
+	bool Registry_IsSameSite( const CallSite_s& a, const CallSite_s& b )
+	{
+		return (a.Name				== b.Name)
+			&& (a.Location.Function == b.Location.Function)
+			&& (a.Location.File		== b.Location.File)
+			&& (a.Location.Line		== b.Location.Line);
+	}
+
+} }
@@ -0,0 +1,100 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+#include "Types.h"
+#include "Constants.h"
+#include "BufferPool.h"
+
+//======================================================================================
+#include <Nemesis/Core/HashTable.h>
+#include <Nemesis/Core/Atomic.h>
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	struct RegistryStats_s
+	{
+		uint32_t NumNames;
+		uint32_t NumLocations;
+		uint32_t NumLocks;
+		uint32_t NumDynamicNames;
+		size_t	 SizeOfNames;
+		size_t	 SizeOfLocations;
+		size_t	 SizeOfLocks;
+	};
+
+	struct DynamicName_s
+	{
+		uint64_t	Id;
+		uint32_t	Prev;
+		uint32_t	Next;
+		uint16_t	Len;
+		char		Text[ MAX_DYNAMIC_NAME_SIZE ];
+	};
+
+	/// Bounded table of names interned by content.
+	/// The least recently used name is recycled once the table is full.
+	struct DynamicNames_s
+	{
+		HashTable_64_32_s	Map;
+		uint32_t			Count;
+		uint32_t			Head;
+		uint32_t			Tail;
+		Array<uint8_t>		Pending;
+		Atomic32			Recycled;
+		DynamicName_s		Item[ MAX_NUM_DYNAMIC_NAMES ];
+	};
+
+	/// Process wide table of names, call sites, threads and mutexes.
+	/// Ids are shared by all thread recorders and each entry is flushed exactly once.
+	struct Registry_s
+	{
+		CriticalSection_t	Mutex;
+		Buffer_t			Meta;
+		BufferPool_t		Pool;
+		Sender_s*			Sender;
+		HashTable_64_32_s	NameMap;
+		Array<cstr_t>		NameVal;
+		Array<uint16_t>		NameLen;
+		HashTable_64_32_s	SiteMap;
+		Array<CallSite_s>	SiteVal;
+		Array<uint8_t>		ThreadKey;
+		Array<cstr_t>		ThreadVal;
+		Array<cptr_t>		MutexKey;
+		Array<cstr_t>		MutexVal;
+		DynamicNames_s		Dynamic;
+		int					FlushName;
+		int					FlushSite;
+		int					FlushThread;
+		int					FlushMutex;
+		int					FlushDynamic;
+		Atomic32			Published;
+		Atomic32			Flushed;
+	};
+
+	void	 Registry_Initialize		( Registry_t reg, Allocator_t alloc, BufferPool_t pool, Sender_s* sender );
+	void	 Registry_Shutdown			( Registry_t reg );
+	void	 Registry_GetStats			( Registry_t reg, RegistryStats_s& stats );
+	uint32_t Registry_RegisterName		( Registry_t reg, cstr_t name );
+	uint64_t Registry_RegisterDynamicName( Registry_t reg, cstr_t text );
+	uint32_t Registry_RegisterCallSite	( Registry_t reg, const CallSite_s& site );
+	void	 Registry_RegisterThread	( Registry_t reg, uint8_t index, cstr_t name );
+	void	 Registry_RegisterMutex		( Registry_t reg, cptr_t handle, cstr_t name );
+	void	 Registry_Flush				( Registry_t reg );
+
+	/// Hashes the text of a dynamic name into its id.
+	uint64_t Registry_MakeDynamicNameId	( cstr_t text );
+
+	/// Hashes the contents of a call site for use as a lookup key.
+	uint64_t Registry_MakeSiteKey		( const CallSite_s& site );
+	bool	 Registry_IsSameSite		( const CallSite_s& a, const CallSite_s& b );
+
+} }
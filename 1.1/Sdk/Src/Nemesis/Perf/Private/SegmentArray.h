@@ -0,0 +1,202 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+#include <Nemesis/Core/Array.h>
+#include <Nemesis/Core/Memory.h>
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	/// Growable array stored in fixed size segments.
+	/// Items are addressed by an absolute index which stays valid while older items are evicted.
+	/// Indices are 32 bit and wrap around, so only their distance to First is meaningful.
+	/// The leading Spilled segments are not owned by the array, they are backed by a file or stored elsewhere.
+	template < typename T, int SHIFT >
+	struct SegmentArray
+	{
+		enum { SEGMENT_SIZE = 1 << SHIFT };
+		enum { SEGMENT_MASK = SEGMENT_SIZE - 1 };
+
+		Array<T*>	Segment;
+		Array<T*>	Spare;
+		uint32_t	Base;
+		uint32_t	First;
+		uint32_t	End;
+		uint32_t	Spilled;
+
+		uint32_t Count() const { return End - First; }
+
+			  T& operator [] ( uint32_t index )		  { return Segment.Data[ (index - Base) >> SHIFT ][ index & SEGMENT_MASK ]; }
+		const T& operator [] ( uint32_t index ) const { return Segment.Data[ (index - Base) >> SHIFT ][ index & SEGMENT_MASK ]; }
+	};
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	template < typename T, int SHIFT >
+	inline void SegmentArray_Init( SegmentArray<T,SHIFT>& arr, Allocator_t alloc )
+	{
+		arr.Segment.Init( alloc );
+		arr.Spare.Init( alloc );
+		arr.Base = arr.First = arr.End = arr.Spilled = 0;
+	}
+
+	template < typename T, int SHIFT >
+	inline void SegmentArray_Clear( SegmentArray<T,SHIFT>& arr )
+	{
+		for ( int i = arr.Spilled; i < arr.Segment.Count; ++i )
+			Mem_Free( arr.Segment.Alloc, arr.Segment[i] );
+		for ( int i = 0; i < arr.Spare.Count; ++i )
+			Mem_Free( arr.Spare.Alloc, arr.Spare[i] );
+		arr.Segment.Clear();
+		arr.Spare.Clear();
+		arr.Base = arr.First = arr.End = arr.Spilled = 0;
+	}
+
+	/// Removes all items and keeps the segments for reuse.
+	/// Spilled segments are dropped.
+	template < typename T, int SHIFT >
+	inline void SegmentArray_Reset( SegmentArray<T,SHIFT>& arr )
+	{
+		arr.Spare.Append( arr.Segment.Data + arr.Spilled, arr.Segment.Count - (int)arr.Spilled );
+		arr.Segment.Reset();
+		arr.Base = arr.First = arr.End = arr.Spilled = 0;
+	}
+
+	/// Removes all items and drops the segments within the given memory range instead of keeping them.
+	template < typename T, int SHIFT >
+	inline void SegmentArray_Detach( SegmentArray<T,SHIFT>& arr, cptr_t begin, cptr_t end )
+	{
+		SegmentArray_Reset( arr );
+		int count = 0;
+		for ( int i = 0; i < arr.Spare.Count; ++i )
+		{
+			T* segment = arr.Spare[i];
+			if ((segment >= (const T*)begin) && (segment < (const T*)end))
+				continue;
+			arr.Spare[ count++ ] = segment;
+		}
+		arr.Spare.Resize( count );
+	}
+
+	/// Removes all items and uses the segments stored contiguously at the given memory.
+	/// The first segment holds the item at the given base index.
+	template < typename T, int SHIFT >
+	inline void SegmentArray_Attach( SegmentArray<T,SHIFT>& arr, T* data, uint32_t base, uint32_t first, uint32_t end )
+	{
+		SegmentArray_Reset( arr );
+		const uint32_t num_segments = (end - base + SegmentArray<T,SHIFT>::SEGMENT_MASK) >> SHIFT;
+		for ( uint32_t i = 0; i < num_segments; ++i )
+			arr.Segment.Append( data + i * SegmentArray<T,SHIFT>::SEGMENT_SIZE );
+		arr.Base = base;
+		arr.First = first;
+		arr.End = end;
+	}
+
+	/// Removes all items and continues numbering at the given index.
+	template < typename T, int SHIFT >
+	inline void SegmentArray_Rebase( SegmentArray<T,SHIFT>& arr, uint32_t index )
+	{
+		SegmentArray_Reset( arr );
+		arr.Base = index & ~(uint32_t)SegmentArray<T,SHIFT>::SEGMENT_MASK;
+		arr.First = arr.End = index;
+	}
+
+	/// Returns the number of heap bytes held by the segments in use.
+	template < typename T, int SHIFT >
+	inline size_t SegmentArray_GetSize( const SegmentArray<T,SHIFT>& arr )
+	{
+		return (size_t)(arr.Segment.Count - arr.Spilled) * SegmentArray<T,SHIFT>::SEGMENT_SIZE * sizeof(T);
+	}
+
+	/// Returns the number of items which can be written at the end without switching segments.
+	template < typename T, int SHIFT >
+	inline uint32_t SegmentArray_Reserve( SegmentArray<T,SHIFT>& arr )
+	{
+		const uint32_t offset = arr.End - arr.Base;
+		if ((offset >> SHIFT) == (uint32_t)arr.Segment.Count)
+		{
+			T* segment = nullptr;
+			if (arr.Spare.Count)
+			{
+				segment = arr.Spare[ arr.Spare.Count-1 ];
+				arr.Spare.RemoveAt( arr.Spare.Count-1 );
+			}
+			else
+			{
+				segment = Mem_Alloc<T>( arr.Segment.Alloc, SegmentArray<T,SHIFT>::SEGMENT_SIZE );
+			}
+			arr.Segment.Append( segment );
+		}
+		return SegmentArray<T,SHIFT>::SEGMENT_SIZE - (offset & SegmentArray<T,SHIFT>::SEGMENT_MASK);
+	}
+
+	template < typename T, int SHIFT >
+	inline T& SegmentArray_Append( SegmentArray<T,SHIFT>& arr )
+	{
+		SegmentArray_Reserve( arr );
+		return arr[ arr.End++ ];
+	}
+
+	template < typename T, int SHIFT >
+	inline void SegmentArray_Append( SegmentArray<T,SHIFT>& arr, const T& item )
+	{
+		SegmentArray_Append( arr ) = item;
+	}
+
+	template < typename T, int SHIFT >
+	inline void SegmentArray_Append( SegmentArray<T,SHIFT>& arr, const T* data, uint32_t count )
+	{
+		while (count)
+		{
+			const uint32_t num_items = NeMin( count, SegmentArray_Reserve( arr ) );
+			Mem_Cpy( &arr[ arr.End ], data, num_items * sizeof(T) );
+			arr.End += num_items;
+			data += num_items;
+			count -= num_items;
+		}
+	}
+
+	/// Appends all items of another segment array.
+	template < typename T, int SHIFT >
+	inline void SegmentArray_Append( SegmentArray<T,SHIFT>& arr, const SegmentArray<T,SHIFT>& src )
+	{
+		uint32_t index = src.First;
+		while (index != src.End)
+		{
+			const uint32_t in_segment = SegmentArray<T,SHIFT>::SEGMENT_SIZE - (index & SegmentArray<T,SHIFT>::SEGMENT_MASK);
+			const uint32_t num_items = NeMin( src.End - index, in_segment );
+			SegmentArray_Append( arr, &src[ index ], num_items );
+			index += num_items;
+		}
+	}
+
+	/// Drops all items before the given index.
+	/// Segments which no longer hold any items are kept for reuse.
+	/// Spilled segments must have been released by their owner beforehand.
+	template < typename T, int SHIFT >
+	inline void SegmentArray_Evict( SegmentArray<T,SHIFT>& arr, uint32_t first )
+	{
+		NeAssert((first - arr.First) <= arr.Count());
+		NeAssert(!arr.Spilled || ((first - arr.Base) < SegmentArray<T,SHIFT>::SEGMENT_SIZE));
+		arr.First = first;
+		int num_segments = 0;
+		while ((num_segments < arr.Segment.Count) && ((first - arr.Base) >= SegmentArray<T,SHIFT>::SEGMENT_SIZE))
+		{
+			arr.Spare.Append( arr.Segment[ num_segments++ ] );
+			arr.Base += SegmentArray<T,SHIFT>::SEGMENT_SIZE;
+		}
+		arr.Segment.RemoveAt( 0, num_segments );
+	}
+
+} }
@@ -68,6 +68,25 @@ namespace nemesis { namespace profiling
 		Worker_Wait( &Sender->Worker );
 	}
 
+	Result_t Sender_StartShared( Sender_s* sender, cstr_t name )
+	{
+		if (sender->Ring.Header)
+			return NE_ERR_INVALID_CALL;
+		const Result_t hr = SharedRing_Create( &sender->Ring, name, SHARED_RING_SIZE );
+		if (NeFailed(hr))
+			return hr;
+		Dispatcher_Share( &sender->Dispatcher, &sender->Ring );
+		return NE_OK;
+	}
+
+	void Sender_StopShared( Sender_s* sender )
+	{
+		if (!sender->Ring.Header)
+			return;
+		Dispatcher_Share( &sender->Dispatcher, nullptr );
+		SharedRing_Destroy( &sender->Ring );
+	}
+
 	void Sender_Attach( Sender_s* sender, const Consumer_s& local )
 	{
 		Dispatcher_Attach( &sender->Dispatcher, local );
@@ -86,6 +105,7 @@ namespace nemesis { namespace profiling
 	void Sender_Shutdown( Sender_s* Sender )
 	{
 		Sender_Stop( Sender );
+		Sender_StopShared( Sender );
 		Dispatcher_Shutdown( &Sender->Dispatcher );
 	}
 
@@ -19,11 +19,14 @@ namespace nemesis { namespace profiling
 		Socket_t	 Socket;
 		Worker_s	 Worker;
 		Dispatcher_s Dispatcher;
+		SharedRing_s Ring;
 	};
 
 	void Sender_Initialize( Sender_s* Sender, Allocator_t alloc );
 	Result_t Sender_Start( Sender_s* Sender, system::IpPort_t port );
 	void Sender_Stop( Sender_s* Sender );
+	Result_t Sender_StartShared( Sender_s* sender, cstr_t name );
+	void Sender_StopShared( Sender_s* sender );
 	void Sender_Attach( Sender_s* sender, const Consumer_s& local );
 	void Sender_Connect( Sender_s* sender, Socket_t client );
 	void Sender_Push( Sender_s* sender, const DispatchItem_s& item );
@@ -0,0 +1,267 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#include "stdafx.h"
+#include "SharedRing.h"
+
+//======================================================================================
+#include "Constants.h"
+
+//======================================================================================
+#include <Nemesis/Core/Atomic.h>
+#include <Nemesis/Core/Memory.h>
+#include <Nemesis/Core/Process.h>
+#include <Nemesis/Core/String.h>
+#include <Nemesis/Core/VMem.h>
+
+//======================================================================================
+using namespace nemesis::system;
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{ 
+	static const uint32_t SHARED_RING_MAGIC = 0x4e455352; // 'NESR'
+
+	static uint32_t SharedRing_AlignRecord( uint32_t size )
+	{
+		return (sizeof(SharedRecord_s) + size + 7) & ~7u;
+	}
+
+	static void SharedRing_MakeName( char* out, size_t size, cstr_t name, cstr_t suffix )
+	{
+		Str_Fmt( out, size, "%s.%s", name, suffix );
+	}
+
+	static bool SharedRing_OpenEvents( SharedRing_s* ring, cstr_t name, bool create )
+	{
+		char data_name[ 128 ];
+		SharedRing_MakeName( data_name, sizeof(data_name), name, "Data" );
+		ring->DataReady = create ? Event_CreateNamed( data_name ) : Event_OpenNamed( data_name );
+		return ring->DataReady != nullptr;
+	}
+
+	static void SharedRing_Unmap( SharedRing_s* ring )
+	{
+		if (ring->DataReady)
+			Event_Close( ring->DataReady );
+		SharedMem_Close( ring->Header, ring->Mapping );
+		NeZero(*ring);
+	}
+
+	static SharedRecord_s* SharedRing_GetRecord( SharedRing_s* ring, int64_t pos )
+	{
+		return (SharedRecord_s*)(ring->Data + (pos & (ring->Header->Capacity-1)));
+	}
+
+	static void SharedRing_Detach( SharedRing_s* ring )
+	{
+		Interlocked_CompareExchange( &ring->Header->Request, 0, ring->Session );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{ 
+	Result_t SharedRing_Create( SharedRing_s* ring, cstr_t name, uint32_t capacity )
+	{
+		NeAssert((capacity & (capacity-1)) == 0);
+		NeZero(*ring);
+		// a segment of that name belongs to another server
+		ptr_t base = SharedMem_Create( name, sizeof(SharedRingHeader_s) + capacity, &ring->Mapping );
+		if (!base)
+			return NE_ERR_INVALID_CALL;
+		ring->Header = (SharedRingHeader_s*)base;
+		ring->Data	 = (uint8_t*)(ring->Header+1);
+		if (!SharedRing_OpenEvents( ring, name, true ))
+		{
+			SharedRing_Unmap( ring );
+			return NE_ERR_NOT_FOUND;
+		}
+		NeZero(*ring->Header);
+		ring->Header->Capacity = capacity;
+		Interlocked_Exchange( (Atomic32*)&ring->Header->Magic, SHARED_RING_MAGIC );
+		return NE_OK;
+	}
+
+	bool SharedRing_Accept( SharedRing_s* ring )
+	{
+		SharedRingHeader_s* header = ring->Header;
+		const int32_t request = Interlocked_Load( &header->Request );
+		if (!request || (request == ring->Session))
+			return false;
+
+		// anything still in the ring belongs to the previous viewer
+		Interlocked_Exchange64( &header->ReadPos, Interlocked_Load64( &header->WritePos ) );
+		ring->Session = request;
+		Interlocked_Exchange( &header->Session, request );
+		Event_Signal( ring->DataReady );
+		return true;
+	}
+
+	bool SharedRing_IsAttached( SharedRing_s* ring )
+	{
+		const int32_t request = Interlocked_Load( &ring->Header->Request );
+		return request && (request == ring->Session);
+	}
+
+	Result_t SharedRing_Write( SharedRing_s* ring, const uint8_t* data, uint32_t size )
+	{
+		SharedRingHeader_s* header = ring->Header;
+		const uint32_t capacity = header->Capacity;
+		const uint32_t length = SharedRing_AlignRecord( size );
+		NeAssert(length <= capacity/2);
+
+		const int64_t write = Interlocked_Load64( &header->WritePos );
+		const uint32_t tail = capacity - (uint32_t)(write & (capacity-1));
+		const uint32_t needed = (tail < length) ? (tail + length) : length;
+
+		if (!SharedRing_IsAttached( ring ))
+			return NE_ERR_NOT_FOUND;
+
+		// the dispatcher must not stall, so a full ring drops the viewer.
+		// it attaches again and starts over with the backlog.
+		if (capacity - (write - Interlocked_Load64( &header->ReadPos )) < needed)
+		{
+			SharedRing_Detach( ring );
+			return NE_ERROR;
+		}
+
+		// packets never wrap, so the viewer can parse them in place
+		int64_t pos = write;
+		if (tail < length)
+		{
+			SharedRing_GetRecord( ring, pos )->Size = 0;
+			pos += tail;
+		}
+		SharedRecord_s* record = SharedRing_GetRecord( ring, pos );
+		record->Size = size;
+		Mem_Cpy( record+1, data, size );
+		Interlocked_Exchange64( &header->WritePos, pos + length );
+
+		// only wake the viewer when it went to sleep
+		if (Interlocked_Exchange( &header->ReaderWaiting, 0 ))
+			Event_Signal( ring->DataReady );
+		return NE_OK;
+	}
+
+	void SharedRing_Destroy( SharedRing_s* ring )
+	{
+		if (!ring->Header)
+			return;
+		Interlocked_Exchange( &ring->Header->Closed, 1 );
+		Event_Signal( ring->DataReady );
+		SharedRing_Unmap( ring );
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{ 
+	Result_t SharedRing_Open( SharedRing_s* ring, cstr_t name )
+	{
+		NeZero(*ring);
+		ptr_t base = SharedMem_Open( name, 0, &ring->Mapping );
+		if (!base)
+			return NE_ERR_NOT_FOUND;
+		ring->Header = (SharedRingHeader_s*)base;
+		ring->Data	 = (uint8_t*)(ring->Header+1);
+		if ((ring->Header->Magic != SHARED_RING_MAGIC) || !SharedRing_OpenEvents( ring, name, false ))
+		{
+			SharedRing_Unmap( ring );
+			return NE_ERR_NOT_FOUND;
+		}
+		return NE_OK;
+	}
+
+	bool SharedRing_IsClosed( SharedRing_s* ring )
+	{
+		return Interlocked_Load( &ring->Header->Closed ) != 0;
+	}
+
+	void SharedRing_Attach( SharedRing_s* ring )
+	{
+		int32_t request = Interlocked_Load( &ring->Header->Session ) + 1;
+		if (!request)
+			request = 1;
+		ring->Session = request;
+		ring->Pending = 0;
+		Interlocked_Exchange( &ring->Header->Request, request );
+	}
+
+	const uint8_t* SharedRing_Peek( SharedRing_s* ring, uint32_t& size, uint32_t ms )
+	{
+		SharedRingHeader_s* header = ring->Header;
+
+		// the server accepts the request with its next packet
+		if (Interlocked_Load( &header->Session ) != ring->Session)
+		{
+			Event_WaitMs( ring->DataReady, ms );
+			return nullptr;
+		}
+
+		const uint32_t capacity = header->Capacity;
+		for ( bool waited = false; ; )
+		{
+			const int64_t read  = Interlocked_Load64( &header->ReadPos );
+			const int64_t write = Interlocked_Load64( &header->WritePos );
+			if (read == write)
+			{
+				if (waited)
+					return nullptr;
+				Interlocked_Exchange( &header->ReaderWaiting, 1 );
+				if (read == Interlocked_Load64( &header->WritePos ))
+					Event_WaitMs( ring->DataReady, ms );
+				Interlocked_Exchange( &header->ReaderWaiting, 0 );
+				waited = true;
+				continue;
+			}
+
+			// records must lie within the written bytes and never wrap
+			const int64_t  avail = write - read;
+			const uint32_t tail  = capacity - (uint32_t)(read & (capacity-1));
+			const uint32_t record_size = SharedRing_GetRecord( ring, read )->Size;
+			const int64_t  length = record_size ? SharedRing_AlignRecord( NeMin( record_size, capacity ) ) : tail;
+			if ((avail < 0) || (avail > capacity) || (record_size > capacity) || (length > tail) || (length > avail))
+			{
+				SharedRing_Detach( ring );
+				return nullptr;
+			}
+
+			// the server moves the read position when it accepts a new viewer
+			if (!record_size)
+			{
+				Interlocked_CompareExchange64( &header->ReadPos, read + tail, read );
+				continue;
+			}
+
+			size		  = record_size;
+			ring->Read	  = read;
+			ring->Pending = (uint32_t)length;
+			return (const uint8_t*)(SharedRing_GetRecord( ring, read )+1);
+		}
+	}
+
+	void SharedRing_Release( SharedRing_s* ring )
+	{
+		if (!ring->Pending)
+			return;
+		Interlocked_CompareExchange64( &ring->Header->ReadPos, ring->Read + ring->Pending, ring->Read );
+		ring->Pending = 0;
+	}
+
+	void SharedRing_Close( SharedRing_s* ring )
+	{
+		if (!ring->Header)
+			return;
+		SharedRing_Detach( ring );
+		SharedRing_Unmap( ring );
+	}
+
+} }
@@ -0,0 +1,71 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+#include "Types.h"
+
+//======================================================================================
+#include <Nemesis/Core/AtomicTypes.h>
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{ 
+	/// Control block at the start of the shared segment.
+	/// Positions only ever grow, the offset into the ring is (pos & (Capacity-1)).
+	struct SharedRingHeader_s
+	{
+		uint32_t	Magic;
+		uint32_t	Capacity;
+		Atomic32	Closed;
+		Atomic32	Request;
+		Atomic32	Session;
+		uint8_t		_pad0_[ 44 ];
+		Atomic64	WritePos;
+		Atomic32	ReaderWaiting;
+		uint8_t		_pad1_[ 52 ];
+		Atomic64	ReadPos;
+		uint8_t		_pad2_[ 56 ];
+	};
+
+	/// Prefix of every packet in the ring, a size of zero skips to the start of the ring.
+	struct SharedRecord_s
+	{
+		uint32_t Size;
+		uint32_t _pad_;
+	};
+
+	/// Single producer, single consumer packet ring in named shared memory.
+	/// The server writes whole packets, the viewer reads them in place.
+	/// The server never waits, a viewer that falls behind is detached and attaches again.
+	struct SharedRing_s
+	{
+		SharedRingHeader_s*	Header;
+		uint8_t*			Data;
+		Handle_t			Mapping;
+		Event_t				DataReady;
+		int64_t				Read;
+		int32_t				Session;
+		uint32_t			Pending;
+	};
+
+	Result_t		SharedRing_Create	( SharedRing_s* ring, cstr_t name, uint32_t capacity );
+	bool			SharedRing_Accept	( SharedRing_s* ring );
+	bool			SharedRing_IsAttached( SharedRing_s* ring );
+	Result_t		SharedRing_Write	( SharedRing_s* ring, const uint8_t* data, uint32_t size );
+	void			SharedRing_Destroy	( SharedRing_s* ring );
+
+	Result_t		SharedRing_Open		( SharedRing_s* ring, cstr_t name );
+	bool			SharedRing_IsClosed	( SharedRing_s* ring );
+	void			SharedRing_Attach	( SharedRing_s* ring );
+	const uint8_t*	SharedRing_Peek		( SharedRing_s* ring, uint32_t& size, uint32_t ms );
+	void			SharedRing_Release	( SharedRing_s* ring );
+	void			SharedRing_Close	( SharedRing_s* ring );
+
+} }
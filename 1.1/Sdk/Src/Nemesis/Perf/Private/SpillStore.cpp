@@ -0,0 +1,107 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#include "stdafx.h"
+#include "SpillStore.h"
+
+//======================================================================================
+#include <Nemesis/Core/Array.h>
+#include <Nemesis/Core/File.h>
+
+//======================================================================================
+using namespace nemesis::system;
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	static SpillSlots_s* SpillStore_GetSlots( SpillStore_s& store, size_t size )
+	{
+		for ( int i = 0; i < store.Slots.Count; ++i )
+		{
+			if (store.Slots[i].Size == size)
+				return &store.Slots[i];
+		}
+		SpillSlots_s& slots = store.Slots.Append();
+		slots.Size = size;
+		slots.Free.Init( store.Slots.Alloc );
+		return &slots;
+	}
+
+} }
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	void SpillStore_Initialize( SpillStore_s& store, Allocator_t alloc )
+	{
+		NeZero( store );
+		store.Slots.Init( alloc );
+	}
+
+	/// Creates the spill file. It is deleted again when the store is closed.
+	bool SpillStore_Open( SpillStore_s& store, cstr_t path, size_t capacity )
+	{
+		SpillStore_Close( store );
+		store.View = (uint8_t*)File_MapTemp( path, capacity, &store.Handle );
+		if (!store.View)
+			return false;
+		store.Capacity = capacity;
+		return true;
+	}
+
+	void SpillStore_Close( SpillStore_s& store )
+	{
+		for ( int i = 0; i < store.Slots.Count; ++i )
+			store.Slots[i].Free.Clear();
+		store.Slots.Clear();
+		File_Unmap( store.View, store.Handle );
+		store.View = nullptr;
+		store.Handle = nullptr;
+		store.Capacity = 0;
+		store.Used = 0;
+	}
+
+	/// Releases all slots at once.
+	void SpillStore_Reset( SpillStore_s& store )
+	{
+		for ( int i = 0; i < store.Slots.Count; ++i )
+			store.Slots[i].Free.Reset();
+		store.Used = 0;
+	}
+
+	/// Returns a slot of the given size or null if the file is full.
+	ptr_t SpillStore_Alloc( SpillStore_s& store, size_t size )
+	{
+		if (!store.View)
+			return nullptr;
+		SpillSlots_s* slots = SpillStore_GetSlots( store, size );
+		if (slots->Free.Count)
+		{
+			ptr_t slot = slots->Free[ slots->Free.Count-1 ];
+			slots->Free.RemoveAt( slots->Free.Count-1 );
+			return slot;
+		}
+		if ((store.Capacity - store.Used) < size)
+			return nullptr;
+		ptr_t slot = store.View + store.Used;
+		store.Used += size;
+		return slot;
+	}
+
+	void SpillStore_Free( SpillStore_s& store, ptr_t slot, size_t size )
+	{
+		NeAssert(SpillStore_Contains( store, slot ));
+		SpillStore_GetSlots( store, size )->Free.Append( slot );
+	}
+
+	bool SpillStore_Contains( const SpillStore_s& store, cptr_t ptr )
+	{
+		return (ptr >= store.View) && (ptr < (store.View + store.Capacity));
+	}
+
+} }
@@ -0,0 +1,43 @@
+//======================================================================================
+// Copyright(C) Piranha Bytes GmbH & THQ Nordic GmbH 2023
+//======================================================================================
+// This file is part of the Nemesis Profiler.
+// Nemesis Profiler is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+// Nemesis Profiler is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with Nemesis Profiler. If not, see <https://www.gnu.org/licenses/>.
+//======================================================================================
+#pragma once
+
+//======================================================================================
+#include "Types.h"
+
+//======================================================================================
+namespace nemesis { namespace profiling
+{
+	/// Free slots of a single size.
+	struct SpillSlots_s
+	{
+		size_t		Size;
+		Array<ptr_t>	Free;
+	};
+
+	/// Fixed size file mapped for reading and writing which takes over segments from the heap.
+	/// Pages are written out and read back by the system on demand.
+	struct SpillStore_s
+	{
+		uint8_t*			View;
+		Handle_t			Handle;
+		size_t				Capacity;
+		size_t				Used;
+		Array<SpillSlots_s>	Slots;
+	};
+
+	void SpillStore_Initialize	( SpillStore_s& store, Allocator_t alloc );
+	bool SpillStore_Open		( SpillStore_s& store, cstr_t path, size_t capacity );
+	void SpillStore_Close		( SpillStore_s& store );
+	void SpillStore_Reset		( SpillStore_s& store );
+	ptr_t SpillStore_Alloc		( SpillStore_s& store, size_t size );
+	void SpillStore_Free		( SpillStore_s& store, ptr_t slot, size_t size );
+	bool SpillStore_Contains	( const SpillStore_s& store, cptr_t ptr );
+
+} }
@@ -24,6 +24,7 @@ namespace nemesis { namespace profiling
 	typedef struct BufferPool_s		*BufferPool_t;
 	typedef struct MainRecorder_s	*MainRecorder_t;
 	typedef struct ThreadRecorder_s	*ThreadRecorder_t;
+	typedef struct Registry_s		*Registry_t;
 
 	using system::TlsId_t;
 	using system::Event_t;
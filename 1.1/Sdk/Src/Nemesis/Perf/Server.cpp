@@ -60,6 +60,16 @@ namespace nemesis { namespace profiling
 		server->Responder = nullptr;
 	}
 
+	Result_t Server_StartSharedSender( Server_t server, const char* name )
+	{
+		return Sender_StartShared( &server->Sender, name );
+	}
+
+	void Server_StopSharedSender( Server_t server )
+	{
+		Sender_StopShared( &server->Sender );
+	}
+
 	void Server_Respond( Server_t server )
 	{
 		ping::Header hdr = {};
@@ -86,19 +96,14 @@ namespace nemesis { namespace profiling
 		MainRecorder_GetStats( &server->Recorder, recorder_stats );
 		stats.Value[ ServerStat::MaxThreads ] = MAX_NUM_THREADS;
 		stats.Value[ ServerStat::NumThreads ] = recorder_stats.NumThreads;
-		for ( uint32_t i = 0; i < recorder_stats.NumThreads; ++i )
-		{
-			stats.Value[ ServerStat::NumNames  ] += recorder_stats.Thread[ i ].NumNames;
-			stats.Value[ ServerStat::NumScopes ] += recorder_stats.Thread[ i ].NumLocations;
-			stats.Value[ ServerStat::NumLocks  ] += recorder_stats.Thread[ i ].NumLocks;
-		}
-
-		const Backlog_s* backlog = &server->Sender.Dispatcher.Backlog;
-		const size_t backlog_capacity = backlog->Buffer.Count * sizeof(Buffer_s::Data);
+		stats.Value[ ServerStat::NumNames   ] = recorder_stats.Registry.NumNames;
+		stats.Value[ ServerStat::NumScopes  ] = recorder_stats.Registry.NumLocations;
+		stats.Value[ ServerStat::NumLocks   ] = recorder_stats.Registry.NumLocks;
+		stats.Value[ ServerStat::NumDynamicNames ] = recorder_stats.Registry.NumDynamicNames;
+
 		size_t backlog_size = 0;
-		const int num_buffers = backlog->Buffer.Count;
-		for ( int i = 0; i < num_buffers; ++i )
-			backlog_size += backlog->Buffer[i]->Count;
+		size_t backlog_capacity = 0;
+		Backlog_GetSize( &server->Sender.Dispatcher.Backlog, backlog_size, backlog_capacity );
 
 		stats.Value[ ServerStat::BacklogCapacity ] = (uint32_t)backlog_capacity;
 		stats.Value[ ServerStat::BacklogSize     ] = (uint32_t)backlog_size;
@@ -150,6 +155,9 @@ namespace nemesis { namespace profiling
 	void Server_LeaveScope( Server_t server, const NamedLocation& scope )
 	{ return MainRecorder_LeaveScope( &server->Recorder, scope ); }
 
+	void Server_EnterDynamicScope( Server_t server, const NamedLocation& scope, const char* name, ScopeType::Enum type )
+	{ return MainRecorder_EnterDynamicScope( &server->Recorder, scope, name, type ); }
+
 	void Server_SetMutexInfo( Server_t server, const void* handle, const char* name )
 	{ return MainRecorder_SetMutexInfo( &server->Recorder, handle, name ); }
 
@@ -238,6 +246,9 @@ namespace nemesis { namespace profiling
 	void Server_LeaveScope( const NamedLocation& scope )
 	{ return MainRecorder_LeaveScope( &TheServer->Recorder, scope ); }
 
+	void Server_EnterDynamicScope( const NamedLocation& scope, const char* name, ScopeType::Enum type )
+	{ return MainRecorder_EnterDynamicScope( &TheServer->Recorder, scope, name, type ); }
+
 	void Server_SetMutexInfo( const void* handle, const char* name )
 	{ return MainRecorder_SetMutexInfo( &TheServer->Recorder, handle, name ); }
 
@@ -267,4 +278,10 @@ namespace nemesis { namespace profiling
 
 	void Server_StopSender()
 	{ return Server_StopSender( TheServer ); }
+
+	Result_t Server_StartSharedSender( const char* name )
+	{ return Server_StartSharedSender( TheServer, name ); }
+
+	void Server_StopSharedSender()
+	{ return Server_StopSharedSender( TheServer ); }
 } }
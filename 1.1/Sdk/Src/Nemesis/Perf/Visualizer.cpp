@@ -12,6 +12,8 @@
 #include "Private/Parser.h"
 #include "Private/Receiver.h"
 #include "Private/Database.h"
+#include "Private/DatabaseFile.h"
+#include "Private/DatabaseTrace.h"
 
 //======================================================================================
 namespace nemesis { namespace profiling 
@@ -100,6 +102,18 @@ namespace nemesis { namespace profiling
 		Mem_Free( alloc, db );
 	}
 
+	bool Database_Save( Database_t db, cstr_t path )
+	{ return DatabaseFile_Save( db, path ); }
+
+	bool Database_Open( Database_t db, cstr_t path )
+	{ return DatabaseFile_Open( db, path ); }
+
+	bool Database_ExportTrace( Database_t db, cstr_t path )
+	{ return DatabaseTrace_Export( db, path ); }
+
+	bool Database_ImportTrace( Database_t db, cstr_t path )
+	{ return DatabaseTrace_Import( db, path ); }
+
 	size_t Database_GetSize( Database_t db )
 	{ return Database_TotalSize( db ); }
 
@@ -119,19 +133,19 @@ namespace nemesis { namespace profiling
 	Tick Database_GetFirstTick( Database_t db )
 	{ 
 		const ParsedData_s& data = Database_GetData( db );
-		return data.Frames.Count ? data.Frames[0].Time.Begin : 0; 
+		return data.NumFrames() ? data.GetFrame( 0 ).Time.Begin : 0; 
 	}
 
 	Tick Database_GetLastEndTick( Database_t db )
 	{ 
 		const ParsedData_s& data = Database_GetData( db );
-		return data.Frames.Count ? data.Frames.Data[data.Frames.Count-1].Time.End : 0; 
+		return data.NumFrames() ? data.GetFrame( data.NumFrames()-1 ).Time.End : 0; 
 	}
 
 	Tick Database_GetLastBeginTick( Database_t db )
 	{ 
 		const ParsedData_s& data = Database_GetData( db );
-		return data.Frames.Count ? data.Frames.Data[data.Frames.Count-1].Time.Begin : 0;
+		return data.NumFrames() ? data.GetFrame( data.NumFrames()-1 ).Time.Begin : 0;
 	}
 
 	Tick Database_GetMaxFrameDuration( Database_t db )
@@ -140,7 +154,7 @@ namespace nemesis { namespace profiling
 	uint32_t Database_GetFirstFrameNumber( Database_t db )
 	{ 
 		const ParsedData_s& data = Database_GetData( db );
-		return data.LastFrameNumber - data.Frames.Count+1; 
+		return data.FirstFrameNumber(); 
 	}
 
 	uint32_t Database_GetLastFrameNumber( Database_t db )
@@ -177,13 +191,13 @@ namespace nemesis { namespace profiling
 	{ item = Database_GetData( db ).Threads.Item[ index ]; }
 
 	int Database_GetNumFrames( Database_t db )
-	{ return Database_GetData( db ).Frames.Count; }
+	{ return Database_GetData( db ).NumFrames(); }
 
 	void Database_GetFrame( Database_t db, int index, viz::Frame& item )
-	{ item = Database_GetData( db ).Frames[ index ]; }
+	{ item = Database_GetData( db ).GetFrame( index ); }
 
-	const viz::Frame* Database_GetFrames( Database_t db )
-	{ return Database_GetData( db ).Frames.Data; }
+	const viz::Frame& Database_GetFrame( Database_t db, int index )
+	{ return Database_GetData( db ).GetFrame( index ); }
 
 	int Database_GetNumLocks( Database_t db )
 	{ return Database_GetData( db ).Locks.Count; }
@@ -204,10 +218,13 @@ namespace nemesis { namespace profiling
 	{ item = Database_GetData( db ).CounterGroups[ index ]; }
 
 	int Database_GetNumCounterValues( Database_t db )
-	{ return Database_GetData( db ).CounterValues.Count; }
+	{ return (int)Database_GetData( db ).CounterValues.Count(); }
 
 	void Database_GetCounterValue( Database_t db, int index, viz::CounterValue& item )
-	{ item = Database_GetData( db ).CounterValues[ index ]; }
+	{ item = Database_GetData( db ).CounterValues[ (uint32_t)index ]; }
+
+	int Database_GetCounterSeries( Database_t db, int counter_index, const TickInterval& time, viz::CounterRange* items, int max_items )
+	{ return ParsedData_GetCounterSeries( Database_GetData( db ), counter_index, time, items, max_items ); }
 
 	int Database_GetNumLocations( Database_t db )
 	{ return Database_GetData( db ).Locations.Count; }
@@ -221,11 +238,11 @@ namespace nemesis { namespace profiling
 			item = INVALID_LOCATION;
 	}
 
-	void Database_GetLocationByZone( Database_t db, int zone, NamedLocation& item )
-	{ return Database_GetLocation( db, Database_GetData( db ).Scopes.Data[ zone ].Location, item ); }
+	void Database_GetLocationByZone( Database_t db, int thread_index, int zone, NamedLocation& item )
+	{ return Database_GetLocation( db, ParsedData_GetScopeLocation( Database_GetData( db ), thread_index, (uint32_t)zone ), item ); }
 
 	int Database_GetNumScopes( Database_t db )
-	{ return Database_GetData( db ).Scopes.Count; }
+	{ return (int)Database_GetData( db ).NumScopes(); }
 
 	void Database_EnumFrameGroups( Database_t db, const viz::FrameRange& cull, const viz::FrameGroupSetup& setup, EnumFrameGroupsFunc func, void* context )
 	{ return ParsedData_EnumFrameGroups( Database_GetData( db ), cull, setup, func, context ); }
@@ -239,7 +256,55 @@ namespace nemesis { namespace profiling
 	void Database_EnumLockEvents( Database_t db, int lock_index, int first_frame, int num_frames, EnumLockEventFunc func, void* context )
 	{ return ParsedData_EnumLockEvents( Database_GetData( db ), lock_index, first_frame, num_frames, func, context ); }
 
+	bool Database_GetLockStats( Database_t db, int lock_index, const IndexRange& frames, viz::LockStats& stats )
+	{ 
+		if (lock_index < 0)
+			return false;
+		return ParsedData_GetLockStats( Database_GetData( db ), (uint32_t)lock_index, frames, stats ); 
+	}
+
+	int Database_GetContendedLocks( Database_t db, const IndexRange& frames, int* locks, viz::LockStats* stats, int max_items )
+	{ return ParsedData_GetContendedLocks( Database_GetData( db ), frames, locks, stats, max_items ); }
+
+	int Database_QueryZones( Database_t db, const viz::ZoneQuery& query, viz::ZoneQueryRow* rows, int max_rows )
+	{ return ParsedData_QueryZones( Database_GetData( db ), db->QueryPool, query, rows, max_rows ); }
+
+	bool Database_QueryZone( Database_t db, int thread_index, uint32_t zone, viz::ZoneQueryRow& row )
+	{ return ParsedData_QueryZone( Database_GetData( db ), thread_index, zone, row ); }
+
+	int Database_GetOpenZones( Database_t db, int thread_index, uint32_t* zones, int max_zones )
+	{ return ParsedData_GetOpenZones( Database_GetData( db ), thread_index, zones, max_zones ); }
+
 	void Database_BuildHotSpots( Database_t db, const viz::HotSpotRange& range, viz::HotSpotGroup& group )
 	{ return ParsedData_BuildHotSpots( Database_GetData( db ), range, group ); }
 
+	bool Database_GetLocationStats( Database_t db, int location, const IndexRange& frames, viz::LocationStats& stats )
+	{ 
+		if (location < 0)
+			return false;
+		return ParsedData_GetLocationStats( Database_GetData( db ), (uint32_t)location, frames, stats ); 
+	}
+
+	bool Database_GetLocationTotalStats( Database_t db, int location, viz::LocationStats& stats )
+	{ 
+		if (location < 0)
+			return false;
+		return ParsedStats_GetTotal( Database_GetData( db ).Stats, (uint32_t)location, stats ); 
+	}
+
+	bool Database_FindNextOccurrence( Database_t db, int location, Tick tick, viz::Occurrence& item )
+	{ return (location >= 0) && ParsedData_FindNextOccurrence( Database_GetData( db ), (uint32_t)location, tick, item ); }
+
+	bool Database_FindPrevOccurrence( Database_t db, int location, Tick tick, viz::Occurrence& item )
+	{ return (location >= 0) && ParsedData_FindPrevOccurrence( Database_GetData( db ), (uint32_t)location, tick, item ); }
+
+	bool Database_FindLongestOccurrence( Database_t db, int location, const IndexRange& frames, viz::Occurrence& item )
+	{ return (location >= 0) && ParsedData_FindLongestOccurrence( Database_GetData( db ), (uint32_t)location, frames, item ); }
+
+	void Database_EnumOccurrences( Database_t db, int location, const TickInterval& time, EnumOccurrencesFunc func, void* context )
+	{ 
+		if (location >= 0) 
+			ParsedData_EnumOccurrences( Database_GetData( db ), (uint32_t)location, time, func, context ); 
+	}
+
 } }